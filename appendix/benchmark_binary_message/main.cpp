@@ -0,0 +1,90 @@
+#include "binary_message.hpp"
+#include <chrono>
+#include <iostream>
+
+namespace {
+const size_t events_count = 100000;
+
+template <typename T>
+void measure(const std::string& name, T function) {
+  auto begin = std::chrono::steady_clock::now();
+  function();
+  auto end = std::chrono::steady_clock::now();
+
+  std::cout << name << ": "
+            << std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count() / 1000.0
+            << " ms" << std::endl;
+}
+} // namespace
+
+int main(int argc, const char* argv[]) {
+  size_t count = 0;
+
+  std::cout << "events: " << events_count << std::endl;
+
+  // MessagePack (one message per event)
+
+  measure("msgpack (encode + decode)", [&] {
+    for (size_t i = 0; i < events_count; ++i) {
+      nlohmann::json json{
+          {"operation_type", krbn::operation_type::key_down_up_valued_event_arrived},
+          {"device_id", krbn::device_id(i)},
+          {"key_down_up_valued_event", krbn::key_down_up_valued_event(krbn::key_code::a)},
+          {"event_type", krbn::event_type::key_down},
+          {"time_stamp", krbn::absolute_time_point(i)},
+      };
+      auto buffer = nlohmann::json::to_msgpack(json);
+
+      auto j = nlohmann::json::from_msgpack(buffer);
+      if (j.at("operation_type").get<krbn::operation_type>() == krbn::operation_type::key_down_up_valued_event_arrived) {
+        auto device_id = j.at("device_id").get<krbn::device_id>();
+        auto event = j.at("key_down_up_valued_event").get<krbn::key_down_up_valued_event>();
+        auto event_type = j.at("event_type").get<krbn::event_type>();
+        auto time_stamp = j.at("time_stamp").get<krbn::absolute_time_point>();
+        count += type_safe::get(device_id) + event.modifier_flag() + static_cast<int>(event_type) + type_safe::get(time_stamp);
+      }
+    }
+  });
+
+  // Binary (one message per event)
+
+  auto decode = [&](const std::vector<uint8_t>& buffer) {
+    if (krbn::binary_message::read_header(buffer).operation == krbn::operation_type::key_down_up_valued_event_arrived) {
+      krbn::binary_message::for_each_entry<krbn::binary_message::key_down_up_valued_event_entry>(buffer, [&](auto&& entry) {
+        auto event = krbn::binary_message::make_key_down_up_valued_event(entry);
+        count += entry.device_id + event->modifier_flag() + entry.event_type + entry.time_stamp;
+      });
+    }
+  };
+
+  measure("binary (encode + decode)", [&] {
+    for (size_t i = 0; i < events_count; ++i) {
+      auto entry = krbn::binary_message::make_key_down_up_valued_event_entry(krbn::device_id(i),
+                                                                             krbn::key_down_up_valued_event(krbn::key_code::a),
+                                                                             krbn::event_type::key_down,
+                                                                             krbn::absolute_time_point(i));
+      decode(krbn::binary_message::make_key_down_up_valued_events_arrived_message(&entry, 1));
+    }
+  });
+
+  // Binary (batched)
+
+  measure("binary batched (encode + decode)", [&] {
+    std::vector<krbn::binary_message::key_down_up_valued_event_entry> entries;
+    for (size_t i = 0; i < events_count; ++i) {
+      entries.push_back(krbn::binary_message::make_key_down_up_valued_event_entry(krbn::device_id(i),
+                                                                                  krbn::key_down_up_valued_event(krbn::key_code::a),
+                                                                                  krbn::event_type::key_down,
+                                                                                  krbn::absolute_time_point(i)));
+    }
+
+    for (size_t i = 0; i < entries.size(); i += krbn::binary_message::max_entries_per_message) {
+      decode(krbn::binary_message::make_key_down_up_valued_events_arrived_message(&(entries[i]),
+                                                                                  std::min(entries.size() - i, krbn::binary_message::max_entries_per_message)));
+    }
+  });
+
+  std::cout << "(" << count << ")" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,95 @@
+#include "dispatcher_utility.hpp"
+#include "grabber/device_grabber_details/complex_modifications_manipulator_manager.hpp"
+#include <chrono>
+#include <iostream>
+
+namespace {
+const size_t manipulators_count = 5000;
+
+nlohmann::json make_profile_json(const std::string& changed_to_key_code) {
+  auto rules = nlohmann::json::array();
+
+  for (size_t i = 0; i < manipulators_count; ++i) {
+    auto to_key_code = (i == manipulators_count / 2) ? changed_to_key_code : "b";
+
+    rules.push_back(nlohmann::json::object({
+        {"description", fmt::format("rule {0}", i)},
+        {"manipulators", nlohmann::json::array({
+                             nlohmann::json::object({
+                                 {"type", "basic"},
+                                 {"from", nlohmann::json::object({
+                                              {"key_code", "a"},
+                                              {"modifiers", nlohmann::json::object({{"mandatory", nlohmann::json::array({"left_shift"})}})},
+                                          })},
+                                 {"to", nlohmann::json::array({nlohmann::json::object({{"key_code", to_key_code}})})},
+                                 {"conditions", nlohmann::json::array({
+                                                    nlohmann::json::object({
+                                                        {"type", "frontmost_application_if"},
+                                                        {"bundle_identifiers", nlohmann::json::array({fmt::format("^com\\.example\\.app{0}$", i)})},
+                                                    }),
+                                                })},
+                             }),
+                         })},
+    }));
+  }
+
+  return nlohmann::json::object({
+      {"name", "benchmark"},
+      {"complex_modifications", nlohmann::json::object({{"rules", rules}})},
+  });
+}
+
+template <typename T>
+void measure(const std::string& name, T function) {
+  auto begin = std::chrono::steady_clock::now();
+  function();
+  auto end = std::chrono::steady_clock::now();
+
+  std::cout << name << ": "
+            << std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count() / 1000.0
+            << " ms" << std::endl;
+}
+} // namespace
+
+int main(int argc, const char* argv[]) {
+  krbn::dispatcher_utility::initialize_dispatchers();
+
+  {
+    krbn::core_configuration::details::profile profile1(make_profile_json("b"));
+    krbn::core_configuration::details::profile profile2(make_profile_json("c"));
+
+    std::cout << "manipulators: " << manipulators_count << std::endl;
+
+    auto manager = std::make_unique<krbn::grabber::device_grabber_details::complex_modifications_manipulator_manager>();
+
+    measure("initial build", [&] {
+      manager->update(profile1);
+    });
+
+    measure("reload (one rule changed)", [&] {
+      manager->update(profile2);
+    });
+
+    measure("reload (no changes)", [&] {
+      manager->update(profile2);
+    });
+
+    measure("switch to cached profile", [&] {
+      manager->update(profile1);
+    });
+
+    manager = nullptr;
+
+    auto full_rebuild_manager = std::make_unique<krbn::grabber::device_grabber_details::complex_modifications_manipulator_manager>();
+
+    measure("full rebuild (previous behavior)", [&] {
+      full_rebuild_manager->update(profile2);
+    });
+
+    full_rebuild_manager = nullptr;
+  }
+
+  krbn::dispatcher_utility::terminate_dispatchers();
+
+  return 0;
+}
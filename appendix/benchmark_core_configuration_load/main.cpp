@@ -0,0 +1,156 @@
+#include "core_configuration/core_configuration.hpp"
+#include "dispatcher_utility.hpp"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <new>
+
+// Track live heap bytes of the process in order to measure the peak memory usage of loading.
+
+namespace {
+std::atomic<uint64_t> live_bytes(0);
+std::atomic<uint64_t> peak_live_bytes(0);
+
+// The allocation size is stored in front of the returned pointer.
+const size_t header_size = alignof(std::max_align_t);
+} // namespace
+
+void* operator new(size_t size) {
+  if (auto p = static_cast<uint8_t*>(malloc(size + header_size))) {
+    *reinterpret_cast<size_t*>(p) = size;
+
+    auto bytes = (live_bytes += size);
+    auto peak = peak_live_bytes.load();
+    while (peak < bytes && !peak_live_bytes.compare_exchange_weak(peak, bytes)) {
+    }
+
+    return p + header_size;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+  if (p) {
+    auto q = static_cast<uint8_t*>(p) - header_size;
+    live_bytes -= *reinterpret_cast<size_t*>(q);
+    free(q);
+  }
+}
+
+namespace {
+const size_t rules_count = 1100;
+const std::string file_path = "tmp/karabiner.json";
+
+void write_core_configuration_file(void) {
+  auto rules = nlohmann::json::array();
+
+  for (size_t i = 0; i < rules_count; ++i) {
+    auto manipulators = nlohmann::json::array();
+
+    for (const auto& from : {"a", "s", "d"}) {
+      manipulators.push_back(nlohmann::json::object({
+          {"type", "basic"},
+          {"from", nlohmann::json::object({
+                       {"key_code", from},
+                       {"modifiers", nlohmann::json::object({{"mandatory", nlohmann::json::array({"left_control"})},
+                                                             {"optional", nlohmann::json::array({"any"})}})},
+                   })},
+          {"to", nlohmann::json::array({
+                     nlohmann::json::object({{"key_code", "left_arrow"}}),
+                 })},
+          {"conditions", nlohmann::json::array({
+                             nlohmann::json::object({
+                                 {"type", "frontmost_application_if"},
+                                 {"bundle_identifiers", nlohmann::json::array({fmt::format("^com\\.example\\.app{0}$", i)})},
+                             }),
+                             nlohmann::json::object({
+                                 {"type", "variable_if"},
+                                 {"name", fmt::format("mode{0}", i)},
+                                 {"value", 1},
+                             }),
+                         })},
+      }));
+    }
+
+    rules.push_back(nlohmann::json::object({
+        {"description", fmt::format("rule {0}", i)},
+        {"manipulators", manipulators},
+    }));
+  }
+
+  auto json = nlohmann::json::object({
+      {"profiles", nlohmann::json::array({
+                       nlohmann::json::object({
+                           {"name", "benchmark"},
+                           {"selected", true},
+                           {"complex_modifications", nlohmann::json::object({{"rules", rules}})},
+                       }),
+                   })},
+  });
+
+  std::ofstream output(file_path);
+  output << std::setw(4) << json << std::endl;
+}
+
+std::shared_ptr<std::vector<uint8_t>> read_file(void) {
+  std::ifstream input(file_path, std::ios::binary);
+  return std::make_shared<std::vector<uint8_t>>(std::istreambuf_iterator<char>(input),
+                                                std::istreambuf_iterator<char>());
+}
+
+template <typename T>
+void measure(const std::string& name, T function) {
+  auto base_bytes = live_bytes.load();
+  peak_live_bytes = base_bytes;
+
+  auto begin = std::chrono::steady_clock::now();
+  function();
+  auto end = std::chrono::steady_clock::now();
+
+  std::cout << name << ": "
+            << std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count() / 1000.0
+            << " ms, peak "
+            << (peak_live_bytes.load() - base_bytes) / 1024 / 1024
+            << " MB" << std::endl;
+}
+} // namespace
+
+int main(int argc, const char* argv[]) {
+  krbn::dispatcher_utility::initialize_dispatchers();
+
+  {
+    system("rm -rf tmp");
+    system("mkdir -p tmp");
+
+    write_core_configuration_file();
+
+    auto file_body = read_file();
+
+    std::cout << "file size: " << file_body->size() / 1024 << " KB" << std::endl;
+
+    measure("load (read file)", [&] {
+      krbn::core_configuration::core_configuration configuration(file_path);
+    });
+
+    measure("load (file_body)", [&] {
+      krbn::core_configuration::core_configuration configuration(file_path, file_body);
+    });
+
+    {
+      krbn::core_configuration::core_configuration configuration(file_path, file_body);
+
+      measure("copy selected profile", [&] {
+        auto profile = configuration.get_selected_profile();
+      });
+
+      measure("to_json", [&] {
+        configuration.to_json();
+      });
+    }
+  }
+
+  krbn::dispatcher_utility::terminate_dispatchers();
+
+  return 0;
+}
@@ -0,0 +1,106 @@
+#include <chrono>
+#include <iostream>
+#include <pqrs/dispatcher.hpp>
+#include <pqrs/thread_wait.hpp>
+#include <random>
+
+namespace {
+const size_t tasks_count = 200000;
+const size_t delayed_tasks_count = 20000;
+const size_t objects_count = 1000;
+
+template <typename T>
+void measure(const std::string& name, T function) {
+  auto begin = std::chrono::steady_clock::now();
+  function();
+  auto end = std::chrono::steady_clock::now();
+
+  std::cout << name << ": "
+            << std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count() / 1000.0
+            << " ms" << std::endl;
+}
+} // namespace
+
+int main(int argc, const char* argv[]) {
+  auto time_source = std::make_shared<pqrs::dispatcher::hardware_time_source>();
+  auto dispatcher = std::make_shared<pqrs::dispatcher::dispatcher>(time_source);
+
+  std::cout << "tasks: " << tasks_count << std::endl;
+  std::cout << "delayed tasks: " << delayed_tasks_count << std::endl;
+  std::cout << "objects: " << objects_count << std::endl;
+
+  // Immediate tasks (enqueue + dispatch)
+
+  {
+    auto object_id = pqrs::dispatcher::make_new_object_id();
+    dispatcher->attach(object_id);
+
+    measure("immediate tasks (enqueue + dispatch)", [&] {
+      size_t count = 0;
+      auto wait = pqrs::make_thread_wait();
+
+      for (size_t i = 0; i < tasks_count; ++i) {
+        // A typical capture size in Karabiner-Elements (`this` + `shared_ptr`)
+        auto p = std::make_shared<size_t>(i);
+        dispatcher->enqueue(object_id, [&count, p, wait] {
+          if (++count == tasks_count) {
+            wait->notify();
+          }
+        });
+      }
+
+      wait->wait_notice();
+    });
+
+    dispatcher->detach(object_id);
+  }
+
+  // Delayed tasks (enqueue in random order)
+
+  {
+    auto object_id = pqrs::dispatcher::make_new_object_id();
+    dispatcher->attach(object_id);
+
+    std::mt19937 engine(0);
+    std::uniform_int_distribution<int> distribution(0, 60 * 60 * 1000);
+    auto now = time_source->now();
+
+    measure("delayed tasks (enqueue)", [&] {
+      for (size_t i = 0; i < delayed_tasks_count; ++i) {
+        dispatcher->enqueue(object_id,
+                            [] {},
+                            now + std::chrono::milliseconds(60 * 1000 + distribution(engine)));
+      }
+    });
+
+    measure("delayed tasks (detach)", [&] {
+      dispatcher->detach(object_id);
+    });
+  }
+
+  // Detach objects while other objects have pending tasks
+
+  {
+    std::vector<pqrs::dispatcher::object_id> object_ids;
+    for (size_t i = 0; i < objects_count; ++i) {
+      object_ids.push_back(pqrs::dispatcher::make_new_object_id());
+      dispatcher->attach(object_ids.back());
+    }
+
+    auto when = time_source->now() + std::chrono::milliseconds(60 * 1000);
+    for (size_t i = 0; i < delayed_tasks_count; ++i) {
+      dispatcher->enqueue(object_ids[i % objects_count], [] {}, when);
+    }
+
+    measure("detach objects", [&] {
+      for (const auto& object_id : object_ids) {
+        dispatcher->detach(object_id);
+      }
+    });
+  }
+
+  dispatcher->terminate();
+  dispatcher = nullptr;
+
+  return 0;
+}
@@ -0,0 +1,164 @@
+#include "manipulator/conditions/input_source.hpp"
+#include <chrono>
+#include <iostream>
+
+namespace {
+const size_t events = 100000;
+// The input source is changed every `input_source_change_interval` events.
+const size_t input_source_change_interval = 1000;
+
+const std::vector<std::pair<std::string, std::string>> input_sources{
+    {"en", "com.apple.keylayout.US"},
+    {"ja", "com.apple.inputmethod.Kotoeri.Japanese"},
+    {"fr", "com.apple.keylayout.French"},
+    {"de", "com.apple.keylayout.German"},
+    {"ru", "com.apple.keylayout.Russian"},
+    {"ko", "com.apple.inputmethod.Korean.2SetKorean"},
+    {"zh-Hans", "com.apple.inputmethod.SCIM.ITABC"},
+    {"es", "com.apple.keylayout.Spanish"},
+};
+
+template <typename T>
+void measure(const std::string& name, T function) {
+  auto begin = std::chrono::steady_clock::now();
+  auto count = function();
+  auto end = std::chrono::steady_clock::now();
+
+  std::cout << name << ": "
+            << std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count() / 1000.0
+            << " ms"
+            << " (fulfilled: " << count << ")" << std::endl;
+}
+
+// Conditions of multilingual layer rules. (Each language has conditions for several layers.)
+std::vector<nlohmann::json> make_condition_jsons(void) {
+  std::vector<nlohmann::json> result;
+
+  for (int layer = 0; layer < 6; ++layer) {
+    for (const auto& [language, input_source_id] : input_sources) {
+      result.push_back(nlohmann::json::object({
+          {"type", layer % 2 == 0 ? "input_source_if" : "input_source_unless"},
+          {"input_sources", nlohmann::json::array({
+                                nlohmann::json::object({{"language", "^" + language + "$"}}),
+                                nlohmann::json::object({{"input_source_id", "^" + input_source_id + "$"}}),
+                                nlohmann::json::object({
+                                    {"language", "^" + language + "$"},
+                                    {"input_mode_id", "Roman$"},
+                                }),
+                            })},
+      }));
+    }
+  }
+
+  return result;
+}
+
+void set_input_source(krbn::manipulator::manipulator_environment& manipulator_environment,
+                      size_t event_index) {
+  if (event_index % input_source_change_interval == 0) {
+    auto& s = input_sources[(event_index / input_source_change_interval) % input_sources.size()];
+
+    pqrs::osx::input_source::properties properties;
+    properties.set_first_language(s.first);
+    properties.set_input_source_id(s.second);
+    manipulator_environment.set_input_source_properties(properties);
+  }
+}
+} // namespace
+
+int main(int argc, const char* argv[]) {
+  auto condition_jsons = make_condition_jsons();
+
+  krbn::event_queue::entry entry(krbn::device_id(1),
+                                 krbn::event_queue::event_time_stamp(krbn::absolute_time_point(0)),
+                                 krbn::event_queue::event(krbn::key_code::a),
+                                 krbn::event_type::key_down,
+                                 krbn::event_queue::event(krbn::key_code::a));
+
+  std::cout << "conditions: " << condition_jsons.size()
+            << ", events: " << events
+            << ", input source changes: " << events / input_source_change_interval << std::endl;
+
+  // The previous implementation (regex evaluation for each call) for comparison.
+
+  measure("per-call regex evaluation", [&] {
+    std::vector<std::pair<bool, std::vector<pqrs::osx::input_source_selector::specifier>>> conditions;
+    for (const auto& j : condition_jsons) {
+      conditions.emplace_back(j["type"] == "input_source_if",
+                              j["input_sources"].get<std::vector<pqrs::osx::input_source_selector::specifier>>());
+    }
+
+    krbn::manipulator::manipulator_environment manipulator_environment;
+    size_t count = 0;
+
+    for (size_t i = 0; i < events; ++i) {
+      set_input_source(manipulator_environment, i);
+
+      for (const auto& [input_source_if, specifiers] : conditions) {
+        bool found = false;
+        for (const auto& s : specifiers) {
+          if (s.test(manipulator_environment.get_input_source_properties())) {
+            found = true;
+            break;
+          }
+        }
+        if (found == input_source_if) {
+          ++count;
+        }
+      }
+    }
+
+    return count;
+  });
+
+  measure("input_source_matcher", [&] {
+    std::vector<std::pair<bool, std::vector<krbn::manipulator::input_source_matcher::specifier>>> conditions;
+    auto matcher = std::make_shared<krbn::manipulator::input_source_matcher>();
+    for (const auto& j : condition_jsons) {
+      std::vector<krbn::manipulator::input_source_matcher::specifier> specifiers;
+      for (const auto& s : j["input_sources"]) {
+        specifiers.push_back(matcher->make_specifier(s));
+      }
+      conditions.emplace_back(j["type"] == "input_source_if", specifiers);
+    }
+
+    krbn::manipulator::manipulator_environment manipulator_environment;
+    size_t count = 0;
+
+    for (size_t i = 0; i < events; ++i) {
+      set_input_source(manipulator_environment, i);
+
+      for (const auto& [input_source_if, specifiers] : conditions) {
+        if (matcher->test(specifiers, manipulator_environment) == input_source_if) {
+          ++count;
+        }
+      }
+    }
+
+    return count;
+  });
+
+  measure("conditions::input_source (input_source_matcher + result cache)", [&] {
+    std::vector<std::unique_ptr<krbn::manipulator::conditions::input_source>> conditions;
+    for (const auto& j : condition_jsons) {
+      conditions.push_back(std::make_unique<krbn::manipulator::conditions::input_source>(j));
+    }
+
+    krbn::manipulator::manipulator_environment manipulator_environment;
+    size_t count = 0;
+
+    for (size_t i = 0; i < events; ++i) {
+      set_input_source(manipulator_environment, i);
+
+      for (const auto& c : conditions) {
+        if (c->is_fulfilled(entry, manipulator_environment)) {
+          ++count;
+        }
+      }
+    }
+
+    return count;
+  });
+
+  return 0;
+}
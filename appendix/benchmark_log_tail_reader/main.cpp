@@ -0,0 +1,81 @@
+#include "log_tail_reader.hpp"
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+namespace {
+const std::vector<std::string> target_file_paths{
+    "tmp/observer.log",
+    "tmp/grabber.log",
+    "tmp/session_monitor.log",
+    "tmp/console_user_server.log",
+};
+const size_t lines_per_file = 50000;
+const size_t max_line_count = 250;
+const size_t updates_count = 20;
+
+template <typename T>
+void measure(const std::string& name, T function) {
+  auto begin = std::chrono::steady_clock::now();
+  function();
+  auto end = std::chrono::steady_clock::now();
+
+  std::cout << name << ": "
+            << std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count() / 1000.0 / updates_count
+            << " ms per update" << std::endl;
+}
+
+void append_line(const std::string& file_path, size_t i) {
+  std::ofstream output(file_path, std::ios::app);
+  output << fmt::format("[2019-01-01 {0:02d}:{1:02d}:{2:02d}.{3:03d}] [info] [benchmark] message {4}",
+                        (i / 3600000) % 24,
+                        (i / 60000) % 60,
+                        (i / 1000) % 60,
+                        i % 1000,
+                        i)
+         << std::endl;
+}
+} // namespace
+
+int main(int argc, const char* argv[]) {
+  system("rm -rf tmp");
+  system("mkdir -p tmp");
+
+  for (const auto& file_path : target_file_paths) {
+    std::ofstream output(file_path);
+    for (size_t i = 0; i < lines_per_file; ++i) {
+      output << fmt::format("[2019-01-01 00:00:00.000] [info] [benchmark] message {0}", i) << std::endl;
+    }
+  }
+
+  std::cout << "files: " << target_file_paths.size() << std::endl;
+  std::cout << "lines per file: " << lines_per_file << std::endl;
+
+  size_t count = 0;
+  size_t time = 1000;
+
+  // Re-read all log files per update (pqrs::spdlog::monitor)
+
+  measure("read_log_files", [&] {
+    for (size_t i = 0; i < updates_count; ++i) {
+      append_line(target_file_paths[i % target_file_paths.size()], ++time);
+      count += pqrs::spdlog::read_log_files(target_file_paths, max_line_count)->size();
+    }
+  });
+
+  // Read only appended lines (krbn::log_tail_reader)
+
+  krbn::log_tail_reader reader(target_file_paths, max_line_count);
+  reader.read_new_lines();
+
+  measure("log_tail_reader", [&] {
+    for (size_t i = 0; i < updates_count; ++i) {
+      append_line(target_file_paths[i % target_file_paths.size()], ++time);
+      count += reader.read_new_lines()->size();
+    }
+  });
+
+  std::cout << "count: " << count << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,141 @@
+#include "event_queue.hpp"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <new>
+
+// Count heap allocations of the process.
+
+namespace {
+std::atomic<uint64_t> allocation_count(0);
+}
+
+void* operator new(size_t size) {
+  ++allocation_count;
+  if (auto p = malloc(size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+  free(p);
+}
+
+namespace {
+// 1000 Hz pointing input for 60 seconds.
+const size_t report_count = 60 * 1000;
+
+template <typename T>
+void measure(const std::string& name, T function) {
+  auto count = allocation_count.load();
+  auto begin = std::chrono::steady_clock::now();
+  function();
+  auto end = std::chrono::steady_clock::now();
+  count = allocation_count.load() - count;
+
+  std::cout << name << ": "
+            << std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count() / report_count
+            << " ns, "
+            << static_cast<double>(count) / report_count
+            << " allocations per report" << std::endl;
+}
+
+std::vector<std::vector<krbn::hid_value>> make_reports(void) {
+  std::vector<std::vector<krbn::hid_value>> reports;
+
+  for (size_t i = 0; i < report_count; ++i) {
+    krbn::absolute_time_point time_stamp(i * 1000 * 1000);
+
+    std::vector<krbn::hid_value> values;
+    values.emplace_back(time_stamp,
+                        static_cast<int>(i % 7) - 3,
+                        krbn::hid_usage_page::generic_desktop,
+                        krbn::hid_usage::gd_x);
+    values.emplace_back(time_stamp,
+                        static_cast<int>(i % 5) - 2,
+                        krbn::hid_usage_page::generic_desktop,
+                        krbn::hid_usage::gd_y);
+
+    // Press button1 occasionally.
+    if (i % 500 == 0) {
+      values.emplace_back(time_stamp,
+                          1,
+                          krbn::hid_usage_page::button,
+                          krbn::hid_usage(1));
+    } else if (i % 500 == 100) {
+      values.emplace_back(time_stamp,
+                          0,
+                          krbn::hid_usage_page::button,
+                          krbn::hid_usage(1));
+    }
+
+    reports.push_back(values);
+  }
+
+  return reports;
+}
+} // namespace
+
+int main(int argc, const char* argv[]) {
+  auto reports = make_reports();
+  krbn::device_id device_id(1);
+
+  std::cout << "reports: " << report_count << " (1000 Hz pointing input)" << std::endl;
+
+  // make_queue + insert_device_keys_and_pointing_buttons_are_released_event + copy
+
+  {
+    auto pressed_keys_manager = std::make_shared<krbn::pressed_keys_manager>();
+    auto merged_input_event_queue = std::make_shared<krbn::event_queue::queue>();
+    size_t entry_count = 0;
+
+    measure("make_queue", [&] {
+      for (const auto& r : reports) {
+        auto event_queue = krbn::event_queue::utility::make_queue(device_id, r);
+        event_queue = krbn::event_queue::utility::insert_device_keys_and_pointing_buttons_are_released_event(event_queue,
+                                                                                                            device_id,
+                                                                                                            pressed_keys_manager);
+        for (const auto& e : event_queue->get_entries()) {
+          krbn::event_queue::entry qe(e.get_device_id(),
+                                      e.get_event_time_stamp(),
+                                      e.get_event(),
+                                      e.get_event_type(),
+                                      e.get_original_event());
+          merged_input_event_queue->push_back_entry(qe);
+        }
+
+        entry_count += merged_input_event_queue->get_entries().size();
+        merged_input_event_queue->clear_events();
+      }
+    });
+
+    std::cout << "  entries: " << entry_count << std::endl;
+  }
+
+  // for_each_entry
+
+  {
+    krbn::pressed_keys_manager pressed_keys_manager;
+    auto merged_input_event_queue = std::make_shared<krbn::event_queue::queue>();
+    size_t entry_count = 0;
+
+    measure("for_each_entry", [&] {
+      for (const auto& r : reports) {
+        krbn::event_queue::utility::for_each_entry(device_id,
+                                                   r,
+                                                   pressed_keys_manager,
+                                                   [&](auto&& e) {
+                                                     merged_input_event_queue->push_back_entry(e);
+                                                   });
+
+        entry_count += merged_input_event_queue->get_entries().size();
+        merged_input_event_queue->clear_events();
+      }
+    });
+
+    std::cout << "  entries: " << entry_count << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,88 @@
+#include "types.hpp"
+#include <chrono>
+#include <iostream>
+
+namespace {
+const size_t iterations = 1000;
+
+template <typename T>
+void measure(const std::string& name, T function) {
+  auto begin = std::chrono::steady_clock::now();
+  function();
+  auto end = std::chrono::steady_clock::now();
+
+  std::cout << name << ": "
+            << std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count() / 1000.0
+            << " ms" << std::endl;
+}
+
+// The previous implementation (a linear search with a lock) for comparison.
+std::string make_key_code_name_linear(krbn::key_code key_code) {
+  static std::mutex mutex;
+  std::lock_guard<std::mutex> guard(mutex);
+
+  for (const auto& pair : krbn::impl::get_key_code_name_value_pairs()) {
+    if (pair.second == key_code) {
+      return pair.first;
+    }
+  }
+  return fmt::format("(number:{0})", static_cast<uint32_t>(key_code));
+}
+
+std::optional<krbn::key_code> make_key_code_unordered_map(const std::string& name) {
+  static std::mutex mutex;
+  std::lock_guard<std::mutex> guard(mutex);
+
+  static std::unordered_map<std::string, krbn::key_code> map(std::begin(krbn::impl::get_key_code_name_value_pairs()),
+                                                             std::end(krbn::impl::get_key_code_name_value_pairs()));
+
+  auto it = map.find(name);
+  if (it == std::end(map)) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+} // namespace
+
+int main(int argc, const char* argv[]) {
+  auto& pairs = krbn::impl::get_key_code_name_value_pairs();
+  size_t count = 0;
+
+  std::cout << "names: " << pairs.size() << ", iterations: " << iterations << std::endl;
+
+  measure("make_key_code_name (linear search)", [&] {
+    for (size_t i = 0; i < iterations; ++i) {
+      for (const auto& pair : pairs) {
+        count += make_key_code_name_linear(pair.second).size();
+      }
+    }
+  });
+
+  measure("make_key_code_name (name_value_table)", [&] {
+    for (size_t i = 0; i < iterations; ++i) {
+      for (const auto& pair : pairs) {
+        count += krbn::make_key_code_name(pair.second).size();
+      }
+    }
+  });
+
+  measure("make_key_code (std::unordered_map)", [&] {
+    for (size_t i = 0; i < iterations; ++i) {
+      for (const auto& pair : pairs) {
+        count += static_cast<bool>(make_key_code_unordered_map(pair.first));
+      }
+    }
+  });
+
+  measure("make_key_code (name_value_table)", [&] {
+    for (size_t i = 0; i < iterations; ++i) {
+      for (const auto& pair : pairs) {
+        count += static_cast<bool>(krbn::make_key_code(pair.first));
+      }
+    }
+  });
+
+  std::cout << "(" << count << ")" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,93 @@
+#include "grabber/pipeline_replayer.hpp"
+#include "dispatcher_utility.hpp"
+#include <atomic>
+#include <iostream>
+#include <new>
+
+// Count heap allocations of the process.
+
+namespace {
+std::atomic<uint64_t> allocation_count(0);
+}
+
+void* operator new(size_t size) {
+  ++allocation_count;
+  if (auto p = malloc(size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+  free(p);
+}
+
+namespace {
+const size_t repeat_count = 20;
+
+// Repeat `input_events` with shifted time stamps.
+std::vector<krbn::event_queue::entry> make_input_events(const std::vector<krbn::event_queue::entry>& input_events) {
+  std::vector<krbn::event_queue::entry> result;
+  if (input_events.empty()) {
+    return result;
+  }
+
+  auto first = input_events.front().get_event_time_stamp().get_time_stamp();
+  auto last = input_events.back().get_event_time_stamp().get_time_stamp();
+  auto interval = (last - first) + pqrs::osx::chrono::make_absolute_time_duration(std::chrono::milliseconds(1000));
+
+  for (size_t i = 0; i < repeat_count; ++i) {
+    for (auto e : input_events) {
+      auto& t = e.get_event_time_stamp();
+      t.set_time_stamp(t.get_time_stamp() + krbn::absolute_time_duration(type_safe::get(interval) * i));
+      result.push_back(e);
+    }
+  }
+
+  return result;
+}
+} // namespace
+
+int main(int argc, const char* argv[]) {
+  krbn::dispatcher_utility::initialize_dispatchers();
+
+  {
+    std::string karabiner_json_file_path = "../../tests/src/pipeline_replayer/json/karabiner.json";
+    std::string input_events_file_path = "../../tests/src/pipeline_replayer/json/input_events.json";
+    if (argc == 3) {
+      karabiner_json_file_path = argv[1];
+      input_events_file_path = argv[2];
+    } else {
+      std::cout << "usage: a.out karabiner.json input_events.json(or event_trace file)" << std::endl;
+      std::cout << "(Using the pipeline_replayer test files with " << repeat_count << " repeats.)" << std::endl;
+    }
+
+    auto profile = krbn::grabber::pipeline_replayer::load_profile(karabiner_json_file_path);
+    auto input_events = krbn::grabber::pipeline_replayer::load_input_events(input_events_file_path);
+    if (argc != 3) {
+      input_events = make_input_events(input_events);
+    }
+
+    krbn::grabber::pipeline_replayer::options options;
+    options.allocation_counter = [] {
+      return allocation_count.load();
+    };
+
+    auto replayer = std::make_unique<krbn::grabber::pipeline_replayer>(*profile, options);
+
+    auto begin = std::chrono::steady_clock::now();
+    auto result = replayer->replay(input_events);
+    auto end = std::chrono::steady_clock::now();
+
+    replayer = nullptr;
+
+    std::cout << "replay: "
+              << std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count()
+              << " ms (wall clock, including pseudo time advancement)" << std::endl;
+    std::cout << result->make_statistics_json().dump(4) << std::endl;
+  }
+
+  krbn::dispatcher_utility::terminate_dispatchers();
+
+  return 0;
+}
@@ -6,30 +6,30 @@
 
 @property(unsafe_unretained) IBOutlet NSTextView* textView;
 
-- (void)callback:(NSString*)filePath;
+- (void)callback:(NSString*)jsonString;
 
 @end
 
-static void staticCallback(const char* filePath,
+static void staticCallback(const char* jsonString,
                            void* context) {
   DevicesController* p = (__bridge DevicesController*)(context);
-  if (p && filePath) {
-    [p callback:[NSString stringWithUTF8String:filePath]];
+  if (p && jsonString) {
+    [p callback:[NSString stringWithUTF8String:jsonString]];
   }
 }
 
 @implementation DevicesController
 
 - (void)setup {
-  libkrbn_enable_device_details_json_file_monitor(staticCallback,
-                                                  (__bridge void*)(self));
+  libkrbn_enable_device_details_monitor(staticCallback,
+                                        (__bridge void*)(self));
 }
 
 - (void)dealloc {
-  libkrbn_disable_device_details_json_file_monitor();
+  libkrbn_disable_device_details_monitor();
 }
 
-- (void)callback:(NSString*)filePath {
+- (void)callback:(NSString*)jsonString {
   @weakify(self);
   dispatch_async(dispatch_get_main_queue(), ^{
     @strongify(self);
@@ -37,18 +37,13 @@ static void staticCallback(const char* filePath,
       return;
     }
 
-    NSString* string = [NSString stringWithContentsOfFile:filePath
-                                                 encoding:NSUTF8StringEncoding
-                                                    error:nil];
-    if (string) {
-      NSTextStorage* textStorage = self.textView.textStorage;
-      NSFont* font = [NSFont fontWithName:@"Menlo" size:11];
-
-      [textStorage beginEditing];
-      [textStorage setAttributedString:[[NSAttributedString alloc] initWithString:string
-                                                                       attributes:@{NSFontAttributeName : font}]];
-      [textStorage endEditing];
-    }
+    NSTextStorage* textStorage = self.textView.textStorage;
+    NSFont* font = [NSFont fontWithName:@"Menlo" size:11];
+
+    [textStorage beginEditing];
+    [textStorage setAttributedString:[[NSAttributedString alloc] initWithString:jsonString
+                                                                     attributes:@{NSFontAttributeName : font}]];
+    [textStorage endEditing];
   });
 }
 
@@ -6,31 +6,31 @@
 
 @property(unsafe_unretained) IBOutlet NSTextView* textView;
 
-- (void)callback:(NSString*)filePath;
+- (void)callback:(NSString*)jsonString;
 
 @end
 
-static void staticCallback(const char* filePath,
+static void staticCallback(const char* jsonString,
                            void* context) {
   VariablesController* p = (__bridge VariablesController*)(context);
-  if (p && filePath) {
-    [p callback:[NSString stringWithUTF8String:filePath]];
+  if (p && jsonString) {
+    [p callback:[NSString stringWithUTF8String:jsonString]];
   }
 }
 
 @implementation VariablesController
 
 - (void)setup {
-  libkrbn_enable_manipulator_environment_json_file_monitor(
+  libkrbn_enable_manipulator_environment_monitor(
       staticCallback,
       (__bridge void*)(self));
 }
 
 - (void)dealloc {
-  libkrbn_disable_manipulator_environment_json_file_monitor();
+  libkrbn_disable_manipulator_environment_monitor();
 }
 
-- (void)callback:(NSString*)filePath {
+- (void)callback:(NSString*)jsonString {
   @weakify(self);
   dispatch_async(dispatch_get_main_queue(), ^{
     @strongify(self);
@@ -38,18 +38,13 @@ static void staticCallback(const char* filePath,
       return;
     }
 
-    NSString* string = [NSString stringWithContentsOfFile:filePath
-                                                 encoding:NSUTF8StringEncoding
-                                                    error:nil];
-    if (string) {
-      NSTextStorage* textStorage = self.textView.textStorage;
-      NSFont* font = [NSFont fontWithName:@"Menlo" size:11];
-
-      [textStorage beginEditing];
-      [textStorage setAttributedString:[[NSAttributedString alloc] initWithString:string
-                                                                       attributes:@{NSFontAttributeName : font}]];
-      [textStorage endEditing];
-    }
+    NSTextStorage* textStorage = self.textView.textStorage;
+    NSFont* font = [NSFont fontWithName:@"Menlo" size:11];
+
+    [textStorage beginEditing];
+    [textStorage setAttributedString:[[NSAttributedString alloc] initWithString:jsonString
+                                                                     attributes:@{NSFontAttributeName : font}]];
+    [textStorage endEditing];
   });
 }
 
@@ -8,31 +8,31 @@
 @property(weak) IBOutlet NSWindow* preferencesWindow;
 @property BOOL shown;
 
-- (void)callback:(NSString*)filePath;
+- (void)callback:(NSString*)jsonString;
 
 @end
 
-static void staticCallback(const char* filePath,
+static void staticCallback(const char* jsonString,
                            void* context) {
   AlertWindowController* p = (__bridge AlertWindowController*)(context);
-  if (p && filePath) {
-    [p callback:[NSString stringWithUTF8String:filePath]];
+  if (p && jsonString) {
+    [p callback:[NSString stringWithUTF8String:jsonString]];
   }
 }
 
 @implementation AlertWindowController
 
 - (void)setup {
-  libkrbn_enable_grabber_alerts_json_file_monitor(staticCallback,
-                                                  (__bridge void*)(self));
+  libkrbn_enable_grabber_alerts_monitor(staticCallback,
+                                        (__bridge void*)(self));
 }
 
 - (void)dealloc {
-  libkrbn_disable_grabber_alerts_json_file_monitor();
+  libkrbn_disable_grabber_alerts_monitor();
 }
 
-- (void)showIfNeeded:(NSString*)filePath {
-  NSDictionary* json = [KarabinerKitJsonUtility loadFile:filePath];
+- (void)showIfNeeded:(NSString*)jsonString {
+  NSDictionary* json = [KarabinerKitJsonUtility loadString:jsonString];
   for (NSString* alert in json[@"alerts"]) {
     if ([alert isEqualToString:@"system_policy_prevents_loading_kext"]) {
       if (!self.shown) {
@@ -48,7 +48,7 @@ static void staticCallback(const char* filePath,
   self.shown = NO;
 }
 
-- (void)callback:(NSString*)filePath {
+- (void)callback:(NSString*)jsonString {
   @weakify(self);
   dispatch_async(dispatch_get_main_queue(), ^{
     @strongify(self);
@@ -56,7 +56,7 @@ static void staticCallback(const char* filePath,
       return;
     }
 
-    [self showIfNeeded:filePath];
+    [self showIfNeeded:jsonString];
   });
 }
 
@@ -8,6 +8,9 @@ typedef enum {
   LogLevelError,
 } LogLevel;
 
+// The same value as the max line count of libkrbn_log_monitor.
+static const NSUInteger maxLineCount = 250;
+
 @interface LogFileTextViewController ()
 
 @property(unsafe_unretained) IBOutlet NSTextView* textView;
@@ -17,7 +20,7 @@ typedef enum {
 @property NSDate* fileModificationDate;
 
 - (NSMutableAttributedString*)logLinesString:(libkrbn_log_lines*)logLines;
-- (void)updateLogLines:(NSAttributedString*)logLinesString;
+- (void)appendLogLines:(NSAttributedString*)logLinesString;
 
 @end
 
@@ -26,7 +29,7 @@ static void log_updated_callback(libkrbn_log_lines* logLines, void* refcon) {
     LogFileTextViewController* controller = (__bridge LogFileTextViewController*)(refcon);
     if (controller) {
       NSMutableAttributedString* logLinesString = [controller logLinesString:logLines];
-      [controller updateLogLines:logLinesString];
+      [controller appendLogLines:logLinesString];
     }
   }
 }
@@ -66,7 +69,7 @@ static void log_updated_callback(libkrbn_log_lines* logLines, void* refcon) {
   libkrbn_disable_log_monitor();
 }
 
-- (void)updateLogLines:(NSAttributedString*)logLinesString {
+- (void)appendLogLines:(NSAttributedString*)logLinesString {
   @weakify(self);
   dispatch_async(dispatch_get_main_queue(), ^{
     @strongify(self);
@@ -74,9 +77,27 @@ static void log_updated_callback(libkrbn_log_lines* logLines, void* refcon) {
       return;
     }
 
-    [self.textView.textStorage beginEditing];
-    [self.textView.textStorage setAttributedString:logLinesString];
-    [self.textView.textStorage endEditing];
+    NSTextStorage* textStorage = self.textView.textStorage;
+
+    [textStorage beginEditing];
+    [textStorage appendAttributedString:logLinesString];
+
+    // Remove old lines.
+
+    NSString* string = textStorage.string;
+    NSUInteger lineCount = 0;
+    NSUInteger index = string.length;
+    while (index > 0) {
+      NSRange range = [string lineRangeForRange:NSMakeRange(index - 1, 0)];
+      ++lineCount;
+      if (lineCount > maxLineCount) {
+        [textStorage deleteCharactersInRange:NSMakeRange(0, NSMaxRange(range))];
+        break;
+      }
+      index = range.location;
+    }
+
+    [textStorage endEditing];
 
     [self scrollToBottom];
   });
@@ -4,11 +4,18 @@
 #pragma clang diagnostic pop
 
 #include "complex_modifications_assets_file.hpp"
+#include "configuration_linter.hpp"
 #include "constants.hpp"
 #include "dispatcher_utility.hpp"
+#include "grabber/pipeline_replayer.hpp"
+#include "grabber_client.hpp"
 #include "karabiner_version.h"
 #include "logger.hpp"
+#include "manipulator/event_trace.hpp"
 #include "monitor/configuration_monitor.hpp"
+#include "shared_state.hpp"
+#include <dirent.h>
+#include <fstream>
 #include <iostream>
 #include <pqrs/thread_wait.hpp>
 #include <spdlog/sinks/stdout_color_sinks.h>
@@ -58,6 +65,248 @@ int remove_system_default_profile(void) {
   }
   return 0;
 }
+
+int dump_event_trace(const std::string& output_file_path) {
+  auto file_path = krbn::constants::get_grabber_event_trace_file_path();
+  unlink(file_path.c_str());
+
+  auto client = std::make_unique<krbn::grabber_client>();
+  auto c = client.get();
+
+  client->connected.connect([c] {
+    c->async_dump_event_trace();
+  });
+
+  client->async_start();
+
+  // Wait until karabiner_grabber writes the file.
+
+  int exit_code = 1;
+  for (int i = 0; i < 50; ++i) {
+    if (pqrs::filesystem::exists(file_path)) {
+      pqrs::filesystem::copy(file_path, output_file_path);
+      exit_code = 0;
+      break;
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+
+  if (exit_code != 0) {
+    krbn::logger::get_logger()->error("karabiner_grabber does not respond.");
+  }
+
+  client = nullptr;
+
+  return exit_code;
+}
+
+std::optional<nlohmann::json> read_rule_statistics(void) {
+  if (auto segment = krbn::shared_state::segment::open(krbn::constants::get_grabber_shared_state_name())) {
+    return segment->read(krbn::shared_state::segment::region::rule_statistics);
+  }
+  return std::nullopt;
+}
+
+int set_rule_statistics_enabled(bool value) {
+  auto client = std::make_unique<krbn::grabber_client>();
+  auto c = client.get();
+
+  client->connected.connect([c, value] {
+    c->async_set_rule_statistics_enabled(value);
+  });
+
+  client->async_start();
+
+  // Wait until karabiner_grabber publishes the rule statistics.
+
+  int exit_code = 1;
+  for (int i = 0; i < 50; ++i) {
+    if (auto json = read_rule_statistics()) {
+      if (pqrs::json::find<bool>(*json, "counters_enabled") == value) {
+        exit_code = 0;
+        break;
+      }
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+
+  if (exit_code != 0) {
+    krbn::logger::get_logger()->error("karabiner_grabber does not respond.");
+  }
+
+  client = nullptr;
+
+  return exit_code;
+}
+
+int show_rule_statistics(void) {
+  auto json = read_rule_statistics();
+  if (!json) {
+    krbn::logger::get_logger()->error("rule statistics are not found. (--enable-rule-statistics is required.)");
+    return 1;
+  }
+
+  // Sort rules by the time spent in manipulators in order to find expensive rules.
+
+  if (auto rules = json->find("rules"); rules != std::end(*json) && rules->is_array()) {
+    std::stable_sort(std::begin(*rules),
+                     std::end(*rules),
+                     [](auto& a, auto& b) {
+                       return a.value("nanoseconds", uint64_t(0)) > b.value("nanoseconds", uint64_t(0));
+                     });
+  }
+
+  std::cout << json->dump(4) << std::endl;
+
+  return 0;
+}
+
+int decode_event_trace(const std::string& file_path) {
+  std::ifstream input(file_path, std::ios::binary);
+  if (!input) {
+    krbn::logger::get_logger()->error("{0} is not found.", file_path);
+    return 1;
+  }
+
+  std::vector<uint8_t> buffer((std::istreambuf_iterator<char>(input)),
+                              std::istreambuf_iterator<char>());
+
+  try {
+    auto json = nlohmann::json::array();
+    for (const auto& r : krbn::manipulator::event_trace::read_binary(buffer)) {
+      json.push_back(krbn::manipulator::event_trace::to_json(r));
+    }
+    std::cout << json.dump(4) << std::endl;
+
+  } catch (std::exception& e) {
+    krbn::logger::get_logger()->error(e.what());
+    return 1;
+  }
+
+  return 0;
+}
+
+int show_latency_statistics(void) {
+  auto file_path = krbn::constants::get_grabber_latency_statistics_json_file_path();
+
+  std::ifstream input(file_path);
+  if (!input) {
+    krbn::logger::get_logger()->error("{0} is not found.", file_path);
+    return 1;
+  }
+
+  try {
+    std::cout << nlohmann::json::parse(input).dump(4) << std::endl;
+
+  } catch (std::exception& e) {
+    krbn::logger::get_logger()->error(e.what());
+    return 1;
+  }
+
+  return 0;
+}
+
+// `.json` files in `path` are checked if `path` is a directory.
+void push_back_lint_inputs(std::vector<krbn::configuration_linter::input>& inputs,
+                           const std::string& path,
+                           krbn::configuration_linter::file_type type) {
+  if (!pqrs::filesystem::is_directory(path)) {
+    inputs.push_back({path, type});
+    return;
+  }
+
+  std::vector<std::string> file_paths;
+
+  if (auto dir = opendir(path.c_str())) {
+    while (auto entry = readdir(dir)) {
+      if (entry->d_type == DT_REG ||
+          entry->d_type == DT_LNK) {
+        std::string name(entry->d_name);
+        if (pqrs::string::ends_with(name, ".json")) {
+          file_paths.push_back(path + "/" + name);
+        }
+      }
+    }
+    closedir(dir);
+  }
+
+  std::sort(std::begin(file_paths), std::end(file_paths));
+
+  for (const auto& file_path : file_paths) {
+    inputs.push_back({file_path, type});
+  }
+}
+
+int lint_files(const std::vector<std::string>& complex_modifications_paths,
+               const std::vector<std::string>& core_configuration_paths) {
+  std::vector<krbn::configuration_linter::input> inputs;
+
+  for (const auto& path : complex_modifications_paths) {
+    push_back_lint_inputs(inputs, path, krbn::configuration_linter::file_type::complex_modifications);
+  }
+  for (const auto& path : core_configuration_paths) {
+    push_back_lint_inputs(inputs, path, krbn::configuration_linter::file_type::core_configuration);
+  }
+
+  auto result = krbn::configuration_linter::lint(inputs);
+
+  std::cout << result.to_json().dump(4) << std::endl;
+
+  return result.get_error_count() == 0 ? 0 : 1;
+}
+
+int simulate(const std::string& input_events_file_path,
+             const std::string& configuration_file_path) {
+  try {
+    auto profile = krbn::grabber::pipeline_replayer::load_profile(configuration_file_path);
+    auto input_events = krbn::grabber::pipeline_replayer::load_input_events(input_events_file_path);
+
+    auto replayer = std::make_unique<krbn::grabber::pipeline_replayer>(*profile);
+    auto result = replayer->replay(input_events);
+    replayer = nullptr;
+
+    auto events = nlohmann::json::array();
+    for (size_t i = 0; i < input_events.size(); ++i) {
+      events.push_back(nlohmann::json::object({
+          {"event", input_events[i].get_event().to_json()},
+          {"event_type", input_events[i].get_event_type()},
+          {"time_stamp", input_events[i].get_event_time_stamp().get_time_stamp()},
+          {"cpu_time_nanoseconds", result->cpu_times[i].count()},
+      }));
+    }
+
+    std::cout << nlohmann::json::object({
+                     {"statistics", result->make_statistics_json()},
+                     {"rules", result->make_rules_json()},
+                     {"events", events},
+                     {"reports", result->reports},
+                 })
+                     .dump(4)
+              << std::endl;
+
+  } catch (std::exception& e) {
+    krbn::logger::get_logger()->error(e.what());
+    return 1;
+  }
+
+  return 0;
+}
+
+int show_shared_state(void) {
+  auto name = krbn::constants::get_grabber_shared_state_name();
+
+  auto segment = krbn::shared_state::segment::open(name);
+  if (!segment) {
+    krbn::logger::get_logger()->error("{0} is not found.", name);
+    return 1;
+  }
+
+  std::cout << segment->to_json().dump(4) << std::endl;
+
+  return 0;
+}
 } // namespace
 
 int main(int argc, char** argv) {
@@ -80,6 +329,29 @@ int main(int argc, char** argv) {
   options.add_options()("lint-complex-modifications", "Check complex_modifications.json",
                         cxxopts::value<std::string>(),
                         "complex_modifications.json");
+  options.add_options()("lint-files", "Check complex_modifications.json files (or directories) in parallel and print results as json. (Specify the option for each file.)",
+                        cxxopts::value<std::vector<std::string>>(),
+                        "file");
+  options.add_options()("lint-core-configuration", "Check karabiner.json files in parallel and print results as json. (Specify the option for each file.)",
+                        cxxopts::value<std::vector<std::string>>(),
+                        "karabiner.json");
+  options.add_options()("dump-event-trace", "Write the recent input events trace of karabiner_grabber to a file.",
+                        cxxopts::value<std::string>(),
+                        "output_file");
+  options.add_options()("decode-event-trace", "Print an event trace file as json.",
+                        cxxopts::value<std::string>(),
+                        "file");
+  options.add_options()("show-latency-statistics", "Print the input event latency statistics of karabiner_grabber.");
+  options.add_options()("enable-rule-statistics", "Start counting evaluations, matches and time of complex_modifications rules in karabiner_grabber.");
+  options.add_options()("disable-rule-statistics", "Stop counting complex_modifications rule statistics in karabiner_grabber.");
+  options.add_options()("show-rule-statistics", "Print the complex_modifications rule statistics of karabiner_grabber sorted by time.");
+  options.add_options()("simulate", "Replay input events through the manipulators of the selected profile without devices and print the output reports, processing times and rule hit counts as json.",
+                        cxxopts::value<std::string>(),
+                        "input_events.json or event_trace_file");
+  options.add_options()("simulate-configuration", "karabiner.json which is used in --simulate. (default: the current user's karabiner.json)",
+                        cxxopts::value<std::string>(),
+                        "karabiner.json");
+  options.add_options()("show-shared-state", "Print the shared state of karabiner_grabber as json.");
   options.add_options()("version", "Displays version.");
   options.add_options()("version-number", "Displays version_number.");
   options.add_options()("help", "Print help.");
@@ -148,6 +420,97 @@ int main(int argc, char** argv) {
       }
     }
 
+    {
+      std::string key1 = "lint-files";
+      std::string key2 = "lint-core-configuration";
+      if (parse_result.count(key1) || parse_result.count(key2)) {
+        std::vector<std::string> complex_modifications_paths;
+        std::vector<std::string> core_configuration_paths;
+        if (parse_result.count(key1)) {
+          complex_modifications_paths = parse_result[key1].as<std::vector<std::string>>();
+        }
+        if (parse_result.count(key2)) {
+          core_configuration_paths = parse_result[key2].as<std::vector<std::string>>();
+        }
+        exit_code = lint_files(complex_modifications_paths, core_configuration_paths);
+        goto finish;
+      }
+    }
+
+    {
+      std::string key = "dump-event-trace";
+      if (parse_result.count(key)) {
+        if (getuid() != 0) {
+          krbn::logger::get_logger()->error("--{0} requires root privilege.", key);
+          exit_code = 1;
+          goto finish;
+        }
+        exit_code = dump_event_trace(parse_result[key].as<std::string>());
+        goto finish;
+      }
+    }
+
+    {
+      std::string key = "decode-event-trace";
+      if (parse_result.count(key)) {
+        exit_code = decode_event_trace(parse_result[key].as<std::string>());
+        goto finish;
+      }
+    }
+
+    {
+      std::string key = "show-latency-statistics";
+      if (parse_result.count(key)) {
+        exit_code = show_latency_statistics();
+        goto finish;
+      }
+    }
+
+    {
+      std::string key = "enable-rule-statistics";
+      if (parse_result.count(key)) {
+        exit_code = set_rule_statistics_enabled(true);
+        goto finish;
+      }
+    }
+
+    {
+      std::string key = "disable-rule-statistics";
+      if (parse_result.count(key)) {
+        exit_code = set_rule_statistics_enabled(false);
+        goto finish;
+      }
+    }
+
+    {
+      std::string key = "show-rule-statistics";
+      if (parse_result.count(key)) {
+        exit_code = show_rule_statistics();
+        goto finish;
+      }
+    }
+
+    {
+      std::string key = "simulate";
+      if (parse_result.count(key)) {
+        std::string configuration_file_path = krbn::constants::get_user_core_configuration_file_path();
+        if (parse_result.count("simulate-configuration")) {
+          configuration_file_path = parse_result["simulate-configuration"].as<std::string>();
+        }
+        exit_code = simulate(parse_result[key].as<std::string>(),
+                             configuration_file_path);
+        goto finish;
+      }
+    }
+
+    {
+      std::string key = "show-shared-state";
+      if (parse_result.count(key)) {
+        exit_code = show_shared_state();
+        goto finish;
+      }
+    }
+
     {
       std::string key = "version";
       if (parse_result.count(key)) {
@@ -194,6 +557,10 @@ int main(int argc, char** argv) {
   std::cout << options.help() << std::endl;
   std::cout << "Examples:" << std::endl;
   std::cout << "  karabiner_cli --select-profile 'Default profile'" << std::endl;
+  std::cout << "  karabiner_cli --lint-files ~/.config/karabiner/assets/complex_modifications --lint-files example.json" << std::endl;
+  std::cout << "  karabiner_cli --lint-core-configuration ~/.config/karabiner/karabiner.json" << std::endl;
+  std::cout << "  karabiner_cli --simulate input_events.json --simulate-configuration karabiner.json" << std::endl;
+  std::cout << "  karabiner_cli --enable-rule-statistics && karabiner_cli --show-rule-statistics" << std::endl;
   std::cout << std::endl;
 
   exit_code = 1;
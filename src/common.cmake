@@ -4,6 +4,9 @@ set(CMAKE_OSX_DEPLOYMENT_TARGET "10.12" CACHE STRING "Minimum OS X deployment ve
 
 set(CMAKE_CXX_STANDARD 17)
 
+# Forks of pqrs libraries (src/lib/pqrs_*) must precede vendor/cget/include in order to replace the upstream libraries.
+include_directories(SYSTEM ${CMAKE_CURRENT_LIST_DIR}/lib/pqrs_dispatcher/include)
+include_directories(SYSTEM ${CMAKE_CURRENT_LIST_DIR}/lib/pqrs_osx_file_monitor/include)
 include_directories(SYSTEM ${CMAKE_CURRENT_LIST_DIR}/vendor)
 include_directories(SYSTEM ${CMAKE_CURRENT_LIST_DIR}/vendor/cget/include)
 include_directories(${CMAKE_CURRENT_LIST_DIR}/share)
@@ -8,7 +8,7 @@
 #include "logger.hpp"
 #include "menu_process_manager.hpp"
 #include "monitor/configuration_monitor.hpp"
-#include "monitor/grabber_alerts_monitor.hpp"
+#include "monitor/shared_state_monitor.hpp"
 #include "monitor/version_monitor.hpp"
 #include "receiver.hpp"
 #include "updater_process_manager.hpp"
@@ -89,16 +89,32 @@ private:
       return;
     }
 
-    grabber_alerts_monitor_ = std::make_unique<grabber_alerts_monitor>(constants::get_grabber_alerts_json_file_path());
-
-    grabber_alerts_monitor_->alerts_changed.connect([](auto&& alerts) {
-      logger::get_logger()->info("karabiner_grabber_alerts.json is updated.");
-      if (!alerts->empty()) {
+    grabber_alerts_monitor_ = std::make_unique<shared_state_monitor>(
+        constants::get_grabber_shared_state_name(),
+        std::vector<std::pair<shared_state::segment::region, std::string>>({
+            {shared_state::segment::region::grabber_alerts, constants::get_grabber_alerts_json_file_path()},
+        }));
+
+    grabber_alerts_monitor_->state_changed.connect([](auto&& region, auto&& json) {
+      logger::get_logger()->info("grabber_alerts are updated.");
+
+      // json example
+      //
+      // {
+      //     "alerts": [
+      //         "system_policy_prevents_loading_kext"
+      //     ]
+      // }
+
+      auto it = json->find("alerts");
+      if (it != std::end(*json) &&
+          it->is_array() &&
+          !it->empty()) {
         application_launcher::launch_preferences();
       }
     });
 
-    grabber_alerts_monitor_->async_start();
+    grabber_alerts_monitor_->async_start(std::chrono::milliseconds(1000));
   }
 
   void start_grabber_client(void) {
@@ -223,7 +239,7 @@ private:
   // Core components
 
   std::weak_ptr<version_monitor> weak_version_monitor_;
-  std::unique_ptr<grabber_alerts_monitor> grabber_alerts_monitor_;
+  std::unique_ptr<shared_state_monitor> grabber_alerts_monitor_;
 
   std::unique_ptr<pqrs::osx::session::monitor> session_monitor_;
   std::unique_ptr<receiver> receiver_;
@@ -4,6 +4,7 @@
 
 #include "console_user_server_client.hpp"
 #include "constants.hpp"
+#include "dispatcher_utility.hpp"
 #include "logger.hpp"
 #include "monitor/version_monitor.hpp"
 #include "receiver.hpp"
@@ -17,7 +18,7 @@ class components_manager final : public pqrs::dispatcher::extra::dispatcher_clie
 public:
   components_manager(const components_manager&) = delete;
 
-  components_manager(std::weak_ptr<version_monitor> weak_version_monitor) : dispatcher_client(),
+  components_manager(std::weak_ptr<version_monitor> weak_version_monitor) : dispatcher_client(dispatcher_utility::get_background_dispatcher_or_shared_dispatcher()),
                                                                             weak_version_monitor_(weak_version_monitor) {
     // session_monitor_receiver_
 
@@ -2,11 +2,14 @@
 
 #include "apple_hid_usage_tables.hpp"
 #include "apple_notification_center.hpp"
+#include "async_file_writer.hpp"
 #include "constants.hpp"
+#include "device_grabber_details/complex_modifications_manipulator_manager.hpp"
 #include "device_grabber_details/entry.hpp"
 #include "device_grabber_details/fn_function_keys_manipulator_manager.hpp"
 #include "device_grabber_details/notification_message_manager.hpp"
 #include "device_grabber_details/simple_modifications_manipulator_manager.hpp"
+#include "dispatcher_utility.hpp"
 #include "event_tap_utility.hpp"
 #include "hid_keyboard_caps_lock_led_state_manager.hpp"
 #include "hid_keyboard_num_lock_led_state_manager.hpp"
@@ -19,6 +22,7 @@
 #include "monitor/configuration_monitor.hpp"
 #include "monitor/event_tap_monitor.hpp"
 #include "probable_stuck_events_manager.hpp"
+#include "shared_state.hpp"
 #include "types.hpp"
 #include "virtual_hid_device_client.hpp"
 #include <deque>
@@ -39,9 +43,15 @@ public:
 
   device_grabber(std::weak_ptr<console_user_server_client> weak_console_user_server_client) : dispatcher_client(),
                                                                                               profile_(nlohmann::json::object()),
+                                                                                              latency_statistics_timer_(*this),
                                                                                               logger_unique_filter_(logger::get_logger()) {
     simple_modifications_manipulator_manager_ = std::make_shared<device_grabber_details::simple_modifications_manipulator_manager>();
-    complex_modifications_manipulator_manager_ = std::make_shared<manipulator::manipulator_manager>();
+    complex_modifications_manipulator_manager_ = std::make_shared<device_grabber_details::complex_modifications_manipulator_manager>();
+    complex_modifications_manipulator_manager_->get_manipulator_manager()->set_order_optimization_enabled(true);
+    complex_modifications_manipulator_manager_->manipulators_updated.connect([this] {
+      // `needs_virtual_hid_pointing` might be changed.
+      update_virtual_hid_pointing();
+    });
     fn_function_keys_manipulator_manager_ = std::make_shared<device_grabber_details::fn_function_keys_manipulator_manager>();
     post_event_to_virtual_devices_manipulator_manager_ = std::make_shared<manipulator::manipulator_manager>();
 
@@ -51,6 +61,14 @@ public:
     fn_function_keys_applied_event_queue_ = std::make_shared<event_queue::queue>();
     posted_event_queue_ = std::make_shared<event_queue::queue>();
 
+    event_trace_ = std::make_shared<manipulator::event_trace>();
+    latency_statistics_ = std::make_shared<manipulator::latency_statistics>(std::vector<std::string>{
+        "simple_modifications",
+        "complex_modifications",
+        "fn_function_keys",
+        "post_event_to_virtual_devices",
+    });
+
     virtual_hid_device_client_ = std::make_shared<virtual_hid_device_client>();
 
     virtual_hid_device_client_->client_connected.connect([this] {
@@ -77,6 +95,7 @@ public:
     post_event_to_virtual_devices_manipulator_ =
         std::make_shared<manipulator::manipulators::post_event_to_virtual_devices::post_event_to_virtual_devices>(
             weak_console_user_server_client);
+    post_event_to_virtual_devices_manipulator_->set_latency_statistics(latency_statistics_);
     post_event_to_virtual_devices_manipulator_manager_->push_back_manipulator(std::shared_ptr<manipulator::manipulators::base>(post_event_to_virtual_devices_manipulator_));
 
     complex_modifications_applied_event_queue_->enable_manipulator_environment_json_output(constants::get_manipulator_environment_json_file_path());
@@ -86,12 +105,14 @@ public:
     manipulator_managers_connector_.emplace_back_connection(simple_modifications_manipulator_manager_->get_manipulator_manager(),
                                                             merged_input_event_queue_,
                                                             simple_modifications_applied_event_queue_);
-    manipulator_managers_connector_.emplace_back_connection(complex_modifications_manipulator_manager_,
+    manipulator_managers_connector_.emplace_back_connection(complex_modifications_manipulator_manager_->get_manipulator_manager(),
                                                             complex_modifications_applied_event_queue_);
     manipulator_managers_connector_.emplace_back_connection(fn_function_keys_manipulator_manager_->get_manipulator_manager(),
                                                             fn_function_keys_applied_event_queue_);
     manipulator_managers_connector_.emplace_back_connection(post_event_to_virtual_devices_manipulator_manager_,
                                                             posted_event_queue_);
+    manipulator_managers_connector_.set_event_trace(event_trace_);
+    manipulator_managers_connector_.set_latency_statistics(latency_statistics_);
 
     external_signal_connections_.emplace_back(
         krbn_notification_center::get_instance().input_event_arrived.connect([this] {
@@ -114,158 +135,184 @@ public:
             pqrs::osx::iokit_hid_usage_generic_desktop_pointer),
     };
 
-    hid_manager_ = std::make_unique<pqrs::osx::iokit_hid_manager>(weak_dispatcher_,
+    // The device observer runs on the background dispatcher and hands devices back to this dispatcher.
+    hid_manager_ = std::make_unique<pqrs::osx::iokit_hid_manager>(dispatcher_utility::get_background_dispatcher_or_shared_dispatcher(),
                                                                   matching_dictionaries,
                                                                   std::chrono::milliseconds(1000));
 
     hid_manager_->device_matched.connect([this](auto&& registry_entry_id, auto&& device_ptr) {
-      if (device_ptr) {
-        auto device_id = make_device_id(registry_entry_id);
+      enqueue_to_dispatcher([this, registry_entry_id, device_ptr] {
+        if (device_ptr) {
+          auto device_id = make_device_id(registry_entry_id);
 
-        if (iokit_utility::is_karabiner_virtual_hid_device(*device_ptr)) {
-          return;
-        }
+          if (iokit_utility::is_karabiner_virtual_hid_device(*device_ptr)) {
+            return;
+          }
 
-        // ----------------------------------------
-        // probable_stuck_events_managers_
+          // ----------------------------------------
+          // probable_stuck_events_managers_
 
-        add_probable_stuck_events_manager(device_id);
+          add_probable_stuck_events_manager(device_id);
 
-        // ----------------------------------------
-        // entries_
+          // ----------------------------------------
+          // entries_
 
-        auto entry = std::make_shared<device_grabber_details::entry>(device_id,
-                                                                     *device_ptr,
-                                                                     core_configuration_);
-        entries_[device_id] = entry;
+          auto entry = std::make_shared<device_grabber_details::entry>(device_id,
+                                                                       *device_ptr,
+                                                                       core_configuration_);
+          entries_[device_id] = entry;
 
-        entry->get_hid_queue_value_monitor()->values_arrived.connect([this, device_id](auto&& values_ptr) {
-          auto it = entries_.find(device_id);
-          if (it != std::end(entries_)) {
-            auto event_queue = event_queue::utility::make_queue(device_id,
-                                                                iokit_utility::make_hid_values(values_ptr));
-            event_queue = event_queue::utility::insert_device_keys_and_pointing_buttons_are_released_event(event_queue,
-                                                                                                           device_id,
-                                                                                                           it->second->get_pressed_keys_manager());
-            values_arrived(it->second, event_queue);
-          }
-        });
+          entry->get_hid_queue_value_monitor()->values_arrived.connect([this, device_id](auto&& values_ptr) {
+            auto it = entries_.find(device_id);
+            if (it != std::end(entries_)) {
+              values_arrived(it->second,
+                             iokit_utility::make_hid_values(values_ptr));
+            }
+          });
 
-        entry->get_hid_queue_value_monitor()->started.connect([this, device_id] {
-          auto it = entries_.find(device_id);
-          if (it != std::end(entries_)) {
-            logger::get_logger()->info("{0} is grabbed.",
-                                       it->second->get_device_name());
-            logger_unique_filter_.reset();
+          entry->get_hid_queue_value_monitor()->started.connect([this, device_id] {
+            auto it = entries_.find(device_id);
+            if (it != std::end(entries_)) {
+              logger::get_logger()->info("{0} is grabbed.",
+                                         it->second->get_device_name());
+              logger_unique_filter_.reset();
 
-            post_device_grabbed_event(it->second->get_device_properties());
+              it->second->get_ingress_filter().clear();
 
-            it->second->set_grabbed(true);
+              post_device_grabbed_event(it->second->get_device_properties());
 
-            update_caps_lock_led();
+              it->second->set_grabbed(true);
 
-            update_num_lock_led();
+              update_caps_lock_led();
 
-            update_virtual_hid_pointing();
+              update_num_lock_led();
 
-            apple_notification_center::post_distributed_notification_to_all_sessions(constants::get_distributed_notification_device_grabbing_state_is_changed());
-          }
-        });
+              update_virtual_hid_pointing();
 
-        entry->get_hid_queue_value_monitor()->stopped.connect([this, device_id] {
-          auto it = entries_.find(device_id);
-          if (it != std::end(entries_)) {
-            logger::get_logger()->info("{0} is ungrabbed.",
-                                       it->second->get_device_name());
-            logger_unique_filter_.reset();
+              apple_notification_center::post_distributed_notification_to_all_sessions(constants::get_distributed_notification_device_grabbing_state_is_changed());
+            }
+          });
 
-            it->second->set_grabbed(false);
+          entry->get_hid_queue_value_monitor()->stopped.connect([this, device_id] {
+            auto it = entries_.find(device_id);
+            if (it != std::end(entries_)) {
+              logger::get_logger()->info("{0} is ungrabbed.",
+                                         it->second->get_device_name());
+              logger_unique_filter_.reset();
 
-            post_device_ungrabbed_event(device_id);
+              auto& counters = it->second->get_ingress_filter().get_counters();
+              if (!counters.empty()) {
+                logger::get_logger()->info("{0} ingress filter: {1}",
+                                           it->second->get_device_name(),
+                                           counters.to_json().dump());
+              }
 
-            update_virtual_hid_pointing();
+              it->second->set_grabbed(false);
 
-            apple_notification_center::post_distributed_notification_to_all_sessions(constants::get_distributed_notification_device_grabbing_state_is_changed());
-          }
-        });
+              post_device_ungrabbed_event(device_id);
 
-        // ----------------------------------------
+              update_virtual_hid_pointing();
 
-        output_devices_json();
-        output_device_details_json();
+              apple_notification_center::post_distributed_notification_to_all_sessions(constants::get_distributed_notification_device_grabbing_state_is_changed());
+            }
+          });
 
-        update_virtual_hid_pointing();
+          // ----------------------------------------
 
-        // ----------------------------------------
+          output_devices_json();
+          output_device_details_json();
 
-        update_devices_disabled();
-        async_grab_devices();
-      }
+          update_virtual_hid_pointing();
+
+          // ----------------------------------------
+
+          update_devices_disabled();
+          async_grab_devices();
+        }
+      });
     });
 
     hid_manager_->device_terminated.connect([this](auto&& registry_entry_id) {
-      auto device_id = make_device_id(registry_entry_id);
+      enqueue_to_dispatcher([this, registry_entry_id] {
+        auto device_id = make_device_id(registry_entry_id);
 
-      // entries_
+        // entries_
 
-      {
-        auto it = entries_.find(device_id);
-        if (it != std::end(entries_)) {
-          logger::get_logger()->info("{0} is terminated.",
-                                     it->second->get_device_name());
-          logger_unique_filter_.reset();
+        {
+          auto it = entries_.find(device_id);
+          if (it != std::end(entries_)) {
+            logger::get_logger()->info("{0} is terminated.",
+                                       it->second->get_device_name());
+            logger_unique_filter_.reset();
 
-          if (auto device_properties = it->second->get_device_properties()) {
-            if (device_properties->get_is_keyboard().value_or(false) &&
-                device_properties->get_is_karabiner_virtual_hid_device().value_or(false)) {
-              virtual_hid_device_client_->async_close();
-              async_ungrab_devices();
+            if (auto device_properties = it->second->get_device_properties()) {
+              if (device_properties->get_is_keyboard().value_or(false) &&
+                  device_properties->get_is_karabiner_virtual_hid_device().value_or(false)) {
+                virtual_hid_device_client_->async_close();
+                async_ungrab_devices();
 
-              virtual_hid_device_client_->async_connect();
+                virtual_hid_device_client_->async_connect();
+              }
             }
-          }
 
-          entries_.erase(it);
+            entries_.erase(it);
+          }
         }
-      }
 
-      // probable_stuck_events_managers_
+        // probable_stuck_events_managers_
 
-      probable_stuck_events_managers_.erase(device_id);
+        probable_stuck_events_managers_.erase(device_id);
 
-      // notification_message_manager_
+        // notification_message_manager_
 
-      if (notification_message_manager_) {
-        notification_message_manager_->erase_device(device_id);
-      }
+        if (notification_message_manager_) {
+          notification_message_manager_->erase_device(device_id);
+        }
 
-      // ----------------------------------------
+        // ----------------------------------------
 
-      output_devices_json();
-      output_device_details_json();
+        output_devices_json();
+        output_device_details_json();
 
-      // ----------------------------------------
+        // ----------------------------------------
 
-      post_device_ungrabbed_event(device_id);
+        post_device_ungrabbed_event(device_id);
 
-      update_virtual_hid_pointing();
+        update_virtual_hid_pointing();
 
-      // ----------------------------------------
-      update_devices_disabled();
-      async_grab_devices();
+        // ----------------------------------------
+        update_devices_disabled();
+        async_grab_devices();
+      });
     });
 
     hid_manager_->error_occurred.connect([this](auto&& message, auto&& iokit_return) {
-      logger::get_logger()->error("{0}: {1}", message, iokit_return.to_string());
-      logger_unique_filter_.reset();
+      enqueue_to_dispatcher([this, message, iokit_return] {
+        logger::get_logger()->error("{0}: {1}", message, iokit_return.to_string());
+        logger_unique_filter_.reset();
+      });
     });
 
     notification_message_manager_ = std::make_shared<device_grabber_details::notification_message_manager>(
         weak_console_user_server_client);
+
+    // latency_statistics_timer_
+
+    latency_statistics_timer_.start(
+        [this] {
+          save_latency_statistics();
+
+          if (complex_modifications_manipulator_manager_->get_manipulator_manager()->get_counters_enabled()) {
+            save_rule_statistics();
+          }
+        },
+        std::chrono::milliseconds(10000));
   }
 
   virtual ~device_grabber(void) {
     detach_from_dispatcher([this] {
+      latency_statistics_timer_.stop();
+
       stop();
 
       notification_message_manager_ = nullptr;
@@ -316,6 +363,15 @@ public:
 
           logger_unique_filter_.reset();
           set_profile(core_configuration->get_selected_profile());
+
+          // Precompile the other profiles for instant profile switching.
+          std::vector<std::shared_ptr<const core_configuration::details::profile>> profiles;
+          for (const auto& p : core_configuration->get_profiles()) {
+            if (!p.get_selected()) {
+              profiles.push_back(std::shared_ptr<const core_configuration::details::profile>(core_configuration, &p));
+            }
+          }
+          complex_modifications_manipulator_manager_->async_precompile(profiles);
         }
       });
 
@@ -394,6 +450,40 @@ public:
       update_num_lock_led();
     });
   }
+
+  void async_dump_event_trace(void) const {
+    enqueue_to_dispatcher([this] {
+      auto records = event_trace_->make_snapshot();
+      auto buffer = manipulator::event_trace::make_binary(records);
+
+      async_file_writer::enqueue(constants::get_grabber_event_trace_file_path(),
+                                 std::string(std::begin(buffer), std::end(buffer)),
+                                 0700,
+                                 0600);
+
+      logger::get_logger()->info("event_trace is dumped ({0} records).", records.size());
+    });
+  }
+
+  void async_set_rule_statistics_enabled(bool value) {
+    enqueue_to_dispatcher([this, value] {
+      auto manipulator_manager = complex_modifications_manipulator_manager_->get_manipulator_manager();
+      if (manipulator_manager->get_counters_enabled() == value) {
+        return;
+      }
+
+      if (value) {
+        // Count from zero.
+        complex_modifications_manipulator_manager_->clear_counters();
+      }
+      manipulator_manager->set_counters_enabled(value);
+
+      logger::get_logger()->info("rule_statistics is {0}.", value ? "enabled" : "disabled");
+
+      save_rule_statistics();
+    });
+  }
+
   void async_set_system_preferences_properties(const pqrs::osx::system_preferences::properties& value) {
     enqueue_to_dispatcher([this, value] {
       system_preferences_properties_ = value;
@@ -468,6 +558,18 @@ public:
 
 private:
   void stop(void) {
+    {
+      auto& center = krbn_notification_center::get_instance();
+      auto histogram = center.get_queueing_delay_histogram();
+      if (histogram.get_count() > 0) {
+        logger::get_logger()->info("input event queueing delay: count:{0} average:{1}us max:{2}us",
+                                   histogram.get_count(),
+                                   histogram.get_mean().count(),
+                                   histogram.get_max().count());
+      }
+      center.clear_queueing_delay_histogram();
+    }
+
     configuration_monitor_ = nullptr;
 
     async_ungrab_devices();
@@ -499,39 +601,72 @@ private:
   }
 
   void values_arrived(std::shared_ptr<device_grabber_details::entry> entry,
-                      std::shared_ptr<event_queue::queue> event_queue) {
+                      const std::vector<hid_value>& hid_values) {
     // Manipulate events
+    //
+    // Entries are appended into `merged_input_event_queue_` directly without intermediate queues.
 
-    if (auto probable_stuck_events_manager = find_probable_stuck_events_manager(entry->get_device_id())) {
+    auto probable_stuck_events_manager = find_probable_stuck_events_manager(entry->get_device_id());
+
+    if (probable_stuck_events_manager) {
       if (!entry->get_first_value_arrived()) {
         // First grabbed event is arrived.
 
         entry->set_first_value_arrived(true);
         probable_stuck_events_manager->clear();
       }
+    }
 
-      bool needs_regrab = false;
+    bool needs_regrab = false;
 
-      for (const auto& e : event_queue->get_entries()) {
-        if (auto ev = e.get_event().make_key_down_up_valued_event()) {
-          needs_regrab |= probable_stuck_events_manager->update(
-              *ev,
-              e.get_event_type(),
-              e.get_event_time_stamp().get_time_stamp(),
-              device_state::grabbed);
-        }
+    auto handle_entry = [&](const event_queue::entry& e) {
+      if (!probable_stuck_events_manager) {
+        return;
+      }
 
-        if (!entry->get_disabled()) {
-          event_queue::entry qe(e.get_device_id(),
-                                e.get_event_time_stamp(),
-                                e.get_event(),
-                                e.get_event_type(),
-                                e.get_original_event());
+      if (auto ev = e.get_event().make_key_down_up_valued_event()) {
+        needs_regrab |= probable_stuck_events_manager->update(
+            *ev,
+            e.get_event_type(),
+            e.get_event_time_stamp().get_time_stamp(),
+            device_state::grabbed);
+      }
 
-          merged_input_event_queue_->push_back_entry(qe);
-        }
+      if (!entry->get_disabled()) {
+        merged_input_event_queue_->push_back_entry(e);
       }
+    };
+
+    // Drop or merge events of input event storms in `ingress_filter` before manipulation.
+
+    auto& ingress_filter = entry->get_ingress_filter();
+    auto ingress_filter_was_active = !ingress_filter.get_counters().empty();
+    auto& pressed_keys_manager = *(entry->get_pressed_keys_manager());
+
+    event_queue::utility::for_each_entry(
+        entry->get_device_id(),
+        hid_values,
+        [&](const event_queue::entry& e) {
+          ingress_filter.filter(e, [&](const event_queue::entry& filtered) {
+            handle_entry(filtered);
 
+            if (auto released = event_queue::utility::update_pressed_keys_manager(filtered,
+                                                                                  entry->get_device_id(),
+                                                                                  pressed_keys_manager)) {
+              handle_entry(*released);
+            }
+          });
+        });
+
+    if (!ingress_filter_was_active &&
+        !ingress_filter.get_counters().empty()) {
+      logger::get_logger()->warn("{0} input events are limited by the ingress filter.",
+                                 entry->get_device_name());
+    }
+
+    schedule_ingress_filter_flush(entry);
+
+    if (probable_stuck_events_manager) {
       if (needs_regrab) {
         grab_device(entry);
       }
@@ -541,6 +676,39 @@ private:
     }
   }
 
+  // Deliver the pending pointing_motion of `ingress_filter` when a token is refilled
+  // since no more events might arrive after a burst.
+  void schedule_ingress_filter_flush(std::shared_ptr<device_grabber_details::entry> entry) {
+    if (entry->get_ingress_filter_flush_scheduled() ||
+        !entry->get_ingress_filter().has_pending_pointing_motion()) {
+      return;
+    }
+
+    entry->set_ingress_filter_flush_scheduled(true);
+
+    std::weak_ptr<device_grabber_details::entry> weak_entry = entry;
+    enqueue_to_dispatcher(
+        [this, weak_entry] {
+          if (auto entry = weak_entry.lock()) {
+            entry->set_ingress_filter_flush_scheduled(false);
+
+            entry->get_ingress_filter().flush(entry->get_device_id(),
+                                              pqrs::osx::chrono::mach_absolute_time_point(),
+                                              [&](const event_queue::entry& e) {
+                                                if (!entry->get_disabled()) {
+                                                  merged_input_event_queue_->push_back_entry(e);
+
+                                                  krbn_notification_center::get_instance().enqueue_input_event_arrived(*this);
+                                                }
+                                              });
+
+            // Retry if tokens are consumed by other events.
+            schedule_ingress_filter_flush(entry);
+          }
+        },
+        when_now() + entry->get_ingress_filter().get_token_refill_interval());
+  }
+
   void post_device_grabbed_event(std::shared_ptr<device_properties> device_properties) {
     if (device_properties) {
       if (auto device_id = device_properties->get_device_id()) {
@@ -817,8 +985,9 @@ private:
       }
     }
 
-    auto file_path = constants::get_devices_json_file_path();
-    connected_devices.async_save_to_file(file_path);
+    shared_state::publisher::async_publish(shared_state::segment::region::devices,
+                                           connected_devices.to_json(),
+                                           constants::get_devices_json_file_path());
   }
 
   void output_device_details_json(void) const {
@@ -835,8 +1004,37 @@ private:
                 return a.compare(b);
               });
 
-    auto file_path = constants::get_device_details_json_file_path();
-    json_writer::async_save_to_file(nlohmann::json(device_details), file_path, 0755, 0644);
+    shared_state::publisher::async_publish(shared_state::segment::region::device_details,
+                                           nlohmann::json(device_details),
+                                           constants::get_device_details_json_file_path());
+  }
+
+  // This method is executed in the shared dispatcher thread.
+  void save_latency_statistics(void) {
+    auto queueing_delay_histogram = krbn_notification_center::get_instance().get_queueing_delay_histogram();
+
+    // Skip saving while no events are processed.
+    auto count = latency_statistics_->get_total_count() + queueing_delay_histogram.get_count();
+    if (last_saved_latency_statistics_count_ == count) {
+      return;
+    }
+    last_saved_latency_statistics_count_ = count;
+
+    auto json = latency_statistics_->to_json();
+    // The wait of input events in the shared dispatcher queue. (See `dispatcher_utility`.)
+    json["input_event_queueing_delay"] = queueing_delay_histogram.to_json();
+
+    json_writer::async_save_to_file(std::move(json),
+                                    constants::get_grabber_latency_statistics_json_file_path(),
+                                    0755,
+                                    0644);
+  }
+
+  // This method is executed in the shared dispatcher thread.
+  void save_rule_statistics(void) {
+    shared_state::publisher::async_publish(shared_state::segment::region::rule_statistics,
+                                           complex_modifications_manipulator_manager_->make_rule_statistics_json(profile_),
+                                           constants::get_grabber_rule_statistics_json_file_path());
   }
 
   void set_profile(const core_configuration::details::profile& profile) {
@@ -849,7 +1047,7 @@ private:
     }
 
     simple_modifications_manipulator_manager_->update(profile_);
-    update_complex_modifications_manipulators();
+    complex_modifications_manipulator_manager_->async_update(std::make_shared<core_configuration::details::profile>(profile_));
     fn_function_keys_manipulator_manager_->update(profile_,
                                                   system_preferences_properties_);
 
@@ -862,29 +1060,6 @@ private:
     async_post_virtual_hid_keyboard_configuration_changed_event();
   }
 
-  void update_complex_modifications_manipulators(void) {
-    complex_modifications_manipulator_manager_->invalidate_manipulators();
-
-    for (const auto& rule : profile_.get_complex_modifications().get_rules()) {
-      for (const auto& manipulator : rule.get_manipulators()) {
-        try {
-          auto m = manipulator::manipulator_factory::make_manipulator(manipulator.get_json(),
-                                                                      manipulator.get_parameters());
-          for (const auto& c : manipulator.get_conditions()) {
-            m->push_back_condition(manipulator::manipulator_factory::make_condition(c.get_json()));
-          }
-          complex_modifications_manipulator_manager_->push_back_manipulator(m);
-
-        } catch (const pqrs::json::unmarshal_error& e) {
-          logger::get_logger()->error(fmt::format("karabiner.json error: {0}", e.what()));
-
-        } catch (const std::exception& e) {
-          logger::get_logger()->error(e.what());
-        }
-      }
-    }
-  }
-
   std::shared_ptr<virtual_hid_device_client> virtual_hid_device_client_;
 
   std::vector<nod::scoped_connection> external_signal_connections_;
@@ -913,7 +1088,7 @@ private:
   std::shared_ptr<device_grabber_details::simple_modifications_manipulator_manager> simple_modifications_manipulator_manager_;
   std::shared_ptr<event_queue::queue> simple_modifications_applied_event_queue_;
 
-  std::shared_ptr<manipulator::manipulator_manager> complex_modifications_manipulator_manager_;
+  std::shared_ptr<device_grabber_details::complex_modifications_manipulator_manager> complex_modifications_manipulator_manager_;
   std::shared_ptr<event_queue::queue> complex_modifications_applied_event_queue_;
 
   std::shared_ptr<device_grabber_details::fn_function_keys_manipulator_manager> fn_function_keys_manipulator_manager_;
@@ -923,6 +1098,12 @@ private:
   std::shared_ptr<manipulator::manipulator_manager> post_event_to_virtual_devices_manipulator_manager_;
   std::shared_ptr<event_queue::queue> posted_event_queue_;
 
+  std::shared_ptr<manipulator::event_trace> event_trace_;
+
+  std::shared_ptr<manipulator::latency_statistics> latency_statistics_;
+  pqrs::dispatcher::extra::timer latency_statistics_timer_;
+  std::optional<uint64_t> last_saved_latency_statistics_count_;
+
   std::shared_ptr<device_grabber_details::notification_message_manager> notification_message_manager_;
 
   mutable pqrs::spdlog::unique_filter logger_unique_filter_;
@@ -0,0 +1,361 @@
+#pragma once
+
+// `krbn::grabber::device_grabber_details::complex_modifications_manipulator_manager` can be used safely in a multi-threaded environment.
+
+#include "complex_modifications_profile_cache.hpp"
+#include "core_configuration/core_configuration.hpp"
+#include "logger.hpp"
+#include "manipulator/manipulator_factory.hpp"
+#include "manipulator/manipulator_manager.hpp"
+#include "parallel_utility.hpp"
+#include <nod/nod.hpp>
+#include <deque>
+#include <pqrs/dispatcher.hpp>
+#include <unordered_map>
+
+namespace krbn {
+namespace grabber {
+namespace device_grabber_details {
+// `complex_modifications_manipulator_manager` rebuilds only changed manipulators when the profile is updated.
+// Manipulators whose definitions (json and parameters) are not changed are reused as is.
+//
+// `async_update` builds manipulators in the background builder thread (and in parallel worker threads),
+// then replaces manipulators in the shared dispatcher thread.
+// Thus, the input event processing in the shared dispatcher thread is not blocked while manipulators are built.
+//
+// Compiled manipulators are also kept per profile in `profile_cache_`.
+// `async_precompile` compiles the other profiles in advance so that switching to them only replaces manipulators.
+
+class complex_modifications_manipulator_manager final : public pqrs::dispatcher::extra::dispatcher_client {
+public:
+  typedef complex_modifications_profile_cache::entries_t entries_t;
+
+  // Signals (invoked from the shared dispatcher thread)
+
+  nod::signal<void(void)> manipulators_updated;
+
+  // Methods
+
+  complex_modifications_manipulator_manager(const complex_modifications_manipulator_manager&) = delete;
+
+  complex_modifications_manipulator_manager(size_t max_cached_profiles = 4) : dispatcher_client(),
+                                                                              entries_(std::make_shared<entries_t>()),
+                                                                              profile_cache_(max_cached_profiles),
+                                                                              generation_(0),
+                                                                              builder_time_source_(std::make_shared<pqrs::dispatcher::hardware_time_source>()),
+                                                                              builder_dispatcher_(std::make_shared<pqrs::dispatcher::dispatcher>(builder_time_source_)),
+                                                                              builder_object_id_(pqrs::dispatcher::make_new_object_id()) {
+    manipulator_manager_ = std::make_shared<manipulator::manipulator_manager>();
+
+    builder_dispatcher_->attach(builder_object_id_);
+  }
+
+  virtual ~complex_modifications_manipulator_manager(void) {
+    // Wait the running build.
+    builder_dispatcher_->detach(builder_object_id_);
+    builder_dispatcher_->terminate();
+    builder_dispatcher_ = nullptr;
+
+    detach_from_dispatcher();
+  }
+
+  std::shared_ptr<manipulator::manipulator_manager> get_manipulator_manager(void) const {
+    return manipulator_manager_;
+  }
+
+  std::shared_ptr<const entries_t> get_entries(void) const {
+    std::lock_guard<std::mutex> lock(entries_mutex_);
+
+    return entries_;
+  }
+
+  const complex_modifications_profile_cache& get_profile_cache(void) const {
+    return profile_cache_;
+  }
+
+  void update(const core_configuration::details::profile& profile) {
+    ++generation_;
+
+    apply(compile(profile));
+  }
+
+  void async_update(std::shared_ptr<const core_configuration::details::profile> profile) {
+    auto generation = ++generation_;
+
+    builder_dispatcher_->enqueue(builder_object_id_, [this, profile, generation] {
+      // Skip if a newer update is already requested.
+      if (generation != generation_) {
+        return;
+      }
+
+      auto result = std::make_shared<build_result>(compile(*profile));
+
+      enqueue_to_dispatcher([this, result, generation] {
+        if (generation != generation_) {
+          return;
+        }
+
+        apply(*result);
+      });
+    });
+  }
+
+  // Enqueue `function` to the builder thread.
+  // Tasks are processed in order with `async_update` and `async_precompile`.
+  // (e.g., tests use it in order to hold the builder thread.)
+
+  void enqueue_to_builder_dispatcher(const std::function<void(void)>& function) {
+    builder_dispatcher_->enqueue(builder_object_id_, function);
+  }
+
+  // Compile profiles which are not cached yet in the background.
+  // Cached profiles are not evicted by precompiled profiles.
+
+  void async_precompile(std::vector<std::shared_ptr<const core_configuration::details::profile>> profiles) {
+    builder_dispatcher_->enqueue(builder_object_id_, [this, profiles] {
+      for (const auto& profile : profiles) {
+        if (profile_cache_.full()) {
+          break;
+        }
+
+        auto key = complex_modifications_profile_cache::make_key(*profile);
+        if (profile_cache_.contains(key)) {
+          continue;
+        }
+
+        auto result = build(*profile, get_entries());
+        profile_cache_.insert(key, result.entries);
+
+        logger::get_logger()->info("complex_modifications manipulators of `{0}` are precompiled ({1} manipulators, {2} profiles cached, {3} bytes)",
+                                   profile->get_name(),
+                                   result.entries->size(),
+                                   profile_cache_.size(),
+                                   profile_cache_.get_memory_size());
+      }
+    });
+  }
+
+  // Return the rule index in `profile` of each entry in `get_entries()`.
+  // (std::nullopt if the entry is not built from `profile`. e.g., `async_update` is not applied yet.)
+  std::vector<std::optional<size_t>> make_rule_indices(const core_configuration::details::profile& profile) const {
+    return make_rule_indices(profile, *(get_entries()));
+  }
+
+  // Sum `manipulator_counters` of manipulators per rule of `profile`.
+  nlohmann::json make_rule_statistics_json(const core_configuration::details::profile& profile) const {
+    const auto& rules = profile.get_complex_modifications().get_rules();
+
+    std::vector<manipulator::manipulator_counters::values> values(rules.size());
+    std::vector<size_t> manipulator_counts(rules.size(), 0);
+
+    auto entries = get_entries();
+    auto rule_indices = make_rule_indices(profile, *entries);
+    for (size_t i = 0; i < entries->size(); ++i) {
+      if (auto rule_index = rule_indices[i]) {
+        values[*rule_index] += (*entries)[i].second->get_counters().get_values();
+        ++(manipulator_counts[*rule_index]);
+      }
+    }
+
+    auto json = nlohmann::json::array();
+    for (size_t i = 0; i < rules.size(); ++i) {
+      auto j = values[i].to_json();
+      j["index"] = i;
+      j["description"] = rules[i].get_description();
+      j["manipulator_count"] = manipulator_counts[i];
+      json.push_back(j);
+    }
+
+    return nlohmann::json::object({
+        {"counters_enabled", manipulator_manager_->get_counters_enabled()},
+        {"rules", json},
+    });
+  }
+
+  void clear_counters(void) {
+    for (const auto& e : *(get_entries())) {
+      e.second->get_counters().clear();
+    }
+  }
+
+  // The key of `entries_t`.
+  static std::string make_key(const core_configuration::details::complex_modifications_rule::manipulator& manipulator) {
+    // `get_json` contains `conditions`.
+    // `get_parameters` contains the parameters which are inherited from `complex_modifications.parameters`.
+    return manipulator.get_json().dump() + manipulator.get_parameters().to_json().dump();
+  }
+
+private:
+  struct build_result final {
+    std::shared_ptr<const entries_t> entries;
+    size_t reused_count;
+    bool cached;
+  };
+
+  static std::vector<std::optional<size_t>> make_rule_indices(const core_configuration::details::profile& profile,
+                                                             const entries_t& entries) {
+    // Same manipulators might be in multiple rules.
+    // They are assigned to rules in order as `build` does.
+    std::unordered_map<std::string, std::deque<size_t>> rule_indices_by_key;
+
+    const auto& rules = profile.get_complex_modifications().get_rules();
+    for (size_t i = 0; i < rules.size(); ++i) {
+      for (const auto& m : rules[i].get_manipulators()) {
+        rule_indices_by_key[make_key(m)].push_back(i);
+      }
+    }
+
+    std::vector<std::optional<size_t>> result;
+    result.reserve(entries.size());
+
+    for (const auto& e : entries) {
+      auto it = rule_indices_by_key.find(e.first);
+      if (it == std::end(rule_indices_by_key) ||
+          it->second.empty()) {
+        result.push_back(std::nullopt);
+      } else {
+        result.push_back(it->second.front());
+        it->second.pop_front();
+      }
+    }
+
+    return result;
+  }
+
+  build_result compile(const core_configuration::details::profile& profile) {
+    auto key = complex_modifications_profile_cache::make_key(profile);
+
+    if (auto entries = profile_cache_.find(key)) {
+      return build_result{entries, entries->size(), true};
+    }
+
+    auto result = build(profile, get_entries());
+    profile_cache_.insert(key, result.entries);
+    return result;
+  }
+
+  static constexpr size_t min_manipulators_per_worker = 64;
+
+  static build_result build(const core_configuration::details::profile& profile,
+                            std::shared_ptr<const entries_t> previous_entries) {
+    std::unordered_multimap<std::string, std::shared_ptr<manipulator::manipulators::base>> previous(std::begin(*previous_entries),
+                                                                                                    std::end(*previous_entries));
+
+    std::vector<const core_configuration::details::complex_modifications_rule::manipulator*> definitions;
+    std::vector<std::string> keys;
+    std::vector<std::shared_ptr<manipulator::manipulators::base>> manipulators;
+    std::vector<size_t> indices_to_build;
+    size_t reused_count = 0;
+
+    for (const auto& rule : profile.get_complex_modifications().get_rules()) {
+      for (const auto& manipulator : rule.get_manipulators()) {
+        auto key = make_key(manipulator);
+
+        std::shared_ptr<manipulator::manipulators::base> m;
+
+        auto it = previous.find(key);
+        if (it != std::end(previous)) {
+          m = it->second;
+          previous.erase(it);
+          ++reused_count;
+        } else {
+          indices_to_build.push_back(definitions.size());
+        }
+
+        definitions.push_back(&manipulator);
+        keys.push_back(std::move(key));
+        manipulators.push_back(m);
+      }
+    }
+
+    // Build manipulators in parallel.
+    // Each worker writes only its own range of `manipulators` and `error_messages`.
+
+    std::vector<std::string> error_messages(definitions.size());
+
+    auto build_range = [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        auto index = indices_to_build[i];
+        try {
+          auto m = manipulator::manipulator_factory::make_manipulator(definitions[index]->get_json(),
+                                                                      definitions[index]->get_parameters());
+          for (const auto& c : definitions[index]->get_conditions()) {
+            m->push_back_condition(manipulator::manipulator_factory::make_condition(c.get_json()));
+          }
+          manipulators[index] = m;
+
+        } catch (const pqrs::json::unmarshal_error& e) {
+          error_messages[index] = fmt::format("karabiner.json error: {0}", e.what());
+
+        } catch (const std::exception& e) {
+          error_messages[index] = e.what();
+        }
+      }
+    };
+
+    parallel_utility::for_each_range(indices_to_build.size(),
+                                     min_manipulators_per_worker,
+                                     build_range);
+
+    // Collect results in the rule order.
+
+    auto entries = std::make_shared<entries_t>();
+    entries->reserve(definitions.size());
+
+    for (size_t i = 0; i < definitions.size(); ++i) {
+      if (!error_messages[i].empty()) {
+        logger::get_logger()->error(error_messages[i]);
+        continue;
+      }
+
+      if (manipulators[i]) {
+        entries->emplace_back(std::move(keys[i]), manipulators[i]);
+      }
+    }
+
+    return build_result{entries, reused_count, false};
+  }
+
+  void apply(const build_result& result) {
+    std::vector<std::shared_ptr<manipulator::manipulators::base>> manipulators;
+    manipulators.reserve(result.entries->size());
+    for (const auto& e : *(result.entries)) {
+      manipulators.push_back(e.second);
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(entries_mutex_);
+
+      entries_ = result.entries;
+    }
+
+    manipulator_manager_->replace_manipulators(manipulators);
+
+    if (result.cached) {
+      logger::get_logger()->info("complex_modifications manipulators are updated (cached: {0})",
+                                 manipulators.size());
+    } else {
+      logger::get_logger()->info("complex_modifications manipulators are updated (reused: {0}, built: {1})",
+                                 result.reused_count,
+                                 manipulators.size() - result.reused_count);
+    }
+
+    manipulators_updated();
+  }
+
+  std::shared_ptr<manipulator::manipulator_manager> manipulator_manager_;
+
+  std::shared_ptr<const entries_t> entries_;
+  mutable std::mutex entries_mutex_;
+
+  complex_modifications_profile_cache profile_cache_;
+
+  std::atomic<uint64_t> generation_;
+
+  std::shared_ptr<pqrs::dispatcher::hardware_time_source> builder_time_source_;
+  std::shared_ptr<pqrs::dispatcher::dispatcher> builder_dispatcher_;
+  pqrs::dispatcher::object_id builder_object_id_;
+};
+} // namespace device_grabber_details
+} // namespace grabber
+} // namespace krbn
@@ -0,0 +1,152 @@
+#pragma once
+
+// `krbn::grabber::device_grabber_details::complex_modifications_profile_cache` can be used safely in a multi-threaded environment.
+
+#include "content_hash.hpp"
+#include "core_configuration/core_configuration.hpp"
+#include "manipulator/manipulators/base.hpp"
+#include <list>
+
+namespace krbn {
+namespace grabber {
+namespace device_grabber_details {
+// `complex_modifications_profile_cache` holds the compiled complex_modifications manipulators of profiles.
+// The entries are keyed by two independent content hashes of `profile.complex_modifications` and
+// the least recently used entry is removed when the number of entries exceeds `max_size`.
+
+class complex_modifications_profile_cache final {
+public:
+  typedef std::vector<std::pair<std::string, std::shared_ptr<manipulator::manipulators::base>>> entries_t;
+
+  struct key final {
+    uint64_t hash;
+    // A hash collision of `hash` is rejected by `secondary_hash`.
+    uint64_t secondary_hash;
+
+    bool operator==(const key& other) const {
+      return hash == other.hash &&
+             secondary_hash == other.secondary_hash;
+    }
+
+    bool operator!=(const key& other) const {
+      return !(*this == other);
+    }
+  };
+
+  complex_modifications_profile_cache(const complex_modifications_profile_cache&) = delete;
+
+  complex_modifications_profile_cache(size_t max_size) : max_size_(max_size),
+                                                        memory_size_(0) {
+  }
+
+  size_t get_max_size(void) const {
+    return max_size_;
+  }
+
+  size_t size(void) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    return entries_.size();
+  }
+
+  bool full(void) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    return entries_.size() >= max_size_;
+  }
+
+  // The estimated memory size of all cached profiles.
+  size_t get_memory_size(void) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    return memory_size_;
+  }
+
+  bool contains(const key& profile_key) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    return std::any_of(std::begin(entries_),
+                       std::end(entries_),
+                       [&](auto&& e) {
+                         return e.profile_key == profile_key;
+                       });
+  }
+
+  std::shared_ptr<const entries_t> find(const key& profile_key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    for (auto it = std::begin(entries_); it != std::end(entries_); ++it) {
+      if (it->profile_key == profile_key) {
+        // Move to the front (most recently used).
+        entries_.splice(std::begin(entries_), entries_, it);
+        return entries_.front().entries;
+      }
+    }
+
+    return nullptr;
+  }
+
+  void insert(const key& profile_key, std::shared_ptr<const entries_t> entries) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    for (auto it = std::begin(entries_); it != std::end(entries_); ++it) {
+      if (it->profile_key == profile_key) {
+        memory_size_ -= it->memory_size;
+        entries_.erase(it);
+        break;
+      }
+    }
+
+    auto memory_size = estimate_memory_size(*entries);
+    entries_.push_front({profile_key, entries, memory_size});
+    memory_size_ += memory_size;
+
+    while (entries_.size() > max_size_) {
+      memory_size_ -= entries_.back().memory_size;
+      entries_.pop_back();
+    }
+  }
+
+  void clear(void) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    entries_.clear();
+    memory_size_ = 0;
+  }
+
+  static key make_key(const core_configuration::details::profile& profile) {
+    auto json = profile.get_complex_modifications().to_json().dump();
+    return key{
+        content_hash::make(json),
+        content_hash::make_secondary(json),
+    };
+  }
+
+  // The estimated memory size of compiled manipulators.
+  // (Manipulators which are shared with other profiles are counted in each profile.)
+  static size_t estimate_memory_size(const entries_t& entries) {
+    size_t size = sizeof(entries_t) + entries.capacity() * sizeof(entries_t::value_type);
+    for (const auto& e : entries) {
+      size += e.first.capacity();
+      if (e.second) {
+        size += e.second->get_memory_size();
+      }
+    }
+    return size;
+  }
+
+private:
+  struct entry final {
+    key profile_key;
+    std::shared_ptr<const entries_t> entries;
+    size_t memory_size;
+  };
+
+  size_t max_size_;
+  std::list<entry> entries_;
+  size_t memory_size_;
+  mutable std::mutex mutex_;
+};
+} // namespace device_grabber_details
+} // namespace grabber
+} // namespace krbn
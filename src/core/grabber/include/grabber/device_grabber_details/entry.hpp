@@ -1,7 +1,9 @@
 #pragma once
 
 #include "core_configuration/core_configuration.hpp"
+#include "device_ingress_filter.hpp"
 #include "device_properties.hpp"
+#include "dispatcher_utility.hpp"
 #include "event_queue.hpp"
 #include "hid_keyboard_caps_lock_led_state_manager.hpp"
 #include "hid_keyboard_num_lock_led_state_manager.hpp"
@@ -22,6 +24,7 @@ public:
                                                                                           core_configuration_(core_configuration),
                                                                                           hid_queue_value_monitor_async_start_called_(false),
                                                                                           first_value_arrived_(false),
+                                                                                          ingress_filter_flush_scheduled_(false),
                                                                                           grabbed_(false),
                                                                                           disabled_(false),
                                                                                           grabbed_time_stamp_(0),
@@ -32,13 +35,18 @@ public:
     pressed_keys_manager_ = std::make_shared<pressed_keys_manager>();
     hid_queue_value_monitor_ = std::make_shared<pqrs::osx::iokit_hid_queue_value_monitor>(pqrs::dispatcher::extra::get_shared_dispatcher(),
                                                                                           device);
-    caps_lock_led_state_manager_ = std::make_shared<krbn::hid_keyboard_caps_lock_led_state_manager>(device);
-    num_lock_led_state_manager_ = std::make_shared<krbn::hid_keyboard_num_lock_led_state_manager>(device);
+    // LED state managers are not a part of the input event pipeline.
+    caps_lock_led_state_manager_ = std::make_shared<krbn::hid_keyboard_caps_lock_led_state_manager>(dispatcher_utility::get_background_dispatcher_or_shared_dispatcher(),
+                                                                                                    device);
+    num_lock_led_state_manager_ = std::make_shared<krbn::hid_keyboard_num_lock_led_state_manager>(dispatcher_utility::get_background_dispatcher_or_shared_dispatcher(),
+                                                                                                  device);
 
     device_name_ = iokit_utility::make_device_name_for_log(device_id,
                                                            device);
     device_short_name_ = iokit_utility::make_device_name(device_id,
                                                          device);
+
+    update_ingress_filter();
   }
 
   ~entry(void) {
@@ -59,6 +67,7 @@ public:
 
     control_caps_lock_led_state_manager();
     control_num_lock_led_state_manager();
+    update_ingress_filter();
 
   }
 
@@ -70,6 +79,18 @@ public:
     return pressed_keys_manager_;
   }
 
+  device_ingress_filter& get_ingress_filter(void) {
+    return ingress_filter_;
+  }
+
+  bool get_ingress_filter_flush_scheduled(void) const {
+    return ingress_filter_flush_scheduled_;
+  }
+
+  void set_ingress_filter_flush_scheduled(bool value) {
+    ingress_filter_flush_scheduled_ = value;
+  }
+
   std::shared_ptr<pqrs::osx::iokit_hid_queue_value_monitor> get_hid_queue_value_monitor(void) const {
     return hid_queue_value_monitor_;
   }
@@ -190,6 +211,23 @@ public:
   }
 
 private:
+  void update_ingress_filter(void) {
+    std::chrono::milliseconds key_chatter_debounce_duration(0);
+    uint64_t rate_limit_per_second = 0;
+
+    if (device_properties_) {
+      if (auto c = core_configuration_.lock()) {
+        if (auto device_identifiers = device_properties_->get_device_identifiers()) {
+          key_chatter_debounce_duration = c->get_selected_profile().get_device_key_chatter_debounce_milliseconds(*device_identifiers);
+          rate_limit_per_second = c->get_selected_profile().get_device_input_event_rate_limit_per_second(*device_identifiers);
+        }
+      }
+    }
+
+    ingress_filter_.set_key_chatter_debounce_duration(key_chatter_debounce_duration);
+    ingress_filter_.set_rate_limit_per_second(rate_limit_per_second);
+  }
+
   void control_caps_lock_led_state_manager(void) {
     if (caps_lock_led_state_manager_) {
       if (device_properties_) {
@@ -232,6 +270,8 @@ private:
   std::weak_ptr<const core_configuration::core_configuration> core_configuration_;
   std::shared_ptr<device_properties> device_properties_;
   std::shared_ptr<pressed_keys_manager> pressed_keys_manager_;
+  device_ingress_filter ingress_filter_;
+  bool ingress_filter_flush_scheduled_;
 
   std::shared_ptr<pqrs::osx::iokit_hid_queue_value_monitor> hid_queue_value_monitor_;
   bool hid_queue_value_monitor_async_start_called_;
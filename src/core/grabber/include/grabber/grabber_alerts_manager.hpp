@@ -2,8 +2,8 @@
 
 // `krbn::grabber::grabber_alerts_manager` can be used safely in a multi-threaded environment.
 
-#include "json_writer.hpp"
 #include "logger.hpp"
+#include "shared_state/publisher.hpp"
 #include <nlohmann/json.hpp>
 #include <pqrs/filesystem.hpp>
 #include <unordered_set>
@@ -51,9 +51,9 @@ public:
   }
 
   void async_save_to_file(void) const {
-    if (!output_json_file_path_.empty()) {
-      json_writer::async_save_to_file(to_json(), output_json_file_path_, 0755, 0644);
-    }
+    shared_state::publisher::async_publish(shared_state::segment::region::grabber_alerts,
+                                           to_json(),
+                                           output_json_file_path_);
   }
 
   nlohmann::json to_json(void) const {
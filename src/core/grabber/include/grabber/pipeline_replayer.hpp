@@ -0,0 +1,474 @@
+#pragma once
+
+// `krbn::grabber::pipeline_replayer` can be used safely in a multi-threaded environment.
+
+#include "console_user_server_client.hpp"
+#include "core_configuration/core_configuration.hpp"
+#include "event_queue.hpp"
+#include "grabber/device_grabber_details/complex_modifications_manipulator_manager.hpp"
+#include "grabber/device_grabber_details/fn_function_keys_manipulator_manager.hpp"
+#include "grabber/device_grabber_details/simple_modifications_manipulator_manager.hpp"
+#include "krbn_notification_center.hpp"
+#include "latency_histogram.hpp"
+#include "manipulator/event_trace.hpp"
+#include "manipulator/manipulator_managers_connector.hpp"
+#include "manipulator/manipulators/post_event_to_virtual_devices/post_event_to_virtual_devices.hpp"
+#include <fstream>
+#include <pqrs/dispatcher.hpp>
+#include <pqrs/thread_wait.hpp>
+#include <time.h>
+
+namespace krbn {
+namespace grabber {
+// `pipeline_replayer` replays input events through the same pipeline as `karabiner_grabber`
+// (simple_modifications -> complex_modifications -> fn_function_keys -> post_event_to_virtual_devices)
+// with `pqrs::dispatcher::pseudo_time_source`.
+// It is used by `karabiner_cli --simulate`, tests and benchmarks.
+//
+// - The pseudo time is advanced by `time_resolution` until the next input event in order to run timers
+//   (to_if_held_down, to_delayed_action, mouse keys, ...) at the same time in every replay.
+//   Idle periods longer than `max_idle_duration` are skipped.
+// - The virtual device reports are taken from the post_event_to_virtual_devices queue
+//   instead of sending them to the virtual devices.
+// - The thread CPU time and the heap allocation count (if `allocation_counter` is set)
+//   of the manipulation are recorded per input event.
+// - The number of events which are manipulated by each complex_modifications rule is counted
+//   from `manipulator::event_trace` records of the complex_modifications stage.
+
+class pipeline_replayer final : pqrs::dispatcher::extra::dispatcher_client {
+public:
+  struct options final {
+    std::chrono::milliseconds time_resolution = std::chrono::milliseconds(1);
+    std::chrono::milliseconds max_idle_duration = std::chrono::milliseconds(5000);
+    // The duration which is replayed after the last input event.
+    std::chrono::milliseconds tail_duration = std::chrono::milliseconds(5000);
+    // Return the total allocation count of the process.
+    std::function<uint64_t(void)> allocation_counter;
+    // Use `manipulator_order_optimizer` in complex_modifications as `device_grabber` does.
+    bool order_optimization = true;
+  };
+
+  struct result final {
+    nlohmann::json reports = nlohmann::json::array();
+    std::vector<std::chrono::nanoseconds> cpu_times;
+    std::vector<uint64_t> allocation_counts;
+    // Indexed by complex_modifications rules of the profile.
+    std::vector<std::string> rule_descriptions;
+    std::vector<uint64_t> rule_hit_counts;
+
+    nlohmann::json make_rules_json(void) const {
+      auto json = nlohmann::json::array();
+      for (size_t i = 0; i < rule_descriptions.size(); ++i) {
+        json.push_back(nlohmann::json::object({
+            {"index", i},
+            {"description", rule_descriptions[i]},
+            {"hit_count", rule_hit_counts[i]},
+        }));
+      }
+      return json;
+    }
+
+    nlohmann::json make_statistics_json(void) const {
+      latency_histogram cpu_time_histogram;
+      for (const auto& t : cpu_times) {
+        cpu_time_histogram.record(std::chrono::duration_cast<std::chrono::microseconds>(t));
+      }
+
+      auto json = nlohmann::json::object({
+          {"event_count", cpu_times.size()},
+          {"report_count", reports.size()},
+          {"cpu_time", cpu_time_histogram.to_json()},
+      });
+
+      if (!allocation_counts.empty()) {
+        uint64_t total = 0;
+        uint64_t max = 0;
+        for (const auto& c : allocation_counts) {
+          total += c;
+          max = std::max(max, c);
+        }
+        json["allocations"] = nlohmann::json::object({
+            {"total", total},
+            {"mean", total / allocation_counts.size()},
+            {"max", max},
+        });
+      }
+
+      return json;
+    }
+  };
+
+  pipeline_replayer(const pipeline_replayer&) = delete;
+
+  pipeline_replayer(const core_configuration::details::profile& profile) : pipeline_replayer(profile, options()) {
+  }
+
+  pipeline_replayer(const core_configuration::details::profile& profile,
+                    const options& options) : dispatcher_client(),
+                                              options_(options) {
+    pseudo_time_source_ = std::make_shared<pqrs::dispatcher::pseudo_time_source>();
+
+    if (auto d = weak_dispatcher_.lock()) {
+      original_weak_time_source_ = d->lock_weak_time_source();
+      d->set_weak_time_source(pseudo_time_source_);
+    }
+
+    console_user_server_client_ = std::make_shared<console_user_server_client>();
+
+    simple_modifications_manipulator_manager_ = std::make_shared<device_grabber_details::simple_modifications_manipulator_manager>();
+    simple_modifications_manipulator_manager_->update(profile);
+
+    complex_modifications_manipulator_manager_ = std::make_shared<device_grabber_details::complex_modifications_manipulator_manager>();
+    complex_modifications_manipulator_manager_->get_manipulator_manager()->set_order_optimization_enabled(options_.order_optimization);
+    complex_modifications_manipulator_manager_->update(profile);
+    make_rule_indices(profile);
+
+    fn_function_keys_manipulator_manager_ = std::make_shared<device_grabber_details::fn_function_keys_manipulator_manager>();
+    fn_function_keys_manipulator_manager_->update(profile,
+                                                  pqrs::osx::system_preferences::properties());
+
+    post_event_to_virtual_devices_manipulator_ =
+        std::make_shared<manipulator::manipulators::post_event_to_virtual_devices::post_event_to_virtual_devices>(
+            console_user_server_client_);
+    post_event_to_virtual_devices_manipulator_manager_ = std::make_shared<manipulator::manipulator_manager>();
+    post_event_to_virtual_devices_manipulator_manager_->push_back_manipulator(std::shared_ptr<manipulator::manipulators::base>(post_event_to_virtual_devices_manipulator_));
+
+    merged_input_event_queue_ = std::make_shared<event_queue::queue>();
+    simple_modifications_applied_event_queue_ = std::make_shared<event_queue::queue>();
+    complex_modifications_applied_event_queue_ = std::make_shared<event_queue::queue>();
+    fn_function_keys_applied_event_queue_ = std::make_shared<event_queue::queue>();
+    posted_event_queue_ = std::make_shared<event_queue::queue>();
+
+    connector_.emplace_back_connection(simple_modifications_manipulator_manager_->get_manipulator_manager(),
+                                       merged_input_event_queue_,
+                                       simple_modifications_applied_event_queue_);
+    connector_.emplace_back_connection(complex_modifications_manipulator_manager_->get_manipulator_manager(),
+                                       complex_modifications_applied_event_queue_);
+    connector_.emplace_back_connection(fn_function_keys_manipulator_manager_->get_manipulator_manager(),
+                                       fn_function_keys_applied_event_queue_);
+    connector_.emplace_back_connection(post_event_to_virtual_devices_manipulator_manager_,
+                                       posted_event_queue_);
+
+    event_trace_ = std::make_shared<manipulator::event_trace>();
+    connector_.set_event_trace(event_trace_);
+
+    input_event_arrived_connection_ = krbn_notification_center::get_instance().input_event_arrived.connect([this] {
+      manipulate(now_);
+    });
+  }
+
+  virtual ~pipeline_replayer(void) {
+    detach_from_dispatcher([this] {
+      input_event_arrived_connection_.disconnect();
+
+      post_event_to_virtual_devices_manipulator_ = nullptr;
+
+      simple_modifications_manipulator_manager_ = nullptr;
+      complex_modifications_manipulator_manager_ = nullptr;
+      fn_function_keys_manipulator_manager_ = nullptr;
+      post_event_to_virtual_devices_manipulator_manager_ = nullptr;
+
+      if (auto d = weak_dispatcher_.lock()) {
+        d->set_weak_time_source(original_weak_time_source_);
+      }
+    });
+  }
+
+  // Replay `input_events` from the pseudo time 0.
+  // This method must not be called in the shared dispatcher thread.
+  std::shared_ptr<result> replay(const std::vector<event_queue::entry>& input_events) {
+    result_ = std::make_shared<result>();
+    result_->rule_descriptions = rule_descriptions_;
+    result_->rule_hit_counts.resize(rule_descriptions_.size(), 0);
+
+    for (const auto& e : input_events) {
+      advance(to_milliseconds(e.get_event_time_stamp().get_time_stamp()));
+
+      run_in_dispatcher([this, &e] {
+        merged_input_event_queue_->push_back_entry(e);
+
+        auto allocation_count = options_.allocation_counter ? options_.allocation_counter() : 0;
+        auto cpu_time = thread_cpu_time();
+
+        manipulate(now_);
+
+        result_->cpu_times.push_back(thread_cpu_time() - cpu_time);
+        if (options_.allocation_counter) {
+          result_->allocation_counts.push_back(options_.allocation_counter() - allocation_count);
+        }
+
+        count_rule_hits();
+      });
+    }
+
+    advance(last_time_ + options_.tail_duration);
+
+    run_in_dispatcher([this] {
+      count_rule_hits();
+
+      for (const auto& e : post_event_to_virtual_devices_manipulator_->get_queue().get_events()) {
+        result_->reports.push_back(e.to_json());
+      }
+    });
+
+    return std::move(result_);
+  }
+
+  // Load a karabiner.json and return the selected profile.
+  static std::shared_ptr<core_configuration::details::profile> load_profile(const std::string& file_path) {
+    std::ifstream input(file_path);
+    if (!input) {
+      throw std::runtime_error(fmt::format("{0} is not found.", file_path));
+    }
+
+    auto json = nlohmann::json::parse(input);
+    if (auto profiles = pqrs::json::find_array(json, "profiles")) {
+      for (const auto& p : profiles->value()) {
+        if (pqrs::json::find<bool>(p, "selected").value_or(false)) {
+          return std::make_shared<core_configuration::details::profile>(p);
+        }
+      }
+      if (!profiles->value().empty()) {
+        return std::make_shared<core_configuration::details::profile>(profiles->value().front());
+      }
+    }
+
+    throw std::runtime_error(fmt::format("{0} does not contain profiles.", file_path));
+  }
+
+  // Load input events from a json array or an event trace file (`karabiner_cli --dump-event-trace`).
+  //
+  // The json array contains `event_queue::entry` json or script steps:
+  //
+  //   {"key_code": "a", "event_type": "key_down"}  (also "consumer_key_code" and "pointing_button")
+  //   {"wait_milliseconds": 100}
+  //
+  // Script steps start at 1000 milliseconds and events of script steps occur at the same time until `wait_milliseconds`.
+  //
+  // Only key_code, consumer_key_code and pointing_button events in the first stage are loaded from event trace files.
+  // Time stamps in event trace files are shifted so that the first event is at 1000 milliseconds.
+  static std::vector<event_queue::entry> load_input_events(const std::string& file_path) {
+    std::ifstream input(file_path, std::ios::binary);
+    if (!input) {
+      throw std::runtime_error(fmt::format("{0} is not found.", file_path));
+    }
+
+    std::vector<uint8_t> buffer((std::istreambuf_iterator<char>(input)),
+                                std::istreambuf_iterator<char>());
+
+    std::vector<event_queue::entry> result;
+
+    uint32_t magic = 0;
+    if (buffer.size() >= sizeof(magic)) {
+      memcpy(&magic, buffer.data(), sizeof(magic));
+    }
+
+    if (magic == manipulator::event_trace::magic) {
+      std::optional<absolute_time_point> first_time_stamp;
+      auto base = absolute_time_point(0) + pqrs::osx::chrono::make_absolute_time_duration(std::chrono::milliseconds(1000));
+
+      for (const auto& r : manipulator::event_trace::read_binary(buffer)) {
+        if (r.stage != 0) {
+          continue;
+        }
+
+        std::optional<event_queue::event> event;
+        switch (static_cast<event_queue::event::type>(r.event)) {
+          case event_queue::event::type::key_code:
+            event = event_queue::event(key_code(r.value));
+            break;
+          case event_queue::event::type::consumer_key_code:
+            event = event_queue::event(consumer_key_code(r.value));
+            break;
+          case event_queue::event::type::pointing_button:
+            event = event_queue::event(pointing_button(r.value));
+            break;
+          default:
+            break;
+        }
+        if (!event) {
+          continue;
+        }
+
+        auto time_stamp = absolute_time_point(r.time_stamp);
+        if (!first_time_stamp) {
+          first_time_stamp = time_stamp;
+        }
+
+        result.emplace_back(device_id(r.device_id),
+                            event_queue::event_time_stamp(base + (time_stamp - *first_time_stamp)),
+                            *event,
+                            static_cast<event_type>(r.event_type),
+                            *event);
+      }
+
+    } else {
+      auto time_stamp = absolute_time_point(0) + pqrs::osx::chrono::make_absolute_time_duration(std::chrono::milliseconds(1000));
+
+      for (const auto& j : nlohmann::json::parse(buffer)) {
+        if (j.contains("event")) {
+          result.push_back(event_queue::entry::make_from_json(j));
+          continue;
+        }
+
+        if (auto v = pqrs::json::find<int>(j, "wait_milliseconds")) {
+          time_stamp += pqrs::osx::chrono::make_absolute_time_duration(std::chrono::milliseconds(*v));
+          continue;
+        }
+
+        std::optional<event_queue::event> event;
+        if (auto v = pqrs::json::find_json(j, "key_code")) {
+          event = event_queue::event(v->value().get<key_code>());
+        } else if (auto v = pqrs::json::find_json(j, "consumer_key_code")) {
+          event = event_queue::event(v->value().get<consumer_key_code>());
+        } else if (auto v = pqrs::json::find_json(j, "pointing_button")) {
+          event = event_queue::event(v->value().get<pointing_button>());
+        } else {
+          throw std::runtime_error(fmt::format("unknown input event: {0}", j.dump()));
+        }
+
+        result.emplace_back(device_id(1),
+                            event_queue::event_time_stamp(time_stamp),
+                            *event,
+                            j.at("event_type").get<event_type>(),
+                            *event);
+      }
+    }
+
+    return result;
+  }
+
+private:
+  // Map manipulators of `complex_modifications_manipulator_manager` to rules.
+  // (Manipulators which are failed to build are not contained in the manager.)
+  void make_rule_indices(const core_configuration::details::profile& profile) {
+    for (const auto& r : profile.get_complex_modifications().get_rules()) {
+      rule_descriptions_.push_back(r.get_description());
+    }
+
+    rule_indices_ = complex_modifications_manipulator_manager_->make_rule_indices(profile);
+  }
+
+  // This method is executed in the shared dispatcher thread.
+  void count_rule_hits(void) {
+    auto records = event_trace_->make_snapshot(next_event_trace_sequence_);
+    for (const auto& r : records) {
+      if (r.stage == complex_modifications_stage &&
+          r.manipulator_index < rule_indices_.size()) {
+        if (auto i = rule_indices_[r.manipulator_index]) {
+          ++(result_->rule_hit_counts[*i]);
+        }
+      }
+      next_event_trace_sequence_ = r.sequence + 1;
+    }
+  }
+
+  static std::chrono::milliseconds to_milliseconds(absolute_time_point time_stamp) {
+    return pqrs::osx::chrono::make_milliseconds(time_stamp - absolute_time_point(0));
+  }
+
+  static std::chrono::nanoseconds thread_cpu_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+  }
+
+  // This method is executed in the shared dispatcher thread.
+  void manipulate(absolute_time_point now) {
+    connector_.manipulate(now);
+
+    posted_event_queue_->clear_events();
+
+    // Reschedule as `device_grabber::manipulate` does.
+    if (auto min = connector_.min_input_event_time_stamp()) {
+      auto when = when_now();
+      if (now < *min) {
+        when += pqrs::osx::chrono::make_milliseconds(*min - now);
+      }
+
+      enqueue_to_dispatcher(
+          [this, min] {
+            manipulate(*min);
+          },
+          when);
+    }
+  }
+
+  void run_in_dispatcher(const std::function<void(void)>& function) {
+    auto wait = pqrs::make_thread_wait();
+    enqueue_to_dispatcher([&function, wait] {
+      function();
+      wait->notify();
+    });
+    wait->wait_notice();
+  }
+
+  // Advance the pseudo time to `time` and run timers until `time`.
+  void advance(std::chrono::milliseconds time) {
+    if (time <= last_time_) {
+      return;
+    }
+
+    auto t = last_time_;
+    while (t < time) {
+      if (t - last_time_ >= options_.max_idle_duration) {
+        t = time;
+      } else {
+        t = std::min(t + options_.time_resolution, time);
+      }
+
+      pseudo_time_source_->set_now(pqrs::dispatcher::time_point(t));
+
+      auto wait = pqrs::make_thread_wait();
+      enqueue_to_dispatcher(
+          [this, t, wait] {
+            now_ = absolute_time_point(0) + pqrs::osx::chrono::make_absolute_time_duration(t);
+            wait->notify();
+          },
+          pqrs::dispatcher::time_point(t));
+      wait->wait_notice();
+    }
+
+    last_time_ = time;
+  }
+
+  // The connection index of complex_modifications in `connector_`.
+  static constexpr uint8_t complex_modifications_stage = 1;
+
+  options options_;
+
+  std::weak_ptr<pqrs::dispatcher::time_source> original_weak_time_source_;
+  std::shared_ptr<pqrs::dispatcher::pseudo_time_source> pseudo_time_source_;
+  std::chrono::milliseconds last_time_ = std::chrono::milliseconds(0);
+  absolute_time_point now_ = absolute_time_point(0);
+
+  std::shared_ptr<console_user_server_client> console_user_server_client_;
+  nod::connection input_event_arrived_connection_;
+
+  manipulator::manipulator_managers_connector connector_;
+
+  std::shared_ptr<event_queue::queue> merged_input_event_queue_;
+
+  std::shared_ptr<device_grabber_details::simple_modifications_manipulator_manager> simple_modifications_manipulator_manager_;
+  std::shared_ptr<event_queue::queue> simple_modifications_applied_event_queue_;
+
+  std::shared_ptr<device_grabber_details::complex_modifications_manipulator_manager> complex_modifications_manipulator_manager_;
+  std::shared_ptr<event_queue::queue> complex_modifications_applied_event_queue_;
+
+  std::shared_ptr<device_grabber_details::fn_function_keys_manipulator_manager> fn_function_keys_manipulator_manager_;
+  std::shared_ptr<event_queue::queue> fn_function_keys_applied_event_queue_;
+
+  std::shared_ptr<manipulator::manipulators::post_event_to_virtual_devices::post_event_to_virtual_devices> post_event_to_virtual_devices_manipulator_;
+  std::shared_ptr<manipulator::manipulator_manager> post_event_to_virtual_devices_manipulator_manager_;
+  std::shared_ptr<event_queue::queue> posted_event_queue_;
+
+  std::shared_ptr<manipulator::event_trace> event_trace_;
+  uint64_t next_event_trace_sequence_ = 0;
+  std::vector<std::string> rule_descriptions_;
+  // Indexed by manipulators of `complex_modifications_manipulator_manager`.
+  std::vector<std::optional<size_t>> rule_indices_;
+
+  std::shared_ptr<result> result_;
+};
+} // namespace grabber
+} // namespace krbn
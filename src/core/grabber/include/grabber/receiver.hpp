@@ -2,9 +2,11 @@
 
 // `krbn::grabber::receiver` can be used safely in a multi-threaded environment.
 
+#include "binary_message.hpp"
 #include "console_user_server_client.hpp"
 #include "constants.hpp"
 #include "device_grabber.hpp"
+#include "dispatcher_utility.hpp"
 #include "types.hpp"
 #include <pqrs/dispatcher.hpp>
 #include <pqrs/local_datagram.hpp>
@@ -19,7 +21,7 @@ class receiver final : public pqrs::dispatcher::extra::dispatcher_client {
 public:
   receiver(const receiver&) = delete;
 
-  receiver(uid_t current_console_user_id) : dispatcher_client(),
+  receiver(uid_t current_console_user_id) : dispatcher_client(dispatcher_utility::get_background_dispatcher_or_shared_dispatcher()),
                                             current_console_user_id_(current_console_user_id) {
     std::string socket_file_path(constants::get_grabber_socket_file_path());
 
@@ -50,6 +52,11 @@ public:
         }
 
         try {
+          if (binary_message::is_binary_message(*buffer)) {
+            handle_binary_message(*buffer);
+            return;
+          }
+
           nlohmann::json json = nlohmann::json::from_msgpack(*buffer);
           switch (json.at("operation_type").get<operation_type>()) {
             case operation_type::key_down_up_valued_event_arrived: {
@@ -94,7 +101,7 @@ public:
               logger::get_logger()->info("karabiner_console_user_server is connected.");
 
               console_user_server_client_ = nullptr;
-              console_user_server_client_ = std::make_shared<console_user_server_client>();
+              console_user_server_client_ = std::make_shared<console_user_server_client>(weak_dispatcher_);
 
               console_user_server_client_->connected.connect([this, user_core_configuration_file_path] {
                 stop_device_grabber();
@@ -144,6 +151,18 @@ public:
               }
               break;
 
+            case operation_type::dump_event_trace:
+              if (device_grabber_) {
+                device_grabber_->async_dump_event_trace();
+              }
+              break;
+
+            case operation_type::set_rule_statistics_enabled:
+              if (device_grabber_) {
+                device_grabber_->async_set_rule_statistics_enabled(json.at("enabled").get<bool>());
+              }
+              break;
+
             default:
               break;
           }
@@ -172,6 +191,50 @@ public:
   }
 
 private:
+  void handle_binary_message(const std::vector<uint8_t>& buffer) {
+    switch (binary_message::read_header(buffer).operation) {
+      case operation_type::key_down_up_valued_event_arrived:
+        binary_message::for_each_entry<binary_message::key_down_up_valued_event_entry>(buffer, [this](auto&& entry) {
+          if (device_grabber_) {
+            auto t = binary_message::make_event_type(entry);
+            if (!t) {
+              logger::get_logger()->warn("invalid event_type in binary message: {0}", static_cast<int>(entry.event_type));
+              return;
+            }
+
+            if (auto event = binary_message::make_key_down_up_valued_event(entry)) {
+              device_grabber_->async_update_probable_stuck_events_by_observer(
+                  device_id(entry.device_id),
+                  *event,
+                  *t,
+                  absolute_time_point(entry.time_stamp));
+            }
+          }
+        });
+        break;
+
+      case operation_type::caps_lock_state_changed:
+        binary_message::for_each_entry<binary_message::lock_state_entry>(buffer, [this](auto&& entry) {
+          if (device_grabber_) {
+            device_grabber_->async_set_caps_lock_state(entry.state);
+          }
+        });
+        break;
+
+      case operation_type::num_lock_state_changed:
+        binary_message::for_each_entry<binary_message::lock_state_entry>(buffer, [this](auto&& entry) {
+          if (device_grabber_) {
+            device_grabber_->async_set_num_lock_state(entry.state);
+          }
+        });
+        break;
+
+      default:
+        logger::get_logger()->warn("unsupported binary message: {0}", static_cast<int>(binary_message::read_header(buffer).operation));
+        break;
+    }
+  }
+
   void start_grabbing_if_system_core_configuration_file_exists(void) {
     auto file_path = constants::get_system_core_configuration_file_path();
     if (pqrs::filesystem::exists(file_path)) {
@@ -3,6 +3,7 @@
 // `krbn::grabber::session_monitor_receiver` can be used safely in a multi-threaded environment.
 
 #include "constants.hpp"
+#include "dispatcher_utility.hpp"
 #include "filesystem_utility.hpp"
 #include "types.hpp"
 #include <pqrs/local_datagram.hpp>
@@ -13,7 +14,7 @@ namespace krbn {
 namespace grabber {
 class session_monitor_receiver final : public pqrs::dispatcher::extra::dispatcher_client {
 public:
-  // Signals (invoked from the shared dispatcher thread)
+  // Signals (invoked from the dispatcher thread)
 
   nod::signal<void(std::optional<uid_t>)> current_console_user_id_changed;
 
@@ -21,7 +22,7 @@ public:
 
   session_monitor_receiver(const session_monitor_receiver&) = delete;
 
-  session_monitor_receiver(void) : dispatcher_client() {
+  session_monitor_receiver(void) : dispatcher_client(dispatcher_utility::get_background_dispatcher_or_shared_dispatcher()) {
     std::string socket_file_path(constants::get_grabber_session_monitor_receiver_socket_file_path());
 
     filesystem_utility::mkdir_rootonly_directory();
@@ -6,6 +6,7 @@
 #include "karabiner_version.h"
 #include "logger.hpp"
 #include "process_utility.hpp"
+#include "shared_state.hpp"
 #include <iostream>
 
 int main(int argc, const char* argv[]) {
@@ -38,6 +39,13 @@ int main(int argc, const char* argv[]) {
 
   krbn::dispatcher_utility::initialize_dispatchers();
 
+  // The shared dispatcher is dedicated to the input event pipeline in karabiner_grabber.
+  // Other components run on the background dispatcher. (See `dispatcher_utility`.)
+  krbn::dispatcher_utility::set_thread_qos_class(pqrs::dispatcher::extra::get_shared_dispatcher(),
+                                                 QOS_CLASS_USER_INTERACTIVE);
+
+  krbn::shared_state::publisher::initialize(krbn::constants::get_grabber_shared_state_name());
+
   signal(SIGUSR1, SIG_IGN);
   signal(SIGUSR2, SIG_IGN);
 
@@ -99,7 +107,8 @@ int main(int argc, const char* argv[]) {
 
   std::shared_ptr<krbn::grabber::components_manager> components_manager;
 
-  auto version_monitor = std::make_shared<krbn::version_monitor>(krbn::constants::get_version_file_path());
+  auto version_monitor = std::make_shared<krbn::version_monitor>(krbn::constants::get_version_file_path(),
+                                                                 krbn::dispatcher_utility::get_background_dispatcher());
 
   version_monitor->changed.connect([&](auto&& version) {
     dispatch_async(dispatch_get_main_queue(), ^{
@@ -119,6 +128,8 @@ int main(int argc, const char* argv[]) {
 
   krbn::logger::get_logger()->info("karabiner_grabber is terminated.");
 
+  krbn::shared_state::publisher::terminate();
+
   krbn::dispatcher_utility::terminate_dispatchers();
 
   return 0;
@@ -77,16 +77,21 @@ public:
           hid_queue_value_monitor->values_arrived.connect([this, device_id](auto&& values_ptr) {
             auto event_queue = event_queue::utility::make_queue(device_id,
                                                                 iokit_utility::make_hid_values(values_ptr));
+
+            // Send events at once.
+            std::vector<binary_message::key_down_up_valued_event_entry> entries;
             for (const auto& entry : event_queue->get_entries()) {
               if (auto e = entry.get_event().make_key_down_up_valued_event()) {
-                if (auto client = grabber_client_.lock()) {
-                  client->async_key_down_up_valued_event_arrived(device_id,
-                                                                 *e,
-                                                                 entry.get_event_type(),
-                                                                 entry.get_event_time_stamp().get_time_stamp());
-                }
+                entries.push_back(binary_message::make_key_down_up_valued_event_entry(device_id,
+                                                                                      *e,
+                                                                                      entry.get_event_type(),
+                                                                                      entry.get_event_time_stamp().get_time_stamp()));
               }
             }
+
+            if (auto client = grabber_client_.lock()) {
+              client->async_key_down_up_valued_events_arrived(entries);
+            }
           });
         }
 
@@ -47,15 +47,19 @@ public:
 
   size_t get_rules_size(size_t file_index) const {
     if (auto f = find_file(file_index)) {
-      return f->get_rules().size();
+      return f->get_rule_descriptions().size();
     }
     return 0;
   }
 
   const char* get_rule_description(size_t file_index,
                                    size_t index) const {
-    if (auto r = find_rule(file_index, index)) {
-      return r->get_description().c_str();
+    // Use descriptions in order to avoid constructing rules.
+    if (auto f = find_file(file_index)) {
+      auto& descriptions = f->get_rule_descriptions();
+      if (index < descriptions.size()) {
+        return descriptions[index].c_str();
+      }
     }
     return nullptr;
   }
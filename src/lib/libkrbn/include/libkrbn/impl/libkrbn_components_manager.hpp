@@ -7,6 +7,7 @@
 #include "libkrbn/impl/libkrbn_frontmost_application_monitor.hpp"
 #include "libkrbn/impl/libkrbn_hid_value_monitor.hpp"
 #include "libkrbn/impl/libkrbn_log_monitor.hpp"
+#include "libkrbn/impl/libkrbn_shared_state_monitor.hpp"
 #include "libkrbn/impl/libkrbn_system_preferences_monitor.hpp"
 #include "libkrbn/impl/libkrbn_version_monitor.hpp"
 
@@ -74,43 +75,46 @@ public:
     connected_devices_monitor_ = nullptr;
   }
 
-  // device_details_json_file_monitor
+  // device_details_monitor
 
-  void enable_device_details_json_file_monitor(libkrbn_file_monitor_callback callback,
-                                               void* refcon) {
-    device_details_json_file_monitor_ = std::make_unique<libkrbn_file_monitor>(krbn::constants::get_device_details_json_file_path(),
-                                                                               callback,
-                                                                               refcon);
+  void enable_device_details_monitor(libkrbn_shared_state_monitor_callback callback,
+                                     void* refcon) {
+    device_details_monitor_ = std::make_unique<libkrbn_shared_state_monitor>(krbn::shared_state::segment::region::device_details,
+                                                                             krbn::constants::get_device_details_json_file_path(),
+                                                                             callback,
+                                                                             refcon);
   }
 
-  void disable_device_details_json_file_monitor(void) {
-    device_details_json_file_monitor_ = nullptr;
+  void disable_device_details_monitor(void) {
+    device_details_monitor_ = nullptr;
   }
 
-  // manipulator_environment_json_file_monitor
+  // manipulator_environment_monitor
 
-  void enable_manipulator_environment_json_file_monitor(libkrbn_file_monitor_callback callback,
-                                                        void* refcon) {
-    manipulator_environment_json_file_monitor_ = std::make_unique<libkrbn_file_monitor>(krbn::constants::get_manipulator_environment_json_file_path(),
-                                                                                        callback,
-                                                                                        refcon);
+  void enable_manipulator_environment_monitor(libkrbn_shared_state_monitor_callback callback,
+                                              void* refcon) {
+    manipulator_environment_monitor_ = std::make_unique<libkrbn_shared_state_monitor>(krbn::shared_state::segment::region::manipulator_environment,
+                                                                                      krbn::constants::get_manipulator_environment_json_file_path(),
+                                                                                      callback,
+                                                                                      refcon);
   }
 
-  void disable_manipulator_environment_json_file_monitor(void) {
-    manipulator_environment_json_file_monitor_ = nullptr;
+  void disable_manipulator_environment_monitor(void) {
+    manipulator_environment_monitor_ = nullptr;
   }
 
-  // grabber_alerts_json_file_monitor
+  // grabber_alerts_monitor
 
-  void enable_grabber_alerts_json_file_monitor(libkrbn_file_monitor_callback callback,
-                                               void* refcon) {
-    grabber_alerts_json_file_monitor_ = std::make_unique<libkrbn_file_monitor>(krbn::constants::get_grabber_alerts_json_file_path(),
-                                                                               callback,
-                                                                               refcon);
+  void enable_grabber_alerts_monitor(libkrbn_shared_state_monitor_callback callback,
+                                     void* refcon) {
+    grabber_alerts_monitor_ = std::make_unique<libkrbn_shared_state_monitor>(krbn::shared_state::segment::region::grabber_alerts,
+                                                                             krbn::constants::get_grabber_alerts_json_file_path(),
+                                                                             callback,
+                                                                             refcon);
   }
 
-  void disable_grabber_alerts_json_file_monitor(void) {
-    grabber_alerts_json_file_monitor_ = nullptr;
+  void disable_grabber_alerts_monitor(void) {
+    grabber_alerts_monitor_ = nullptr;
   }
 
   // notification_message_json_file_monitor
@@ -175,9 +179,9 @@ private:
   std::shared_ptr<libkrbn_complex_modifications_assets_manager> complex_modifications_assets_manager_;
   std::unique_ptr<libkrbn_system_preferences_monitor> system_preferences_monitor_;
   std::unique_ptr<libkrbn_connected_devices_monitor> connected_devices_monitor_;
-  std::unique_ptr<libkrbn_file_monitor> device_details_json_file_monitor_;
-  std::unique_ptr<libkrbn_file_monitor> manipulator_environment_json_file_monitor_;
-  std::unique_ptr<libkrbn_file_monitor> grabber_alerts_json_file_monitor_;
+  std::unique_ptr<libkrbn_shared_state_monitor> device_details_monitor_;
+  std::unique_ptr<libkrbn_shared_state_monitor> manipulator_environment_monitor_;
+  std::unique_ptr<libkrbn_shared_state_monitor> grabber_alerts_monitor_;
   std::unique_ptr<libkrbn_file_monitor> notification_message_json_file_monitor_;
   std::unique_ptr<libkrbn_frontmost_application_monitor> frontmost_application_monitor_;
   std::unique_ptr<libkrbn_log_monitor> log_monitor_;
@@ -26,6 +26,7 @@ public:
     krbn::logger::get_logger()->info(__func__);
 
     monitor_ = std::make_unique<krbn::connected_devices_monitor>(
+        krbn::constants::get_grabber_shared_state_name(),
         krbn::constants::get_devices_json_file_path());
 
     monitor_->connected_devices_updated.connect([callback, refcon](auto&& weak_connected_devices) {
@@ -3,7 +3,7 @@
 #include "constants.hpp"
 #include "libkrbn/libkrbn.h"
 #include "logger.hpp"
-#include <pqrs/spdlog.hpp>
+#include "monitor/log_monitor.hpp"
 
 class libkrbn_log_lines_class final {
 public:
@@ -36,11 +36,10 @@ public:
       targets.push_back(log_directory + "/console_user_server.log");
     }
 
-    monitor_ = std::make_unique<pqrs::spdlog::monitor>(pqrs::dispatcher::extra::get_shared_dispatcher(),
-                                                       targets,
-                                                       250);
+    monitor_ = std::make_unique<krbn::log_monitor>(targets,
+                                                   250);
 
-    monitor_->log_file_updated.connect([callback, refcon](auto&& lines) {
+    monitor_->new_log_line_arrived.connect([callback, refcon](auto&& lines) {
       if (callback) {
         auto log_lines = new libkrbn_log_lines_class(lines);
         callback(reinterpret_cast<libkrbn_log_lines*>(log_lines), refcon);
@@ -56,5 +55,5 @@ public:
   }
 
 private:
-  std::unique_ptr<pqrs::spdlog::monitor> monitor_;
+  std::unique_ptr<krbn::log_monitor> monitor_;
 };
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "constants.hpp"
+#include "libkrbn/libkrbn.h"
+#include "monitor/shared_state_monitor.hpp"
+
+class libkrbn_shared_state_monitor final {
+public:
+  libkrbn_shared_state_monitor(const libkrbn_shared_state_monitor&) = delete;
+
+  libkrbn_shared_state_monitor(krbn::shared_state::segment::region region,
+                               const std::string& json_file_path,
+                               libkrbn_shared_state_monitor_callback callback,
+                               void* refcon) {
+    krbn::logger::get_logger()->info("{0} {1}", __func__, krbn::shared_state::segment::to_string(region));
+
+    monitor_ = std::make_unique<krbn::shared_state_monitor>(
+        krbn::constants::get_grabber_shared_state_name(),
+        std::vector<std::pair<krbn::shared_state::segment::region, std::string>>({
+            {region, json_file_path},
+        }));
+
+    monitor_->state_changed.connect([callback, refcon](auto&& region, auto&& json) {
+      if (callback) {
+        auto json_string = json->dump(4);
+        callback(json_string.c_str(), refcon);
+      }
+    });
+
+    monitor_->async_start(std::chrono::milliseconds(500));
+  }
+
+  ~libkrbn_shared_state_monitor(void) {
+    krbn::logger::get_logger()->info(__func__);
+  }
+
+private:
+  std::unique_ptr<krbn::shared_state_monitor> monitor_;
+};
@@ -245,25 +245,32 @@ typedef void (*libkrbn_file_monitor_callback)(const char* file_path,
                                               void* refcon);
 
 // ----------------------------------------
-// libkrbn_device_details_json_file_monitor
+// libkrbn_shared_state_monitor
 
-void libkrbn_enable_device_details_json_file_monitor(libkrbn_file_monitor_callback callback,
-                                                     void* refcon);
-void libkrbn_disable_device_details_json_file_monitor(void);
+// `json_string` is the state document which is published by karabiner_grabber.
+typedef void (*libkrbn_shared_state_monitor_callback)(const char* json_string,
+                                                      void* refcon);
 
 // ----------------------------------------
-// libkrbn_manipulator_environment_json_file_monitor
+// libkrbn_device_details_monitor
 
-void libkrbn_enable_manipulator_environment_json_file_monitor(libkrbn_file_monitor_callback callback,
-                                                              void* refcon);
-void libkrbn_disable_manipulator_environment_json_file_monitor(void);
+void libkrbn_enable_device_details_monitor(libkrbn_shared_state_monitor_callback callback,
+                                           void* refcon);
+void libkrbn_disable_device_details_monitor(void);
 
 // ----------------------------------------
-// libkrbn_grabber_alerts_json_file_monitor
+// libkrbn_manipulator_environment_monitor
 
-void libkrbn_enable_grabber_alerts_json_file_monitor(libkrbn_file_monitor_callback callback,
-                                                     void* refcon);
-void libkrbn_disable_grabber_alerts_json_file_monitor(void);
+void libkrbn_enable_manipulator_environment_monitor(libkrbn_shared_state_monitor_callback callback,
+                                                    void* refcon);
+void libkrbn_disable_manipulator_environment_monitor(void);
+
+// ----------------------------------------
+// libkrbn_grabber_alerts_monitor
+
+void libkrbn_enable_grabber_alerts_monitor(libkrbn_shared_state_monitor_callback callback,
+                                           void* refcon);
+void libkrbn_disable_grabber_alerts_monitor(void);
 
 // ----------------------------------------
 // libkrbn_notification_message_json_file_monitor
@@ -286,6 +293,8 @@ void libkrbn_disable_frontmost_application_monitor(void);
 // libkrbn_log_monitor
 
 typedef void libkrbn_log_lines;
+// `log_lines` contains only new lines since the last callback.
+// (The first callback contains the last 250 lines of the existing log files.)
 typedef void (*libkrbn_log_monitor_callback)(libkrbn_log_lines* log_lines, void* refcon);
 void libkrbn_enable_log_monitor(libkrbn_log_monitor_callback callback,
                                 void* refcon);
@@ -295,56 +295,56 @@ void libkrbn_disable_connected_devices_monitor(void) {
 }
 
 // ============================================================
-// device_details_json_file_monitor
+// device_details_monitor
 // ============================================================
 
-void libkrbn_enable_device_details_json_file_monitor(libkrbn_file_monitor_callback callback,
-                                                     void* refcon) {
+void libkrbn_enable_device_details_monitor(libkrbn_shared_state_monitor_callback callback,
+                                           void* refcon) {
   if (libkrbn_components_manager_) {
-    libkrbn_components_manager_->enable_device_details_json_file_monitor(callback,
-                                                                         refcon);
+    libkrbn_components_manager_->enable_device_details_monitor(callback,
+                                                               refcon);
   }
 }
 
-void libkrbn_disable_device_details_json_file_monitor(void) {
+void libkrbn_disable_device_details_monitor(void) {
   if (libkrbn_components_manager_) {
-    libkrbn_components_manager_->disable_device_details_json_file_monitor();
+    libkrbn_components_manager_->disable_device_details_monitor();
   }
 }
 
 // ============================================================
-// manipulator_environment_json_file_monitor
+// manipulator_environment_monitor
 // ============================================================
 
-void libkrbn_enable_manipulator_environment_json_file_monitor(libkrbn_file_monitor_callback callback,
-                                                              void* refcon) {
+void libkrbn_enable_manipulator_environment_monitor(libkrbn_shared_state_monitor_callback callback,
+                                                    void* refcon) {
   if (libkrbn_components_manager_) {
-    libkrbn_components_manager_->enable_manipulator_environment_json_file_monitor(callback,
-                                                                                  refcon);
+    libkrbn_components_manager_->enable_manipulator_environment_monitor(callback,
+                                                                        refcon);
   }
 }
 
-void libkrbn_disable_manipulator_environment_json_file_monitor(void) {
+void libkrbn_disable_manipulator_environment_monitor(void) {
   if (libkrbn_components_manager_) {
-    libkrbn_components_manager_->disable_manipulator_environment_json_file_monitor();
+    libkrbn_components_manager_->disable_manipulator_environment_monitor();
   }
 }
 
 // ============================================================
-// grabber_alerts_json_file_monitor
+// grabber_alerts_monitor
 // ============================================================
 
-void libkrbn_enable_grabber_alerts_json_file_monitor(libkrbn_file_monitor_callback callback,
-                                                     void* refcon) {
+void libkrbn_enable_grabber_alerts_monitor(libkrbn_shared_state_monitor_callback callback,
+                                           void* refcon) {
   if (libkrbn_components_manager_) {
-    libkrbn_components_manager_->enable_grabber_alerts_json_file_monitor(callback,
-                                                                         refcon);
+    libkrbn_components_manager_->enable_grabber_alerts_monitor(callback,
+                                                               refcon);
   }
 }
 
-void libkrbn_disable_grabber_alerts_json_file_monitor(void) {
+void libkrbn_disable_grabber_alerts_monitor(void) {
   if (libkrbn_components_manager_) {
-    libkrbn_components_manager_->disable_grabber_alerts_json_file_monitor();
+    libkrbn_components_manager_->disable_grabber_alerts_monitor();
   }
 }
 
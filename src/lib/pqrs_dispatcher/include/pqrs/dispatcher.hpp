@@ -0,0 +1,15 @@
+#pragma once
+
+// pqrs::dispatcher v2.5
+
+// (C) Copyright Takayama Fumihiko 2018.
+// Distributed under the Boost Software License, Version 1.0.
+// (See http://www.boost.org/LICENSE_1_0.txt)
+
+#include "dispatcher/dispatcher.hpp"
+#include "dispatcher/object_id.hpp"
+#include "dispatcher/time_source.hpp"
+
+#include "dispatcher/extra/dispatcher_client.hpp"
+#include "dispatcher/extra/shared_dispatcher.hpp"
+#include "dispatcher/extra/timer.hpp"
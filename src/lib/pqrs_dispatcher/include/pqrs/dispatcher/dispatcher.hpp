@@ -0,0 +1,565 @@
+#pragma once
+
+// (C) Copyright Takayama Fumihiko 2018.
+// Distributed under the Boost Software License, Version 1.0.
+// (See http://www.boost.org/LICENSE_1_0.txt)
+
+// `pqrs::dispatcher::dispatcher` can be used safely in a multi-threaded environment.
+
+#include "object_id.hpp"
+#include "time_source.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <pqrs/thread_wait.hpp>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace pqrs {
+namespace dispatcher {
+// Tasks are stored in the following queues:
+//
+// - `immediate_tasks_`: A FIFO for tasks which are enqueued with `when_immediately`.
+// - `delayed_tasks_`:   A binary heap (ordered by `when` and the enqueued order) for delayed tasks.
+//
+// The queues hold indices of `tasks_` which is a pool of task slots.
+// Released slots are reused for new tasks in order to avoid allocations per task.
+//
+// Tasks are also linked per object_id so that `detach` takes O(k) (k is the number of tasks of the object).
+// Detached tasks are marked as cancelled and removed from the queues lazily.
+
+class dispatcher final {
+public:
+  dispatcher(const dispatcher&) = delete;
+
+  dispatcher(std::weak_ptr<time_source> weak_time_source) : weak_time_source_(weak_time_source),
+                                                            worker_thread_id_wait_(make_thread_wait()),
+                                                            exit_(false),
+                                                            sequence_(0),
+                                                            cancelled_delayed_task_count_(0),
+                                                            object_id_(make_new_object_id()) {
+    worker_thread_ = std::thread([this] {
+      worker_thread_id_ = std::this_thread::get_id();
+      worker_thread_id_wait_->notify();
+
+      while (true) {
+        std::function<void(void)> function;
+        uint64_t object_id_value = 0;
+
+        {
+          std::unique_lock<std::mutex> lock(mutex_);
+
+          while (!exit_ && !pop_task(function, object_id_value)) {
+            // Wait
+
+            if (auto d = calculate_delayed_task_duration()) {
+              cv_.wait_for(lock, *d);
+            } else {
+              cv_.wait(lock);
+            }
+          }
+
+          if (exit_) {
+            break;
+          }
+
+          // Set running_function_object_id_
+          // (Set it while `mutex_` is locked in order to ensure `detach` waits the function.)
+
+          {
+            std::lock_guard<std::mutex> running_function_object_id_lock(running_function_object_id_mutex_);
+
+            running_function_object_id_ = object_id_value;
+          }
+        }
+
+        running_function_object_id_cv_.notify_all();
+
+        // Run function
+
+        function();
+        function = nullptr;
+
+        // Unset running_function_object_id_
+
+        {
+          std::lock_guard<std::mutex> lock(running_function_object_id_mutex_);
+
+          running_function_object_id_ = std::nullopt;
+        }
+
+        running_function_object_id_cv_.notify_all();
+      }
+    });
+
+    worker_thread_id_wait_->wait_notice();
+
+    attach(object_id_);
+  }
+
+  ~dispatcher(void) {
+    if (worker_thread_.joinable()) {
+      terminate();
+    }
+  }
+
+  void set_weak_time_source(std::weak_ptr<time_source> value) {
+    std::lock_guard<std::mutex> lock(weak_time_source_mutex_);
+
+    weak_time_source_ = value;
+  }
+
+  std::shared_ptr<time_source> lock_weak_time_source(void) const {
+    std::lock_guard<std::mutex> lock(weak_time_source_mutex_);
+
+    return weak_time_source_.lock();
+  }
+
+  void attach(const object_id& object_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    objects_.emplace(object_id.get(), object_entry());
+  }
+
+  bool detach(const object_id& object_id) {
+    // Erase `object_id` from objects_ if exists, and cancel tasks.
+
+    // Captured objects in functions must be released after `mutex_` is unlocked
+    // since their destructors might call dispatcher methods.
+    std::vector<std::function<void(void)>> cancelled_functions;
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      auto it = objects_.find(object_id.get());
+
+      if (it == std::end(objects_)) {
+        return false;
+      }
+
+      auto index = it->second.first_task_index;
+      while (index != invalid_task_index) {
+        auto& t = tasks_[index];
+        auto next = t.next;
+
+        cancelled_functions.push_back(std::move(t.function));
+        t.function = nullptr;
+        t.object = nullptr;
+        t.previous = invalid_task_index;
+        t.next = invalid_task_index;
+        t.cancelled = true;
+        if (t.delayed) {
+          ++cancelled_delayed_task_count_;
+        }
+
+        index = next;
+      }
+
+      objects_.erase(it);
+
+      compact_delayed_tasks();
+    }
+
+    cancelled_functions.clear();
+
+    if (!dispatcher_thread()) {
+      // Wait the running function if the running function is owned by object_id.
+
+      std::unique_lock<std::mutex> lock(running_function_object_id_mutex_);
+
+      running_function_object_id_cv_.wait(lock, [this, &object_id] {
+        return running_function_object_id_ != object_id.get();
+      });
+    }
+
+    return true;
+  }
+
+  // Note:
+  // Do not wait (thread::join, etc.) in `function` in order to avoid a deadlock.
+  void detach(const object_id& object_id,
+              const std::function<void(void)>& function) {
+    if (!detach(object_id)) {
+      return;
+    }
+
+    // Skip `function` if dispatcher is terminating or already terminated.
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      if (exit_) {
+        return;
+      }
+    }
+
+    // Execute function
+
+    if (dispatcher_thread()) {
+      function();
+    } else {
+      auto w = make_thread_wait();
+
+      // Run detached function with dispatcher's object_id.
+      // (`object_id` in arguments is already detached.)
+
+      enqueue(object_id_,
+              [w, &function] {
+                function();
+                w->notify();
+              },
+              when_internal_detached());
+
+      w->wait_notice();
+    }
+  }
+
+  bool attached(const object_id& object_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    return objects_.find(object_id.get()) != std::end(objects_);
+  }
+
+  bool dispatcher_thread(void) const {
+    return std::this_thread::get_id() == worker_thread_id_;
+  }
+
+  bool running_detached_function(void) const {
+    std::lock_guard<std::mutex> lock(running_function_object_id_mutex_);
+
+    return running_function_object_id_ == object_id_.get();
+  }
+
+  void terminate(void) {
+    // We should separate `~dispatcher` and `terminate` to ensure dispatcher exists until all jobs are processed.
+    //
+    // Example:
+    // ----------------------------------------
+    // class example final {
+    // public:
+    //   example(void) : object_id_(pqrs::dispatcher::make_new_object_id()) {
+    //     dispatcher_ = std::make_unique<pqrs::dispatcher::dispatcher>();
+    //     dispatcher_->attach(object_id_);
+    //
+    //     dispatcher_->enqueue(
+    //         object_id_,
+    //         [this] {
+    //           // `dispatcher_` might be nullptr if we call `terminate` before `dispatcher_ = nullptr`.
+    //           dispatcher_->enqueue(
+    //               object_id_,
+    //               [] {
+    //                 std::cout << "hello" << std::endl;
+    //               });
+    //         });
+    //
+    //     dispatcher_->terminate(); // SEGV if comment out this line
+    //     dispatcher_ = nullptr;
+    //   }
+    //
+    // private:
+    //   pqrs::dispatcher::object_id object_id_;
+    //   std::unique_ptr<pqrs::dispatcher::dispatcher> dispatcher_;
+    // };
+    // ----------------------------------------
+
+    if (dispatcher_thread()) {
+      // Do not call pqrs::dispatcher::terminate in the dispatcher thread.
+      abort();
+    }
+
+    if (worker_thread_.joinable()) {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        exit_ = true;
+      }
+
+      cv_.notify_one();
+      worker_thread_.join();
+    }
+  }
+
+  // Note:
+  // Do not wait (thread::join, etc.) in `function` in order to avoid a deadlock.
+  //
+  // `function` is moved into the task slot if it is passed as a rvalue.
+  // Tasks of objects which are not attached are discarded since they are never called.
+  void enqueue(const object_id& object_id,
+               std::function<void(void)> function,
+               time_point when = when_immediately()) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      auto it = objects_.find(object_id.get());
+      if (it == std::end(objects_)) {
+        return;
+      }
+
+      auto index = acquire_task_index();
+      auto& t = tasks_[index];
+      t.function = std::move(function);
+      t.object_id_value = object_id.get();
+      t.delayed = (when > when_immediately());
+      t.cancelled = false;
+
+      // Link to the object's task list.
+
+      t.object = &(it->second);
+      t.previous = invalid_task_index;
+      t.next = it->second.first_task_index;
+      if (t.next != invalid_task_index) {
+        tasks_[t.next].previous = index;
+      }
+      it->second.first_task_index = index;
+
+      // Push to the queue.
+
+      if (when == when_internal_detached()) {
+        immediate_tasks_.push_front(index);
+      } else if (!t.delayed) {
+        immediate_tasks_.push_back(index);
+      } else {
+        delayed_tasks_.push_back(delayed_task{when, ++sequence_, index});
+        std::push_heap(std::begin(delayed_tasks_),
+                       std::end(delayed_tasks_),
+                       delayed_task_compare);
+      }
+    }
+
+    cv_.notify_one();
+  }
+
+  void invoke(void) {
+    cv_.notify_one();
+  }
+
+  static constexpr time_point when_internal_detached() {
+    return time_point(duration(0));
+  }
+
+  static constexpr time_point when_immediately() {
+    return time_point(duration(1));
+  }
+
+private:
+  static constexpr uint32_t invalid_task_index = std::numeric_limits<uint32_t>::max();
+  static constexpr size_t min_cancelled_delayed_task_count_to_compact = 64;
+
+  struct object_entry final {
+    object_entry(void) : first_task_index(invalid_task_index) {
+    }
+
+    uint32_t first_task_index;
+  };
+
+  struct task final {
+    std::function<void(void)> function;
+    uint64_t object_id_value;
+    // `object` is nullptr if the task is not linked to an object (released or cancelled).
+    // (The address of an element in `std::unordered_map` is not changed by rehashing.)
+    object_entry* object;
+    uint32_t previous;
+    uint32_t next;
+    bool delayed;
+    bool cancelled;
+  };
+
+  struct delayed_task final {
+    time_point when;
+    uint64_t sequence;
+    uint32_t index;
+  };
+
+  // `std::push_heap` makes a max heap, so we reverse the order to pop the earliest task first.
+  static bool delayed_task_compare(const delayed_task& a, const delayed_task& b) {
+    if (a.when != b.when) {
+      return a.when > b.when;
+    }
+    return a.sequence > b.sequence;
+  }
+
+  // The following methods must be called while `mutex_` is locked.
+
+  uint32_t acquire_task_index(void) {
+    if (!free_task_indices_.empty()) {
+      auto index = free_task_indices_.back();
+      free_task_indices_.pop_back();
+      return index;
+    }
+
+    if (tasks_.size() >= invalid_task_index) {
+      throw std::runtime_error("pqrs::dispatcher::dispatcher too many tasks.");
+    }
+
+    tasks_.emplace_back();
+    return static_cast<uint32_t>(tasks_.size() - 1);
+  }
+
+  void release_task_index(uint32_t index) {
+    auto& t = tasks_[index];
+
+    if (t.object) {
+      if (t.previous != invalid_task_index) {
+        tasks_[t.previous].next = t.next;
+      } else {
+        t.object->first_task_index = t.next;
+      }
+      if (t.next != invalid_task_index) {
+        tasks_[t.next].previous = t.previous;
+      }
+    }
+
+    t.function = nullptr;
+    t.object = nullptr;
+    t.previous = invalid_task_index;
+    t.next = invalid_task_index;
+
+    free_task_indices_.push_back(index);
+  }
+
+  // Move the function of the task to `function` and release the task.
+  // Return false if the task is cancelled.
+  bool take_task(uint32_t index,
+                 std::function<void(void)>& function,
+                 uint64_t& object_id_value) {
+    auto& t = tasks_[index];
+
+    bool result = false;
+    if (!t.cancelled) {
+      function = std::move(t.function);
+      object_id_value = t.object_id_value;
+      result = true;
+    }
+
+    release_task_index(index);
+
+    return result;
+  }
+
+  bool pop_task(std::function<void(void)>& function,
+                uint64_t& object_id_value) {
+    while (!immediate_tasks_.empty()) {
+      auto index = immediate_tasks_.front();
+      immediate_tasks_.pop_front();
+
+      if (take_task(index, function, object_id_value)) {
+        return true;
+      }
+    }
+
+    if (!delayed_tasks_.empty()) {
+      auto now = calculate_now();
+
+      while (!delayed_tasks_.empty()) {
+        auto top = delayed_tasks_.front();
+        auto cancelled = tasks_[top.index].cancelled;
+
+        if (!cancelled && now < top.when) {
+          return false;
+        }
+
+        std::pop_heap(std::begin(delayed_tasks_),
+                      std::end(delayed_tasks_),
+                      delayed_task_compare);
+        delayed_tasks_.pop_back();
+
+        if (cancelled) {
+          --cancelled_delayed_task_count_;
+        }
+
+        if (take_task(top.index, function, object_id_value)) {
+          return true;
+        }
+      }
+    }
+
+    return false;
+  }
+
+  // Remove cancelled tasks from `delayed_tasks_` if they occupy more than half of the heap.
+  void compact_delayed_tasks(void) {
+    if (cancelled_delayed_task_count_ < min_cancelled_delayed_task_count_to_compact ||
+        cancelled_delayed_task_count_ * 2 < delayed_tasks_.size()) {
+      return;
+    }
+
+    delayed_tasks_.erase(std::remove_if(std::begin(delayed_tasks_),
+                                        std::end(delayed_tasks_),
+                                        [this](auto&& e) {
+                                          if (tasks_[e.index].cancelled) {
+                                            release_task_index(e.index);
+                                            return true;
+                                          }
+                                          return false;
+                                        }),
+                         std::end(delayed_tasks_));
+    std::make_heap(std::begin(delayed_tasks_),
+                   std::end(delayed_tasks_),
+                   delayed_task_compare);
+
+    cancelled_delayed_task_count_ = 0;
+  }
+
+  time_point calculate_now(void) const {
+    auto now = when_immediately();
+
+    if (auto s = lock_weak_time_source()) {
+      auto n = s->now();
+      if (now < n) {
+        now = n;
+      }
+    }
+
+    return now;
+  }
+
+  // Return the duration until the earliest delayed task.
+  // Return std::nullopt if there is no delayed task.
+  std::optional<duration> calculate_delayed_task_duration(void) const {
+    if (delayed_tasks_.empty()) {
+      return std::nullopt;
+    }
+
+    auto now = calculate_now();
+    auto when = delayed_tasks_.front().when;
+    if (now < when) {
+      return when - now;
+    }
+
+    return duration(0);
+  }
+
+  std::weak_ptr<time_source> weak_time_source_;
+  mutable std::mutex weak_time_source_mutex_;
+
+  std::thread worker_thread_;
+  std::thread::id worker_thread_id_;
+  std::shared_ptr<thread_wait> worker_thread_id_wait_;
+
+  std::vector<task> tasks_;
+  std::vector<uint32_t> free_task_indices_;
+  std::deque<uint32_t> immediate_tasks_;
+  std::vector<delayed_task> delayed_tasks_;
+  bool exit_;
+  uint64_t sequence_;
+  size_t cancelled_delayed_task_count_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+
+  // `object_id_` is for a function after detach
+  object_id object_id_;
+  std::unordered_map<uint64_t, object_entry> objects_;
+
+  std::optional<uint64_t> running_function_object_id_;
+  mutable std::mutex running_function_object_id_mutex_;
+  std::condition_variable running_function_object_id_cv_;
+};
+} // namespace dispatcher
+} // namespace pqrs
@@ -20,31 +20,56 @@ public:
                       const std::string& body,
                       mode_t parent_directory_mode,
                       mode_t file_mode) {
-    dispatcher_utility::enqueue_to_file_writer_dispatcher([file_path, body, parent_directory_mode, file_mode] {
-      try {
-        pqrs::filesystem::create_directory_with_intermediate_directories(pqrs::filesystem::dirname(file_path),
-                                                                         parent_directory_mode);
+    enqueue(file_path,
+            [body] {
+              return body;
+            },
+            parent_directory_mode,
+            file_mode);
+  }
+
+  // `make_body` is called in the file writer thread.
+  // Use this method to move slow serialization (e.g., `nlohmann::json::dump`) out of the caller thread.
+  static void enqueue(const std::string& file_path,
+                      const std::function<std::string(void)>& make_body,
+                      mode_t parent_directory_mode,
+                      mode_t file_mode) {
+    dispatcher_utility::enqueue_to_file_writer_dispatcher([file_path, make_body, parent_directory_mode, file_mode] {
+      write(file_path, make_body, parent_directory_mode, file_mode);
+    });
+  }
+
+  // Write the file synchronously.
+  // This method is intended to be called from tasks running in the file writer thread.
+  static void write(const std::string& file_path,
+                    const std::function<std::string(void)>& make_body,
+                    mode_t parent_directory_mode,
+                    mode_t file_mode) {
+    try {
+      auto body = make_body();
 
-        std::string tmp_file_path = file_path + ".tmp";
+      pqrs::filesystem::create_directory_with_intermediate_directories(pqrs::filesystem::dirname(file_path),
+                                                                       parent_directory_mode);
 
-        unlink(tmp_file_path.c_str());
+      std::string tmp_file_path = file_path + ".tmp";
 
-        std::ofstream output(tmp_file_path);
-        if (output) {
-          output << body;
+      unlink(tmp_file_path.c_str());
 
-          unlink(file_path.c_str());
-          rename(tmp_file_path.c_str(), file_path.c_str());
+      std::ofstream output(tmp_file_path);
+      if (output) {
+        output << body;
 
-          chmod(file_path.c_str(), file_mode);
-        } else {
-          logger::get_logger()->error("async_file_writer failed to open: {0}", file_path);
-        }
+        unlink(file_path.c_str());
+        rename(tmp_file_path.c_str(), file_path.c_str());
 
-      } catch (std::exception& e) {
-        logger::get_logger()->error("async_file_writer error: {0}", e.what());
+        chmod(file_path.c_str(), file_mode);
+      } else {
+        logger::get_logger()->error("async_file_writer failed to open: {0}", file_path);
       }
-    });
+
+    } catch (std::exception& e) {
+      logger::get_logger()->error("async_file_writer error: {0}", e.what());
+    }
   }
 
   static void wait(void) {
@@ -0,0 +1,194 @@
+#pragma once
+
+// `krbn::binary_message` can be used safely in a multi-threaded environment.
+
+#include "types.hpp"
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+namespace krbn {
+// A fixed-layout binary message format for frequent operations (observer -> grabber).
+//
+// The other (rare) operations are sent in MessagePack format.
+// The first byte of binary messages is 0xc1 which is never used in MessagePack,
+// so the receiver can distinguish binary messages from MessagePack messages.
+//
+// Layout (native byte order since the messages are exchanged between processes in the same machine):
+//
+//   header (8 bytes)
+//   entries (header.count * sizeof(entry type))
+
+class binary_message final {
+public:
+  static constexpr uint8_t magic = 0xc1;
+  static constexpr uint8_t version = 1;
+
+  // The receiver buffer size is 32 KB.
+  static constexpr size_t max_entries_per_message = 256;
+
+  struct header final {
+    uint8_t magic;
+    uint8_t version;
+    operation_type operation;
+    uint8_t reserved;
+    uint32_t count;
+  };
+  static_assert(sizeof(header) == 8);
+
+  enum class value_type : uint8_t {
+    none,
+    key_code,
+    consumer_key_code,
+    pointing_button,
+  };
+
+  struct key_down_up_valued_event_entry final {
+    uint64_t device_id;
+    uint64_t time_stamp;
+    uint32_t value;
+    value_type type;
+    uint8_t event_type;
+    uint16_t reserved;
+  };
+  static_assert(sizeof(key_down_up_valued_event_entry) == 24);
+
+  struct lock_state_entry final {
+    uint8_t state;
+  };
+  static_assert(sizeof(lock_state_entry) == 1);
+
+  static bool is_binary_message(const std::vector<uint8_t>& buffer) {
+    return !buffer.empty() && buffer[0] == magic;
+  }
+
+  // ----------------------------------------
+  // Encode
+
+  static key_down_up_valued_event_entry make_key_down_up_valued_event_entry(device_id device_id,
+                                                                            const key_down_up_valued_event& event,
+                                                                            event_type event_type,
+                                                                            absolute_time_point time_stamp) {
+    key_down_up_valued_event_entry entry{};
+
+    entry.device_id = type_safe::get(device_id);
+    entry.time_stamp = type_safe::get(time_stamp);
+    entry.event_type = static_cast<uint8_t>(event_type);
+
+    if (auto v = event.find<key_code>()) {
+      entry.type = value_type::key_code;
+      entry.value = static_cast<uint32_t>(*v);
+    } else if (auto v = event.find<consumer_key_code>()) {
+      entry.type = value_type::consumer_key_code;
+      entry.value = static_cast<uint32_t>(*v);
+    } else if (auto v = event.find<pointing_button>()) {
+      entry.type = value_type::pointing_button;
+      entry.value = static_cast<uint32_t>(*v);
+    } else {
+      entry.type = value_type::none;
+    }
+
+    return entry;
+  }
+
+  static std::vector<uint8_t> make_key_down_up_valued_events_arrived_message(const key_down_up_valued_event_entry* entries,
+                                                                            size_t count) {
+    return make_message(operation_type::key_down_up_valued_event_arrived, entries, count);
+  }
+
+  static std::vector<uint8_t> make_caps_lock_state_changed_message(bool state) {
+    lock_state_entry entry{static_cast<uint8_t>(state)};
+    return make_message(operation_type::caps_lock_state_changed, &entry, 1);
+  }
+
+  static std::vector<uint8_t> make_num_lock_state_changed_message(bool state) {
+    lock_state_entry entry{static_cast<uint8_t>(state)};
+    return make_message(operation_type::num_lock_state_changed, &entry, 1);
+  }
+
+  // ----------------------------------------
+  // Decode
+  //
+  // These methods throw std::runtime_error if the buffer is broken.
+
+  static header read_header(const std::vector<uint8_t>& buffer) {
+    if (buffer.size() < sizeof(header)) {
+      throw std::runtime_error("binary_message: buffer is too short");
+    }
+
+    header h;
+    memcpy(&h, buffer.data(), sizeof(h));
+
+    if (h.magic != magic) {
+      throw std::runtime_error("binary_message: invalid magic");
+    }
+    if (h.version != version) {
+      throw std::runtime_error(fmt::format("binary_message: unsupported version {0}", h.version));
+    }
+
+    return h;
+  }
+
+  template <typename T>
+  static void for_each_entry(const std::vector<uint8_t>& buffer,
+                             const std::function<void(const T&)>& function) {
+    auto h = read_header(buffer);
+
+    if (buffer.size() != sizeof(header) + sizeof(T) * h.count) {
+      throw std::runtime_error("binary_message: invalid buffer size");
+    }
+
+    auto p = buffer.data() + sizeof(header);
+    for (uint32_t i = 0; i < h.count; ++i) {
+      T entry;
+      memcpy(&entry, p, sizeof(entry));
+      function(entry);
+      p += sizeof(entry);
+    }
+  }
+
+  static std::optional<key_down_up_valued_event> make_key_down_up_valued_event(const key_down_up_valued_event_entry& entry) {
+    switch (entry.type) {
+      case value_type::key_code:
+        return key_down_up_valued_event(key_code(entry.value));
+      case value_type::consumer_key_code:
+        return key_down_up_valued_event(consumer_key_code(entry.value));
+      case value_type::pointing_button:
+        return key_down_up_valued_event(pointing_button(entry.value));
+      case value_type::none:
+        break;
+    }
+    return std::nullopt;
+  }
+
+  // Return std::nullopt if `entry.event_type` is not a valid `event_type`.
+  static std::optional<event_type> make_event_type(const key_down_up_valued_event_entry& entry) {
+    switch (static_cast<event_type>(entry.event_type)) {
+      case event_type::key_down:
+        return event_type::key_down;
+      case event_type::key_up:
+        return event_type::key_up;
+      case event_type::single:
+        return event_type::single;
+    }
+    return std::nullopt;
+  }
+
+private:
+  template <typename T>
+  static std::vector<uint8_t> make_message(operation_type operation_type,
+                                           const T* entries,
+                                           size_t count) {
+    header h{magic, version, operation_type, 0, static_cast<uint32_t>(count)};
+
+    std::vector<uint8_t> buffer(sizeof(header) + sizeof(T) * count);
+    memcpy(buffer.data(), &h, sizeof(h));
+    if (count > 0) {
+      memcpy(buffer.data() + sizeof(header), entries, sizeof(T) * count);
+    }
+
+    return buffer;
+  }
+};
+} // namespace krbn
@@ -1,56 +1,51 @@
 #pragma once
 
+// `krbn::complex_modifications_assets_file` can be used safely in a multi-threaded environment.
+
+#include "complex_modifications_assets_header.hpp"
 #include "constants.hpp"
+#include "content_hash.hpp"
 #include "core_configuration/core_configuration.hpp"
+#include "file_fingerprint.hpp"
+#include "logger.hpp"
 #include "manipulator/manipulator_factory.hpp"
+#include <mutex>
 #include <pqrs/string.hpp>
 
 namespace krbn {
+// The constructor reads only the title and rule descriptions by `complex_modifications_assets_header`.
+// Rules are constructed when `get_rules` is called at the first time.
+// (The file is read again at that time and rules are not constructed if the content is changed after the constructor.)
+//
+// Copies of `complex_modifications_assets_file` share the constructed rules.
+
 class complex_modifications_assets_file final {
 public:
-  complex_modifications_assets_file(const std::string& file_path) : file_path_(file_path) {
-    std::ifstream stream(file_path);
-    if (!stream) {
+  complex_modifications_assets_file(const std::string& file_path) : file_path_(file_path),
+                                                                    file_status_(file_fingerprint::make_file_status(file_path)),
+                                                                    rules_state_(std::make_shared<rules_state>()) {
+    auto body = read_file(file_path);
+    if (!body) {
       throw std::runtime_error(std::string("failed to open ") + file_path);
-    } else {
-      auto json = nlohmann::json::parse(stream);
-
-      if (!json.is_object()) {
-        throw pqrs::json::unmarshal_error(fmt::format("json must be object, but is `{0}`", json.dump()));
-      }
-
-      for (const auto& [key, value] : json.items()) {
-        if (key == "title") {
-          if (!value.is_string()) {
-            throw pqrs::json::unmarshal_error(fmt::format("`{0}` must be string, but is `{1}`", key, value.dump()));
-          }
+    }
 
-          title_ = value.get<std::string>();
+    content_hash_ = content_hash::make(body->data(), body->size());
 
-        } else if (key == "maintainers") {
-          // `maintainers` is used in <https://pqrs.org/osx/karabiner/complex_modifications/>.
-          if (!value.is_array()) {
-            throw pqrs::json::unmarshal_error(fmt::format("`{0}` must be array, but is `{1}`", key, value.dump()));
-          }
+    if (auto header = complex_modifications_assets_header::parse(*body)) {
+      title_ = header->get_title();
+      rule_descriptions_ = header->get_rule_descriptions();
 
-        } else if (key == "rules") {
-          if (!value.is_array()) {
-            throw pqrs::json::unmarshal_error(fmt::format("`{0}` must be array, but is `{1}`", key, value.dump()));
-          }
+    } else {
+      // Parse the file fully in order to throw the detailed error.
+      // (The constructed rules are kept if no error is found.)
 
-          core_configuration::details::complex_modifications_parameters parameters;
-          for (const auto& j : value) {
-            try {
-              rules_.emplace_back(j, parameters);
-            } catch (const pqrs::json::unmarshal_error& e) {
-              throw pqrs::json::unmarshal_error(fmt::format("`{0}` entry error: {1}", key, e.what()));
-            }
-          }
+      std::vector<core_configuration::details::complex_modifications_rule> rules;
+      load(*body, title_, rules);
 
-        } else {
-          // Ignore unknown keys
-        }
+      for (const auto& r : rules) {
+        rule_descriptions_.push_back(r.get_description());
       }
+      rules_state_->rules = std::move(rules);
     }
   }
 
@@ -58,18 +53,57 @@ public:
     return file_path_;
   }
 
+  // The file status when the file is read. (std::nullopt if `stat` is failed.)
+  const std::optional<file_fingerprint::file_status>& get_file_status(void) const {
+    return file_status_;
+  }
+
   const std::string& get_title(void) const {
     return title_;
   }
 
+  // Descriptions of rules. (Rules are not constructed.)
+  const std::vector<std::string>& get_rule_descriptions(void) const {
+    return rule_descriptions_;
+  }
+
   const std::vector<core_configuration::details::complex_modifications_rule>& get_rules(void) const {
-    return rules_;
+    std::lock_guard<std::mutex> lock(rules_state_->mutex);
+
+    if (!rules_state_->rules) {
+      std::string title;
+      std::vector<core_configuration::details::complex_modifications_rule> rules;
+
+      try {
+        auto body = read_file(file_path_);
+        if (!body) {
+          throw std::runtime_error(std::string("failed to open ") + file_path_);
+        }
+
+        // The title and rule descriptions are read from the previous content.
+        // Thus, we have to reject the changed content in order to avoid adding unexpected rules.
+        if (content_hash::make(body->data(), body->size()) != content_hash_) {
+          throw std::runtime_error("the file is changed after it is loaded. Reload complex_modifications assets.");
+        }
+
+        load(*body, title, rules);
+
+      } catch (std::exception& e) {
+        logger::get_logger()->error("Error in {0}: {1}", file_path_, e.what());
+        rules.clear();
+      }
+
+      rules_state_->rules = std::move(rules);
+    }
+
+    return *(rules_state_->rules);
   }
 
   void push_back_rule_to_core_configuration_profile(core_configuration::details::profile& profile,
-                                                    size_t index) {
-    if (index < rules_.size()) {
-      profile.push_back_complex_modifications_rule(rules_[index]);
+                                                    size_t index) const {
+    auto& rules = get_rules();
+    if (index < rules.size()) {
+      profile.push_back_complex_modifications_rule(rules[index]);
     }
   }
 
@@ -84,7 +118,7 @@ public:
   std::vector<std::string> lint(void) const {
     std::vector<std::string> error_messages;
 
-    for (const auto& rule : rules_) {
+    for (const auto& rule : get_rules()) {
       for (const auto& manipulator : rule.get_manipulators()) {
         try {
           manipulator::manipulator_factory::make_manipulator(manipulator.get_json(),
@@ -105,8 +139,80 @@ public:
   }
 
 private:
+  struct rules_state final {
+    std::mutex mutex;
+    std::optional<std::vector<core_configuration::details::complex_modifications_rule>> rules;
+  };
+
+  static std::optional<std::vector<uint8_t>> read_file(const std::string& file_path) {
+    std::ifstream input(file_path, std::ios::binary | std::ios::ate);
+    if (!input) {
+      return std::nullopt;
+    }
+
+    auto size = input.tellg();
+    if (size < 0) {
+      return std::nullopt;
+    }
+    input.seekg(0);
+
+    std::vector<uint8_t> body(static_cast<size_t>(size));
+    if (!input.read(reinterpret_cast<char*>(body.data()), size)) {
+      return std::nullopt;
+    }
+
+    return body;
+  }
+
+  static void load(const std::vector<uint8_t>& body,
+                   std::string& title,
+                   std::vector<core_configuration::details::complex_modifications_rule>& rules) {
+    auto json = nlohmann::json::parse(std::begin(body), std::end(body));
+
+    if (!json.is_object()) {
+      throw pqrs::json::unmarshal_error(fmt::format("json must be object, but is `{0}`", json.dump()));
+    }
+
+    for (auto& [key, value] : json.items()) {
+      if (key == "title") {
+        if (!value.is_string()) {
+          throw pqrs::json::unmarshal_error(fmt::format("`{0}` must be string, but is `{1}`", key, value.dump()));
+        }
+
+        title = value.get<std::string>();
+
+      } else if (key == "maintainers") {
+        // `maintainers` is used in <https://pqrs.org/osx/karabiner/complex_modifications/>.
+        if (!value.is_array()) {
+          throw pqrs::json::unmarshal_error(fmt::format("`{0}` must be array, but is `{1}`", key, value.dump()));
+        }
+
+      } else if (key == "rules") {
+        if (!value.is_array()) {
+          throw pqrs::json::unmarshal_error(fmt::format("`{0}` must be array, but is `{1}`", key, value.dump()));
+        }
+
+        core_configuration::details::complex_modifications_parameters parameters;
+        for (auto& j : value) {
+          try {
+            // Move the rule json into the rule in order to avoid copying manipulators.
+            rules.emplace_back(std::move(j), parameters);
+          } catch (const pqrs::json::unmarshal_error& e) {
+            throw pqrs::json::unmarshal_error(fmt::format("`{0}` entry error: {1}", key, e.what()));
+          }
+        }
+
+      } else {
+        // Ignore unknown keys
+      }
+    }
+  }
+
   std::string file_path_;
+  std::optional<file_fingerprint::file_status> file_status_;
+  uint64_t content_hash_;
   std::string title_;
-  std::vector<core_configuration::details::complex_modifications_rule> rules_;
+  std::vector<std::string> rule_descriptions_;
+  std::shared_ptr<rules_state> rules_state_;
 };
 } // namespace krbn
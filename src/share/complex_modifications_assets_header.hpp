@@ -0,0 +1,270 @@
+#pragma once
+
+// `krbn::complex_modifications_assets_header` can be used safely in a multi-threaded environment.
+
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace krbn {
+// `complex_modifications_assets_header` holds the title and rule descriptions of a complex_modifications assets file.
+//
+// `parse` extracts them by a SAX pass without building the json tree and without constructing rules.
+// It also checks the structure which `complex_modifications_assets_file` checks when it constructs rules
+// (types of `title`, `maintainers`, `rules`, rule `description`, `available_since`, `manipulators`, manipulator `description`, `conditions` and `parameters`).
+//
+// `parse` returns `std::nullopt` if the file is broken or the structure is not valid.
+// The caller should parse the file fully in this case to get the detailed error message.
+
+class complex_modifications_assets_header final {
+public:
+  const std::string& get_title(void) const {
+    return title_;
+  }
+
+  const std::vector<std::string>& get_rule_descriptions(void) const {
+    return rule_descriptions_;
+  }
+
+  static std::optional<complex_modifications_assets_header> parse(const std::vector<uint8_t>& body) {
+    parser p;
+    if (!nlohmann::json::sax_parse(std::begin(body), std::end(body), &p)) {
+      return std::nullopt;
+    }
+
+    return p.get_header();
+  }
+
+private:
+  class parser final {
+  public:
+    // `role` of json containers.
+    enum class role {
+      skip,
+      file,
+      rules,
+      rule,
+      manipulators,
+      manipulator,
+    };
+
+    enum class value_type {
+      string,
+      object,
+      array,
+      other,
+    };
+
+    complex_modifications_assets_header get_header(void) const {
+      complex_modifications_assets_header header;
+
+      header.title_ = title_;
+      for (const auto& r : rules_) {
+        // Use manipulators's description if needed. (Same as `complex_modifications_rule`.)
+        header.rule_descriptions_.push_back(r.description.empty() ? r.manipulator_description : r.description);
+      }
+
+      return header;
+    }
+
+    //
+    // SAX interface
+    //
+
+    bool null(void) {
+      return value(value_type::other, nullptr);
+    }
+
+    bool boolean(bool) {
+      return value(value_type::other, nullptr);
+    }
+
+    bool number_integer(nlohmann::json::number_integer_t) {
+      return value(value_type::other, nullptr);
+    }
+
+    bool number_unsigned(nlohmann::json::number_unsigned_t) {
+      return value(value_type::other, nullptr);
+    }
+
+    bool number_float(nlohmann::json::number_float_t, const nlohmann::json::string_t&) {
+      return value(value_type::other, nullptr);
+    }
+
+    bool string(nlohmann::json::string_t& v) {
+      return value(value_type::string, &v);
+    }
+
+    bool start_object(size_t) {
+      if (!value(value_type::object, nullptr)) {
+        return false;
+      }
+
+      switch (child_role_) {
+        case role::rule:
+          rules_.emplace_back();
+          break;
+        case role::manipulator:
+          manipulator_description_.clear();
+          break;
+        default:
+          break;
+      }
+
+      stack_.push_back(child_role_);
+      return true;
+    }
+
+    bool key(nlohmann::json::string_t& v) {
+      if (stack_.back() != role::skip) {
+        key_ = v;
+      }
+      return true;
+    }
+
+    bool end_object(void) {
+      if (stack_.back() == role::manipulator &&
+          !rules_.empty() &&
+          rules_.back().manipulator_description.empty()) {
+        rules_.back().manipulator_description = manipulator_description_;
+      }
+
+      stack_.pop_back();
+      return true;
+    }
+
+    bool start_array(size_t) {
+      if (!value(value_type::array, nullptr)) {
+        return false;
+      }
+
+      stack_.push_back(child_role_);
+      return true;
+    }
+
+    bool end_array(void) {
+      stack_.pop_back();
+      return true;
+    }
+
+    bool parse_error(size_t, const std::string&, const nlohmann::detail::exception&) {
+      return false;
+    }
+
+  private:
+    struct rule final {
+      std::string description;
+      // The first non-empty description of manipulators.
+      std::string manipulator_description;
+    };
+
+    // Check the value type and set `child_role_` for containers.
+    bool value(value_type type, const std::string* string) {
+      child_role_ = role::skip;
+
+      if (stack_.empty()) {
+        if (type != value_type::object) {
+          return false;
+        }
+        child_role_ = role::file;
+        return true;
+      }
+
+      switch (stack_.back()) {
+        case role::skip:
+          return true;
+
+        case role::file:
+          if (key_ == "title") {
+            if (type != value_type::string) {
+              return false;
+            }
+            title_ = *string;
+
+          } else if (key_ == "maintainers") {
+            if (type != value_type::array) {
+              return false;
+            }
+
+          } else if (key_ == "rules") {
+            if (type != value_type::array) {
+              return false;
+            }
+            // The last one is used if `rules` are duplicated.
+            rules_.clear();
+            child_role_ = role::rules;
+          }
+          return true;
+
+        case role::rules:
+          if (type != value_type::object) {
+            return false;
+          }
+          child_role_ = role::rule;
+          return true;
+
+        case role::rule:
+          if (key_ == "description") {
+            if (type != value_type::string) {
+              return false;
+            }
+            rules_.back().description = *string;
+
+          } else if (key_ == "available_since") {
+            if (type != value_type::string) {
+              return false;
+            }
+
+          } else if (key_ == "manipulators") {
+            if (type != value_type::array) {
+              return false;
+            }
+            rules_.back().manipulator_description.clear();
+            child_role_ = role::manipulators;
+          }
+          return true;
+
+        case role::manipulators:
+          if (type != value_type::object) {
+            return false;
+          }
+          child_role_ = role::manipulator;
+          return true;
+
+        case role::manipulator:
+          if (key_ == "description") {
+            if (type != value_type::string) {
+              return false;
+            }
+            manipulator_description_ = *string;
+
+          } else if (key_ == "conditions") {
+            if (type != value_type::array) {
+              return false;
+            }
+
+          } else if (key_ == "parameters") {
+            if (type != value_type::object) {
+              return false;
+            }
+          }
+          return true;
+      }
+
+      return false;
+    }
+
+    std::vector<role> stack_;
+    std::string key_;
+    role child_role_ = role::skip;
+
+    std::string title_;
+    std::vector<rule> rules_;
+    std::string manipulator_description_;
+  };
+
+  std::string title_;
+  std::vector<std::string> rule_descriptions_;
+};
+} // namespace krbn
@@ -1,23 +1,23 @@
 #pragma once
 
 #include "complex_modifications_assets_file.hpp"
+#include "parallel_utility.hpp"
 #include <dirent.h>
 #include <unistd.h>
+#include <unordered_map>
 
 namespace krbn {
+// `reload` reads files in parallel.
+// Files which are not changed since the last `reload` (same path and same file status) are reused without reading them.
+
 class complex_modifications_assets_manager final {
 public:
   void reload(const std::string& directory, bool load_system_example_file = true) {
-    files_.clear();
+    std::vector<std::string> file_paths;
 
     // Load system example file.
     if (load_system_example_file) {
-      const std::string file_path = "/Library/Application Support/org.pqrs/Karabiner-Elements/complex_modifications_rules_example.json";
-      try {
-        files_.emplace_back(file_path);
-      } catch (std::exception& e) {
-        logger::get_logger()->error("Error in {0}: {1}", file_path, e.what());
-      }
+      file_paths.push_back("/Library/Application Support/org.pqrs/Karabiner-Elements/complex_modifications_rules_example.json");
     }
 
     // Load user files.
@@ -26,17 +26,67 @@ public:
       while (auto entry = readdir(dir)) {
         if (entry->d_type == DT_REG ||
             entry->d_type == DT_LNK) {
-          auto file_path = directory + "/" + entry->d_name;
+          file_paths.push_back(directory + "/" + entry->d_name);
+        }
+      }
+      closedir(dir);
+    }
 
-          try {
-            files_.emplace_back(file_path);
+    // Reuse cached files.
 
-          } catch (std::exception& e) {
-            logger::get_logger()->error("Error in {0}: {1}", file_path, e.what());
-          }
+    std::vector<std::optional<complex_modifications_assets_file>> files(file_paths.size());
+    std::vector<size_t> indices_to_read;
+
+    for (size_t i = 0; i < file_paths.size(); ++i) {
+      auto it = cache_.find(file_paths[i]);
+      if (it != std::end(cache_)) {
+        auto& status = it->second.get_file_status();
+        if (status &&
+            status == file_fingerprint::make_file_status(file_paths[i])) {
+          files[i] = it->second;
+          continue;
         }
       }
-      closedir(dir);
+
+      indices_to_read.push_back(i);
+    }
+
+    // Read files in parallel.
+    // Each worker writes only its own range of `files` and `error_messages`.
+
+    std::vector<std::string> error_messages(file_paths.size());
+
+    auto read_range = [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        auto index = indices_to_read[i];
+        try {
+          files[index] = complex_modifications_assets_file(file_paths[index]);
+        } catch (std::exception& e) {
+          error_messages[index] = e.what();
+        }
+      }
+    };
+
+    parallel_utility::for_each_range(indices_to_read.size(),
+                                     min_files_per_worker,
+                                     read_range);
+
+    // Collect results.
+    // Files which are removed from the directory are also removed from `cache_`.
+
+    files_.clear();
+    cache_.clear();
+
+    for (size_t i = 0; i < file_paths.size(); ++i) {
+      if (!error_messages[i].empty()) {
+        logger::get_logger()->error("Error in {0}: {1}", file_paths[i], error_messages[i]);
+        continue;
+      }
+
+      if (files[i]) {
+        cache_.emplace(file_paths[i], *(files[i]));
+        files_.push_back(std::move(*(files[i])));
+      }
     }
 
     // Sort by title_
@@ -52,6 +102,10 @@ public:
   }
 
 private:
+  // Small directories are read in the current thread since starting threads costs more than reading a few files.
+  static constexpr size_t min_files_per_worker = 8;
+
   std::vector<complex_modifications_assets_file> files_;
+  std::unordered_map<std::string, complex_modifications_assets_file> cache_;
 };
 } // namespace krbn
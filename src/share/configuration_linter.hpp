@@ -0,0 +1,393 @@
+#pragma once
+
+// `krbn::configuration_linter` can be used safely in a multi-threaded environment.
+
+#include "core_configuration/core_configuration.hpp"
+#include "manipulator/manipulator_factory.hpp"
+#include "parallel_utility.hpp"
+#include <chrono>
+#include <fstream>
+
+namespace krbn {
+// `configuration_linter` checks complex_modifications assets files and karabiner.json files.
+//
+// - Files are parsed in parallel, and then rules of all files are checked in parallel.
+// - Each error has the JSON pointer of the invalid value. (e.g., `/rules/0/manipulators/1`)
+// - Unlike `complex_modifications_assets_file::lint`, checking is continued after an invalid rule
+//   in order to report all errors at once.
+
+class configuration_linter final {
+public:
+  enum class file_type {
+    complex_modifications,
+    core_configuration,
+  };
+
+  struct input final {
+    std::string file_path;
+    file_type type;
+  };
+
+  struct error final {
+    std::string json_pointer;
+    // The rule description if the error is in a rule.
+    std::string description;
+    std::string message;
+
+    nlohmann::json to_json(void) const {
+      return nlohmann::json::object({
+          {"json_pointer", json_pointer},
+          {"description", description},
+          {"message", message},
+      });
+    }
+  };
+
+  struct file_result final {
+    std::string file_path;
+    std::vector<error> errors;
+    size_t rule_count = 0;
+    // The total time to check the file. (Time of parallel workers are summed.)
+    std::chrono::nanoseconds duration = std::chrono::nanoseconds(0);
+
+    nlohmann::json to_json(void) const {
+      auto json = nlohmann::json::object({
+          {"file_path", file_path},
+          {"errors", nlohmann::json::array()},
+          {"rule_count", rule_count},
+          {"milliseconds", make_milliseconds(duration)},
+      });
+      for (const auto& e : errors) {
+        json["errors"].push_back(e.to_json());
+      }
+      return json;
+    }
+  };
+
+  struct result final {
+    std::vector<file_result> files;
+    size_t worker_count = 1;
+    // The elapsed time.
+    std::chrono::nanoseconds duration = std::chrono::nanoseconds(0);
+
+    size_t get_error_count(void) const {
+      size_t count = 0;
+      for (const auto& f : files) {
+        count += f.errors.size();
+      }
+      return count;
+    }
+
+    nlohmann::json to_json(void) const {
+      size_t rule_count = 0;
+      auto files_json = nlohmann::json::array();
+      for (const auto& f : files) {
+        rule_count += f.rule_count;
+        files_json.push_back(f.to_json());
+      }
+
+      return nlohmann::json::object({
+          {"files", files_json},
+          {"summary", nlohmann::json::object({
+                          {"file_count", files.size()},
+                          {"rule_count", rule_count},
+                          {"error_count", get_error_count()},
+                          {"worker_count", worker_count},
+                          {"milliseconds", make_milliseconds(duration)},
+                      })},
+      });
+    }
+  };
+
+  static result lint(const std::vector<input>& inputs) {
+    auto start = std::chrono::steady_clock::now();
+
+    result r;
+    r.files.resize(inputs.size());
+
+    // Parse files in parallel.
+
+    std::vector<std::vector<error>> file_errors(inputs.size());
+    std::vector<std::vector<rule_job>> file_jobs(inputs.size());
+
+    r.worker_count = parallel_utility::for_each_range(
+        inputs.size(),
+        min_files_per_worker,
+        [&](size_t begin, size_t end) {
+          for (size_t i = begin; i < end; ++i) {
+            auto s = std::chrono::steady_clock::now();
+
+            auto& f = r.files[i];
+            f.file_path = inputs[i].file_path;
+            parse_file(inputs[i], i, file_errors[i], file_jobs[i]);
+            f.rule_count = file_jobs[i].size();
+
+            f.duration += std::chrono::steady_clock::now() - s;
+          }
+        });
+
+    // Check rules in parallel.
+
+    std::vector<rule_job> jobs;
+    for (auto&& v : file_jobs) {
+      std::move(std::begin(v), std::end(v), std::back_inserter(jobs));
+    }
+
+    r.worker_count = std::max(r.worker_count,
+                              parallel_utility::for_each_range(
+                                  jobs.size(),
+                                  min_rules_per_worker,
+                                  [&](size_t begin, size_t end) {
+                                    for (size_t i = begin; i < end; ++i) {
+                                      auto s = std::chrono::steady_clock::now();
+                                      check_rule(jobs[i]);
+                                      jobs[i].duration = std::chrono::steady_clock::now() - s;
+                                    }
+                                  }));
+
+    // Collect errors in the document order.
+
+    std::vector<size_t> file_error_indices(inputs.size(), 0);
+
+    auto move_file_errors = [&](size_t file_index, size_t end) {
+      auto& i = file_error_indices[file_index];
+      for (; i < end; ++i) {
+        r.files[file_index].errors.push_back(std::move(file_errors[file_index][i]));
+      }
+    };
+
+    for (auto&& job : jobs) {
+      auto& f = r.files[job.file_index];
+      move_file_errors(job.file_index, job.file_error_position);
+      std::move(std::begin(job.errors), std::end(job.errors), std::back_inserter(f.errors));
+      f.duration += job.duration;
+    }
+
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      move_file_errors(i, file_errors[i].size());
+    }
+
+    r.duration = std::chrono::steady_clock::now() - start;
+
+    return r;
+  }
+
+private:
+  static constexpr size_t min_files_per_worker = 4;
+  static constexpr size_t min_rules_per_worker = 16;
+
+  struct rule_job final {
+    size_t file_index;
+    // The number of file errors which are found before this rule.
+    size_t file_error_position;
+    std::string json_pointer;
+    // A slice of the file json.
+    std::shared_ptr<const nlohmann::json> json;
+    core_configuration::details::complex_modifications_parameters parameters;
+
+    std::vector<error> errors;
+    std::chrono::nanoseconds duration;
+  };
+
+  static double make_milliseconds(std::chrono::nanoseconds duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+  }
+
+  static void parse_file(const input& input,
+                         size_t file_index,
+                         std::vector<error>& errors,
+                         std::vector<rule_job>& jobs) {
+    std::shared_ptr<nlohmann::json> json;
+
+    {
+      std::ifstream stream(input.file_path);
+      if (!stream) {
+        errors.push_back({"", "", std::string("failed to open ") + input.file_path});
+        return;
+      }
+
+      try {
+        json = std::make_shared<nlohmann::json>(nlohmann::json::parse(stream));
+      } catch (const std::exception& e) {
+        errors.push_back({"", "", e.what()});
+        return;
+      }
+    }
+
+    if (!json->is_object()) {
+      errors.push_back({"", "", fmt::format("json must be object, but is `{0}`", json->dump())});
+      return;
+    }
+
+    switch (input.type) {
+      case file_type::complex_modifications:
+        parse_complex_modifications(json, file_index, errors, jobs);
+        break;
+
+      case file_type::core_configuration:
+        parse_core_configuration(json, file_index, errors, jobs);
+        break;
+    }
+  }
+
+  static void parse_complex_modifications(std::shared_ptr<const nlohmann::json> json,
+                                          size_t file_index,
+                                          std::vector<error>& errors,
+                                          std::vector<rule_job>& jobs) {
+    for (const auto& [key, value] : json->items()) {
+      if (key == "title") {
+        if (!value.is_string()) {
+          errors.push_back({"/" + key, "", fmt::format("`{0}` must be string, but is `{1}`", key, value.dump())});
+        }
+
+      } else if (key == "maintainers") {
+        if (!value.is_array()) {
+          errors.push_back({"/" + key, "", fmt::format("`{0}` must be array, but is `{1}`", key, value.dump())});
+        }
+
+      } else if (key == "rules") {
+        push_back_rule_jobs(json,
+                            value,
+                            "/rules",
+                            core_configuration::details::complex_modifications_parameters(),
+                            file_index,
+                            errors,
+                            jobs);
+      }
+    }
+  }
+
+  static void parse_core_configuration(std::shared_ptr<const nlohmann::json> json,
+                                       size_t file_index,
+                                       std::vector<error>& errors,
+                                       std::vector<rule_job>& jobs) {
+    if (auto v = pqrs::json::find_json(*json, "global")) {
+      try {
+        core_configuration::details::global_configuration(v->value());
+      } catch (const std::exception& e) {
+        errors.push_back({"/global", "", e.what()});
+      }
+    }
+
+    auto it = json->find("profiles");
+    if (it == std::end(*json)) {
+      return;
+    }
+
+    if (!it->is_array()) {
+      errors.push_back({"/profiles", "", fmt::format("`profiles` must be array, but is `{0}`", it->dump())});
+      return;
+    }
+
+    for (size_t i = 0; i < it->size(); ++i) {
+      const auto& profile_json = (*it)[i];
+      auto json_pointer = fmt::format("/profiles/{0}", i);
+
+      // Check the profile without rules, and then check rules individually.
+
+      const nlohmann::json* rules_json = nullptr;
+      auto profile_json_without_rules = nlohmann::json::object();
+
+      if (profile_json.is_object()) {
+        for (const auto& [key, value] : profile_json.items()) {
+          if (key == "complex_modifications" && value.is_object()) {
+            auto& complex_modifications_json = profile_json_without_rules[key];
+            complex_modifications_json = nlohmann::json::object();
+            for (const auto& [k, v] : value.items()) {
+              if (k == "rules") {
+                rules_json = &v;
+              } else {
+                complex_modifications_json[k] = v;
+              }
+            }
+          } else {
+            profile_json_without_rules[key] = value;
+          }
+        }
+      } else {
+        profile_json_without_rules = profile_json;
+      }
+
+      try {
+        core_configuration::details::profile profile(std::move(profile_json_without_rules));
+
+        if (rules_json) {
+          push_back_rule_jobs(json,
+                              *rules_json,
+                              json_pointer + "/complex_modifications/rules",
+                              profile.get_complex_modifications().get_parameters(),
+                              file_index,
+                              errors,
+                              jobs);
+        }
+
+      } catch (const std::exception& e) {
+        errors.push_back({json_pointer, "", e.what()});
+      }
+    }
+  }
+
+  static void push_back_rule_jobs(std::shared_ptr<const nlohmann::json> json,
+                                  const nlohmann::json& rules_json,
+                                  const std::string& json_pointer,
+                                  const core_configuration::details::complex_modifications_parameters& parameters,
+                                  size_t file_index,
+                                  std::vector<error>& errors,
+                                  std::vector<rule_job>& jobs) {
+    if (!rules_json.is_array()) {
+      errors.push_back({json_pointer, "", fmt::format("`rules` must be array, but is `{0}`", rules_json.dump())});
+      return;
+    }
+
+    for (size_t i = 0; i < rules_json.size(); ++i) {
+      jobs.push_back(rule_job{
+          file_index,
+          errors.size(),
+          fmt::format("{0}/{1}", json_pointer, i),
+          std::shared_ptr<const nlohmann::json>(json, &(rules_json[i])),
+          parameters,
+          {},
+          std::chrono::nanoseconds(0),
+      });
+    }
+  }
+
+  static void check_rule(rule_job& job) {
+    std::optional<core_configuration::details::complex_modifications_rule> rule;
+
+    try {
+      rule = core_configuration::details::complex_modifications_rule(*(job.json), job.parameters);
+    } catch (const std::exception& e) {
+      std::string description;
+      if (auto v = pqrs::json::find<std::string>(*(job.json), "description")) {
+        description = *v;
+      }
+      job.errors.push_back({job.json_pointer, description, e.what()});
+      return;
+    }
+
+    const auto& manipulators = rule->get_manipulators();
+    for (size_t i = 0; i < manipulators.size(); ++i) {
+      auto json_pointer = fmt::format("{0}/manipulators/{1}", job.json_pointer, i);
+
+      try {
+        manipulator::manipulator_factory::make_manipulator(manipulators[i].get_json(),
+                                                           manipulators[i].get_parameters());
+      } catch (const std::exception& e) {
+        job.errors.push_back({json_pointer, rule->get_description(), e.what()});
+      }
+
+      const auto& conditions = manipulators[i].get_conditions();
+      for (size_t j = 0; j < conditions.size(); ++j) {
+        try {
+          manipulator::manipulator_factory::make_condition(conditions[j].get_json());
+        } catch (const std::exception& e) {
+          job.errors.push_back({fmt::format("{0}/conditions/{1}", json_pointer, j),
+                                rule->get_description(),
+                                e.what()});
+        }
+      }
+    }
+  }
+};
+} // namespace krbn
@@ -53,15 +53,7 @@ public:
     std::ifstream input(file_path);
     if (input) {
       try {
-        auto json = nlohmann::json::parse(input);
-
-        if (json.is_array()) {
-          for (const auto& j : json) {
-            devices_.emplace_back(details::device::make_from_json(j));
-          }
-        }
-
-        loaded_ = true;
+        load(nlohmann::json::parse(input));
 
       } catch (std::exception& e) {
         logger::get_logger()->error("parse error in {0}: {1}", file_path, e.what());
@@ -69,6 +61,23 @@ public:
     }
   }
 
+  // `file_body` is the content of `file_path` which is already read by the caller (e.g., `pqrs::osx::file_monitor`).
+  connected_devices(const std::string& file_path,
+                    const std::vector<uint8_t>& file_body) : loaded_(false) {
+    try {
+      load(nlohmann::json::parse(std::begin(file_body), std::end(file_body)));
+
+    } catch (std::exception& e) {
+      logger::get_logger()->error("parse error in {0}: {1}", file_path, e.what());
+    }
+  }
+
+  static connected_devices make_from_json(const nlohmann::json& json) {
+    connected_devices result;
+    result.load(json);
+    return result;
+  }
+
   nlohmann::json to_json(void) const {
     return nlohmann::json(devices_);
   }
@@ -121,6 +130,16 @@ public:
   }
 
 private:
+  void load(const nlohmann::json& json) {
+    if (json.is_array()) {
+      for (const auto& j : json) {
+        devices_.emplace_back(details::device::make_from_json(j));
+      }
+    }
+
+    loaded_ = true;
+  }
+
   bool loaded_;
 
   std::vector<details::device> devices_;
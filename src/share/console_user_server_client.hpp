@@ -14,7 +14,7 @@
 namespace krbn {
 class console_user_server_client final : public pqrs::dispatcher::extra::dispatcher_client {
 public:
-  // Signals (invoked from the shared dispatcher thread)
+  // Signals (invoked from the dispatcher thread)
 
   nod::signal<void(void)> connected;
   nod::signal<void(const asio::error_code&)> connect_failed;
@@ -24,7 +24,7 @@ public:
 
   console_user_server_client(const console_user_server_client&) = delete;
 
-  console_user_server_client(void) : dispatcher_client() {
+  console_user_server_client(std::weak_ptr<pqrs::dispatcher::dispatcher> weak_dispatcher = pqrs::dispatcher::extra::get_shared_dispatcher()) : dispatcher_client(weak_dispatcher) {
   }
 
   virtual ~console_user_server_client(void) {
@@ -25,6 +25,10 @@ public:
     return "/Library/Application Support/org.pqrs/tmp/rootonly";
   }
 
+  static std::string get_grabber_event_trace_file_path(void) {
+    return get_rootonly_directory() + "/event_trace.bin";
+  }
+
   static const char* get_grabber_socket_file_path(void) {
     return "/Library/Application Support/org.pqrs/tmp/karabiner_grabber_receiver";
   }
@@ -49,6 +53,19 @@ public:
     return "/Library/Application Support/org.pqrs/tmp/karabiner_grabber_manipulator_environment.json";
   }
 
+  // The name of the shared state segment must be shorter than 31 characters on macOS.
+  static const char* get_grabber_shared_state_name(void) {
+    return "/krbn_grabber_state";
+  }
+
+  static const char* get_grabber_latency_statistics_json_file_path(void) {
+    return "/Library/Application Support/org.pqrs/tmp/karabiner_grabber_latency_statistics.json";
+  }
+
+  static const char* get_grabber_rule_statistics_json_file_path(void) {
+    return "/Library/Application Support/org.pqrs/tmp/karabiner_grabber_rule_statistics.json";
+  }
+
   static std::string get_session_monitor_receiver_socket_file_path(uid_t uid) {
     return fmt::format("{0}/karabiner_session_monitor_receiver.{1}", get_rootonly_directory(), uid);
   }
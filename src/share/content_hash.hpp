@@ -0,0 +1,140 @@
+#pragma once
+
+// `krbn::content_hash` can be used safely in a multi-threaded environment.
+
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+namespace krbn {
+class content_hash final {
+public:
+  // XXH64 (xxHash 64bit)
+  // The input is processed 32 bytes per round, so hashing a large karabiner.json is much faster than a byte-at-a-time hash.
+  // The value is stable across processes and builds, so it can be used as a key of on-disk caches.
+
+  static uint64_t make(const void* data, size_t size) {
+    return xxh64(data, size, 0);
+  }
+
+  static uint64_t make(const std::string& body) {
+    return make(body.data(), body.size());
+  }
+
+  // A second hash which is independent of `make`. (XXH64 with another seed.)
+  // Compare it in addition to `make` where a hash collision must not be accepted silently.
+
+  static uint64_t make_secondary(const void* data, size_t size) {
+    return xxh64(data, size, secondary_seed);
+  }
+
+  static uint64_t make_secondary(const std::string& body) {
+    return make_secondary(body.data(), body.size());
+  }
+
+  static std::string to_string(uint64_t hash) {
+    std::stringstream ss;
+    ss << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return ss.str();
+  }
+
+private:
+  static constexpr uint64_t prime1 = 0x9e3779b185ebca87ULL;
+  static constexpr uint64_t prime2 = 0xc2b2ae3d27d4eb4fULL;
+  static constexpr uint64_t prime3 = 0x165667b19e3779f9ULL;
+  static constexpr uint64_t prime4 = 0x85ebca77c2b2ae63ULL;
+  static constexpr uint64_t prime5 = 0x27d4eb2f165667c5ULL;
+
+  static constexpr uint64_t secondary_seed = 0x9e3779b97f4a7c15ULL;
+
+  static uint64_t rotl(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+  }
+
+  // xxHash is defined in little endian. (All supported architectures are little endian.)
+  static uint64_t read64(const uint8_t* p) {
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+  }
+
+  static uint32_t read32(const uint8_t* p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+  }
+
+  static uint64_t round(uint64_t accumulator, uint64_t input) {
+    accumulator += input * prime2;
+    accumulator = rotl(accumulator, 31);
+    return accumulator * prime1;
+  }
+
+  static uint64_t merge_round(uint64_t accumulator, uint64_t value) {
+    accumulator ^= round(0, value);
+    return accumulator * prime1 + prime4;
+  }
+
+  static uint64_t xxh64(const void* data, size_t size, uint64_t seed) {
+    auto p = static_cast<const uint8_t*>(data);
+    auto end = p + size;
+    uint64_t h = 0;
+
+    if (size >= 32) {
+      uint64_t v1 = seed + prime1 + prime2;
+      uint64_t v2 = seed + prime2;
+      uint64_t v3 = seed;
+      uint64_t v4 = seed - prime1;
+
+      auto limit = end - 32;
+      do {
+        v1 = round(v1, read64(p));
+        v2 = round(v2, read64(p + 8));
+        v3 = round(v3, read64(p + 16));
+        v4 = round(v4, read64(p + 24));
+        p += 32;
+      } while (p <= limit);
+
+      h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+      h = merge_round(h, v1);
+      h = merge_round(h, v2);
+      h = merge_round(h, v3);
+      h = merge_round(h, v4);
+    } else {
+      h = seed + prime5;
+    }
+
+    h += static_cast<uint64_t>(size);
+
+    while (p + 8 <= end) {
+      h ^= round(0, read64(p));
+      h = rotl(h, 27) * prime1 + prime4;
+      p += 8;
+    }
+
+    if (p + 4 <= end) {
+      h ^= static_cast<uint64_t>(read32(p)) * prime1;
+      h = rotl(h, 23) * prime2 + prime3;
+      p += 4;
+    }
+
+    while (p < end) {
+      h ^= static_cast<uint64_t>(*p) * prime5;
+      h = rotl(h, 11) * prime1;
+      ++p;
+    }
+
+    // Avalanche
+
+    h ^= h >> 33;
+    h *= prime2;
+    h ^= h >> 29;
+    h *= prime3;
+    h ^= h >> 32;
+
+    return h;
+  }
+};
+} // namespace krbn
@@ -8,6 +8,7 @@
 #include "details/profile/device.hpp"
 #include "details/profile/simple_modifications.hpp"
 #include "details/profile/virtual_hid_keyboard.hpp"
+#include "file_fingerprint.hpp"
 #include "json_writer.hpp"
 #include "logger.hpp"
 #include "types.hpp"
@@ -29,8 +30,15 @@ class core_configuration final {
 public:
   core_configuration(const core_configuration&) = delete;
 
-  core_configuration(const std::string& file_path) : loaded_(false),
-                                                     global_configuration_(nlohmann::json::object()) {
+  core_configuration(const std::string& file_path) : core_configuration(file_path,
+                                                                         std::shared_ptr<const std::vector<uint8_t>>()) {
+  }
+
+  // `file_body` is the content of `file_path` which is already read by the caller (e.g., `pqrs::osx::file_monitor`).
+  // `file_path` is read if `file_body` is nullptr.
+  core_configuration(const std::string& file_path,
+                     std::shared_ptr<const std::vector<uint8_t>> file_body) : loaded_(false),
+                                                                              global_configuration_(nlohmann::json::object()) {
     bool valid_file_owner = false;
 
     // Load karabiner.json only when the owner is root or current session user.
@@ -49,21 +57,35 @@ public:
         logger::get_logger()->warn("{0} is not owned by a valid user.", file_path);
 
       } else {
-        std::ifstream input(file_path);
-        if (input) {
+        if (!file_body) {
+          file_body = read_file(file_path);
+        }
+
+        if (file_body) {
+          file_fingerprint_ = file_fingerprint::make(file_path, file_body);
+
           try {
-            json_ = nlohmann::json::parse(input);
+            json_ = nlohmann::json::parse(std::begin(*file_body), std::end(*file_body));
+
+            // Move subtrees into objects in order to avoid copying large json (e.g., complex_modifications rules).
+            // `global` and `profiles` are restored in `to_json`.
 
             if (auto v = pqrs::json::find_object(json_, "global")) {
               global_configuration_ = details::global_configuration(v->value());
             }
 
-            if (auto v = pqrs::json::find_array(json_, "profiles")) {
-              for (const auto& profile_json : v->value()) {
-                profiles_.emplace_back(profile_json);
+            auto it = json_.find("profiles");
+            if (it != std::end(json_) && it->is_array()) {
+              for (auto&& profile_json : *it) {
+                profiles_.emplace_back(std::move(profile_json));
               }
             }
 
+            if (json_.is_object()) {
+              json_.erase("global");
+              json_.erase("profiles");
+            }
+
             loaded_ = true;
 
           } catch (std::exception& e) {
@@ -94,6 +116,12 @@ public:
 
   bool is_loaded(void) const { return loaded_; }
 
+  // The fingerprint of the loaded file.
+  // Consumers can skip reloading if the fingerprint of the new file is same.
+  const file_fingerprint& get_file_fingerprint(void) const {
+    return file_fingerprint_;
+  }
+
   const details::global_configuration& get_global_configuration(void) const {
     return global_configuration_;
   }
@@ -160,6 +188,27 @@ public:
   }
 
 private:
+  static std::shared_ptr<const std::vector<uint8_t>> read_file(const std::string& file_path) {
+    std::ifstream input(file_path, std::ios::binary | std::ios::ate);
+    if (!input) {
+      return nullptr;
+    }
+
+    // Allocate the buffer at once since karabiner.json might be large.
+    auto size = input.tellg();
+    if (size < 0) {
+      return nullptr;
+    }
+    input.seekg(0);
+
+    auto body = std::make_shared<std::vector<uint8_t>>(static_cast<size_t>(size));
+    if (!input.read(reinterpret_cast<char*>(body->data()), size)) {
+      return nullptr;
+    }
+
+    return body;
+  }
+
   void make_backup_file(void) {
     auto file_path = constants::get_user_core_configuration_file_path();
 
@@ -215,6 +264,7 @@ private:
 
   nlohmann::json json_;
   bool loaded_;
+  file_fingerprint file_fingerprint_;
 
   details::global_configuration global_configuration_;
   std::vector<details::profile> profiles_;
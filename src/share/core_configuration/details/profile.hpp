@@ -12,8 +12,8 @@ namespace core_configuration {
 namespace details {
 class profile final {
 public:
-  profile(const nlohmann::json& json) : json_(json),
-                                        selected_(false) {
+  // `json` is moved into the profile if it is passed as rvalue.
+  profile(nlohmann::json json) : selected_(false) {
     // ----------------------------------------
     // Set default value
 
@@ -26,7 +26,7 @@ public:
       throw pqrs::json::unmarshal_error(fmt::format("json must be object, but is `{0}`", json.dump()));
     }
 
-    for (const auto& [key, value] : json.items()) {
+    for (auto&& [key, value] : json.items()) {
       if (key == "name") {
         if (!value.is_string()) {
           throw pqrs::json::unmarshal_error(fmt::format("`{0}` must be string, but is `{1}`", key, value.dump()));
@@ -64,7 +64,7 @@ public:
 
       } else if (key == "complex_modifications") {
         try {
-          complex_modifications_ = complex_modifications(value);
+          complex_modifications_ = complex_modifications(std::move(value));
         } catch (const pqrs::json::unmarshal_error& e) {
           throw pqrs::json::unmarshal_error(fmt::format("`{0}` error: {1}", key, e.what()));
         }
@@ -90,6 +90,19 @@ public:
         }
       }
     }
+
+    // Keep only unknown keys since other keys are restored in `to_json`.
+    for (const auto& key : {"name",
+                            "selected",
+                            "parameters",
+                            "simple_modifications",
+                            "fn_function_keys",
+                            "complex_modifications",
+                            "virtual_hid_keyboard",
+                            "devices"}) {
+      json.erase(key);
+    }
+    json_ = std::move(json);
   }
 
   static nlohmann::json make_default_fn_function_keys_json(void) {
@@ -357,6 +370,48 @@ public:
     }
   }
 
+  std::chrono::milliseconds get_device_key_chatter_debounce_milliseconds(const device_identifiers& identifiers) const {
+    for (const auto& d : devices_) {
+      if (d.get_identifiers() == identifiers) {
+        return d.get_key_chatter_debounce_milliseconds();
+      }
+    }
+    return std::chrono::milliseconds(0);
+  }
+
+  void set_device_key_chatter_debounce_milliseconds(const device_identifiers& identifiers,
+                                                    std::chrono::milliseconds value) {
+    add_device(identifiers);
+
+    for (auto&& device : devices_) {
+      if (device.get_identifiers() == identifiers) {
+        device.set_key_chatter_debounce_milliseconds(value);
+        return;
+      }
+    }
+  }
+
+  uint64_t get_device_input_event_rate_limit_per_second(const device_identifiers& identifiers) const {
+    for (const auto& d : devices_) {
+      if (d.get_identifiers() == identifiers) {
+        return d.get_input_event_rate_limit_per_second();
+      }
+    }
+    return 0;
+  }
+
+  void set_device_input_event_rate_limit_per_second(const device_identifiers& identifiers,
+                                                    uint64_t value) {
+    add_device(identifiers);
+
+    for (auto&& device : devices_) {
+      if (device.get_identifiers() == identifiers) {
+        device.set_input_event_rate_limit_per_second(value);
+        return;
+      }
+    }
+  }
+
 private:
   void add_device(const device_identifiers& identifiers) {
     for (auto&& device : devices_) {
@@ -11,7 +11,8 @@ public:
   complex_modifications(void) : complex_modifications(nlohmann::json::object()) {
   }
 
-  complex_modifications(const nlohmann::json& json) : json_(json) {
+  // `json` is moved into the object if it is passed as rvalue.
+  complex_modifications(nlohmann::json json) {
     if (!json.is_object()) {
       throw pqrs::json::unmarshal_error(fmt::format("json must be object, but is `{0}`", json.dump()));
     }
@@ -24,11 +25,17 @@ public:
 
     // Load rules_
 
-    if (auto v = pqrs::json::find_array(json, "rules")) {
-      for (const auto& j : v->value()) {
-        rules_.emplace_back(j, parameters_);
+    auto it = json.find("rules");
+    if (it != std::end(json) && it->is_array()) {
+      for (auto&& j : *it) {
+        rules_.emplace_back(std::move(j), parameters_);
       }
+
+      // `rules` is restored from `rules_` in `to_json`.
+      json.erase(it);
     }
+
+    json_ = std::move(json);
   }
 
   nlohmann::json to_json(void) const {
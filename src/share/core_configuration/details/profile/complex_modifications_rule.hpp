@@ -6,38 +6,50 @@
 namespace krbn {
 namespace core_configuration {
 namespace details {
+// Manipulators and conditions refer slices of the rule json via aliasing `std::shared_ptr`
+// in order to avoid copying json subtrees.
+// (The rule json is immutable and shared between copies of the rule.)
+
 class complex_modifications_rule final {
 public:
   class manipulator {
   public:
     class condition {
     public:
-      condition(const nlohmann::json& json) : json_(json) {
+      condition(const nlohmann::json& json) : condition(std::make_shared<const nlohmann::json>(json)) {
+      }
+
+      condition(std::shared_ptr<const nlohmann::json> json) : json_(json) {
       }
 
       const nlohmann::json& get_json(void) const {
-        return json_;
+        return *json_;
       }
 
     private:
-      nlohmann::json json_;
+      std::shared_ptr<const nlohmann::json> json_;
     };
 
     manipulator(const nlohmann::json& json,
+                const complex_modifications_parameters& parameters) : manipulator(std::make_shared<const nlohmann::json>(json),
+                                                                                  parameters) {
+    }
+
+    manipulator(std::shared_ptr<const nlohmann::json> json,
                 const complex_modifications_parameters& parameters) : json_(json),
                                                                       parameters_(parameters) {
-      if (!json.is_object()) {
-        throw pqrs::json::unmarshal_error(fmt::format("json must be object, but is `{0}`", json.dump()));
+      if (!json_->is_object()) {
+        throw pqrs::json::unmarshal_error(fmt::format("json must be object, but is `{0}`", json_->dump()));
       }
 
-      for (const auto& [key, value] : json.items()) {
+      for (const auto& [key, value] : json_->items()) {
         if (key == "conditions") {
           if (!value.is_array()) {
             throw pqrs::json::unmarshal_error(fmt::format("`{0}` must be array, but is `{1}`", key, value.dump()));
           }
 
           for (const auto& j : value) {
-            conditions_.emplace_back(j);
+            conditions_.emplace_back(std::shared_ptr<const nlohmann::json>(json_, &j));
           }
 
         } else if (key == "parameters") {
@@ -61,7 +73,7 @@ public:
     }
 
     const nlohmann::json& get_json(void) const {
-      return json_;
+      return *json_;
     }
 
     const std::vector<condition>& get_conditions(void) const {
@@ -77,19 +89,20 @@ public:
     }
 
   private:
-    nlohmann::json json_;
+    std::shared_ptr<const nlohmann::json> json_;
     std::vector<condition> conditions_;
     complex_modifications_parameters parameters_;
     std::string description_;
   };
 
-  complex_modifications_rule(const nlohmann::json& json,
-                             const complex_modifications_parameters& parameters) : json_(json) {
-    if (!json.is_object()) {
-      throw pqrs::json::unmarshal_error(fmt::format("json must be object, but is `{0}`", json.dump()));
+  // `json` is moved into the rule if it is passed as rvalue.
+  complex_modifications_rule(nlohmann::json json,
+                             const complex_modifications_parameters& parameters) : json_(std::make_shared<const nlohmann::json>(std::move(json))) {
+    if (!json_->is_object()) {
+      throw pqrs::json::unmarshal_error(fmt::format("json must be object, but is `{0}`", json_->dump()));
     }
 
-    for (const auto& [key, value] : json.items()) {
+    for (const auto& [key, value] : json_->items()) {
       if (key == "manipulators") {
         if (!value.is_array()) {
           throw pqrs::json::unmarshal_error(fmt::format("`{0}` must be array, but is `{1}`", key, value.dump()));
@@ -97,7 +110,8 @@ public:
 
         for (const auto& j : value) {
           try {
-            manipulators_.emplace_back(j, parameters);
+            manipulators_.emplace_back(std::shared_ptr<const nlohmann::json>(json_, &j),
+                                       parameters);
           } catch (const pqrs::json::unmarshal_error& e) {
             throw pqrs::json::unmarshal_error(fmt::format("`{0}` entry error: {1}", key, e.what()));
           }
@@ -133,7 +147,7 @@ public:
   }
 
   const nlohmann::json& get_json(void) const {
-    return json_;
+    return *json_;
   }
 
   const std::vector<manipulator>& get_manipulators(void) const {
@@ -145,7 +159,7 @@ public:
   }
 
 private:
-  nlohmann::json json_;
+  std::shared_ptr<const nlohmann::json> json_;
   std::vector<manipulator> manipulators_;
   std::string description_;
 };
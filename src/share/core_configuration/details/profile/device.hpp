@@ -11,7 +11,9 @@ public:
                                        ignore_(false),
                                        manipulate_caps_lock_led_(false),
                                        manipulate_num_lock_led_(false),
-                                       disable_built_in_keyboard_if_exists_(false) {
+                                       disable_built_in_keyboard_if_exists_(false),
+                                       key_chatter_debounce_milliseconds_(0),
+                                       input_event_rate_limit_per_second_(0) {
     auto ignore_configured = false;
     auto manipulate_caps_lock_led_configured = false;
     auto manipulate_num_lock_led_configured = false;
@@ -69,6 +71,20 @@ public:
 
         disable_built_in_keyboard_if_exists_ = value.get<bool>();
 
+      } else if (key == "key_chatter_debounce_milliseconds") {
+        if (!value.is_number_integer() || value.get<int64_t>() < 0) {
+          throw pqrs::json::unmarshal_error(fmt::format("`{0}` must be unsigned number, but is `{1}`", key, value.dump()));
+        }
+
+        key_chatter_debounce_milliseconds_ = std::chrono::milliseconds(value.get<uint64_t>());
+
+      } else if (key == "input_event_rate_limit_per_second") {
+        if (!value.is_number_integer() || value.get<int64_t>() < 0) {
+          throw pqrs::json::unmarshal_error(fmt::format("`{0}` must be unsigned number, but is `{1}`", key, value.dump()));
+        }
+
+        input_event_rate_limit_per_second_ = value.get<uint64_t>();
+
       } else if (key == "simple_modifications") {
         try {
           simple_modifications_.update(value);
@@ -140,6 +156,8 @@ public:
     j["manipulate_caps_lock_led"] = manipulate_caps_lock_led_;
     j["manipulate_num_lock_led"] = manipulate_num_lock_led_;
     j["disable_built_in_keyboard_if_exists"] = disable_built_in_keyboard_if_exists_;
+    j["key_chatter_debounce_milliseconds"] = key_chatter_debounce_milliseconds_.count();
+    j["input_event_rate_limit_per_second"] = input_event_rate_limit_per_second_;
     j["simple_modifications"] = simple_modifications_.to_json();
     j["fn_function_keys"] = fn_function_keys_.to_json();
     return j;
@@ -177,6 +195,22 @@ public:
     disable_built_in_keyboard_if_exists_ = value;
   }
 
+  // 0 disables the key chatter debounce.
+  std::chrono::milliseconds get_key_chatter_debounce_milliseconds(void) const {
+    return key_chatter_debounce_milliseconds_;
+  }
+  void set_key_chatter_debounce_milliseconds(std::chrono::milliseconds value) {
+    key_chatter_debounce_milliseconds_ = value;
+  }
+
+  // 0 disables the input event rate limit.
+  uint64_t get_input_event_rate_limit_per_second(void) const {
+    return input_event_rate_limit_per_second_;
+  }
+  void set_input_event_rate_limit_per_second(uint64_t value) {
+    input_event_rate_limit_per_second_ = value;
+  }
+
   const simple_modifications& get_simple_modifications(void) const {
     return simple_modifications_;
   }
@@ -198,6 +232,8 @@ private:
   bool manipulate_caps_lock_led_;
   bool manipulate_num_lock_led_;
   bool disable_built_in_keyboard_if_exists_;
+  std::chrono::milliseconds key_chatter_debounce_milliseconds_;
+  uint64_t input_event_rate_limit_per_second_;
   simple_modifications simple_modifications_;
   simple_modifications fn_function_keys_;
 };
@@ -0,0 +1,304 @@
+#pragma once
+
+// `krbn::device_ingress_filter` can be used safely in a multi-threaded environment
+// if it is used in a single thread.
+
+#include "event_queue.hpp"
+#include <map>
+#include <optional>
+#include <pqrs/osx/chrono.hpp>
+
+namespace krbn {
+// `device_ingress_filter` protects the manipulation pipeline from input event storms of a single device
+// (e.g., chattering switches, high polling rate mice).
+//
+// - Key chatter debounce:
+//   A key_down which arrives within `key_chatter_debounce_duration` after the key_up of the same key is dropped.
+// - Rate limit:
+//   key_down and pointing_motion events consume a token of a token bucket.
+//   (The bucket size is 100 milliseconds worth of tokens.)
+//   A key_down is dropped if the bucket is empty.
+//   A pointing_motion is merged into the next passed pointing_motion if the bucket is empty.
+//   The merged pointing_motion is passed without a token before the next event of another type
+//   in order to keep the order of events (e.g., the motion of a drag is passed before the button release).
+//   It is also passed by `flush` when a token is refilled.
+//   (`flush` delivers the last motion of a burst which ends while the bucket is empty.)
+//
+// The key_up of a dropped key_down is also dropped. Other key_up events are never dropped to avoid stuck keys.
+// Time stamps of events are used as the clock in order to make the behavior deterministic.
+
+class device_ingress_filter final {
+public:
+  struct counters final {
+    // Events which are dropped by the rate limit.
+    uint64_t dropped = 0;
+    // pointing_motion events which are merged by the rate limit.
+    uint64_t merged = 0;
+    // Events which are dropped by the key chatter debounce.
+    uint64_t debounced = 0;
+
+    bool empty(void) const {
+      return dropped == 0 &&
+             merged == 0 &&
+             debounced == 0;
+    }
+
+    nlohmann::json to_json(void) const {
+      return nlohmann::json::object({
+          {"dropped", dropped},
+          {"merged", merged},
+          {"debounced", debounced},
+      });
+    }
+  };
+
+  device_ingress_filter(void) : key_chatter_debounce_duration_(0),
+                                rate_limit_per_second_(0),
+                                tokens_(0),
+                                last_refill_time_stamp_(std::nullopt) {
+  }
+
+  void set_key_chatter_debounce_duration(std::chrono::milliseconds value) {
+    key_chatter_debounce_duration_ = value;
+  }
+
+  void set_rate_limit_per_second(uint64_t value) {
+    if (rate_limit_per_second_ != value) {
+      rate_limit_per_second_ = value;
+      tokens_ = get_bucket_size();
+      last_refill_time_stamp_ = std::nullopt;
+    }
+  }
+
+  bool enabled(void) const {
+    return key_chatter_debounce_duration_ > std::chrono::milliseconds(0) ||
+           rate_limit_per_second_ > 0;
+  }
+
+  const counters& get_counters(void) const {
+    return counters_;
+  }
+
+  void clear(void) {
+    tokens_ = get_bucket_size();
+    last_refill_time_stamp_ = std::nullopt;
+    last_key_up_time_stamps_.clear();
+    suppressed_keys_.clear();
+    pending_pointing_motion_ = std::nullopt;
+    counters_ = counters();
+  }
+
+  bool has_pending_pointing_motion(void) const {
+    return pending_pointing_motion_ != std::nullopt;
+  }
+
+  // The interval of token refills.
+  std::chrono::milliseconds get_token_refill_interval(void) const {
+    if (rate_limit_per_second_ == 0) {
+      return std::chrono::milliseconds(0);
+    }
+
+    return std::chrono::milliseconds(std::max(1000 / rate_limit_per_second_, uint64_t(1)));
+  }
+
+  // `function` is called with `entry` (or the merged entry) if the entry is passed.
+  template <typename T>
+  void filter(const event_queue::entry& entry, T function) {
+    if (!enabled()) {
+      function(entry);
+      return;
+    }
+
+    auto time_stamp = entry.get_event_time_stamp().get_time_stamp();
+
+    if (!entry.get_event().find<pointing_motion>()) {
+      pass_pending_pointing_motion(entry.get_device_id(), time_stamp, function);
+    }
+
+    if (auto key = make_key(entry.get_event())) {
+      switch (entry.get_event_type()) {
+        case event_type::key_down:
+          if (key_chatter(*key, time_stamp)) {
+            suppressed_keys_[*key] = reason::debounced;
+            ++(counters_.debounced);
+            return;
+          }
+
+          if (!consume_token(time_stamp)) {
+            suppressed_keys_[*key] = reason::dropped;
+            ++(counters_.dropped);
+            return;
+          }
+          break;
+
+        case event_type::key_up: {
+          last_key_up_time_stamps_[*key] = time_stamp;
+
+          auto it = suppressed_keys_.find(*key);
+          if (it != std::end(suppressed_keys_)) {
+            if (it->second == reason::debounced) {
+              ++(counters_.debounced);
+            } else {
+              ++(counters_.dropped);
+            }
+            suppressed_keys_.erase(it);
+            return;
+          }
+          break;
+        }
+
+        case event_type::single:
+          break;
+      }
+
+      function(entry);
+      return;
+    }
+
+    if (auto m = entry.get_event().find<pointing_motion>()) {
+      if (!consume_token(time_stamp)) {
+        if (!pending_pointing_motion_) {
+          pending_pointing_motion_ = *m;
+        } else {
+          pending_pointing_motion_ = merge(*pending_pointing_motion_, *m);
+        }
+        ++(counters_.merged);
+        return;
+      }
+
+      if (pending_pointing_motion_) {
+        event_queue::event event(merge(*pending_pointing_motion_, *m));
+        pending_pointing_motion_ = std::nullopt;
+
+        function(event_queue::entry(entry.get_device_id(),
+                                    entry.get_event_time_stamp(),
+                                    event,
+                                    entry.get_event_type(),
+                                    event));
+        return;
+      }
+    }
+
+    function(entry);
+  }
+
+  // `function` is called with the pending merged pointing_motion if a token is available at `time_stamp`.
+  template <typename T>
+  void flush(device_id device_id, absolute_time_point time_stamp, T function) {
+    if (!pending_pointing_motion_) {
+      return;
+    }
+
+    if (!consume_token(time_stamp)) {
+      return;
+    }
+
+    pass_pending_pointing_motion(device_id, time_stamp, function);
+  }
+
+private:
+  enum class reason {
+    dropped,
+    debounced,
+  };
+
+  // The pending pointing_motion is passed regardless of tokens.
+  template <typename T>
+  void pass_pending_pointing_motion(device_id device_id, absolute_time_point time_stamp, T function) {
+    if (!pending_pointing_motion_) {
+      return;
+    }
+
+    event_queue::event event(*pending_pointing_motion_);
+    pending_pointing_motion_ = std::nullopt;
+
+    function(event_queue::entry(device_id,
+                                event_queue::event_time_stamp(time_stamp),
+                                event,
+                                event_type::single,
+                                event));
+  }
+
+  static std::optional<key_down_up_valued_event> make_key(const event_queue::event& event) {
+    if (auto v = event.find<key_code>()) {
+      return key_down_up_valued_event(*v);
+    } else if (auto v = event.find<consumer_key_code>()) {
+      return key_down_up_valued_event(*v);
+    } else if (auto v = event.find<pointing_button>()) {
+      return key_down_up_valued_event(*v);
+    }
+    return std::nullopt;
+  }
+
+  static pointing_motion merge(const pointing_motion& m1, const pointing_motion& m2) {
+    return pointing_motion(m1.get_x() + m2.get_x(),
+                           m1.get_y() + m2.get_y(),
+                           m1.get_vertical_wheel() + m2.get_vertical_wheel(),
+                           m1.get_horizontal_wheel() + m2.get_horizontal_wheel());
+  }
+
+  bool key_chatter(const key_down_up_valued_event& key, absolute_time_point time_stamp) const {
+    if (key_chatter_debounce_duration_ == std::chrono::milliseconds(0)) {
+      return false;
+    }
+
+    auto it = last_key_up_time_stamps_.find(key);
+    if (it == std::end(last_key_up_time_stamps_) ||
+        time_stamp < it->second) {
+      return false;
+    }
+
+    return pqrs::osx::chrono::make_milliseconds(time_stamp - it->second) < key_chatter_debounce_duration_;
+  }
+
+  // Tokens are counted in `token_unit` in order to refill them without rounding errors.
+  static constexpr uint64_t token_unit = 1000000000;
+
+  uint64_t get_bucket_size(void) const {
+    return std::max(rate_limit_per_second_ * (token_unit / 10), token_unit);
+  }
+
+  bool consume_token(absolute_time_point time_stamp) {
+    if (rate_limit_per_second_ == 0) {
+      return true;
+    }
+
+    // Refill
+
+    if (last_refill_time_stamp_ &&
+        *last_refill_time_stamp_ < time_stamp) {
+      // The bucket is filled up within 1 second.
+      auto elapsed = std::min(pqrs::osx::chrono::make_nanoseconds(time_stamp - *last_refill_time_stamp_),
+                              std::chrono::nanoseconds(std::chrono::seconds(1)));
+      // `tokens_` is increased by (elapsed seconds) * (rate_limit_per_second_) * (token_unit).
+      tokens_ = std::min(tokens_ + static_cast<uint64_t>(elapsed.count()) * rate_limit_per_second_,
+                         get_bucket_size());
+    }
+    if (!last_refill_time_stamp_ ||
+        *last_refill_time_stamp_ < time_stamp) {
+      last_refill_time_stamp_ = time_stamp;
+    }
+
+    // Consume
+
+    if (tokens_ < token_unit) {
+      return false;
+    }
+
+    tokens_ -= token_unit;
+    return true;
+  }
+
+  std::chrono::milliseconds key_chatter_debounce_duration_;
+  uint64_t rate_limit_per_second_;
+
+  uint64_t tokens_;
+  std::optional<absolute_time_point> last_refill_time_stamp_;
+
+  std::map<key_down_up_valued_event, absolute_time_point> last_key_up_time_stamps_;
+  std::map<key_down_up_valued_event, reason> suppressed_keys_;
+  std::optional<pointing_motion> pending_pointing_motion_;
+
+  counters counters_;
+};
+} // namespace krbn
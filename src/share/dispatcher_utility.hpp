@@ -3,8 +3,47 @@
 // `krbn::dispatcher_utility` can be used safely in a multi-threaded environment.
 
 #include <pqrs/dispatcher.hpp>
+#include <pqrs/thread_wait.hpp>
+#include <pthread/qos.h>
 
 namespace krbn {
+// Dispatchers:
+//
+// - shared dispatcher (`pqrs::dispatcher::extra::get_shared_dispatcher`):
+//   The input event pipeline runs on this dispatcher.
+//   In karabiner_grabber, this dispatcher is dedicated to the pipeline:
+//   `device_grabber`, its entries, manipulator managers, manipulators, event queues and `virtual_hid_device_client`.
+//   Do not run slow tasks (json parsing, json serialization, etc.) on this dispatcher.
+//
+// - background dispatcher (`dispatcher_utility::get_background_dispatcher`):
+//   Non-latency-critical slow tasks run on this dispatcher.
+//   In karabiner_grabber, clients which are not a part of the pipeline are attached to this dispatcher:
+//   `components_manager`, `receiver`, `session_monitor_receiver`, `console_user_server_client`, `version_monitor`,
+//   the device observer (`iokit_hid_manager` in `device_grabber`), LED state managers and `mouse_motion_to_scroll` counters.
+//
+// - file writer dispatcher:
+//   `async_file_writer` writes files on this dispatcher.
+//
+// Handoff between the shared dispatcher and the background dispatcher (e.g., `configuration_monitor`):
+//
+// 1. The object owns a `dispatcher_client` for the background dispatcher in addition to its shared dispatcher client.
+//    The background client is not attached if the background dispatcher is not initialized (e.g., in tests).
+//    Run the task synchronously in that case.
+// 2. Shared -> background:
+//    Enqueue the task with the background client.
+//    Capture inputs by value (or `std::shared_ptr<const T>`), not references to objects owned by the shared dispatcher.
+// 3. Members which are updated in background tasks are owned by the background dispatcher.
+//    Guard them with a mutex if they are read from other threads.
+// 4. Background -> shared:
+//    Hand the result (by value or `std::shared_ptr`) back with `enqueue_to_dispatcher` of the shared dispatcher client,
+//    and invoke signals there. Thus, signals are always invoked in the shared dispatcher thread.
+//    Results are delivered in the order of tasks since each dispatcher processes tasks in FIFO order.
+// 5. On destruction, detach the background client first (it waits the running task),
+//    and then detach the shared dispatcher client.
+//
+// The queueing delay of input events in the shared dispatcher is recorded by `krbn_notification_center`
+// and karabiner_grabber saves it as `input_event_queueing_delay` in the latency statistics file.
+
 class dispatcher_utility final {
 public:
   static void initialize_dispatchers(void) {
@@ -17,6 +56,18 @@ public:
         get_file_writer() = std::make_shared<file_writer>();
       }
     }
+
+    {
+      std::lock_guard<std::mutex> lock(get_background_dispatcher_mutex());
+
+      if (!get_background_dispatcher_pointer()) {
+        auto time_source = std::make_shared<pqrs::dispatcher::hardware_time_source>();
+        get_background_dispatcher_pointer() = std::make_shared<pqrs::dispatcher::dispatcher>(time_source);
+        get_background_time_source_pointer() = time_source;
+      }
+    }
+
+    set_thread_qos_class(get_background_dispatcher(), QOS_CLASS_UTILITY);
   }
 
   static void terminate_dispatchers(void) {
@@ -27,6 +78,60 @@ public:
 
       get_file_writer() = nullptr;
     }
+
+    {
+      // Keep `time_source` until the dispatcher is terminated.
+      std::shared_ptr<pqrs::dispatcher::dispatcher> d;
+      std::shared_ptr<pqrs::dispatcher::hardware_time_source> time_source;
+
+      {
+        std::lock_guard<std::mutex> lock(get_background_dispatcher_mutex());
+
+        d = get_background_dispatcher_pointer();
+        time_source = get_background_time_source_pointer();
+        get_background_dispatcher_pointer() = nullptr;
+        get_background_time_source_pointer() = nullptr;
+      }
+
+      if (d) {
+        d->terminate();
+      }
+    }
+  }
+
+  static std::weak_ptr<pqrs::dispatcher::dispatcher> get_background_dispatcher(void) {
+    std::lock_guard<std::mutex> lock(get_background_dispatcher_mutex());
+
+    return get_background_dispatcher_pointer();
+  }
+
+  // Return the shared dispatcher if the background dispatcher is not initialized (e.g., in tests).
+  // Use this method for clients which run on the background dispatcher as a whole
+  // and hand results back to the shared dispatcher (handoff step 4).
+  static std::weak_ptr<pqrs::dispatcher::dispatcher> get_background_dispatcher_or_shared_dispatcher(void) {
+    if (auto d = get_background_dispatcher().lock()) {
+      return d;
+    }
+    return pqrs::dispatcher::extra::get_shared_dispatcher();
+  }
+
+  // Set the quality of service class of the dispatcher thread.
+  // (e.g., `QOS_CLASS_USER_INTERACTIVE` for the shared dispatcher of processes which handle input events.)
+  static void set_thread_qos_class(std::weak_ptr<pqrs::dispatcher::dispatcher> weak_dispatcher,
+                                   qos_class_t qos_class) {
+    if (auto d = weak_dispatcher.lock()) {
+      auto object_id = pqrs::dispatcher::make_new_object_id();
+      d->attach(object_id);
+
+      auto wait = pqrs::make_thread_wait();
+      d->enqueue(object_id, [wait, qos_class] {
+        pthread_set_qos_class_self_np(qos_class, 0);
+        wait->notify();
+      });
+      wait->wait_notice();
+
+      d->detach(object_id);
+    }
   }
 
   static void enqueue_to_file_writer_dispatcher(const std::function<void(void)>& function) {
@@ -70,5 +175,20 @@ private:
     static std::shared_ptr<file_writer> p;
     return p;
   }
+
+  static std::mutex& get_background_dispatcher_mutex(void) {
+    static std::mutex mutex;
+    return mutex;
+  }
+
+  static std::shared_ptr<pqrs::dispatcher::dispatcher>& get_background_dispatcher_pointer(void) {
+    static std::shared_ptr<pqrs::dispatcher::dispatcher> p;
+    return p;
+  }
+
+  static std::shared_ptr<pqrs::dispatcher::hardware_time_source>& get_background_time_source_pointer(void) {
+    static std::shared_ptr<pqrs::dispatcher::hardware_time_source> p;
+    return p;
+  }
 };
 } // namespace krbn
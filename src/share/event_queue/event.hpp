@@ -454,14 +454,6 @@ public:
            value_ == other.value_;
   }
 
-private:
-  static event make_virtual_event(type type) {
-    event e;
-    e.type_ = type;
-    e.value_ = mpark::monostate();
-    return e;
-  }
-
   static const char* to_c_string(type t) {
 #define TO_C_STRING(TYPE) \
   case type::TYPE:        \
@@ -495,6 +487,14 @@ private:
     return nullptr;
   }
 
+private:
+  static event make_virtual_event(type type) {
+    event e;
+    e.type_ = type;
+    e.value_ = mpark::monostate();
+    return e;
+  }
+
   static type to_type(const std::string& t) {
 #define TO_TYPE(TYPE)    \
   {                      \
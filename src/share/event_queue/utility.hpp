@@ -6,10 +6,12 @@
 namespace krbn {
 namespace event_queue {
 namespace utility {
-static inline std::shared_ptr<queue> make_queue(device_id device_id,
-                                                const std::vector<hid_value>& hid_values) {
-  auto result = std::make_shared<queue>();
-
+// Convert `hid_values` into entries in a single pass and call `function` with each entry.
+// `function` is `void(const entry&)`.
+template <typename T>
+static inline void for_each_entry(device_id device_id,
+                                  const std::vector<hid_value>& hid_values,
+                                  T function) {
   // The pointing motion usage (hid_usage::gd_x, hid_usage::gd_y, etc.) are splitted from one HID report.
   // We have to join them into one pointing_motion event to avoid VMware Remote Console problem that VMRC ignores frequently events.
 
@@ -29,11 +31,11 @@ static inline std::shared_ptr<queue> make_queue(device_id device_id,
 
       event_queue::event event(pointing_motion);
 
-      result->emplace_back_entry(device_id,
-                                 event_time_stamp(*pointing_motion_time_stamp),
-                                 event,
-                                 event_type::single,
-                                 event);
+      function(entry(device_id,
+                     event_time_stamp(*pointing_motion_time_stamp),
+                     event,
+                     event_type::single,
+                     event));
 
       pointing_motion_time_stamp = std::nullopt;
       pointing_motion_x = std::nullopt;
@@ -48,27 +50,27 @@ static inline std::shared_ptr<queue> make_queue(device_id device_id,
       if (auto usage = v.get_hid_usage()) {
         if (auto key_code = make_key_code(*usage_page, *usage)) {
           event_queue::event event(*key_code);
-          result->emplace_back_entry(device_id,
-                                     event_time_stamp(v.get_time_stamp()),
-                                     event,
-                                     v.get_integer_value() ? event_type::key_down : event_type::key_up,
-                                     event);
+          function(entry(device_id,
+                         event_time_stamp(v.get_time_stamp()),
+                         event,
+                         v.get_integer_value() ? event_type::key_down : event_type::key_up,
+                         event));
 
         } else if (auto consumer_key_code = make_consumer_key_code(*usage_page, *usage)) {
           event_queue::event event(*consumer_key_code);
-          result->emplace_back_entry(device_id,
-                                     event_time_stamp(v.get_time_stamp()),
-                                     event,
-                                     v.get_integer_value() ? event_type::key_down : event_type::key_up,
-                                     event);
+          function(entry(device_id,
+                         event_time_stamp(v.get_time_stamp()),
+                         event,
+                         v.get_integer_value() ? event_type::key_down : event_type::key_up,
+                         event));
 
         } else if (auto pointing_button = make_pointing_button(*usage_page, *usage)) {
           event_queue::event event(*pointing_button);
-          result->emplace_back_entry(device_id,
-                                     event_time_stamp(v.get_time_stamp()),
-                                     event,
-                                     v.get_integer_value() ? event_type::key_down : event_type::key_up,
-                                     event);
+          function(entry(device_id,
+                         event_time_stamp(v.get_time_stamp()),
+                         event,
+                         v.get_integer_value() ? event_type::key_down : event_type::key_up,
+                         event));
 
         } else if (*usage_page == hid_usage_page::generic_desktop &&
                    *usage == hid_usage::gd_x) {
@@ -105,30 +107,102 @@ static inline std::shared_ptr<queue> make_queue(device_id device_id,
                    *usage == hid_usage::led_caps_lock) {
           event_queue::event event(event_queue::event::type::caps_lock_state_changed,
                                    v.get_integer_value());
-          result->emplace_back_entry(device_id,
-                                     event_time_stamp(v.get_time_stamp()),
-                                     event,
-                                     event_type::single,
-                                     event);
+          function(entry(device_id,
+                         event_time_stamp(v.get_time_stamp()),
+                         event,
+                         event_type::single,
+                         event));
         } else if (*usage_page == hid_usage_page::leds &&
                    *usage == hid_usage::led_num_lock) {
           event_queue::event event(event_queue::event::type::num_lock_state_changed,
                                    v.get_integer_value());
-          result->emplace_back_entry(device_id,
-                                     event_time_stamp(v.get_time_stamp()),
-                                     event,
-                                     event_type::single,
-                                     event);
+          function(entry(device_id,
+                         event_time_stamp(v.get_time_stamp()),
+                         event,
+                         event_type::single,
+                         event));
         } 
       }
     }
   }
 
   emplace_back_pointing_motion_event();
+}
+
+static inline std::shared_ptr<queue> make_queue(device_id device_id,
+                                                const std::vector<hid_value>& hid_values) {
+  auto result = std::make_shared<queue>();
+
+  for_each_entry(device_id,
+                 hid_values,
+                 [&](const entry& entry) {
+                   result->push_back_entry(entry);
+                 });
 
   return result;
 }
 
+// Update `pressed_keys_manager` with `entry` and
+// return a device_keys_and_pointing_buttons_are_released event entry if all keys and pointing buttons of `device_id` are released.
+static inline std::optional<entry> update_pressed_keys_manager(const entry& entry,
+                                                               device_id device_id,
+                                                               pressed_keys_manager& pressed_keys_manager) {
+  if (entry.get_device_id() == device_id) {
+    auto& e = entry.get_event();
+
+    if (entry.get_event_type() == event_type::key_down) {
+      if (auto v = e.find<key_code>()) {
+        pressed_keys_manager.insert(*v);
+      } else if (auto v = e.find<consumer_key_code>()) {
+        pressed_keys_manager.insert(*v);
+      } else if (auto v = e.find<pointing_button>()) {
+        pressed_keys_manager.insert(*v);
+      }
+    } else if (entry.get_event_type() == event_type::key_up) {
+      if (!pressed_keys_manager.empty()) {
+        if (auto v = e.find<key_code>()) {
+          pressed_keys_manager.erase(*v);
+        } else if (auto v = e.find<consumer_key_code>()) {
+          pressed_keys_manager.erase(*v);
+        } else if (auto v = e.find<pointing_button>()) {
+          pressed_keys_manager.erase(*v);
+        }
+
+        if (pressed_keys_manager.empty()) {
+          auto event = event::make_device_keys_and_pointing_buttons_are_released_event();
+          return event_queue::entry(device_id,
+                                    entry.get_event_time_stamp(),
+                                    event,
+                                    event_type::single,
+                                    event);
+        }
+      }
+    }
+  }
+
+  return std::nullopt;
+}
+
+// The single pass version of `make_queue` and `insert_device_keys_and_pointing_buttons_are_released_event`.
+// `function` is called with each entry and device_keys_and_pointing_buttons_are_released event entries.
+template <typename T>
+static inline void for_each_entry(device_id device_id,
+                                  const std::vector<hid_value>& hid_values,
+                                  pressed_keys_manager& pressed_keys_manager,
+                                  T function) {
+  for_each_entry(device_id,
+                 hid_values,
+                 [&](const entry& entry) {
+                   function(entry);
+
+                   if (auto e = update_pressed_keys_manager(entry,
+                                                            device_id,
+                                                            pressed_keys_manager)) {
+                     function(*e);
+                   }
+                 });
+}
+
 static inline std::shared_ptr<queue> insert_device_keys_and_pointing_buttons_are_released_event(std::shared_ptr<queue> queue,
                                                                                                 device_id device_id,
                                                                                                 std::shared_ptr<pressed_keys_manager> pressed_keys_manager) {
@@ -138,37 +212,10 @@ static inline std::shared_ptr<queue> insert_device_keys_and_pointing_buttons_are
     for (const auto& entry : queue->get_entries()) {
       result->push_back_entry(entry);
 
-      if (entry.get_device_id() == device_id) {
-        auto& e = entry.get_event();
-
-        if (entry.get_event_type() == event_type::key_down) {
-          if (auto v = e.find<key_code>()) {
-            pressed_keys_manager->insert(*v);
-          } else if (auto v = e.find<consumer_key_code>()) {
-            pressed_keys_manager->insert(*v);
-          } else if (auto v = e.find<pointing_button>()) {
-            pressed_keys_manager->insert(*v);
-          }
-        } else if (entry.get_event_type() == event_type::key_up) {
-          if (!pressed_keys_manager->empty()) {
-            if (auto v = e.find<key_code>()) {
-              pressed_keys_manager->erase(*v);
-            } else if (auto v = e.find<consumer_key_code>()) {
-              pressed_keys_manager->erase(*v);
-            } else if (auto v = e.find<pointing_button>()) {
-              pressed_keys_manager->erase(*v);
-            }
-
-            if (pressed_keys_manager->empty()) {
-              auto event = event::make_device_keys_and_pointing_buttons_are_released_event();
-              result->emplace_back_entry(device_id,
-                                         entry.get_event_time_stamp(),
-                                         event,
-                                         event_type::single,
-                                         event);
-            }
-          }
-        }
+      if (auto e = update_pressed_keys_manager(entry,
+                                               device_id,
+                                               *pressed_keys_manager)) {
+        result->push_back_entry(*e);
       }
     }
   }
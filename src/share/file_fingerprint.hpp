@@ -0,0 +1,115 @@
+#pragma once
+
+// `krbn::file_fingerprint` can be used safely in a multi-threaded environment.
+
+#include "content_hash.hpp"
+#include <memory>
+#include <optional>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+namespace krbn {
+// `file_fingerprint` identifies the content of a file without keeping the content.
+//
+// - The file status (size, modification time, inode and owner) is used as the fast path
+//   to detect unchanged files without reading them.
+//   (async_file_writer and most editors replace files by `rename`, so the inode is changed on each save.)
+// - `content_hash` of the file body is used to detect whether the content is actually changed.
+//   Two fingerprints are equal if both files do not exist or have the same owner and content hash.
+
+class file_fingerprint final {
+public:
+  struct file_status final {
+    uint64_t size;
+    int64_t modification_time; // nanoseconds
+    uint64_t inode;
+    uid_t owner;
+
+    bool operator==(const file_status& other) const {
+      return size == other.size &&
+             modification_time == other.modification_time &&
+             inode == other.inode &&
+             owner == other.owner;
+    }
+
+    bool operator!=(const file_status& other) const { return !(*this == other); }
+  };
+
+  file_fingerprint(void) : hash_(std::nullopt),
+                           file_status_(std::nullopt) {
+  }
+
+  // `file_body` is the content of `file_path` which is already read by the caller. (nullptr if the file does not exist.)
+  static file_fingerprint make(const std::string& file_path,
+                               const std::shared_ptr<const std::vector<uint8_t>>& file_body) {
+    file_fingerprint fingerprint;
+
+    if (file_body) {
+      fingerprint.hash_ = content_hash::make(file_body->data(), file_body->size());
+      fingerprint.file_status_ = make_file_status(file_path);
+    }
+
+    return fingerprint;
+  }
+
+  static std::optional<file_status> make_file_status(const std::string& file_path) {
+    struct stat s;
+    if (stat(file_path.c_str(), &s) != 0) {
+      return std::nullopt;
+    }
+
+    return file_status{
+        static_cast<uint64_t>(s.st_size),
+#ifdef __APPLE__
+        static_cast<int64_t>(s.st_mtimespec.tv_sec) * 1000000000 + s.st_mtimespec.tv_nsec,
+#else
+        static_cast<int64_t>(s.st_mtim.tv_sec) * 1000000000 + s.st_mtim.tv_nsec,
+#endif
+        static_cast<uint64_t>(s.st_ino),
+        s.st_uid,
+    };
+  }
+
+  bool exists(void) const {
+    return hash_ != std::nullopt;
+  }
+
+  const std::optional<uint64_t>& get_hash(void) const {
+    return hash_;
+  }
+
+  const std::optional<file_status>& get_file_status(void) const {
+    return file_status_;
+  }
+
+  // Return true if the current status of `file_path` is same as the status at the fingerprint is made.
+  // In this case, the content is probably not changed and reading the file can be skipped.
+  bool same_file_status(const std::string& file_path) const {
+    auto s = make_file_status(file_path);
+    if (!exists()) {
+      return !s;
+    }
+
+    return file_status_ && s && *file_status_ == *s;
+  }
+
+  bool operator==(const file_fingerprint& other) const {
+    if (!exists() || !other.exists()) {
+      return exists() == other.exists();
+    }
+
+    auto owner = file_status_ ? std::optional<uid_t>(file_status_->owner) : std::nullopt;
+    auto other_owner = other.file_status_ ? std::optional<uid_t>(other.file_status_->owner) : std::nullopt;
+
+    return hash_ == other.hash_ &&
+           owner == other_owner;
+  }
+
+  bool operator!=(const file_fingerprint& other) const { return !(*this == other); }
+
+private:
+  std::optional<uint64_t> hash_;
+  std::optional<file_status> file_status_;
+};
+} // namespace krbn
@@ -2,6 +2,7 @@
 
 // `krbn::grabber_client` can be used safely in a multi-threaded environment.
 
+#include "binary_message.hpp"
 #include "constants.hpp"
 #include "logger.hpp"
 #include "types.hpp"
@@ -93,17 +94,27 @@ public:
                                               const key_down_up_valued_event& event,
                                               event_type event_type,
                                               absolute_time_point time_stamp) const {
-    enqueue_to_dispatcher([this, device_id, event, event_type, time_stamp] {
-      nlohmann::json json{
-          {"operation_type", operation_type::key_down_up_valued_event_arrived},
-          {"device_id", device_id},
-          {"key_down_up_valued_event", event},
-          {"event_type", event_type},
-          {"time_stamp", time_stamp},
-      };
+    async_key_down_up_valued_events_arrived({
+        binary_message::make_key_down_up_valued_event_entry(device_id,
+                                                            event,
+                                                            event_type,
+                                                            time_stamp),
+    });
+  }
 
+  // Send events in batches (`binary_message::max_entries_per_message` events per message).
+  void async_key_down_up_valued_events_arrived(const std::vector<binary_message::key_down_up_valued_event_entry>& entries) const {
+    if (entries.empty()) {
+      return;
+    }
+
+    enqueue_to_dispatcher([this, entries] {
       if (client_) {
-        client_->async_send(nlohmann::json::to_msgpack(json));
+        for (size_t i = 0; i < entries.size(); i += binary_message::max_entries_per_message) {
+          auto count = std::min(entries.size() - i, binary_message::max_entries_per_message);
+          client_->async_send(binary_message::make_key_down_up_valued_events_arrived_message(&(entries[i]),
+                                                                                             count));
+        }
       }
     });
   }
@@ -123,26 +134,16 @@ public:
 
   void async_caps_lock_state_changed(bool state) const {
     enqueue_to_dispatcher([this, state] {
-      nlohmann::json json{
-          {"operation_type", operation_type::caps_lock_state_changed},
-          {"caps_lock_state", state},
-      };
-
       if (client_) {
-        client_->async_send(nlohmann::json::to_msgpack(json));
+        client_->async_send(binary_message::make_caps_lock_state_changed_message(state));
       }
     });
   }
 
   void async_num_lock_state_changed(bool state) const {
     enqueue_to_dispatcher([this, state] {
-      nlohmann::json json{
-          {"operation_type", operation_type::num_lock_state_changed},
-          {"num_lock_state", state},
-      };
-
       if (client_) {
-        client_->async_send(nlohmann::json::to_msgpack(json));
+        client_->async_send(binary_message::make_num_lock_state_changed_message(state));
       }
     });
   }
@@ -205,6 +206,31 @@ public:
     });
   }
 
+  void async_dump_event_trace(void) const {
+    enqueue_to_dispatcher([this] {
+      nlohmann::json json{
+          {"operation_type", operation_type::dump_event_trace},
+      };
+
+      if (client_) {
+        client_->async_send(nlohmann::json::to_msgpack(json));
+      }
+    });
+  }
+
+  void async_set_rule_statistics_enabled(bool value) const {
+    enqueue_to_dispatcher([this, value] {
+      nlohmann::json json{
+          {"operation_type", operation_type::set_rule_statistics_enabled},
+          {"enabled", value},
+      };
+
+      if (client_) {
+        client_->async_send(nlohmann::json::to_msgpack(json));
+      }
+    });
+  }
+
 private:
   void stop(void) {
     if (!client_) {
@@ -9,7 +9,8 @@
 namespace krbn {
 class hid_keyboard_caps_lock_led_state_manager final : public pqrs::dispatcher::extra::dispatcher_client {
 public:
-  hid_keyboard_caps_lock_led_state_manager(IOHIDDeviceRef device) : dispatcher_client(),
+  hid_keyboard_caps_lock_led_state_manager(std::weak_ptr<pqrs::dispatcher::dispatcher> weak_dispatcher,
+                                           IOHIDDeviceRef device) : dispatcher_client(weak_dispatcher),
                                                                     device_(device),
                                                                     timer_(*this) {
     if (device_) {
@@ -9,9 +9,10 @@
 namespace krbn {
 class hid_keyboard_num_lock_led_state_manager final : public pqrs::dispatcher::extra::dispatcher_client {
 public:
-  hid_keyboard_num_lock_led_state_manager(IOHIDDeviceRef device) : dispatcher_client(),
-                                                                    device_(device),
-                                                                    timer_(*this) {
+  hid_keyboard_num_lock_led_state_manager(std::weak_ptr<pqrs::dispatcher::dispatcher> weak_dispatcher,
+                                          IOHIDDeviceRef device) : dispatcher_client(weak_dispatcher),
+                                                                   device_(device),
+                                                                   timer_(*this) {
     if (device_) {
       pqrs::osx::iokit_hid_device hid_device(*device_);
       for (const auto& e : hid_device.make_elements()) {
@@ -11,21 +11,28 @@
 namespace krbn {
 class json_writer final {
 public:
-  static void async_save_to_file(const nlohmann::json& json,
+  // `json` is moved into a shared_ptr in order to avoid deep copies of json in the caller thread.
+  // (`std::function` copies the captured values.)
+  static void async_save_to_file(nlohmann::json json,
                                  const std::string& file_path,
                                  mode_t parent_directory_mode,
                                  mode_t file_mode) {
+    auto shared_json = std::make_shared<const nlohmann::json>(std::move(json));
+
+    // Serialize json in the file writer thread.
     async_file_writer::enqueue(file_path,
-                               json.dump(4),
+                               [shared_json] {
+                                 return shared_json->dump(4);
+                               },
                                parent_directory_mode,
                                file_mode);
   }
 
-  static void sync_save_to_file(const nlohmann::json& json,
+  static void sync_save_to_file(nlohmann::json json,
                                 const std::string& file_path,
                                 mode_t parent_directory_mode,
                                 mode_t file_mode) {
-    async_save_to_file(json,
+    async_save_to_file(std::move(json),
                        file_path,
                        parent_directory_mode,
                        file_mode);
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "latency_histogram.hpp"
+#include <chrono>
 #include <nod/nod.hpp>
 #include <pqrs/dispatcher.hpp>
 
@@ -10,11 +12,43 @@ public:
   public:
     nod::signal<void(void)> input_event_arrived;
 
+    core(void) {
+    }
+
     void enqueue_input_event_arrived(pqrs::dispatcher::extra::dispatcher_client& client) {
-      client.enqueue_to_dispatcher([this] {
+      auto enqueued_at = std::chrono::steady_clock::now();
+
+      client.enqueue_to_dispatcher([this, enqueued_at] {
+        record_queueing_delay(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - enqueued_at));
+
         input_event_arrived();
       });
     }
+
+    // The queueing delay of `input_event_arrived` in the shared dispatcher.
+    // A large delay means that some slow tasks are blocking the input event pipeline.
+    latency_histogram get_queueing_delay_histogram(void) const {
+      std::lock_guard<std::mutex> lock(queueing_delay_histogram_mutex_);
+
+      return queueing_delay_histogram_;
+    }
+
+    void clear_queueing_delay_histogram(void) {
+      std::lock_guard<std::mutex> lock(queueing_delay_histogram_mutex_);
+
+      queueing_delay_histogram_.clear();
+    }
+
+  private:
+    void record_queueing_delay(std::chrono::microseconds delay) {
+      std::lock_guard<std::mutex> lock(queueing_delay_histogram_mutex_);
+
+      queueing_delay_histogram_.record(delay);
+    }
+
+    latency_histogram queueing_delay_histogram_;
+    mutable std::mutex queueing_delay_histogram_mutex_;
   };
 
   static core& get_instance(void) {
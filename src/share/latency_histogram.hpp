@@ -0,0 +1,176 @@
+#pragma once
+
+// `krbn::latency_histogram` can be used safely in a multi-threaded environment
+// if it is modified in a single thread.
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+
+namespace krbn {
+// `latency_histogram` is a fixed-size log-linear (HDR-style) histogram of durations in microseconds.
+//
+// - Values less than `sub_bucket_count` are recorded exactly.
+// - Larger values are recorded into one of `sub_bucket_count / 2` buckets per power of two,
+//   so the relative error of percentiles is less than 1 / (sub_bucket_count / 2) (6.25%).
+// - Values larger than `max_value` are recorded as `max_value`.
+//
+// Recording a value takes no allocation.
+
+class latency_histogram final {
+public:
+  static constexpr uint64_t sub_bucket_count = 32;
+  static constexpr uint64_t max_value = 60 * 1000 * 1000; // 60 seconds
+
+  latency_histogram(void) : counts_{},
+                            count_(0),
+                            total_(0),
+                            min_(0),
+                            max_(0) {
+  }
+
+  void record(std::chrono::microseconds duration) {
+    uint64_t v = 0;
+    if (duration.count() > 0) {
+      v = std::min(static_cast<uint64_t>(duration.count()), max_value);
+    }
+
+    ++counts_[bucket_index(v)];
+
+    if (count_ == 0 || v < min_) {
+      min_ = v;
+    }
+    if (max_ < v) {
+      max_ = v;
+    }
+    ++count_;
+    total_ += v;
+  }
+
+  void merge(const latency_histogram& other) {
+    if (other.count_ == 0) {
+      return;
+    }
+
+    for (size_t i = 0; i < counts_.size(); ++i) {
+      counts_[i] += other.counts_[i];
+    }
+
+    if (count_ == 0 || other.min_ < min_) {
+      min_ = other.min_;
+    }
+    if (max_ < other.max_) {
+      max_ = other.max_;
+    }
+    count_ += other.count_;
+    total_ += other.total_;
+  }
+
+  void clear(void) {
+    counts_.fill(0);
+    count_ = 0;
+    total_ = 0;
+    min_ = 0;
+    max_ = 0;
+  }
+
+  uint64_t get_count(void) const {
+    return count_;
+  }
+
+  std::chrono::microseconds get_min(void) const {
+    return std::chrono::microseconds(min_);
+  }
+
+  std::chrono::microseconds get_max(void) const {
+    return std::chrono::microseconds(max_);
+  }
+
+  std::chrono::microseconds get_mean(void) const {
+    if (count_ == 0) {
+      return std::chrono::microseconds(0);
+    }
+    return std::chrono::microseconds(total_ / count_);
+  }
+
+  // Return the highest value which is equivalent to the value at `percentile` (0.0 - 100.0).
+  std::chrono::microseconds value_at_percentile(double percentile) const {
+    if (count_ == 0) {
+      return std::chrono::microseconds(0);
+    }
+
+    percentile = std::min(std::max(percentile, 0.0), 100.0);
+
+    auto target = static_cast<uint64_t>(percentile / 100.0 * count_ + 0.5);
+    target = std::min(std::max(target, uint64_t(1)), count_);
+
+    uint64_t n = 0;
+    for (size_t i = 0; i < counts_.size(); ++i) {
+      n += counts_[i];
+      if (n >= target) {
+        return std::chrono::microseconds(std::min(std::max(highest_equivalent_value(i), min_), max_));
+      }
+    }
+
+    return std::chrono::microseconds(max_);
+  }
+
+  nlohmann::json to_json(void) const {
+    return nlohmann::json::object({
+        {"count", count_},
+        {"min_us", min_},
+        {"mean_us", get_mean().count()},
+        {"p50_us", value_at_percentile(50.0).count()},
+        {"p90_us", value_at_percentile(90.0).count()},
+        {"p99_us", value_at_percentile(99.0).count()},
+        {"p999_us", value_at_percentile(99.9).count()},
+        {"max_us", max_},
+    });
+  }
+
+private:
+  static constexpr uint64_t half_sub_bucket_count = sub_bucket_count / 2;
+  static constexpr int sub_bucket_bits = 5; // log2(sub_bucket_count)
+
+  static_assert((uint64_t(1) << sub_bucket_bits) == sub_bucket_count);
+
+  // The shift of values in [2^n, 2^(n+1)) is (n - sub_bucket_bits + 1).
+  static int shift(uint64_t v) {
+    auto msb = 63 - __builtin_clzll(v);
+    return msb - sub_bucket_bits + 1;
+  }
+
+  static size_t bucket_index(uint64_t v) {
+    if (v < sub_bucket_count) {
+      return v;
+    }
+
+    auto s = shift(v);
+    return sub_bucket_count +
+           (s - 1) * half_sub_bucket_count +
+           ((v >> s) - half_sub_bucket_count);
+  }
+
+  static uint64_t highest_equivalent_value(size_t index) {
+    if (index < sub_bucket_count) {
+      return index;
+    }
+
+    auto s = (index - sub_bucket_count) / half_sub_bucket_count + 1;
+    auto sub = (index - sub_bucket_count) % half_sub_bucket_count + half_sub_bucket_count;
+    return ((sub + 1) << s) - 1;
+  }
+
+  static constexpr int max_value_msb = 25;
+  static constexpr size_t bucket_count = sub_bucket_count + (max_value_msb - sub_bucket_bits + 1) * half_sub_bucket_count;
+
+  static_assert((uint64_t(1) << max_value_msb) <= max_value && max_value < (uint64_t(1) << (max_value_msb + 1)));
+
+  std::array<uint64_t, bucket_count> counts_;
+  uint64_t count_;
+  uint64_t total_;
+  uint64_t min_;
+  uint64_t max_;
+};
+} // namespace krbn
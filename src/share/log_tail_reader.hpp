@@ -0,0 +1,156 @@
+#pragma once
+
+// `krbn::log_tail_reader` can be used safely in a multi-threaded environment.
+
+#include <algorithm>
+#include <deque>
+#include <fcntl.h>
+#include <map>
+#include <pqrs/spdlog.hpp>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace krbn {
+// `log_tail_reader` reads only lines which are appended to log files since the last `read_new_lines` call.
+//
+// - The read offset is kept per file (identified by device and inode).
+//   Thus, the rotated file (`grabber.1.log`) continues from the offset of the previous `grabber.log`,
+//   and the new `grabber.log` is read from the beginning.
+// - If a file is truncated (the file size becomes smaller than the offset), the file is read from the beginning.
+// - A line is read after its line terminator is written.
+// - New lines of all files are merged by their timestamps.
+
+class log_tail_reader final {
+public:
+  log_tail_reader(const log_tail_reader&) = delete;
+
+  log_tail_reader(const std::vector<std::string>& target_file_paths,
+                  size_t max_line_count) : max_line_count_(max_line_count) {
+    for (const auto& file_path : target_file_paths) {
+      // Read the rotated file at first since it contains older lines.
+      file_paths_.push_back(pqrs::spdlog::make_rotated_file_path(file_path));
+      file_paths_.push_back(file_path);
+    }
+  }
+
+  std::shared_ptr<std::deque<std::string>> read_new_lines(void) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::vector<line> lines;
+    std::map<file_key, file_state> file_states;
+
+    for (const auto& file_path : file_paths_) {
+      read_file(file_path, lines, file_states);
+    }
+
+    // Files which are not found in `file_paths_` are removed.
+    file_states_ = std::move(file_states);
+
+    std::stable_sort(std::begin(lines),
+                     std::end(lines),
+                     [](auto&& a, auto&& b) {
+                       return a.sort_key < b.sort_key;
+                     });
+
+    auto result = std::make_shared<std::deque<std::string>>();
+
+    auto begin = std::begin(lines);
+    if (max_line_count_ > 0 && lines.size() > max_line_count_) {
+      begin += lines.size() - max_line_count_;
+    }
+    for (auto it = begin; it != std::end(lines); ++it) {
+      result->push_back(std::move(it->text));
+    }
+
+    return result;
+  }
+
+private:
+  typedef std::pair<dev_t, ino_t> file_key;
+
+  struct file_state final {
+    off_t offset;
+    std::string partial_line;
+  };
+
+  struct line final {
+    uint64_t sort_key;
+    std::string text;
+  };
+
+  void read_file(const std::string& file_path,
+                 std::vector<line>& lines,
+                 std::map<file_key, file_state>& file_states) {
+    auto fd = open(file_path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return;
+    }
+
+    struct stat s;
+    if (fstat(fd, &s) == 0) {
+      file_key key(s.st_dev, s.st_ino);
+
+      auto& state = file_states[key];
+      auto it = file_states_.find(key);
+      if (it != std::end(file_states_)) {
+        state = std::move(it->second);
+        file_states_.erase(it);
+      }
+
+      if (s.st_size < state.offset) {
+        // The file is truncated.
+        state.offset = 0;
+        state.partial_line.clear();
+      }
+
+      if (state.offset < s.st_size) {
+        std::string buffer(s.st_size - state.offset, '\0');
+        auto n = pread(fd, &(buffer[0]), buffer.size(), state.offset);
+        if (n > 0) {
+          buffer.resize(n);
+          state.offset += n;
+
+          auto first_line_index = lines.size();
+          split_lines(state.partial_line + buffer, lines, state.partial_line);
+
+          // Older lines are never used since they are dropped after merging.
+          auto count = lines.size() - first_line_index;
+          if (max_line_count_ > 0 && count > max_line_count_) {
+            lines.erase(std::begin(lines) + first_line_index,
+                        std::begin(lines) + first_line_index + (count - max_line_count_));
+          }
+        }
+      }
+    }
+
+    close(fd);
+  }
+
+  static void split_lines(const std::string& buffer,
+                          std::vector<line>& lines,
+                          std::string& partial_line) {
+    size_t begin = 0;
+    while (true) {
+      auto end = buffer.find('\n', begin);
+      if (end == std::string::npos) {
+        partial_line = buffer.substr(begin);
+        return;
+      }
+
+      auto text = buffer.substr(begin, end - begin);
+      // Skip broken lines.
+      if (auto sort_key = pqrs::spdlog::make_sort_key(text)) {
+        lines.push_back({*sort_key, std::move(text)});
+      }
+
+      begin = end + 1;
+    }
+  }
+
+  std::vector<std::string> file_paths_;
+  size_t max_line_count_;
+  std::map<file_key, file_state> file_states_;
+  std::mutex mutex_;
+};
+} // namespace krbn
@@ -15,6 +15,10 @@ public:
     conditions_.push_back(condition);
   }
 
+  const std::vector<std::shared_ptr<manipulator::conditions::base>>& get_conditions(void) const {
+    return conditions_;
+  }
+
   bool is_fulfilled(const event_queue::entry& entry,
                     const manipulator_environment& manipulator_environment) const {
     bool result = true;
@@ -29,6 +33,14 @@ public:
     return result;
   }
 
+  size_t get_memory_size(void) const {
+    size_t size = conditions_.capacity() * sizeof(std::shared_ptr<manipulator::conditions::base>);
+    for (const auto& c : conditions_) {
+      size += c->get_memory_size();
+    }
+    return size;
+  }
+
 private:
   std::vector<std::shared_ptr<manipulator::conditions::base>> conditions_;
 };
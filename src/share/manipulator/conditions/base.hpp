@@ -17,6 +17,9 @@ public:
 
   virtual bool is_fulfilled(const event_queue::entry& entry,
                             const manipulator_environment& manipulator_environment) const = 0;
+
+  // The estimated size of the condition object and its heap allocations.
+  virtual size_t get_memory_size(void) const = 0;
 };
 } // namespace conditions
 } // namespace manipulator
@@ -104,6 +104,11 @@ public:
     }
   }
 
+  virtual size_t get_memory_size(void) const {
+    return sizeof(*this) +
+           definitions_.capacity() * sizeof(definition);
+  }
+
 private:
   struct definition final {
     std::optional<vendor_id> vendor_id;
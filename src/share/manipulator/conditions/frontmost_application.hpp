@@ -93,7 +93,7 @@ public:
 
   virtual bool is_fulfilled(const event_queue::entry& entry,
                             const manipulator_environment& manipulator_environment) const {
-    if (cached_result_ && cached_result_->first == manipulator_environment.get_frontmost_application()) {
+    if (cached_result_ && cached_result_->first == manipulator_environment.get_frontmost_application_generation()) {
       return cached_result_->second;
     }
 
@@ -149,16 +149,23 @@ public:
     }
 
   finish:
-    cached_result_ = std::make_pair(manipulator_environment.get_frontmost_application(), result);
+    cached_result_ = std::make_pair(manipulator_environment.get_frontmost_application_generation(), result);
     return result;
   }
 
+  virtual size_t get_memory_size(void) const {
+    // The compiled automaton in std::regex is not included.
+    return sizeof(*this) +
+           (bundle_identifiers_.capacity() + file_paths_.capacity()) * sizeof(std::regex);
+  }
+
 private:
   type type_;
   std::vector<std::regex> bundle_identifiers_;
   std::vector<std::regex> file_paths_;
 
-  mutable std::optional<std::pair<pqrs::osx::frontmost_application_monitor::application, bool>> cached_result_;
+  // The result and the generation of the environment value.
+  mutable std::optional<std::pair<uint64_t, bool>> cached_result_;
 };
 } // namespace conditions
 } // namespace manipulator
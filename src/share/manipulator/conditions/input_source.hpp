@@ -1,6 +1,7 @@
 #pragma once
 
 #include "base.hpp"
+#include "manipulator/input_source_matcher.hpp"
 #include <string>
 #include <vector>
 
@@ -15,7 +16,8 @@ public:
   };
 
   input_source(const nlohmann::json& json) : base(),
-                                             type_(type::input_source_if) {
+                                             type_(type::input_source_if),
+                                             input_source_matcher_(input_source_matcher::get_shared_input_source_matcher()) {
     if (!json.is_object()) {
       throw pqrs::json::unmarshal_error(fmt::format("json must be object, but is `{0}`", json.dump()));
     }
@@ -45,7 +47,7 @@ public:
 
         for (const auto& j : value) {
           try {
-            input_source_specifiers_.emplace_back(j);
+            input_source_specifiers_.push_back(input_source_matcher_->make_specifier(j));
           } catch (pqrs::json::unmarshal_error& e) {
             throw pqrs::json::unmarshal_error(fmt::format("`{0}` entry error: {1}", key, e.what()));
           }
@@ -65,22 +67,21 @@ public:
 
   virtual bool is_fulfilled(const event_queue::entry& entry,
                             const manipulator_environment& manipulator_environment) const {
-    if (cached_result_ && cached_result_->first == manipulator_environment.get_input_source_properties()) {
+    if (cached_result_ && cached_result_->first == manipulator_environment.get_input_source_properties_generation()) {
       return cached_result_->second;
     }
 
     bool result = false;
 
-    for (const auto& s : input_source_specifiers_) {
-      if (s.test(manipulator_environment.get_input_source_properties())) {
-        switch (type_) {
-          case type::input_source_if:
-            result = true;
-            goto finish;
-          case type::input_source_unless:
-            result = false;
-            goto finish;
-        }
+    if (input_source_matcher_->test(input_source_specifiers_,
+                                    manipulator_environment)) {
+      switch (type_) {
+        case type::input_source_if:
+          result = true;
+          goto finish;
+        case type::input_source_unless:
+          result = false;
+          goto finish;
       }
     }
 
@@ -96,15 +97,23 @@ public:
     }
 
   finish:
-    cached_result_ = std::make_pair(manipulator_environment.get_input_source_properties(), result);
+    cached_result_ = std::make_pair(manipulator_environment.get_input_source_properties_generation(), result);
     return result;
   }
 
+  virtual size_t get_memory_size(void) const {
+    // Patterns are shared in `input_source_matcher` and they are not included.
+    return sizeof(*this) +
+           input_source_specifiers_.capacity() * sizeof(input_source_matcher::specifier);
+  }
+
 private:
   type type_;
-  std::vector<pqrs::osx::input_source_selector::specifier> input_source_specifiers_;
+  std::shared_ptr<input_source_matcher> input_source_matcher_;
+  std::vector<input_source_matcher::specifier> input_source_specifiers_;
 
-  mutable std::optional<std::pair<pqrs::osx::input_source::properties, bool>> cached_result_;
+  // The result and the generation of the environment value.
+  mutable std::optional<std::pair<uint64_t, bool>> cached_result_;
 };
 } // namespace conditions
 } // namespace manipulator
@@ -65,13 +65,21 @@ public:
 
   virtual bool is_fulfilled(const event_queue::entry& entry,
                             const manipulator_environment& manipulator_environment) const {
+    if (cached_result_ && cached_result_->first == manipulator_environment.get_virtual_hid_keyboard_keyboard_type_generation()) {
+      return cached_result_->second;
+    }
+
+    bool result = false;
+
     for (const auto& t : keyboard_types_) {
       if (t == manipulator_environment.get_virtual_hid_keyboard_keyboard_type()) {
         switch (type_) {
           case type::keyboard_type_if:
-            return true;
+            result = true;
+            goto finish;
           case type::keyboard_type_unless:
-            return false;
+            result = false;
+            goto finish;
         }
       }
     }
@@ -80,17 +88,33 @@ public:
 
     switch (type_) {
       case type::keyboard_type_if:
-        return false;
+        result = false;
+        goto finish;
       case type::keyboard_type_unless:
-        return true;
+        result = true;
+        goto finish;
     }
 
-    return false;
+  finish:
+    cached_result_ = std::make_pair(manipulator_environment.get_virtual_hid_keyboard_keyboard_type_generation(), result);
+    return result;
+  }
+
+  virtual size_t get_memory_size(void) const {
+    size_t size = sizeof(*this) +
+                  keyboard_types_.capacity() * sizeof(std::string);
+    for (const auto& t : keyboard_types_) {
+      size += t.capacity();
+    }
+    return size;
   }
 
 private:
   type type_;
   std::vector<std::string> keyboard_types_;
+
+  // The result and the generation of the environment value.
+  mutable std::optional<std::pair<uint64_t, bool>> cached_result_;
 };
 } // namespace conditions
 } // namespace manipulator
@@ -17,6 +17,10 @@ public:
                             const manipulator_environment& manipulator_environment) const {
     return true;
   }
+
+  virtual size_t get_memory_size(void) const {
+    return sizeof(*this);
+  }
 };
 } // namespace conditions
 } // namespace manipulator
@@ -72,6 +72,18 @@ public:
   virtual ~variable(void) {
   }
 
+  type get_type(void) const {
+    return type_;
+  }
+
+  const std::optional<std::string>& get_name(void) const {
+    return name_;
+  }
+
+  const std::optional<int>& get_value(void) const {
+    return value_;
+  }
+
   virtual bool is_fulfilled(const event_queue::entry& entry,
                             const manipulator_environment& manipulator_environment) const {
     switch (type_) {
@@ -82,6 +94,11 @@ public:
     }
   }
 
+  virtual size_t get_memory_size(void) const {
+    return sizeof(*this) +
+           (name_ ? name_->capacity() : 0);
+  }
+
 private:
   type type_;
   std::optional<std::string> name_;
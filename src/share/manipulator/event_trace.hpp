@@ -0,0 +1,217 @@
+#pragma once
+
+// `krbn::manipulator::event_trace` can be used safely in a multi-threaded environment
+// if `push_back_entry` and `make_snapshot` are called in the same thread (the shared dispatcher thread).
+
+#include "event_queue.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <nlohmann/json.hpp>
+#include <stdexcept>
+#include <vector>
+
+namespace krbn {
+namespace manipulator {
+// `event_trace` is a fixed-size in-memory ring buffer which records entries as they pass each stage
+// (each connection of `manipulator_managers_connector`).
+//
+// Recording an entry only copies a fixed-size record into the buffer (no lock and no allocation).
+// The oldest records are overwritten when the buffer is full.
+//
+// The binary file format (native byte order):
+//
+//   file_header (16 bytes)
+//   records (file_header.count * sizeof(record))
+
+class event_trace final {
+public:
+  static constexpr uint32_t magic = 0x6b727474; // "krtt"
+  static constexpr uint32_t version = 2;
+  static constexpr size_t capacity = 8192; // must be a power of 2
+  static constexpr uint32_t no_manipulator = UINT32_MAX;
+  // The entry is manipulated by a manipulator which is already invalidated by a configuration change.
+  static constexpr uint32_t invalidated_manipulator = UINT32_MAX - 1;
+
+  static_assert((capacity & (capacity - 1)) == 0);
+
+  enum flags : uint8_t {
+    flag_valid = 1 << 0,
+    flag_lazy = 1 << 1,
+  };
+
+  struct file_header final {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t count;
+  };
+  static_assert(sizeof(file_header) == 16);
+
+  struct record final {
+    uint64_t sequence;
+    uint64_t device_id;
+    // The event time stamp.
+    uint64_t time_stamp;
+    // `now` of the manipulation.
+    uint64_t recorded_at;
+    // key_code, consumer_key_code or pointing_button.
+    uint32_t value;
+    // The index of the matched manipulator in the valid manipulators of the manipulator_manager,
+    // `invalidated_manipulator` or `no_manipulator`.
+    // (The valid manipulators are same as `complex_modifications_manipulator_manager::get_entries`.)
+    uint32_t manipulator_index;
+    uint8_t stage;
+    uint8_t event;      // event_queue::event::type
+    uint8_t event_type; // krbn::event_type
+    uint8_t flags;
+    uint32_t reserved;
+  };
+  static_assert(sizeof(record) == 48);
+
+  event_trace(const event_trace&) = delete;
+
+  event_trace(void) : next_sequence_(0) {
+  }
+
+  // This method is executed in the shared dispatcher thread.
+  void push_back_entry(uint8_t stage,
+                       const event_queue::entry& entry,
+                       absolute_time_point now,
+                       uint32_t manipulator_index) {
+    auto sequence = next_sequence_.load(std::memory_order_relaxed);
+
+    auto& r = records_[sequence & (capacity - 1)];
+    r.sequence = sequence;
+    r.device_id = type_safe::get(entry.get_device_id());
+    r.time_stamp = type_safe::get(entry.get_event_time_stamp().get_time_stamp());
+    r.recorded_at = type_safe::get(now);
+    r.value = 0;
+    r.manipulator_index = manipulator_index;
+    r.stage = stage;
+    r.event = static_cast<uint8_t>(entry.get_event().get_type());
+    r.event_type = static_cast<uint8_t>(entry.get_event_type());
+    r.flags = (entry.get_valid() ? flag_valid : 0) |
+              (entry.get_lazy() ? flag_lazy : 0);
+    r.reserved = 0;
+
+    if (auto v = entry.get_event().find<key_code>()) {
+      r.value = static_cast<uint32_t>(*v);
+    } else if (auto v = entry.get_event().find<consumer_key_code>()) {
+      r.value = static_cast<uint32_t>(*v);
+    } else if (auto v = entry.get_event().find<pointing_button>()) {
+      r.value = static_cast<uint32_t>(*v);
+    }
+
+    next_sequence_.store(sequence + 1, std::memory_order_release);
+  }
+
+  // Return records from the oldest one.
+  std::vector<record> make_snapshot(void) const {
+    return make_snapshot(0);
+  }
+
+  // Return records whose sequence is `begin_sequence` or later.
+  // (Records which are already overwritten are not returned.)
+  std::vector<record> make_snapshot(uint64_t begin_sequence) const {
+    auto end = next_sequence_.load(std::memory_order_acquire);
+    auto begin = std::max(begin_sequence, end > capacity ? end - capacity : 0);
+    if (begin > end) {
+      begin = end;
+    }
+
+    std::vector<record> result;
+    result.reserve(end - begin);
+    for (auto s = begin; s < end; ++s) {
+      result.push_back(records_[s & (capacity - 1)]);
+    }
+    return result;
+  }
+
+  static std::vector<uint8_t> make_binary(const std::vector<record>& records) {
+    file_header h{magic, version, sizeof(record), static_cast<uint32_t>(records.size())};
+
+    std::vector<uint8_t> buffer(sizeof(file_header) + sizeof(record) * records.size());
+    memcpy(buffer.data(), &h, sizeof(h));
+    if (!records.empty()) {
+      memcpy(buffer.data() + sizeof(file_header), records.data(), sizeof(record) * records.size());
+    }
+
+    return buffer;
+  }
+
+  // This method throws std::runtime_error if the buffer is broken.
+  static std::vector<record> read_binary(const std::vector<uint8_t>& buffer) {
+    if (buffer.size() < sizeof(file_header)) {
+      throw std::runtime_error("event_trace: buffer is too short");
+    }
+
+    file_header h;
+    memcpy(&h, buffer.data(), sizeof(h));
+
+    if (h.magic != magic) {
+      throw std::runtime_error("event_trace: invalid magic");
+    }
+    if (h.version != version || h.record_size != sizeof(record)) {
+      throw std::runtime_error(fmt::format("event_trace: unsupported version {0}", h.version));
+    }
+    if (buffer.size() != sizeof(file_header) + sizeof(record) * h.count) {
+      throw std::runtime_error("event_trace: invalid buffer size");
+    }
+
+    std::vector<record> result(h.count);
+    if (h.count > 0) {
+      memcpy(result.data(), buffer.data() + sizeof(file_header), sizeof(record) * h.count);
+    }
+    return result;
+  }
+
+  static nlohmann::json to_json(const record& r) {
+    auto type = static_cast<event_queue::event::type>(r.event);
+
+    nlohmann::json event;
+    switch (type) {
+      case event_queue::event::type::key_code:
+        event = event_queue::event(key_code(r.value)).to_json();
+        break;
+      case event_queue::event::type::consumer_key_code:
+        event = event_queue::event(consumer_key_code(r.value)).to_json();
+        break;
+      case event_queue::event::type::pointing_button:
+        event = event_queue::event(pointing_button(r.value)).to_json();
+        break;
+      default:
+        if (auto s = event_queue::event::to_c_string(type)) {
+          event["type"] = s;
+        }
+        break;
+    }
+
+    nlohmann::json json{
+        {"sequence", r.sequence},
+        {"stage", r.stage},
+        {"device_id", r.device_id},
+        {"time_stamp", r.time_stamp},
+        {"recorded_at", r.recorded_at},
+        {"event", event},
+        {"event_type", static_cast<event_type>(r.event_type)},
+        {"valid", (r.flags & flag_valid) != 0},
+        {"lazy", (r.flags & flag_lazy) != 0},
+    };
+
+    if (r.manipulator_index == invalidated_manipulator) {
+      json["manipulator_invalidated"] = true;
+    } else if (r.manipulator_index != no_manipulator) {
+      json["manipulator_index"] = r.manipulator_index;
+    }
+
+    return json;
+  }
+
+private:
+  std::array<record, capacity> records_;
+  std::atomic<uint64_t> next_sequence_;
+};
+} // namespace manipulator
+} // namespace krbn
@@ -0,0 +1,260 @@
+#pragma once
+
+// `krbn::manipulator::input_source_matcher` can be used safely in a multi-threaded environment.
+
+#include "manipulator_environment.hpp"
+#include <array>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <pqrs/json.hpp>
+#include <regex>
+#include <unordered_map>
+#include <vector>
+
+namespace krbn {
+namespace manipulator {
+// `input_source_matcher` tests patterns of all `input_source` conditions at once.
+//
+// - Patterns (language, input_source_id and input_mode_id) are compiled once and shared among conditions.
+//   (`make_specifier` reads pattern strings from json directly and compiles only patterns which are not shared yet.)
+// - When the input source is changed, all patterns are tested once and the results are stored into a bitset.
+// - Conditions test their specifiers with the bitset without regex evaluation.
+//
+// Patterns are released when all specifiers which refer them are destroyed.
+
+class input_source_matcher final {
+public:
+  enum class field {
+    language,
+    input_source_id,
+    input_mode_id,
+  };
+
+  class pattern final {
+  public:
+    pattern(field field,
+            const std::string& string,
+            size_t index) : field_(field),
+                            regex_(string),
+                            index_(index) {
+    }
+
+    field get_field(void) const {
+      return field_;
+    }
+
+    const std::regex& get_regex(void) const {
+      return regex_;
+    }
+
+    size_t get_index(void) const {
+      return index_;
+    }
+
+  private:
+    field field_;
+    std::regex regex_;
+    size_t index_;
+  };
+
+  class specifier final {
+  public:
+    // All patterns must be matched. (nullptr means any.)
+    std::shared_ptr<pattern> language;
+    std::shared_ptr<pattern> input_source_id;
+    std::shared_ptr<pattern> input_mode_id;
+  };
+
+  input_source_matcher(const input_source_matcher&) = delete;
+
+  input_source_matcher(void) {
+  }
+
+  static std::shared_ptr<input_source_matcher> get_shared_input_source_matcher(void) {
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> guard(mutex);
+
+    static std::shared_ptr<input_source_matcher> matcher;
+    if (!matcher) {
+      matcher = std::make_shared<input_source_matcher>();
+    }
+
+    return matcher;
+  }
+
+  // `json` is an entry of `input_sources`. (e.g., `{"language": "^en$", "input_mode_id": "Roman$"}`)
+  // The json format and error messages are same as `pqrs::osx::input_source_selector::specifier`.
+  specifier make_specifier(const nlohmann::json& json) {
+    using namespace std::string_literals;
+
+    if (!json.is_object()) {
+      throw pqrs::json::unmarshal_error("json must be object, but is `"s + json.dump() + "`"s);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    specifier result;
+
+    for (const auto& [key, value] : json.items()) {
+      std::shared_ptr<pattern>* p = nullptr;
+      field f = field::language;
+
+      if (key == "language") {
+        p = &(result.language);
+        f = field::language;
+      } else if (key == "input_source_id") {
+        p = &(result.input_source_id);
+        f = field::input_source_id;
+      } else if (key == "input_mode_id") {
+        p = &(result.input_mode_id);
+        f = field::input_mode_id;
+      } else {
+        throw pqrs::json::unmarshal_error("unknown key: `"s + key + "`"s);
+      }
+
+      if (!value.is_string()) {
+        throw pqrs::json::unmarshal_error("`"s + key + "` must be string, but is `"s + value.dump() + "`"s);
+      }
+
+      try {
+        *p = make_pattern(f, value.get<std::string>());
+      } catch (std::regex_error& e) {
+        throw pqrs::json::unmarshal_error(e.what() + ": `\""s + key + "\":" + value.dump() + "`"s);
+      }
+    }
+
+    return result;
+  }
+
+  // Return true if any of `specifiers` matches the current input source.
+  bool test(const std::vector<specifier>& specifiers,
+            const manipulator_environment& manipulator_environment) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto generation = manipulator_environment.get_input_source_properties_generation();
+    if (generation_ != generation) {
+      update(manipulator_environment.get_input_source_properties());
+      generation_ = generation;
+    }
+
+    for (const auto& s : specifiers) {
+      if (test(s.language) &&
+          test(s.input_source_id) &&
+          test(s.input_mode_id)) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  size_t get_pattern_count(void) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    size_t count = 0;
+    for (const auto& p : patterns_) {
+      if (!p.expired()) {
+        ++count;
+      }
+    }
+    return count;
+  }
+
+private:
+  // This method must be called under `mutex_`.
+  // This method throws std::regex_error if `string` is not a valid regex.
+  std::shared_ptr<pattern> make_pattern(field field,
+                                        const std::string& string) {
+    auto& map = pattern_maps_[static_cast<size_t>(field)];
+
+    auto it = map.find(string);
+    if (it != std::end(map)) {
+      if (auto p = it->second.lock()) {
+        return p;
+      }
+    }
+
+    // Reuse an index of a released pattern.
+
+    size_t index = 0;
+    for (; index < patterns_.size(); ++index) {
+      if (patterns_[index].expired()) {
+        break;
+      }
+    }
+
+    auto p = std::make_shared<pattern>(field, string, index);
+
+    if (index < patterns_.size()) {
+      patterns_[index] = p;
+    } else {
+      patterns_.push_back(p);
+      matches_.push_back(false);
+    }
+
+    map[string] = p;
+
+    // Remove released patterns from the map.
+
+    for (auto it = std::begin(map); it != std::end(map);) {
+      if (it->second.expired()) {
+        it = map.erase(it);
+      } else {
+        ++it;
+      }
+    }
+
+    // The new pattern is not tested yet.
+
+    generation_ = std::nullopt;
+
+    return p;
+  }
+
+  void update(const pqrs::osx::input_source::properties& properties) {
+    for (size_t i = 0; i < patterns_.size(); ++i) {
+      matches_[i] = false;
+
+      if (auto p = patterns_[i].lock()) {
+        const std::optional<std::string>* v = nullptr;
+        switch (p->get_field()) {
+          case field::language:
+            v = &(properties.get_first_language());
+            break;
+          case field::input_source_id:
+            v = &(properties.get_input_source_id());
+            break;
+          case field::input_mode_id:
+            v = &(properties.get_input_mode_id());
+            break;
+        }
+
+        if (v && *v) {
+          matches_[i] = regex_search(std::begin(**v),
+                                     std::end(**v),
+                                     p->get_regex());
+        }
+      }
+    }
+  }
+
+  bool test(const std::shared_ptr<pattern>& p) const {
+    if (!p) {
+      return true;
+    }
+
+    return matches_[p->get_index()];
+  }
+
+  mutable std::mutex mutex_;
+  std::array<std::unordered_map<std::string, std::weak_ptr<pattern>>, 3> pattern_maps_;
+  // `patterns_[n]` is the pattern whose index is `n`.
+  std::vector<std::weak_ptr<pattern>> patterns_;
+  // `matches_[n]` is the result of `patterns_[n]`.
+  std::vector<bool> matches_;
+  // The input source generation of `matches_`.
+  std::optional<uint64_t> generation_;
+};
+} // namespace manipulator
+} // namespace krbn
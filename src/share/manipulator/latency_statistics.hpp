@@ -0,0 +1,140 @@
+#pragma once
+
+// `krbn::manipulator::latency_statistics` can be used safely in a multi-threaded environment.
+
+#include "event_queue.hpp"
+#include "latency_histogram.hpp"
+#include <mutex>
+#include <pqrs/osx/chrono.hpp>
+
+namespace krbn {
+namespace manipulator {
+// `latency_statistics` collects latencies of input events in the manipulation pipeline.
+//
+// - stages[n]: The input event time stamp -> the entry is processed by the stage n
+//              (the connection n of `manipulator_managers_connector`).
+//              The first stage includes the wait in the input event queue.
+//              The stage which creates the virtual device reports is the "scheduled" time.
+// - posted: The scheduled time of a virtual device report -> the report is sent to the virtual device.
+//
+// Only key_code, consumer_key_code, pointing_button and pointing_motion events are recorded.
+// The count of `needs_wait_until_time_stamp` results is also counted per stage.
+
+class latency_statistics final {
+public:
+  typedef std::function<absolute_time_point(void)> clock;
+
+  latency_statistics(const latency_statistics&) = delete;
+
+  latency_statistics(const std::vector<std::string>& stage_names,
+                     clock clock = pqrs::osx::chrono::mach_absolute_time_point) : clock_(clock),
+                                                                                   stages_(stage_names.size()) {
+    for (size_t i = 0; i < stage_names.size(); ++i) {
+      stages_[i].name = stage_names[i];
+    }
+  }
+
+  absolute_time_point now(void) const {
+    return clock_();
+  }
+
+  static bool target_event(const event_queue::entry& entry) {
+    switch (entry.get_event().get_type()) {
+      case event_queue::event::type::key_code:
+      case event_queue::event::type::consumer_key_code:
+      case event_queue::event::type::pointing_button:
+      case event_queue::event::type::pointing_motion:
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  void record_stage(size_t stage,
+                    const event_queue::entry& entry,
+                    absolute_time_point now) {
+    if (!target_event(entry)) {
+      return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (stage < stages_.size()) {
+      stages_[stage].histogram.record(make_duration(entry.get_event_time_stamp().get_time_stamp(), now));
+    }
+  }
+
+  void record_wait(size_t stage) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (stage < stages_.size()) {
+      ++(stages_[stage].wait_count);
+    }
+  }
+
+  void record_posted(absolute_time_point scheduled_time_stamp,
+                     absolute_time_point now) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    posted_.record(make_duration(scheduled_time_stamp, now));
+  }
+
+  uint64_t get_total_count(void) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    uint64_t count = posted_.get_count();
+    for (const auto& s : stages_) {
+      count += s.histogram.get_count() + s.wait_count;
+    }
+    return count;
+  }
+
+  nlohmann::json to_json(void) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto stages = nlohmann::json::array();
+    for (const auto& s : stages_) {
+      auto json = s.histogram.to_json();
+      json["name"] = s.name;
+      json["needs_wait_until_time_stamp_count"] = s.wait_count;
+      stages.push_back(json);
+    }
+
+    return nlohmann::json::object({
+        {"stages", stages},
+        {"posted", posted_.to_json()},
+    });
+  }
+
+  void clear(void) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    for (auto& s : stages_) {
+      s.histogram.clear();
+      s.wait_count = 0;
+    }
+    posted_.clear();
+  }
+
+private:
+  struct stage final {
+    std::string name;
+    latency_histogram histogram;
+    uint64_t wait_count = 0;
+  };
+
+  static std::chrono::microseconds make_duration(absolute_time_point from,
+                                                 absolute_time_point to) {
+    if (to < from) {
+      return std::chrono::microseconds(0);
+    }
+    return std::chrono::duration_cast<std::chrono::microseconds>(pqrs::osx::chrono::make_nanoseconds(to - from));
+  }
+
+  clock clock_;
+  std::vector<stage> stages_;
+  latency_histogram posted_;
+  mutable std::mutex mutex_;
+};
+} // namespace manipulator
+} // namespace krbn
@@ -0,0 +1,98 @@
+#pragma once
+
+// `krbn::manipulator::manipulator_counters` can be used safely in a multi-threaded environment.
+
+#include "types/manipulate_result.hpp"
+#include <atomic>
+#include <chrono>
+#include <nlohmann/json.hpp>
+
+namespace krbn {
+namespace manipulator {
+// `manipulator_counters` holds the cost of a manipulator.
+//
+// - evaluated: The count of `manipulate` calls.
+// - matched: The count of `manipulate_result::manipulated` results.
+// - needs_wait_until_time_stamp: The count of `manipulate_result::needs_wait_until_time_stamp` results.
+// - nanoseconds: The total time spent in `manipulate`.
+//
+// Counters are updated by `manipulator_manager` only while counters are enabled in the manager.
+
+class manipulator_counters final {
+public:
+  struct values final {
+    uint64_t evaluated = 0;
+    uint64_t matched = 0;
+    uint64_t needs_wait_until_time_stamp = 0;
+    uint64_t nanoseconds = 0;
+
+    values& operator+=(const values& other) {
+      evaluated += other.evaluated;
+      matched += other.matched;
+      needs_wait_until_time_stamp += other.needs_wait_until_time_stamp;
+      nanoseconds += other.nanoseconds;
+      return *this;
+    }
+
+    nlohmann::json to_json(void) const {
+      return nlohmann::json::object({
+          {"evaluated", evaluated},
+          {"matched", matched},
+          {"needs_wait_until_time_stamp", needs_wait_until_time_stamp},
+          {"nanoseconds", nanoseconds},
+      });
+    }
+  };
+
+  manipulator_counters(void) : evaluated_(0),
+                               matched_(0),
+                               needs_wait_until_time_stamp_(0),
+                               nanoseconds_(0) {
+  }
+
+  manipulator_counters(const manipulator_counters&) = delete;
+
+  void record(manipulate_result result,
+              std::chrono::nanoseconds duration) {
+    // Only the manipulate thread updates counters. Thus, relaxed operations are enough.
+
+    evaluated_.fetch_add(1, std::memory_order_relaxed);
+
+    switch (result) {
+      case manipulate_result::passed:
+        break;
+      case manipulate_result::manipulated:
+        matched_.fetch_add(1, std::memory_order_relaxed);
+        break;
+      case manipulate_result::needs_wait_until_time_stamp:
+        needs_wait_until_time_stamp_.fetch_add(1, std::memory_order_relaxed);
+        break;
+    }
+
+    nanoseconds_.fetch_add(duration.count(), std::memory_order_relaxed);
+  }
+
+  values get_values(void) const {
+    values v;
+    v.evaluated = evaluated_.load(std::memory_order_relaxed);
+    v.matched = matched_.load(std::memory_order_relaxed);
+    v.needs_wait_until_time_stamp = needs_wait_until_time_stamp_.load(std::memory_order_relaxed);
+    v.nanoseconds = nanoseconds_.load(std::memory_order_relaxed);
+    return v;
+  }
+
+  void clear(void) {
+    evaluated_.store(0, std::memory_order_relaxed);
+    matched_.store(0, std::memory_order_relaxed);
+    needs_wait_until_time_stamp_.store(0, std::memory_order_relaxed);
+    nanoseconds_.store(0, std::memory_order_relaxed);
+  }
+
+private:
+  std::atomic<uint64_t> evaluated_;
+  std::atomic<uint64_t> matched_;
+  std::atomic<uint64_t> needs_wait_until_time_stamp_;
+  std::atomic<uint64_t> nanoseconds_;
+};
+} // namespace manipulator
+} // namespace krbn
@@ -1,8 +1,9 @@
 #pragma once
 
 #include "device_properties_manager.hpp"
-#include "json_writer.hpp"
 #include "logger.hpp"
+#include "shared_state/publisher.hpp"
+#include <atomic>
 #include <fstream>
 #include <iostream>
 #include <nlohmann/json.hpp>
@@ -17,11 +18,18 @@
 
 namespace krbn {
 namespace manipulator {
+// Values which are referred by conditions have a generation which is changed when the value is changed.
+// Conditions memoize their result with the generation in order to avoid re-evaluation for each event.
+// (Generations are unique among all `manipulator_environment` instances.)
+
 class manipulator_environment final {
 public:
   manipulator_environment(const manipulator_environment&) = delete;
 
-  manipulator_environment(void) : virtual_hid_keyboard_country_code_(0) {
+  manipulator_environment(void) : frontmost_application_generation_(make_generation()),
+                                  input_source_properties_generation_(make_generation()),
+                                  virtual_hid_keyboard_country_code_(0),
+                                  virtual_hid_keyboard_keyboard_type_generation_(make_generation()) {
   }
 
   nlohmann::json to_json(void) const {
@@ -71,8 +79,15 @@ public:
     return frontmost_application_;
   }
 
+  uint64_t get_frontmost_application_generation(void) const {
+    return frontmost_application_generation_;
+  }
+
   void set_frontmost_application(const pqrs::osx::frontmost_application_monitor::application& value) {
-    frontmost_application_ = value;
+    if (frontmost_application_ != value) {
+      frontmost_application_ = value;
+      frontmost_application_generation_ = make_generation();
+    }
     async_save_to_file();
   }
 
@@ -80,8 +95,15 @@ public:
     return input_source_properties_;
   }
 
+  uint64_t get_input_source_properties_generation(void) const {
+    return input_source_properties_generation_;
+  }
+
   void set_input_source_properties(const pqrs::osx::input_source::properties& value) {
-    input_source_properties_ = value;
+    if (input_source_properties_ != value) {
+      input_source_properties_ = value;
+      input_source_properties_generation_ = make_generation();
+    }
     async_save_to_file();
   }
 
@@ -123,10 +145,21 @@ public:
     return virtual_hid_keyboard_keyboard_type_;
   }
 
+  uint64_t get_virtual_hid_keyboard_keyboard_type_generation(void) const {
+    return virtual_hid_keyboard_keyboard_type_generation_;
+  }
+
 private:
+  static uint64_t make_generation(void) {
+    static std::atomic<uint64_t> generation(0);
+    return ++generation;
+  }
+
   void async_save_to_file(void) const {
     if (!output_json_file_path_.empty()) {
-      json_writer::async_save_to_file(to_json(), output_json_file_path_, 0755, 0644);
+      shared_state::publisher::async_publish(shared_state::segment::region::manipulator_environment,
+                                             to_json(),
+                                             output_json_file_path_);
     }
   }
 
@@ -137,21 +170,28 @@ private:
         virtual_hid_keyboard_country_code_);
     auto& keyboard_types = system_preferences_properties_.get_keyboard_types();
     auto it = keyboard_types.find(key);
+    std::string keyboard_type;
     if (it != std::end(keyboard_types)) {
-      virtual_hid_keyboard_keyboard_type_ = pqrs::osx::make_iokit_keyboard_type_string(it->second);
-    } else {
-      virtual_hid_keyboard_keyboard_type_.clear();
+      keyboard_type = pqrs::osx::make_iokit_keyboard_type_string(it->second);
+    }
+
+    if (virtual_hid_keyboard_keyboard_type_ != keyboard_type) {
+      virtual_hid_keyboard_keyboard_type_ = keyboard_type;
+      virtual_hid_keyboard_keyboard_type_generation_ = make_generation();
     }
   }
 
   std::string output_json_file_path_;
   device_properties_manager device_properties_manager_;
   pqrs::osx::frontmost_application_monitor::application frontmost_application_;
+  uint64_t frontmost_application_generation_;
   pqrs::osx::input_source::properties input_source_properties_;
+  uint64_t input_source_properties_generation_;
   std::unordered_map<std::string, int> variables_;
   pqrs::osx::system_preferences::properties system_preferences_properties_;
   hid_country_code virtual_hid_keyboard_country_code_;
   std::string virtual_hid_keyboard_keyboard_type_; // cache value
+  uint64_t virtual_hid_keyboard_keyboard_type_generation_;
 };
 } // namespace manipulator
 } // namespace krbn
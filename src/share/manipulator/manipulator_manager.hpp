@@ -1,6 +1,10 @@
 #pragma once
 
+#include "manipulator/event_trace.hpp"
+#include "manipulator/latency_statistics.hpp"
 #include "manipulator/manipulator_factory.hpp"
+#include "manipulator/manipulator_order_optimizer.hpp"
+#include <unordered_set>
 
 namespace krbn {
 namespace manipulator {
@@ -8,7 +12,7 @@ class manipulator_manager final {
 public:
   manipulator_manager(const manipulator_manager&) = delete;
 
-  manipulator_manager(void) {
+  manipulator_manager(void) : counters_enabled_(false) {
   }
 
   ~manipulator_manager(void) {
@@ -24,6 +28,8 @@ public:
         std::lock_guard<std::mutex> lock(manipulators_mutex_);
 
         manipulators_.push_back(m);
+        reset_order_optimizer();
+        update_trace_manipulator_indices();
       }
 
     } catch (const pqrs::json::unmarshal_error& e) {
@@ -38,15 +44,86 @@ public:
     std::lock_guard<std::mutex> lock(manipulators_mutex_);
 
     manipulators_.push_back(ptr);
+    reset_order_optimizer();
+    update_trace_manipulator_indices();
   }
 
+  // Replace the current manipulators with `manipulators` at once.
+  //
+  // Manipulators which are contained in both the current manipulators and `manipulators` are kept as is (with their state).
+  // The other current manipulators are invalidated and they are kept at the front until they become inactive
+  // (same as `invalidate_manipulators` + `push_back_manipulator`).
+  // Manipulators in `manipulators` are marked as valid even if they were invalidated before (e.g., reused from a profile cache).
+
+  void replace_manipulators(const std::vector<std::shared_ptr<manipulators::base>>& manipulators) {
+    std::lock_guard<std::mutex> lock(manipulators_mutex_);
+
+    std::unordered_set<std::shared_ptr<manipulators::base>> new_manipulators(std::begin(manipulators),
+                                                                             std::end(manipulators));
+
+    std::vector<std::shared_ptr<manipulators::base>> result;
+    result.reserve(manipulators.size());
+
+    for (auto&& m : manipulators_) {
+      if (new_manipulators.find(m) == std::end(new_manipulators)) {
+        m->set_valid(false);
+
+        // Keep active manipulators.
+        if (m->active()) {
+          result.push_back(m);
+        }
+      }
+    }
+
+    for (const auto& m : manipulators) {
+      m->set_valid(true);
+      result.push_back(m);
+    }
+
+    manipulators_ = std::move(result);
+    reset_order_optimizer();
+    update_trace_manipulator_indices();
+  }
+
+  // `manipulator_counters` of manipulators are updated in `manipulate` while counters are enabled.
+  // (Counters are not touched and `manipulate` is not timed while counters are disabled.)
+
+  void set_counters_enabled(bool value) {
+    counters_enabled_ = value;
+  }
+
+  bool get_counters_enabled(void) const {
+    return counters_enabled_;
+  }
+
+  // key_down events are evaluated in the order of `manipulator_order_optimizer` while the order optimization is enabled.
+  // The result is same as the rule order.
+
+  void set_order_optimization_enabled(bool value,
+                                      uint64_t reorder_interval = manipulator_order_optimizer::default_reorder_interval) {
+    std::lock_guard<std::mutex> lock(manipulators_mutex_);
+
+    if (value) {
+      order_optimizer_ = std::make_unique<manipulator_order_optimizer>(reorder_interval);
+    } else {
+      order_optimizer_ = nullptr;
+    }
+  }
+
+  // Processed entries are recorded into `trace` and `statistics` as `stage` if they are not nullptr.
+  // The manipulator index in `trace` is the index in the valid manipulators (see `update_trace_manipulator_indices`).
+
   void manipulate(std::weak_ptr<event_queue::queue> weak_input_event_queue,
                   std::weak_ptr<event_queue::queue> weak_output_event_queue,
-                  absolute_time_point now) {
+                  absolute_time_point now,
+                  event_trace* trace = nullptr,
+                  latency_statistics* statistics = nullptr,
+                  uint8_t stage = 0) {
     if (auto input_event_queue = weak_input_event_queue.lock()) {
       if (auto output_event_queue = weak_output_event_queue.lock()) {
         while (!input_event_queue->empty()) {
           auto& front_input_event = input_event_queue->get_front_event();
+          auto manipulator_index = event_trace::no_manipulator;
 
           switch (front_input_event.get_event().get_type()) {
             case event_queue::event::type::device_keys_and_pointing_buttons_are_released:
@@ -126,27 +203,79 @@ public:
               if (!skip) {
                 std::lock_guard<std::mutex> lock(manipulators_mutex_);
 
-                for (auto&& m : manipulators_) {
-                  auto r = m->manipulate(front_input_event,
-                                         *input_event_queue,
-                                         output_event_queue,
-                                         now);
+                bool counters_enabled = counters_enabled_;
+
+                const std::vector<size_t>* order = nullptr;
+                if (order_optimizer_) {
+                  order = order_optimizer_->find_order(front_input_event, manipulators_);
+                }
+                std::optional<size_t> matched_position;
+
+                auto size = order ? order->size() : manipulators_.size();
+                for (size_t n = 0; n < size; ++n) {
+                  auto i = order ? (*order)[n] : n;
+                  auto r = manipulate_result::passed;
+
+                  if (counters_enabled) {
+                    auto start = std::chrono::steady_clock::now();
+
+                    r = manipulators_[i]->manipulate(front_input_event,
+                                                     *input_event_queue,
+                                                     output_event_queue,
+                                                     now);
+
+                    manipulators_[i]->get_counters().record(r, std::chrono::steady_clock::now() - start);
+
+                  } else {
+                    r = manipulators_[i]->manipulate(front_input_event,
+                                                     *input_event_queue,
+                                                     output_event_queue,
+                                                     now);
+                  }
 
                   switch (r) {
                     case manipulate_result::passed:
-                    case manipulate_result::manipulated:
                       // Do nothing
                       break;
 
+                    case manipulate_result::manipulated:
+                      if (!matched_position) {
+                        if (trace) {
+                          manipulator_index = trace_manipulator_indices_[i];
+                        }
+                        matched_position = n;
+                      }
+                      break;
+
                     case manipulate_result::needs_wait_until_time_stamp:
+                      if (statistics) {
+                        statistics->record_wait(stage);
+                      }
                       goto finish;
                   }
                 }
+
+                if (order) {
+                  order_optimizer_->record(front_input_event.get_event(), matched_position);
+                }
               }
               break;
             }
           }
 
+          if (trace) {
+            trace->push_back_entry(stage,
+                                   input_event_queue->get_front_event(),
+                                   now,
+                                   manipulator_index);
+          }
+
+          if (statistics) {
+            statistics->record_stage(stage,
+                                     input_event_queue->get_front_event(),
+                                     statistics->now());
+          }
+
           if (input_event_queue->get_front_event().get_valid()) {
             output_event_queue->push_back_entry(input_event_queue->get_front_event());
           }
@@ -167,6 +296,7 @@ public:
       for (auto&& m : manipulators_) {
         m->set_valid(false);
       }
+      update_trace_manipulator_indices();
     }
 
     remove_invalid_manipulators();
@@ -189,9 +319,38 @@ public:
   }
 
 private:
+  // This method must be called under `manipulators_mutex_`.
+  void reset_order_optimizer(void) {
+    if (order_optimizer_) {
+      order_optimizer_->clear();
+    }
+  }
+
+  // Update `trace_manipulator_indices_` after `manipulators_` or their validity are changed.
+  // `trace_manipulator_indices_[i]` is the index of `manipulators_[i]` in the valid manipulators.
+  // The index is stable while the manipulators are not replaced since invalidated manipulators are excluded.
+  // (The valid manipulators are same as the `replace_manipulators` argument.)
+  //
+  // This method must be called under `manipulators_mutex_`.
+  void update_trace_manipulator_indices(void) {
+    trace_manipulator_indices_.resize(manipulators_.size());
+
+    uint32_t index = 0;
+    for (size_t i = 0; i < manipulators_.size(); ++i) {
+      if (manipulators_[i]->get_valid()) {
+        trace_manipulator_indices_[i] = index;
+        ++index;
+      } else {
+        trace_manipulator_indices_[i] = event_trace::invalidated_manipulator;
+      }
+    }
+  }
+
   void remove_invalid_manipulators(void) {
     std::lock_guard<std::mutex> lock(manipulators_mutex_);
 
+    auto size = manipulators_.size();
+
     manipulators_.erase(std::remove_if(std::begin(manipulators_),
                                        std::end(manipulators_),
                                        [](const auto& it) {
@@ -199,10 +358,19 @@ private:
                                          return !it->get_valid() && !it->active();
                                        }),
                         std::end(manipulators_));
+
+    if (manipulators_.size() != size) {
+      reset_order_optimizer();
+      update_trace_manipulator_indices();
+    }
   }
 
   std::vector<std::shared_ptr<manipulators::base>> manipulators_;
+  // The event trace index of each manipulator in `manipulators_`.
+  std::vector<uint32_t> trace_manipulator_indices_;
   mutable std::mutex manipulators_mutex_;
+  std::atomic<bool> counters_enabled_;
+  std::unique_ptr<manipulator_order_optimizer> order_optimizer_;
 };
 } // namespace manipulator
 } // namespace krbn
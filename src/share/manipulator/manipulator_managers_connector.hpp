@@ -27,11 +27,17 @@ public:
       return weak_output_event_queue_;
     }
 
-    void manipulate(absolute_time_point now) const {
+    void manipulate(absolute_time_point now,
+                    event_trace* trace,
+                    latency_statistics* statistics,
+                    uint8_t stage) const {
       if (auto manipulator_manager = weak_manipulator_manager_.lock()) {
         manipulator_manager->manipulate(weak_input_event_queue_,
                                         weak_output_event_queue_,
-                                        now);
+                                        now,
+                                        trace,
+                                        statistics,
+                                        stage);
       }
     }
 
@@ -98,11 +104,31 @@ public:
                               weak_output_event_queue);
   }
 
+  // Entries are recorded into `event_trace` with the connection index as the stage.
+  void set_event_trace(std::weak_ptr<event_trace> value) {
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+
+    weak_event_trace_ = value;
+  }
+
+  // Latencies are recorded into `latency_statistics` with the connection index as the stage.
+  void set_latency_statistics(std::weak_ptr<latency_statistics> value) {
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+
+    weak_latency_statistics_ = value;
+  }
+
   void manipulate(absolute_time_point now) const {
     std::lock_guard<std::mutex> lock(connections_mutex_);
 
-    for (auto&& c : connections_) {
-      c.manipulate(now);
+    auto trace = weak_event_trace_.lock();
+    auto statistics = weak_latency_statistics_.lock();
+
+    for (size_t i = 0; i < connections_.size(); ++i) {
+      connections_[i].manipulate(now,
+                                 trace.get(),
+                                 statistics.get(),
+                                 static_cast<uint8_t>(i));
     }
   }
 
@@ -150,6 +176,8 @@ public:
 
 private:
   std::vector<connection> connections_;
+  std::weak_ptr<event_trace> weak_event_trace_;
+  std::weak_ptr<latency_statistics> weak_latency_statistics_;
   mutable std::mutex connections_mutex_;
 };
 } // namespace manipulator
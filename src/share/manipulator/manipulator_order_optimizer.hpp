@@ -0,0 +1,275 @@
+#pragma once
+
+#include "event_queue.hpp"
+#include "manipulator/conditions/variable.hpp"
+#include "manipulator/manipulators/basic/basic.hpp"
+#include <unordered_map>
+
+namespace krbn {
+namespace manipulator {
+// `manipulator_order_optimizer` decides the order in which `manipulator_manager` evaluates manipulators for key_down events.
+//
+// Manipulators are evaluated in the rule order and the first matched manipulator wins.
+// For key_down events of key_code, consumer_key_code and pointing_button, the optimizer makes a per-key order which
+// gives the same result as the rule order:
+//
+// - Manipulators which never react to the key are skipped.
+//   (basic manipulators whose `from` does not match the key and which have no to_if_alone, to_if_held_down and to_delayed_action.)
+// - Frequently matched manipulators are moved forward by swapping adjacent manipulators which commute for the key:
+//   - Both are basic manipulators without to_delayed_action (`to_delayed_action` posts events when it is canceled by any key_down).
+//   - Neither is a simultaneous `from` which matches the key (it might return `needs_wait_until_time_stamp`).
+//   - One of them does not match the key, or they never match the same key_down event.
+//     (A mandatory modifier of one is not allowed in the other, or they have contradicting variable conditions.)
+//
+// Other events (key_up, pointing_motion, ...) are evaluated in the rule order.
+//
+// `manipulator_manager` uses `manipulator_order_optimizer` under its mutex.
+// `clear` must be called when manipulators are changed.
+
+class manipulator_order_optimizer final {
+public:
+  manipulator_order_optimizer(const manipulator_order_optimizer&) = delete;
+
+  static constexpr uint64_t default_reorder_interval = 64;
+
+  // Manipulators are reordered every `reorder_interval` key_down events of each key.
+  manipulator_order_optimizer(uint64_t reorder_interval = default_reorder_interval) : reorder_interval_(reorder_interval) {
+  }
+
+  void clear(void) {
+    infos_.clear();
+    orders_.clear();
+  }
+
+  // Return manipulator indices in the evaluation order.
+  // Return nullptr if `entry` should be evaluated in the rule order.
+  const std::vector<size_t>* find_order(const event_queue::entry& entry,
+                                        const std::vector<std::shared_ptr<manipulators::base>>& manipulators) {
+    if (!target_event(entry)) {
+      return nullptr;
+    }
+
+    if (infos_.size() != manipulators.size()) {
+      make_infos(manipulators);
+    }
+
+    auto it = orders_.find(entry.get_event());
+    if (it == std::end(orders_)) {
+      it = orders_.emplace(entry.get_event(), make_order(entry.get_event())).first;
+    }
+
+    return &(it->second.indices);
+  }
+
+  // Record the result of the event which is evaluated in the order of `find_order`.
+  // `position` is the position of the matched manipulator in the order. (std::nullopt if no manipulator is matched.)
+  void record(const event_queue::event& event,
+              std::optional<size_t> position) {
+    auto it = orders_.find(event);
+    if (it == std::end(orders_)) {
+      return;
+    }
+
+    auto& o = it->second;
+
+    if (position && *position < o.hit_counts.size()) {
+      ++(o.hit_counts[*position]);
+    }
+
+    if (++(o.event_count) >= reorder_interval_) {
+      reorder(event, o);
+    }
+  }
+
+  static bool target_event(const event_queue::entry& entry) {
+    if (entry.get_event_type() != event_type::key_down) {
+      return false;
+    }
+
+    const auto& e = entry.get_event();
+    return e.get_key_code() ||
+           e.get_consumer_key_code() ||
+           e.get_pointing_button();
+  }
+
+private:
+  struct info final {
+    // nullptr if the manipulator is not basic.
+    const manipulators::basic::basic* basic = nullptr;
+    // The manipulator might change its state or post events for unmatched key_down events.
+    bool stateful = true;
+    std::vector<const conditions::variable*> variable_conditions;
+  };
+
+  struct order final {
+    std::vector<size_t> indices;
+    // `hit_counts[n]` is the count of `indices[n]`.
+    std::vector<uint64_t> hit_counts;
+    uint64_t event_count = 0;
+  };
+
+  void make_infos(const std::vector<std::shared_ptr<manipulators::base>>& manipulators) {
+    clear();
+
+    for (const auto& m : manipulators) {
+      info i;
+
+      if (auto b = dynamic_cast<const manipulators::basic::basic*>(m.get())) {
+        i.basic = b;
+        i.stateful = !b->get_to_if_alone().empty() ||
+                     b->get_to_if_held_down() ||
+                     b->get_to_delayed_action();
+
+        for (const auto& c : b->get_condition_manager().get_conditions()) {
+          if (auto v = dynamic_cast<const conditions::variable*>(c.get())) {
+            i.variable_conditions.push_back(v);
+          }
+        }
+      }
+
+      infos_.push_back(std::move(i));
+    }
+  }
+
+  order make_order(const event_queue::event& event) const {
+    order o;
+
+    for (size_t i = 0; i < infos_.size(); ++i) {
+      if (infos_[i].stateful ||
+          matches(event, infos_[i])) {
+        o.indices.push_back(i);
+      }
+    }
+
+    o.hit_counts.resize(o.indices.size(), 0);
+
+    return o;
+  }
+
+  void reorder(const event_queue::event& event,
+               order& o) const {
+    // Insertion sort by hit counts with adjacent swaps of commutable manipulators.
+
+    for (size_t i = 1; i < o.indices.size(); ++i) {
+      for (size_t j = i; j > 0; --j) {
+        if (o.hit_counts[j] <= o.hit_counts[j - 1] ||
+            !commutable(event, infos_[o.indices[j - 1]], infos_[o.indices[j]])) {
+          break;
+        }
+
+        std::swap(o.indices[j], o.indices[j - 1]);
+        std::swap(o.hit_counts[j], o.hit_counts[j - 1]);
+      }
+    }
+
+    // Decay counts in order to follow recent usage.
+
+    for (auto& c : o.hit_counts) {
+      c /= 2;
+    }
+    o.event_count = 0;
+  }
+
+  static bool matches(const event_queue::event& event,
+                      const info& info) {
+    if (!info.basic) {
+      return true;
+    }
+
+    return manipulators::basic::from_event_definition::test_event(event, info.basic->get_from());
+  }
+
+  static bool commutable(const event_queue::event& event,
+                         const info& a,
+                         const info& b) {
+    if (!a.basic || !b.basic ||
+        a.basic->get_to_delayed_action() ||
+        b.basic->get_to_delayed_action()) {
+      return false;
+    }
+
+    auto a_matches = matches(event, a);
+    auto b_matches = matches(event, b);
+
+    if ((a_matches && a.basic->get_from().get_event_definitions().size() > 1) ||
+        (b_matches && b.basic->get_from().get_event_definitions().size() > 1)) {
+      return false;
+    }
+
+    if (!a_matches || !b_matches) {
+      return true;
+    }
+
+    return disjoint_modifiers(a.basic->get_from().get_from_modifiers_definition(),
+                              b.basic->get_from().get_from_modifiers_definition()) ||
+           disjoint_modifiers(b.basic->get_from().get_from_modifiers_definition(),
+                              a.basic->get_from().get_from_modifiers_definition()) ||
+           disjoint_conditions(a, b);
+  }
+
+  // Return true if a mandatory modifier of `a` is not allowed in `b`.
+  static bool disjoint_modifiers(const from_modifiers_definition& a,
+                                 const from_modifiers_definition& b) {
+    const auto& b_mandatory = b.get_mandatory_modifiers();
+    const auto& b_optional = b.get_optional_modifiers();
+
+    if (b_mandatory.find(modifier_definition::modifier::any) != std::end(b_mandatory) ||
+        b_optional.find(modifier_definition::modifier::any) != std::end(b_optional)) {
+      return false;
+    }
+
+    std::unordered_set<modifier_flag> b_allowed;
+    for (const auto& modifiers : {b_mandatory, b_optional}) {
+      for (const auto& m : modifiers) {
+        for (const auto& f : modifier_definition::get_modifier_flags(m)) {
+          b_allowed.insert(f);
+        }
+      }
+    }
+
+    for (const auto& m : a.get_mandatory_modifiers()) {
+      auto flags = modifier_definition::get_modifier_flags(m);
+      if (!flags.empty() &&
+          std::none_of(std::begin(flags),
+                       std::end(flags),
+                       [&](auto& f) {
+                         return b_allowed.find(f) != std::end(b_allowed);
+                       })) {
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  // Return true if `a` and `b` have variable conditions which are never fulfilled at the same time.
+  static bool disjoint_conditions(const info& a,
+                                  const info& b) {
+    for (const auto& x : a.variable_conditions) {
+      for (const auto& y : b.variable_conditions) {
+        if (x->get_name() != y->get_name()) {
+          continue;
+        }
+
+        if (x->get_type() == conditions::variable::type::variable_if &&
+            y->get_type() == conditions::variable::type::variable_if &&
+            x->get_value() != y->get_value()) {
+          return true;
+        }
+
+        if (x->get_type() != y->get_type() &&
+            x->get_value() == y->get_value()) {
+          return true;
+        }
+      }
+    }
+
+    return false;
+  }
+
+  uint64_t reorder_interval_;
+  std::vector<info> infos_;
+  std::unordered_map<event_queue::event, order> orders_;
+};
+} // namespace manipulator
+} // namespace krbn
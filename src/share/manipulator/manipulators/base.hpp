@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../condition_manager.hpp"
+#include "../manipulator_counters.hpp"
 #include "../types.hpp"
 #include "event_queue.hpp"
 #include "modifier_flag_manager.hpp"
@@ -38,6 +39,11 @@ public:
   virtual void handle_pointing_device_event_from_event_tap(const event_queue::entry& front_input_event,
                                                            event_queue::queue& output_event_queue) = 0;
 
+  // The estimated size of the manipulator object and its definitions (including conditions).
+  // The runtime state (e.g., queued events) is not included.
+  // It is used for the memory accounting of compiled manipulators. (e.g., `complex_modifications_profile_cache`)
+  virtual size_t get_memory_size(void) const = 0;
+
   bool get_valid(void) const {
     return valid_;
   }
@@ -45,10 +51,22 @@ public:
     valid_ = value;
   }
 
+  manipulator_counters& get_counters(void) {
+    return counters_;
+  }
+
+  const manipulator_counters& get_counters(void) const {
+    return counters_;
+  }
+
   void push_back_condition(std::shared_ptr<manipulator::conditions::base> condition) {
     condition_manager_.push_back_condition(condition);
   }
 
+  const condition_manager& get_condition_manager(void) const {
+    return condition_manager_;
+  }
+
   static void post_lazy_modifier_key_events(const std::unordered_set<modifier_flag>& modifiers,
                                             event_type event_type,
                                             device_id device_id,
@@ -75,6 +93,7 @@ public:
 protected:
   bool valid_;
   condition_manager condition_manager_;
+  manipulator_counters counters_;
 };
 } // namespace manipulators
 } // namespace manipulator
@@ -662,6 +662,26 @@ public:
                           front_input_event.get_event_type());
   }
 
+  virtual size_t get_memory_size(void) const {
+    size_t size = sizeof(*this) +
+                  condition_manager_.get_memory_size() +
+                  from_.get_event_definitions().capacity() * sizeof(event_definition) +
+                  (to_.capacity() + to_after_key_up_.capacity() + to_if_alone_.capacity()) * sizeof(to_event_definition) +
+                  manipulated_original_events_.capacity() * sizeof(std::shared_ptr<manipulated_original_event::manipulated_original_event>);
+
+    if (to_if_held_down_) {
+      size += sizeof(to_if_held_down) +
+              to_if_held_down_->get_to().capacity() * sizeof(to_event_definition);
+    }
+
+    if (to_delayed_action_) {
+      size += sizeof(to_delayed_action) +
+              (to_delayed_action_->get_to_if_invoked().capacity() + to_delayed_action_->get_to_if_canceled().capacity()) * sizeof(to_event_definition);
+    }
+
+    return size;
+  }
+
   const from_event_definition& get_from(void) const {
     return from_;
   }
@@ -3,6 +3,7 @@
 #include "../../types.hpp"
 #include "../base.hpp"
 #include "counter.hpp"
+#include "dispatcher_utility.hpp"
 #include "krbn_notification_center.hpp"
 #include <nlohmann/json.hpp>
 #include <pqrs/dispatcher.hpp>
@@ -61,12 +62,15 @@ public:
         }
       }
 
-      counter_ = std::make_unique<counter>(weak_dispatcher_,
+      // The counter runs its timer on the background dispatcher and hands scroll events back to this dispatcher.
+      counter_ = std::make_unique<counter>(dispatcher_utility::get_background_dispatcher_or_shared_dispatcher(),
                                            parameters,
                                            options_);
 
       counter_->scroll_event_arrived.connect([this](auto&& pointing_motion) {
-        post_events(pointing_motion);
+        enqueue_to_dispatcher([this, pointing_motion] {
+          post_events(pointing_motion);
+        });
       });
 
     } catch (...) {
@@ -149,6 +153,12 @@ public:
                                                            event_queue::queue& output_event_queue) {
   }
 
+  virtual size_t get_memory_size(void) const {
+    return sizeof(*this) +
+           condition_manager_.get_memory_size() +
+           (counter_ ? sizeof(counter) : 0);
+  }
+
 private:
   std::shared_ptr<std::unordered_set<modifier_flag>> test_conditions(const event_queue::entry& front_input_event,
                                                                      std::shared_ptr<event_queue::queue> output_event_queue) const {
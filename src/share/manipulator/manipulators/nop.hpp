@@ -45,6 +45,11 @@ public:
   virtual void handle_pointing_device_event_from_event_tap(const event_queue::entry& front_input_event,
                                                            event_queue::queue& output_event_queue) {
   }
+
+  virtual size_t get_memory_size(void) const {
+    return sizeof(*this) +
+           condition_manager_.get_memory_size();
+  }
 };
 } // namespace manipulators
 } // namespace manipulator
@@ -367,14 +367,24 @@ public:
     // This manipulator is always valid.
   }
 
+  virtual size_t get_memory_size(void) const {
+    return sizeof(*this) +
+           condition_manager_.get_memory_size();
+  }
+
   void async_post_events(std::weak_ptr<virtual_hid_device_client> weak_virtual_hid_device_client) {
     enqueue_to_dispatcher(
         [this, weak_virtual_hid_device_client] {
           queue_.async_post_events(weak_virtual_hid_device_client,
-                                   weak_console_user_server_client_);
+                                   weak_console_user_server_client_,
+                                   weak_latency_statistics_);
         });
   }
 
+  void set_latency_statistics(std::weak_ptr<latency_statistics> value) {
+    weak_latency_statistics_ = value;
+  }
+
   const queue& get_queue(void) const {
     return queue_;
   }
@@ -389,6 +399,7 @@ public:
 
 private:
   std::weak_ptr<console_user_server_client> weak_console_user_server_client_;
+  std::weak_ptr<latency_statistics> weak_latency_statistics_;
 
   queue queue_;
   key_event_dispatcher key_event_dispatcher_;
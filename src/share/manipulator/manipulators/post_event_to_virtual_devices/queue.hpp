@@ -1,6 +1,7 @@
 #pragma once
 
 #include "keyboard_repeat_detector.hpp"
+#include "manipulator/latency_statistics.hpp"
 #include "types.hpp"
 #include "virtual_hid_device_client.hpp"
 #include "virtual_hid_device_utility.hpp"
@@ -394,9 +395,10 @@ public:
   }
 
   void async_post_events(std::weak_ptr<virtual_hid_device_client> weak_virtual_hid_device_client,
-                         std::weak_ptr<console_user_server_client> weak_console_user_server_client) {
+                         std::weak_ptr<console_user_server_client> weak_console_user_server_client,
+                         std::weak_ptr<latency_statistics> weak_latency_statistics = std::weak_ptr<latency_statistics>()) {
     enqueue_to_dispatcher(
-        [this, weak_virtual_hid_device_client, weak_console_user_server_client] {
+        [this, weak_virtual_hid_device_client, weak_console_user_server_client, weak_latency_statistics] {
           auto now = pqrs::osx::chrono::mach_absolute_time_point();
 
           while (!events_.empty()) {
@@ -411,15 +413,31 @@ public:
               }
 
               enqueue_to_dispatcher(
-                  [this, weak_virtual_hid_device_client, weak_console_user_server_client] {
+                  [this, weak_virtual_hid_device_client, weak_console_user_server_client, weak_latency_statistics] {
                     async_post_events(weak_virtual_hid_device_client,
-                                      weak_console_user_server_client);
+                                      weak_console_user_server_client,
+                                      weak_latency_statistics);
                   },
                   when_now() + pqrs::osx::chrono::make_milliseconds(duration));
 
               return;
             }
 
+            switch (e.get_type()) {
+              case event::type::keyboard_input:
+              case event::type::consumer_input:
+              case event::type::apple_vendor_top_case_input:
+              case event::type::apple_vendor_keyboard_input:
+              case event::type::pointing_input:
+                if (auto statistics = weak_latency_statistics.lock()) {
+                  statistics->record_posted(e.get_time_stamp(), statistics->now());
+                }
+                break;
+              case event::type::shell_command:
+              case event::type::select_input_source:
+                break;
+            }
+
             if (auto input = e.get_keyboard_input()) {
               if (auto client = weak_virtual_hid_device_client.lock()) {
                 client->async_post_keyboard_input_report(*input);
@@ -4,6 +4,7 @@
 
 #include "constants.hpp"
 #include "core_configuration/core_configuration.hpp"
+#include "dispatcher_utility.hpp"
 #include "logger.hpp"
 #include <nod/nod.hpp>
 #include <pqrs/osx/file_monitor.hpp>
@@ -19,6 +20,8 @@ public:
 
   configuration_monitor(const std::string& user_core_configuration_file_path,
                         const std::string& system_core_configuration_file_path = constants::get_system_core_configuration_file_path()) : dispatcher_client() {
+    background_dispatcher_client_ = std::make_unique<pqrs::dispatcher::extra::dispatcher_client>(dispatcher_utility::get_background_dispatcher());
+
     std::vector<std::string> targets = {
         user_core_configuration_file_path,
         system_core_configuration_file_path,
@@ -52,35 +55,74 @@ public:
         }
       }
 
-      if (pqrs::filesystem::exists(file_path)) {
-        logger::get_logger()->info("Load {0}...", file_path);
+      // Use the file body which is already read by file_monitor in order to avoid reading the file again.
+
+      std::shared_ptr<const std::vector<uint8_t>> file_body;
+      if (file_path == changed_file_path) {
+        file_body = changed_file_body;
       }
 
-      auto c = std::make_shared<core_configuration::core_configuration>(file_path);
+      // Parse the file in the background dispatcher in order to avoid blocking the shared dispatcher.
 
-      if (core_configuration_ && !c->is_loaded()) {
-        return;
-      }
+      enqueue_to_background_dispatcher([this, file_path, file_body]() mutable {
+        // `core_configuration_` and `core_configuration_file_path_` are updated only in the background dispatcher.
 
-      if (core_configuration_ && core_configuration_->to_json() == c->to_json()) {
-        return;
-      }
+        // Skip reloading if the content of the file is not changed.
 
-      {
-        std::lock_guard<std::mutex> lock(core_configuration_mutex_);
+        if (core_configuration_ &&
+            core_configuration_file_path_ == file_path) {
+          auto& fingerprint = core_configuration_->get_file_fingerprint();
 
-        core_configuration_ = c;
-      }
+          if (!file_body) {
+            if (fingerprint.same_file_status(file_path)) {
+              return;
+            }
+            file_body = pqrs::osx::file_monitor::read_file(file_path);
+          }
 
-      logger::get_logger()->info("core_configuration is updated.");
+          if (fingerprint == file_fingerprint::make(file_path, file_body)) {
+            return;
+          }
+        }
+
+        if (pqrs::filesystem::exists(file_path)) {
+          logger::get_logger()->info("Load {0}...", file_path);
+        }
 
-      enqueue_to_dispatcher([this, c] {
-        core_configuration_updated(c);
+        auto c = std::make_shared<core_configuration::core_configuration>(file_path,
+                                                                          file_body);
+
+        if (core_configuration_ && !c->is_loaded()) {
+          return;
+        }
+
+        // Skip reloading if the configuration is not changed semantically.
+        // (e.g., only whitespace or the key order is changed, or the file is saved again by an editor.)
+
+        if (core_configuration_ && core_configuration_->to_json() == c->to_json()) {
+          return;
+        }
+
+        {
+          std::lock_guard<std::mutex> lock(core_configuration_mutex_);
+
+          core_configuration_ = c;
+        }
+        core_configuration_file_path_ = file_path;
+
+        logger::get_logger()->info("core_configuration is updated.");
+
+        enqueue_to_dispatcher([this, c] {
+          core_configuration_updated(c);
+        });
       });
     });
   }
 
   virtual ~configuration_monitor(void) {
+    // Wait the running background task.
+    background_dispatcher_client_->detach_from_dispatcher();
+
     detach_from_dispatcher([this] {
       file_monitor_ = nullptr;
     });
@@ -97,9 +139,20 @@ public:
   }
 
 private:
+  void enqueue_to_background_dispatcher(const std::function<void(void)>& function) const {
+    if (background_dispatcher_client_->attached()) {
+      background_dispatcher_client_->enqueue_to_dispatcher(function);
+    } else {
+      // The background dispatcher is not initialized.
+      function();
+    }
+  }
+
+  std::unique_ptr<pqrs::dispatcher::extra::dispatcher_client> background_dispatcher_client_;
   std::unique_ptr<pqrs::osx::file_monitor> file_monitor_;
 
   std::shared_ptr<core_configuration::core_configuration> core_configuration_;
   mutable std::mutex core_configuration_mutex_;
+  std::string core_configuration_file_path_;
 };
 } // namespace krbn
@@ -4,10 +4,13 @@
 
 #include "connected_devices/connected_devices.hpp"
 #include "logger.hpp"
+#include "monitor/shared_state_monitor.hpp"
 #include <nod/nod.hpp>
-#include <pqrs/osx/file_monitor.hpp>
 
 namespace krbn {
+// `connected_devices_monitor` reads the devices region of the shared state segment which is published by karabiner_grabber.
+// (`devices_json_file_path` is read only if the region is unavailable in the segment.)
+
 class connected_devices_monitor final : pqrs::dispatcher::extra::dispatcher_client {
 public:
   // Signals (invoked from the shared dispatcher thread)
@@ -16,23 +19,22 @@ public:
 
   // Methods
 
-  connected_devices_monitor(const std::string& devices_json_file_path) : dispatcher_client() {
-    std::vector<std::string> targets = {
-        devices_json_file_path,
-    };
-
-    file_monitor_ = std::make_unique<pqrs::osx::file_monitor>(weak_dispatcher_,
-                                                              targets);
-
-    file_monitor_->file_changed.connect([this](auto&& changed_file_path,
-                                               auto&& changed_file_body) {
-      if (pqrs::filesystem::exists(changed_file_path)) {
-        logger::get_logger()->info("Load {0}...", changed_file_path);
-      }
-
-      auto c = std::make_shared<connected_devices::connected_devices>(changed_file_path);
-
-      if (connected_devices_ && !c->is_loaded()) {
+  connected_devices_monitor(const std::string& shared_state_name,
+                            const std::string& devices_json_file_path,
+                            uid_t owner_uid = 0) : dispatcher_client() {
+    shared_state_monitor_ = std::make_unique<shared_state_monitor>(
+        shared_state_name,
+        std::vector<std::pair<shared_state::segment::region, std::string>>({
+            {shared_state::segment::region::devices, devices_json_file_path},
+        }),
+        owner_uid);
+
+    shared_state_monitor_->state_changed.connect([this](auto&& region, auto&& json) {
+      std::shared_ptr<connected_devices::connected_devices> c;
+      try {
+        c = std::make_shared<connected_devices::connected_devices>(connected_devices::connected_devices::make_from_json(*json));
+      } catch (std::exception& e) {
+        logger::get_logger()->error("connected_devices_monitor error: {0}", e.what());
         return;
       }
 
@@ -52,12 +54,12 @@ public:
 
   virtual ~connected_devices_monitor(void) {
     detach_from_dispatcher([this] {
-      file_monitor_ = nullptr;
+      shared_state_monitor_ = nullptr;
     });
   }
 
-  void async_start() {
-    file_monitor_->async_start();
+  void async_start(std::chrono::milliseconds interval = std::chrono::milliseconds(500)) {
+    shared_state_monitor_->async_start(interval);
   }
 
   std::shared_ptr<connected_devices::connected_devices> get_connected_devices(void) const {
@@ -67,7 +69,7 @@ public:
   }
 
 private:
-  std::unique_ptr<pqrs::osx::file_monitor> file_monitor_;
+  std::unique_ptr<shared_state_monitor> shared_state_monitor_;
 
   std::shared_ptr<connected_devices::connected_devices> connected_devices_;
   mutable std::mutex connected_devices_mutex_;
@@ -3,6 +3,7 @@
 // `krbn::grabber_alerts_monitor` can be used safely in a multi-threaded environment.
 
 #include "constants.hpp"
+#include "file_fingerprint.hpp"
 #include "logger.hpp"
 #include <fstream>
 #include <nod/nod.hpp>
@@ -32,6 +33,13 @@ public:
     file_monitor_->file_changed.connect([this](auto&& changed_file_path,
                                                auto&& changed_file_body) {
       if (changed_file_body) {
+        // Skip parsing if the content is not changed.
+        auto fingerprint = file_fingerprint::make(changed_file_path, changed_file_body);
+        if (last_fingerprint_ == fingerprint) {
+          return;
+        }
+        last_fingerprint_ = fingerprint;
+
         try {
           auto json = nlohmann::json::parse(*changed_file_body);
 
@@ -44,15 +52,10 @@ public:
           // }
 
           if (auto v = pqrs::json::find_array(json, "alerts")) {
-            auto s = v->value().dump();
-            if (last_json_string_ != s) {
-              last_json_string_ = s;
-
-              auto alerts = std::make_shared<nlohmann::json>(v->value());
-              enqueue_to_dispatcher([this, alerts] {
-                alerts_changed(alerts);
-              });
-            }
+            auto alerts = std::make_shared<nlohmann::json>(v->value());
+            enqueue_to_dispatcher([this, alerts] {
+              alerts_changed(alerts);
+            });
           }
         } catch (std::exception& e) {
           logger::get_logger()->error("parse error in {0}: {1}", changed_file_path, e.what());
@@ -73,6 +76,6 @@ public:
 
 private:
   std::unique_ptr<pqrs::osx::file_monitor> file_monitor_;
-  std::optional<std::string> last_json_string_;
+  file_fingerprint last_fingerprint_;
 };
 } // namespace krbn
@@ -0,0 +1,52 @@
+#pragma once
+
+// `krbn::log_monitor` can be used safely in a multi-threaded environment.
+
+#include "log_tail_reader.hpp"
+#include <nod/nod.hpp>
+#include <pqrs/dispatcher.hpp>
+
+namespace krbn {
+// `log_monitor` polls log files and notifies only new lines.
+// The first notification contains the last `max_line_count` lines of the existing log files.
+
+class log_monitor final : public pqrs::dispatcher::extra::dispatcher_client {
+public:
+  // Signals (invoked from the shared dispatcher thread)
+
+  nod::signal<void(std::shared_ptr<std::deque<std::string>> lines)> new_log_line_arrived;
+
+  // Methods
+
+  log_monitor(const log_monitor&) = delete;
+
+  log_monitor(const std::vector<std::string>& target_file_paths,
+              size_t max_line_count) : dispatcher_client(),
+                                       reader_(target_file_paths, max_line_count),
+                                       timer_(*this) {
+  }
+
+  virtual ~log_monitor(void) {
+    detach_from_dispatcher([this] {
+      timer_.stop();
+    });
+  }
+
+  void async_start(std::chrono::milliseconds interval) {
+    enqueue_to_dispatcher([this, interval] {
+      timer_.start(
+          [this] {
+            auto lines = reader_.read_new_lines();
+            if (!lines->empty()) {
+              new_log_line_arrived(lines);
+            }
+          },
+          interval);
+    });
+  }
+
+private:
+  log_tail_reader reader_;
+  pqrs::dispatcher::extra::timer timer_;
+};
+} // namespace krbn
@@ -0,0 +1,111 @@
+#pragma once
+
+// `krbn::shared_state_monitor` can be used safely in a multi-threaded environment.
+
+#include "shared_state/segment.hpp"
+#include <fstream>
+#include <nod/nod.hpp>
+#include <pqrs/dispatcher.hpp>
+#include <unordered_map>
+
+namespace krbn {
+// `shared_state_monitor` polls generation numbers of the shared state segment
+// and notifies only changed regions.
+// The segment is reopened when the writer (karabiner_grabber) is restarted.
+// If a region is unavailable in the segment (e.g., the document is too large), the json file of the region is read instead.
+
+class shared_state_monitor final : public pqrs::dispatcher::extra::dispatcher_client {
+public:
+  // Signals (invoked from the shared dispatcher thread)
+
+  nod::signal<void(shared_state::segment::region, std::shared_ptr<nlohmann::json>)> state_changed;
+
+  // Methods
+
+  shared_state_monitor(const shared_state_monitor&) = delete;
+
+  // `regions` is a list of pairs of a region and the json file path of the region.
+  shared_state_monitor(const std::string& segment_name,
+                       const std::vector<std::pair<shared_state::segment::region, std::string>>& regions,
+                       uid_t owner_uid = 0) : dispatcher_client(),
+                                              segment_name_(segment_name),
+                                              regions_(regions),
+                                              owner_uid_(owner_uid),
+                                              timer_(*this) {
+  }
+
+  virtual ~shared_state_monitor(void) {
+    detach_from_dispatcher([this] {
+      timer_.stop();
+      segment_ = nullptr;
+    });
+  }
+
+  void async_start(std::chrono::milliseconds interval) {
+    enqueue_to_dispatcher([this, interval] {
+      timer_.start(
+          [this] {
+            check();
+          },
+          interval);
+    });
+  }
+
+private:
+  void check(void) {
+    if (segment_ && segment_->closed()) {
+      segment_ = nullptr;
+    }
+
+    if (!segment_) {
+      segment_ = shared_state::segment::open(segment_name_, owner_uid_);
+      if (!segment_) {
+        return;
+      }
+      generations_.clear();
+    }
+
+    for (const auto& [r, json_file_path] : regions_) {
+      // Skip the copy if the region is not changed.
+      auto g = segment_->get_generation(r);
+      if (g == 0 || generations_[r] == g) {
+        continue;
+      }
+
+      std::vector<uint8_t> bytes;
+      if (auto generation = segment_->read_bytes(r, bytes)) {
+        generations_[r] = *generation;
+
+        try {
+          std::shared_ptr<nlohmann::json> json;
+          if (!bytes.empty()) {
+            json = std::make_shared<nlohmann::json>(nlohmann::json::from_msgpack(bytes));
+          } else {
+            std::ifstream input(json_file_path);
+            if (!input) {
+              logger::get_logger()->warn("shared_state_monitor {0} is unavailable and {1} is not found.",
+                                         shared_state::segment::to_string(r),
+                                         json_file_path);
+              continue;
+            }
+            json = std::make_shared<nlohmann::json>(nlohmann::json::parse(input));
+          }
+          state_changed(r, json);
+        } catch (std::exception& e) {
+          logger::get_logger()->error("shared_state_monitor {0} parse error: {1}",
+                                      shared_state::segment::to_string(r),
+                                      e.what());
+        }
+      }
+    }
+  }
+
+  std::string segment_name_;
+  std::vector<std::pair<shared_state::segment::region, std::string>> regions_;
+  uid_t owner_uid_;
+  pqrs::dispatcher::extra::timer timer_;
+
+  std::unique_ptr<shared_state::segment> segment_;
+  std::unordered_map<shared_state::segment::region, uint64_t> generations_;
+};
+} // namespace krbn
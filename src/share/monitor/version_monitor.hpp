@@ -3,6 +3,7 @@
 // `krbn::version_monitor` can be used safely in a multi-threaded environment.
 
 #include "constants.hpp"
+#include "file_fingerprint.hpp"
 #include "logger.hpp"
 #include <fstream>
 #include <nod/nod.hpp>
@@ -13,7 +14,7 @@
 namespace krbn {
 class version_monitor final : public pqrs::dispatcher::extra::dispatcher_client {
 public:
-  // Signals (invoked from the shared dispatcher thread)
+  // Signals (invoked from the dispatcher thread)
 
   nod::signal<void(const std::string& version)> changed;
 
@@ -21,8 +22,11 @@ public:
 
   version_monitor(const version_monitor&) = delete;
 
-  version_monitor(const std::string& version_file_path) : version_file_path_(version_file_path) {
-    version_ = pqrs::osx::file_monitor::read_file(version_file_path_);
+  version_monitor(const std::string& version_file_path,
+                  std::weak_ptr<pqrs::dispatcher::dispatcher> weak_dispatcher = pqrs::dispatcher::extra::get_shared_dispatcher()) : dispatcher_client(weak_dispatcher),
+                                                                                                                                  version_file_path_(version_file_path) {
+    version_fingerprint_ = file_fingerprint::make(version_file_path_,
+                                                  pqrs::osx::file_monitor::read_file(version_file_path_));
 
     std::vector<std::string> targets = {
         version_file_path_,
@@ -34,11 +38,8 @@ public:
     file_monitor_->file_changed.connect([this](auto&& changed_file_path,
                                                auto&& changed_file_body) {
       if (changed_file_body) {
-        if (version_) {
-          if (*version_ == *changed_file_body) {
-            return;
-          }
-        } else if (!version_ && !changed_file_body) {
+        auto fingerprint = file_fingerprint::make(changed_file_path, changed_file_body);
+        if (version_fingerprint_ == fingerprint) {
           return;
         }
 
@@ -48,7 +49,7 @@ public:
 
         logger::get_logger()->info("Version is changed to {0}", version_string);
 
-        version_ = changed_file_body;
+        version_fingerprint_ = fingerprint;
 
         enqueue_to_dispatcher([this, version_string] {
           changed(version_string);
@@ -74,7 +75,7 @@ public:
 private:
   std::string version_file_path_;
 
-  std::shared_ptr<std::vector<uint8_t>> version_;
+  file_fingerprint version_fingerprint_;
   std::unique_ptr<pqrs::osx::file_monitor> file_monitor_;
 };
 } // namespace krbn
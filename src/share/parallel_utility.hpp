@@ -0,0 +1,53 @@
+#pragma once
+
+// `krbn::parallel_utility` can be used safely in a multi-threaded environment.
+
+#include <algorithm>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace krbn {
+class parallel_utility final {
+public:
+  // Split [0, count) into ranges and call `function(begin, end)` for each range in parallel.
+  //
+  // - Each worker handles at least `min_count_per_worker` elements
+  //   since starting threads costs more than handling a few elements.
+  // - The current thread is also used as a worker.
+  // - `function` must write only its own range of results.
+  //
+  // Returns the number of workers.
+  template <typename T>
+  static size_t for_each_range(size_t count,
+                               size_t min_count_per_worker,
+                               T function) {
+    size_t worker_count = std::max(1u, std::thread::hardware_concurrency());
+    worker_count = std::min(worker_count,
+                            (count + min_count_per_worker - 1) / min_count_per_worker);
+    if (worker_count <= 1) {
+      function(0, count);
+      return 1;
+    }
+
+    auto chunk_size = (count + worker_count - 1) / worker_count;
+
+    std::vector<std::future<void>> futures;
+    for (size_t begin = chunk_size; begin < count; begin += chunk_size) {
+      futures.push_back(std::async(std::launch::async,
+                                   function,
+                                   begin,
+                                   std::min(begin + chunk_size, count)));
+    }
+
+    // Use the current thread as a worker.
+    function(0, chunk_size);
+
+    for (auto&& f : futures) {
+      f.get();
+    }
+
+    return futures.size() + 1;
+  }
+};
+} // namespace krbn
@@ -0,0 +1,4 @@
+#pragma once
+
+#include "shared_state/publisher.hpp"
+#include "shared_state/segment.hpp"
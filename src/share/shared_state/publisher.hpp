@@ -0,0 +1,88 @@
+#pragma once
+
+// `krbn::shared_state::publisher` can be used safely in a multi-threaded environment.
+
+#include "async_file_writer.hpp"
+#include "dispatcher_utility.hpp"
+#include "segment.hpp"
+
+namespace krbn {
+namespace shared_state {
+// `publisher` updates the shared state segment of the process.
+//
+// State documents are serialized and published in the file writer thread.
+// The json file of the document is written only when the segment cannot hold it:
+//
+// - `initialize` is not called. (e.g., in other processes and tests.)
+// - The document exceeds `segment::region_capacity`.
+//   The region is marked as unavailable after the json file is written so that readers fall back to the file.
+
+class publisher final {
+public:
+  publisher(const publisher&) = delete;
+  publisher(void) = delete;
+
+  static void initialize(const std::string& name) {
+    std::lock_guard<std::mutex> lock(get_mutex());
+
+    get_segment() = segment::create(name);
+    if (get_segment()) {
+      logger::get_logger()->info("shared_state::publisher is initialized: {0}", name);
+    }
+  }
+
+  static void terminate(void) {
+    // Wait pending `async_publish`.
+    async_file_writer::wait();
+
+    std::lock_guard<std::mutex> lock(get_mutex());
+
+    get_segment() = nullptr;
+  }
+
+  // `json` is moved into a shared_ptr in order to avoid deep copies of json in the caller thread.
+  static void async_publish(segment::region region,
+                            nlohmann::json json,
+                            const std::string& json_file_path) {
+    auto shared_json = std::make_shared<const nlohmann::json>(std::move(json));
+
+    dispatcher_utility::enqueue_to_file_writer_dispatcher([region, shared_json, json_file_path] {
+      const auto& json = *shared_json;
+
+      std::lock_guard<std::mutex> lock(get_mutex());
+
+      if (get_segment()) {
+        if (get_segment()->publish(region, json) != segment::publish_result::too_large) {
+          return;
+        }
+      }
+
+      if (!json_file_path.empty()) {
+        async_file_writer::write(json_file_path,
+                                 [&json] {
+                                   return json.dump(4);
+                                 },
+                                 0755,
+                                 0644);
+      }
+
+      // Notify readers that the json file is updated.
+      if (get_segment()) {
+        get_segment()->publish_unavailable(region);
+      }
+    });
+  }
+
+private:
+  static std::mutex& get_mutex(void) {
+    static std::mutex mutex;
+    return mutex;
+  }
+
+  static std::unique_ptr<segment>& get_segment(void) {
+    static std::unique_ptr<segment> segment;
+    return segment;
+  }
+};
+} // namespace shared_state
+} // namespace krbn
@@ -0,0 +1,443 @@
+#pragma once
+
+// `krbn::shared_state::segment` can be used safely in a multi-threaded environment
+// if `publish` and `publish_unavailable` are called from a single thread.
+
+#include "logger.hpp"
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <nlohmann/json.hpp>
+#include <optional>
+#include <random>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace krbn {
+namespace shared_state {
+// `segment` publishes state documents of karabiner_grabber to other processes via POSIX shared memory.
+//
+// Layout:
+//
+//   header
+//   region_header, payload (region_capacity bytes)  (devices)
+//   region_header, payload (region_capacity bytes)  (device_details)
+//   ...
+//
+// Each region is protected by a seqlock.
+// The writer increments `sequence` to an odd number before updating the payload and to an even number after that.
+// Readers copy the payload and retry if `sequence` is changed during the copy.
+// `sequence / 2` is the generation number of the region. (0 means the region is not published yet.)
+//
+// Payloads are MessagePack encoded json documents.
+// An empty payload means the document is unavailable in the segment (e.g., it exceeds `region_capacity`).
+// Readers fall back to the json file of the document in that case.
+
+class segment final {
+public:
+  enum class region : uint32_t {
+    devices,
+    device_details,
+    grabber_alerts,
+    manipulator_environment,
+    rule_statistics,
+    end_,
+  };
+
+  enum class publish_result {
+    published,
+    unchanged,
+    too_large,
+  };
+
+  static constexpr uint32_t magic = 0x6b726273; // krbs
+  static constexpr uint32_t version = 2;
+  static constexpr uint32_t region_count = static_cast<uint32_t>(region::end_);
+  static constexpr uint32_t region_capacity = 256 * 1024;
+
+  segment(const segment&) = delete;
+
+  ~segment(void) {
+    if (owner_) {
+      get_header()->closed.store(1, std::memory_order_release);
+
+      // Do not unlink the segment if the name is already used by a new segment.
+      if (same_segment(name_, get_header()->instance_id)) {
+        shm_unlink(name_.c_str());
+      }
+    }
+
+    munmap(address_, get_segment_size());
+  }
+
+  // Create a new segment for the writer.
+  // An existing segment which has the same name is replaced.
+  // (`name` must be shorter than 31 characters on macOS.)
+  static std::unique_ptr<segment> create(const std::string& name) {
+    shm_unlink(name.c_str());
+
+    int fd = -1;
+    for (int i = 0; i < max_create_retry_count; ++i) {
+      fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+      if (fd >= 0 || errno != EEXIST) {
+        break;
+      }
+
+      // Another process created the segment between `shm_unlink` and `shm_open`.
+      logger::get_logger()->warn("shared_state::segment {0} is created by another process. Retrying...", name);
+      shm_unlink(name.c_str());
+    }
+    if (fd < 0) {
+      logger::get_logger()->error("shared_state::segment shm_open error: {0} {1}", name, strerror(errno));
+      return nullptr;
+    }
+
+    // Ignore umask.
+    fchmod(fd, 0644);
+
+    if (ftruncate(fd, get_segment_size()) != 0) {
+      logger::get_logger()->error("shared_state::segment ftruncate error: {0} {1}", name, strerror(errno));
+      close(fd);
+      shm_unlink(name.c_str());
+      return nullptr;
+    }
+
+    auto address = mmap(nullptr, get_segment_size(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (address == MAP_FAILED) {
+      logger::get_logger()->error("shared_state::segment mmap error: {0} {1}", name, strerror(errno));
+      shm_unlink(name.c_str());
+      return nullptr;
+    }
+
+    auto h = new (address) header();
+    h->writer_pid = getpid();
+    h->instance_id = std::random_device()();
+    h->instance_id = (h->instance_id << 32) | std::random_device()();
+    for (uint32_t i = 0; i < region_count; ++i) {
+      new (static_cast<uint8_t*>(address) + get_region_offset(i)) region_header();
+    }
+
+    // Publish the header after regions are initialized.
+    h->version = version;
+    h->region_count = region_count;
+    h->region_capacity = region_capacity;
+    std::atomic_thread_fence(std::memory_order_release);
+    h->magic = magic;
+
+    return std::unique_ptr<segment>(new segment(name, address, true));
+  }
+
+  // Open an existing segment as a reader.
+  // Return nullptr if the segment does not exist, the layout is not compatible or the segment is not owned by `owner_uid`.
+  // (The owner is checked in order to ignore a segment which is created by a non-privileged process instead of karabiner_grabber.)
+  static std::unique_ptr<segment> open(const std::string& name,
+                                       uid_t owner_uid = 0) {
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+      return nullptr;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 ||
+        static_cast<size_t>(st.st_size) < get_segment_size()) {
+      close(fd);
+      return nullptr;
+    }
+
+    if (st.st_uid != owner_uid) {
+      close(fd);
+      return nullptr;
+    }
+
+    auto address = mmap(nullptr, get_segment_size(), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (address == MAP_FAILED) {
+      return nullptr;
+    }
+
+    auto h = static_cast<const header*>(address);
+    if (h->magic != magic ||
+        h->version != version ||
+        h->region_count != region_count ||
+        h->region_capacity != region_capacity) {
+      munmap(address, get_segment_size());
+      return nullptr;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    return std::unique_ptr<segment>(new segment(name, address, false));
+  }
+
+  static std::string to_string(region r) {
+    switch (r) {
+      case region::devices:
+        return "devices";
+      case region::device_details:
+        return "device_details";
+      case region::grabber_alerts:
+        return "grabber_alerts";
+      case region::manipulator_environment:
+        return "manipulator_environment";
+      case region::rule_statistics:
+        return "rule_statistics";
+      case region::end_:
+        break;
+    }
+    return "";
+  }
+
+  const std::string& get_name(void) const {
+    return name_;
+  }
+
+  // Return true if the writer closed the segment or the writer process is terminated.
+  // Readers should reopen the segment in this case.
+  bool closed(void) const {
+    auto h = get_header();
+    if (h->closed.load(std::memory_order_acquire)) {
+      return true;
+    }
+
+    if (!owner_ &&
+        kill(h->writer_pid, 0) != 0 &&
+        errno == ESRCH) {
+      return true;
+    }
+
+    return false;
+  }
+
+  uint64_t get_generation(region r) const {
+    return get_region_header(r)->sequence.load(std::memory_order_acquire) / 2;
+  }
+
+  // Update the region if the content is changed.
+  // If the document exceeds `region_capacity`, the region is marked as unavailable instead of keeping the previous payload.
+  publish_result publish(region r, const nlohmann::json& json) {
+    auto bytes = nlohmann::json::to_msgpack(json);
+    if (bytes.size() > region_capacity) {
+      logger::get_logger()->error("shared_state::segment {0} is too large: {1} bytes",
+                                  to_string(r),
+                                  bytes.size());
+      write_payload(r, nullptr, 0);
+      return publish_result::too_large;
+    }
+
+    auto h = get_region_header(r);
+    auto payload = get_payload(r);
+
+    // Only the writer updates regions. Thus we can compare the payload without the seqlock.
+    auto sequence = h->sequence.load(std::memory_order_relaxed);
+    if (sequence > 0 &&
+        h->size == bytes.size() &&
+        memcmp(payload, bytes.data(), bytes.size()) == 0) {
+      return publish_result::unchanged;
+    }
+
+    write_payload(r, bytes.data(), bytes.size());
+
+    return publish_result::published;
+  }
+
+  // Mark the region as unavailable and increment the generation.
+  // Call this method after the json file of the document is updated in order to notify readers.
+  void publish_unavailable(region r) {
+    write_payload(r, nullptr, 0);
+  }
+
+  // Copy the payload of the region into `bytes` and return the generation of the copied payload.
+  // Return std::nullopt if the region is not published yet or a consistent copy is not taken.
+  // `bytes` is empty if the region is unavailable.
+  std::optional<uint64_t> read_bytes(region r, std::vector<uint8_t>& bytes) const {
+    auto h = get_region_header(r);
+    auto payload = get_payload(r);
+
+    for (int i = 0; i < max_read_retry_count; ++i) {
+      auto sequence1 = h->sequence.load(std::memory_order_acquire);
+      if (sequence1 == 0) {
+        return std::nullopt;
+      }
+      if (sequence1 % 2 == 1) {
+        std::this_thread::yield();
+        continue;
+      }
+
+      auto size = std::min(h->size, region_capacity);
+      bytes.resize(size);
+      memcpy(bytes.data(), payload, size);
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+      auto sequence2 = h->sequence.load(std::memory_order_relaxed);
+      if (sequence1 == sequence2) {
+        return sequence1 / 2;
+      }
+    }
+
+    return std::nullopt;
+  }
+
+  // Return std::nullopt if the region is not published yet or unavailable.
+  std::optional<nlohmann::json> read(region r) const {
+    std::vector<uint8_t> bytes;
+    if (read_bytes(r, bytes) && !bytes.empty()) {
+      try {
+        return nlohmann::json::from_msgpack(bytes);
+      } catch (std::exception& e) {
+        logger::get_logger()->error("shared_state::segment {0} parse error: {1}", to_string(r), e.what());
+      }
+    }
+    return std::nullopt;
+  }
+
+  // Wait until the generation of the region becomes greater than `generation`.
+  // Return the new generation or std::nullopt if timeout.
+  std::optional<uint64_t> wait_for_generation(region r,
+                                              uint64_t generation,
+                                              std::chrono::milliseconds timeout,
+                                              std::chrono::milliseconds interval = std::chrono::milliseconds(1)) const {
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (true) {
+      auto g = get_generation(r);
+      if (g > generation) {
+        return g;
+      }
+      if (std::chrono::steady_clock::now() >= deadline) {
+        return std::nullopt;
+      }
+      std::this_thread::sleep_for(interval);
+    }
+  }
+
+  // Export all published regions as a json object for compatibility.
+  // ("value" is omitted if the region is unavailable.)
+  //
+  // {
+  //     "devices": {"generation": 3, "value": [...]},
+  //     ...
+  // }
+  nlohmann::json to_json(void) const {
+    auto json = nlohmann::json::object();
+    for (uint32_t i = 0; i < region_count; ++i) {
+      auto r = static_cast<region>(i);
+      std::vector<uint8_t> bytes;
+      if (auto g = read_bytes(r, bytes)) {
+        auto j = nlohmann::json::object({
+            {"generation", *g},
+        });
+        if (!bytes.empty()) {
+          try {
+            j["value"] = nlohmann::json::from_msgpack(bytes);
+          } catch (std::exception& e) {
+            logger::get_logger()->error("shared_state::segment {0} parse error: {1}", to_string(r), e.what());
+            continue;
+          }
+        }
+        json[to_string(r)] = j;
+      }
+    }
+    return json;
+  }
+
+private:
+  static constexpr int max_read_retry_count = 1000;
+  static constexpr int max_create_retry_count = 3;
+
+  struct header final {
+    uint32_t magic = 0;
+    uint32_t version = 0;
+    uint32_t region_count = 0;
+    uint32_t region_capacity = 0;
+    std::atomic<uint32_t> closed{0};
+    pid_t writer_pid = 0;
+    uint64_t instance_id = 0;
+  };
+
+  struct region_header final {
+    // odd: the payload is being updated.
+    std::atomic<uint64_t> sequence{0};
+    uint32_t size = 0;
+  };
+
+  static_assert(std::atomic<uint64_t>::is_always_lock_free);
+  static_assert(std::atomic<uint32_t>::is_always_lock_free);
+
+  // Regions are aligned to the cache line size.
+  static constexpr size_t alignment = 64;
+
+  static constexpr size_t align(size_t size) {
+    return (size + alignment - 1) / alignment * alignment;
+  }
+
+  static constexpr size_t get_region_offset(uint32_t index) {
+    return align(sizeof(header)) + index * align(align(sizeof(region_header)) + region_capacity);
+  }
+
+  static constexpr size_t get_segment_size(void) {
+    return get_region_offset(region_count);
+  }
+
+  segment(const std::string& name,
+          void* address,
+          bool owner) : name_(name),
+                        address_(address),
+                        owner_(owner) {
+  }
+
+  static bool same_segment(const std::string& name, uint64_t instance_id) {
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+      return false;
+    }
+
+    auto address = mmap(nullptr, sizeof(header), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (address == MAP_FAILED) {
+      return false;
+    }
+
+    auto result = (static_cast<const header*>(address)->instance_id == instance_id);
+    munmap(address, sizeof(header));
+    return result;
+  }
+
+  header* get_header(void) const {
+    return static_cast<header*>(address_);
+  }
+
+  region_header* get_region_header(region r) const {
+    return reinterpret_cast<region_header*>(static_cast<uint8_t*>(address_) + get_region_offset(static_cast<uint32_t>(r)));
+  }
+
+  uint8_t* get_payload(region r) const {
+    return reinterpret_cast<uint8_t*>(get_region_header(r)) + align(sizeof(region_header));
+  }
+
+  void write_payload(region r, const uint8_t* data, size_t size) {
+    auto h = get_region_header(r);
+    auto sequence = h->sequence.load(std::memory_order_relaxed);
+
+    h->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    h->size = static_cast<uint32_t>(size);
+    if (size > 0) {
+      memcpy(get_payload(r), data, size);
+    }
+
+    h->sequence.store(sequence + 2, std::memory_order_release);
+  }
+
+  std::string name_;
+  void* address_;
+  bool owner_;
+};
+} // namespace shared_state
+} // namespace krbn
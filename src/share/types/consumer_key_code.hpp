@@ -1,6 +1,7 @@
 #pragma once
 
 #include "hid_value.hpp"
+#include "name_value_table.hpp"
 #include "stream_utility.hpp"
 #include <IOKit/hid/IOHIDUsageTables.h>
 #include <cstdint>
@@ -24,9 +25,6 @@ enum class consumer_key_code : uint32_t {
 
 namespace impl {
 inline const std::vector<std::pair<std::string, consumer_key_code>>& get_consumer_key_code_name_value_pairs(void) {
-  static std::mutex mutex;
-  std::lock_guard<std::mutex> guard(mutex);
-
   static std::vector<std::pair<std::string, consumer_key_code>> pairs({
       {"power", consumer_key_code::power},
       {"display_brightness_increment", consumer_key_code::display_brightness_increment},
@@ -45,45 +43,20 @@ inline const std::vector<std::pair<std::string, consumer_key_code>>& get_consume
   return pairs;
 }
 
-inline const std::unordered_map<std::string, consumer_key_code>& get_consumer_key_code_name_value_map(void) {
-  static std::mutex mutex;
-  std::lock_guard<std::mutex> guard(mutex);
-
-  static std::unordered_map<std::string, consumer_key_code> map;
-
-  if (map.empty()) {
-    for (const auto& pair : get_consumer_key_code_name_value_pairs()) {
-      auto it = map.find(pair.first);
-      if (it != std::end(map)) {
-        throw std::logic_error(
-            fmt::format("duplicate entry in get_consumer_key_code_name_value_pairs: {0}",
-                        pair.first));
-      } else {
-        map.emplace(pair.first, pair.second);
-      }
-    }
-  }
+inline const name_value_table<consumer_key_code>& get_consumer_key_code_name_value_table(void) {
+  // The initialization of function-local static variables is thread-safe.
+  static name_value_table<consumer_key_code> table(get_consumer_key_code_name_value_pairs());
 
-  return map;
+  return table;
 }
 } // namespace impl
 
 inline std::optional<consumer_key_code> make_consumer_key_code(const std::string& name) {
-  auto& map = impl::get_consumer_key_code_name_value_map();
-  auto it = map.find(name);
-  if (it == map.end()) {
-    return std::nullopt;
-  }
-  return it->second;
+  return impl::get_consumer_key_code_name_value_table().find_value(name);
 }
 
 inline std::string make_consumer_key_code_name(consumer_key_code consumer_key_code) {
-  for (const auto& pair : impl::get_consumer_key_code_name_value_pairs()) {
-    if (pair.second == consumer_key_code) {
-      return pair.first;
-    }
-  }
-  return fmt::format("(number:{0})", static_cast<uint32_t>(consumer_key_code));
+  return impl::get_consumer_key_code_name_value_table().make_name(consumer_key_code);
 }
 
 inline std::optional<consumer_key_code> make_consumer_key_code(hid_usage_page usage_page, hid_usage usage) {
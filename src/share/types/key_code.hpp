@@ -2,6 +2,7 @@
 
 #include "hid_value.hpp"
 #include "modifier_flag.hpp"
+#include "name_value_table.hpp"
 #include "stream_utility.hpp"
 
 namespace krbn {
@@ -142,9 +143,6 @@ enum class key_code : uint32_t {
 namespace impl {
 // string -> hid usage map
 inline const std::vector<std::pair<std::string, key_code>>& get_key_code_name_value_pairs(void) {
-  static std::mutex mutex;
-  std::lock_guard<std::mutex> guard(mutex);
-
   static std::vector<std::pair<std::string, key_code>> pairs({
       // From IOHIDUsageTables.h
       {"a", key_code(kHIDUsage_KeyboardA)},
@@ -364,45 +362,20 @@ inline const std::vector<std::pair<std::string, key_code>>& get_key_code_name_va
   return pairs;
 }
 
-inline const std::unordered_map<std::string, key_code>& get_key_code_name_value_map(void) {
-  static std::mutex mutex;
-  std::lock_guard<std::mutex> guard(mutex);
-
-  static std::unordered_map<std::string, key_code> map;
-
-  if (map.empty()) {
-    for (const auto& pair : impl::get_key_code_name_value_pairs()) {
-      auto it = map.find(pair.first);
-      if (it != std::end(map)) {
-        throw std::logic_error(
-            fmt::format("duplicate entry in get_key_code_name_value_pairs: {0}",
-                        pair.first));
-      } else {
-        map.emplace(pair.first, pair.second);
-      }
-    }
-  }
+inline const name_value_table<key_code>& get_key_code_name_value_table(void) {
+  // The initialization of function-local static variables is thread-safe.
+  static name_value_table<key_code> table(get_key_code_name_value_pairs());
 
-  return map;
+  return table;
 }
 } // namespace impl
 
 inline std::string make_key_code_name(key_code key_code) {
-  for (const auto& pair : impl::get_key_code_name_value_pairs()) {
-    if (pair.second == key_code) {
-      return pair.first;
-    }
-  }
-  return fmt::format("(number:{0})", static_cast<uint32_t>(key_code));
+  return impl::get_key_code_name_value_table().make_name(key_code);
 }
 
 inline std::optional<key_code> make_key_code(const std::string& name) {
-  auto& map = impl::get_key_code_name_value_map();
-  auto it = map.find(name);
-  if (it == map.end()) {
-    return std::nullopt;
-  }
-  return it->second;
+  return impl::get_key_code_name_value_table().find_value(name);
 }
 
 inline std::optional<key_code> make_key_code(hid_usage_page usage_page, hid_usage usage) {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Karabiner-VirtualHIDDevice/dist/include/karabiner_virtual_hid_device_methods.hpp"
+#include "name_value_table.hpp"
 #include <cstdint>
 
 namespace krbn {
@@ -20,6 +21,42 @@ enum class modifier_flag : uint32_t {
   end_,
 };
 
+namespace impl {
+inline const std::vector<std::pair<std::string, modifier_flag>>& get_modifier_flag_name_value_pairs(void) {
+  static std::vector<std::pair<std::string, modifier_flag>> pairs({
+      {"zero", modifier_flag::zero},
+      {"caps_lock", modifier_flag::caps_lock},
+      {"left_control", modifier_flag::left_control},
+      {"left_shift", modifier_flag::left_shift},
+      {"left_option", modifier_flag::left_option},
+      {"left_command", modifier_flag::left_command},
+      {"right_control", modifier_flag::right_control},
+      {"right_shift", modifier_flag::right_shift},
+      {"right_option", modifier_flag::right_option},
+      {"right_command", modifier_flag::right_command},
+      {"fn", modifier_flag::fn},
+      {"num_lock", modifier_flag::num_lock},
+  });
+
+  return pairs;
+}
+
+inline const name_value_table<modifier_flag>& get_modifier_flag_name_value_table(void) {
+  // The initialization of function-local static variables is thread-safe.
+  static name_value_table<modifier_flag> table(get_modifier_flag_name_value_pairs());
+
+  return table;
+}
+} // namespace impl
+
+inline std::optional<modifier_flag> make_modifier_flag(const std::string& name) {
+  return impl::get_modifier_flag_name_value_table().find_value(name);
+}
+
+inline std::string make_modifier_flag_name(modifier_flag modifier_flag) {
+  return impl::get_modifier_flag_name_value_table().make_name(modifier_flag);
+}
+
 inline std::optional<pqrs::karabiner_virtual_hid_device::hid_report::modifier> make_hid_report_modifier(modifier_flag modifier_flag) {
   switch (modifier_flag) {
     case modifier_flag::left_control:
@@ -49,30 +86,8 @@ inline void from_json(const nlohmann::json& json, modifier_flag& value) {
   }
 
   auto name = json.get<std::string>();
-  if (name == "zero") {
-    value = modifier_flag::zero;
-  } else if (name == "caps_lock") {
-    value = modifier_flag::caps_lock;
-  } else if (name == "num_lock") {
-    value = modifier_flag::num_lock;
-  } else if (name == "left_control") {
-    value = modifier_flag::left_control;
-  } else if (name == "left_shift") {
-    value = modifier_flag::left_shift;
-  } else if (name == "left_option") {
-    value = modifier_flag::left_option;
-  } else if (name == "left_command") {
-    value = modifier_flag::left_command;
-  } else if (name == "right_control") {
-    value = modifier_flag::right_control;
-  } else if (name == "right_shift") {
-    value = modifier_flag::right_shift;
-  } else if (name == "right_option") {
-    value = modifier_flag::right_option;
-  } else if (name == "right_command") {
-    value = modifier_flag::right_command;
-  } else if (name == "fn") {
-    value = modifier_flag::fn;
+  if (auto v = make_modifier_flag(name)) {
+    value = *v;
   } else {
     throw pqrs::json::unmarshal_error(fmt::format("unknown modifier_flag: `{0}`", name));
   }
@@ -0,0 +1,221 @@
+#pragma once
+
+// `krbn::name_value_table` can be used safely in a multi-threaded environment.
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <spdlog/fmt/fmt.h>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace krbn {
+// An immutable name <-> value table for enum types (key_code, consumer_key_code, pointing_button, ...).
+//
+// - name -> value: A minimal perfect hash (hash and displace) which is built once in the constructor.
+//                  A lookup takes one hash calculation of the name and one string comparison.
+// - value -> name: A direct index for small values and a sorted vector for the others.
+//                  If there are multiple names for a value, the first name in `pairs` is used.
+//
+// The table is never modified after the construction, so no lock is required to read it.
+
+template <typename T>
+class name_value_table final {
+public:
+  name_value_table(const name_value_table&) = delete;
+
+  name_value_table(const std::vector<std::pair<std::string, T>>& pairs) : pairs_(pairs) {
+    build_name_index();
+    build_value_index();
+  }
+
+  const std::vector<std::pair<std::string, T>>& get_pairs(void) const {
+    return pairs_;
+  }
+
+  std::optional<T> find_value(std::string_view name) const {
+    if (pairs_.empty()) {
+      return std::nullopt;
+    }
+
+    auto h = hash(name);
+    auto seed = seeds_[mix(h, 0) % seeds_.size()];
+    auto index = slots_[mix(h, seed) % slots_.size()];
+    if (index == invalid_index) {
+      return std::nullopt;
+    }
+
+    auto& pair = pairs_[index];
+    if (pair.first != name) {
+      return std::nullopt;
+    }
+
+    return pair.second;
+  }
+
+  const std::string* find_name(T value) const {
+    auto v = static_cast<uint32_t>(value);
+
+    if (v < direct_indices_.size()) {
+      auto index = direct_indices_[v];
+      if (index == invalid_index) {
+        return nullptr;
+      }
+      return &(pairs_[index].first);
+    }
+
+    auto it = std::lower_bound(std::begin(sparse_indices_),
+                               std::end(sparse_indices_),
+                               v,
+                               [](auto&& e, auto&& value) {
+                                 return e.first < value;
+                               });
+    if (it == std::end(sparse_indices_) || it->first != v) {
+      return nullptr;
+    }
+    return &(pairs_[it->second].first);
+  }
+
+  std::string make_name(T value) const {
+    if (auto name = find_name(value)) {
+      return *name;
+    }
+    return fmt::format("(number:{0})", static_cast<uint32_t>(value));
+  }
+
+private:
+  static constexpr uint32_t invalid_index = UINT32_MAX;
+  static constexpr uint32_t max_direct_index_size = 0x1000;
+
+  // FNV-1a
+  static uint64_t hash(std::string_view name) {
+    uint64_t h = 14695981039346656037ULL;
+    for (auto c : name) {
+      h ^= static_cast<uint8_t>(c);
+      h *= 1099511628211ULL;
+    }
+    return h;
+  }
+
+  // Derive a seeded hash value from `hash(name)`.
+  static uint64_t mix(uint64_t h, uint64_t seed) {
+    h ^= seed * 0x9e3779b97f4a7c15ULL;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+  }
+
+  void build_name_index(void) {
+    if (pairs_.empty()) {
+      return;
+    }
+
+    // Check duplicated names.
+
+    {
+      std::vector<std::string_view> names;
+      for (const auto& pair : pairs_) {
+        names.push_back(pair.first);
+      }
+      std::sort(std::begin(names), std::end(names));
+      auto it = std::adjacent_find(std::begin(names), std::end(names));
+      if (it != std::end(names)) {
+        throw std::logic_error(fmt::format("duplicate entry in name_value_table: {0}", *it));
+      }
+    }
+
+    // Hash and displace:
+    // Split names into buckets, then find a seed for each bucket (from the largest bucket)
+    // which places all names in the bucket into empty slots.
+
+    auto bucket_count = std::max(size_t(1), pairs_.size() / 4);
+    std::vector<uint64_t> hashes;
+    std::vector<std::vector<uint32_t>> buckets(bucket_count);
+    for (uint32_t i = 0; i < pairs_.size(); ++i) {
+      hashes.push_back(hash(pairs_[i].first));
+      buckets[mix(hashes.back(), 0) % bucket_count].push_back(i);
+    }
+
+    std::vector<size_t> bucket_order(bucket_count);
+    for (size_t i = 0; i < bucket_count; ++i) {
+      bucket_order[i] = i;
+    }
+    std::stable_sort(std::begin(bucket_order),
+                     std::end(bucket_order),
+                     [&](auto&& a, auto&& b) {
+                       return buckets[a].size() > buckets[b].size();
+                     });
+
+    seeds_.resize(bucket_count, 0);
+    slots_.resize(pairs_.size() + pairs_.size() / 4 + 1, invalid_index);
+
+    std::vector<size_t> candidate_slots;
+    for (auto b : bucket_order) {
+      if (buckets[b].empty()) {
+        break;
+      }
+
+      for (uint64_t seed = 1;; ++seed) {
+        candidate_slots.clear();
+
+        bool found = true;
+        for (auto index : buckets[b]) {
+          auto slot = mix(hashes[index], seed) % slots_.size();
+          if (slots_[slot] != invalid_index ||
+              std::find(std::begin(candidate_slots), std::end(candidate_slots), slot) != std::end(candidate_slots)) {
+            found = false;
+            break;
+          }
+          candidate_slots.push_back(slot);
+        }
+
+        if (found) {
+          seeds_[b] = seed;
+          for (size_t i = 0; i < candidate_slots.size(); ++i) {
+            slots_[candidate_slots[i]] = buckets[b][i];
+          }
+          break;
+        }
+      }
+    }
+  }
+
+  void build_value_index(void) {
+    for (uint32_t i = 0; i < pairs_.size(); ++i) {
+      auto v = static_cast<uint32_t>(pairs_[i].second);
+
+      if (v < max_direct_index_size) {
+        if (v >= direct_indices_.size()) {
+          direct_indices_.resize(v + 1, invalid_index);
+        }
+        // Keep the first name.
+        if (direct_indices_[v] == invalid_index) {
+          direct_indices_[v] = i;
+        }
+      } else {
+        auto it = std::find_if(std::begin(sparse_indices_),
+                               std::end(sparse_indices_),
+                               [&](auto&& e) {
+                                 return e.first == v;
+                               });
+        if (it == std::end(sparse_indices_)) {
+          sparse_indices_.emplace_back(v, i);
+        }
+      }
+    }
+
+    std::sort(std::begin(sparse_indices_), std::end(sparse_indices_));
+  }
+
+  std::vector<std::pair<std::string, T>> pairs_;
+
+  std::vector<uint64_t> seeds_;
+  std::vector<uint32_t> slots_;
+
+  std::vector<uint32_t> direct_indices_;
+  std::vector<std::pair<uint32_t, uint32_t>> sparse_indices_;
+};
+} // namespace krbn
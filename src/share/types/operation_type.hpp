@@ -21,6 +21,9 @@ enum class operation_type : uint8_t {
   select_input_source,
   set_notification_message,
   num_lock_state_changed,  
+  // karabiner_cli -> grabber
+  dump_event_trace,
+  set_rule_statistics_enabled,
   end_,
 };
 
@@ -40,6 +43,8 @@ NLOHMANN_JSON_SERIALIZE_ENUM(
         {operation_type::select_input_source, "select_input_source"},
         {operation_type::set_notification_message, "set_notification_message"},
         {operation_type::num_lock_state_changed, "num_lock_state_changed"},
+        {operation_type::dump_event_trace, "dump_event_trace"},
+        {operation_type::set_rule_statistics_enabled, "set_rule_statistics_enabled"},
         {operation_type::end_, "end_"},
     });
 } // namespace krbn
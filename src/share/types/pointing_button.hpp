@@ -1,5 +1,6 @@
 #pragma once
 
+#include "name_value_table.hpp"
 #include "stream_utility.hpp"
 #include <cstdint>
 
@@ -48,9 +49,6 @@ enum class pointing_button : uint32_t {
 
 namespace impl {
 inline const std::vector<std::pair<std::string, pointing_button>>& get_pointing_button_name_value_pairs(void) {
-  static std::mutex mutex;
-  std::lock_guard<std::mutex> guard(mutex);
-
   static std::vector<std::pair<std::string, pointing_button>> pairs({
       // From IOHIDUsageTables.h
 
@@ -94,45 +92,20 @@ inline const std::vector<std::pair<std::string, pointing_button>>& get_pointing_
   return pairs;
 }
 
-inline const std::unordered_map<std::string, pointing_button>& get_pointing_button_name_value_map(void) {
-  static std::mutex mutex;
-  std::lock_guard<std::mutex> guard(mutex);
-
-  static std::unordered_map<std::string, pointing_button> map;
-
-  if (map.empty()) {
-    for (const auto& pair : impl::get_pointing_button_name_value_pairs()) {
-      auto it = map.find(pair.first);
-      if (it != std::end(map)) {
-        throw std::logic_error(
-            fmt::format("duplicate entry in get_pointing_button_name_value_pairs: {0}",
-                        pair.first));
-      } else {
-        map.emplace(pair.first, pair.second);
-      }
-    }
-  }
+inline const name_value_table<pointing_button>& get_pointing_button_name_value_table(void) {
+  // The initialization of function-local static variables is thread-safe.
+  static name_value_table<pointing_button> table(get_pointing_button_name_value_pairs());
 
-  return map;
+  return table;
 }
 } // namespace impl
 
 inline std::optional<pointing_button> make_pointing_button(const std::string& name) {
-  auto& map = impl::get_pointing_button_name_value_map();
-  auto it = map.find(name);
-  if (it == map.end()) {
-    return std::nullopt;
-  }
-  return it->second;
+  return impl::get_pointing_button_name_value_table().find_value(name);
 }
 
 inline std::string make_pointing_button_name(pointing_button pointing_button) {
-  for (const auto& pair : impl::get_pointing_button_name_value_pairs()) {
-    if (pair.second == pointing_button) {
-      return pair.first;
-    }
-  }
-  return fmt::format("(number:{0})", static_cast<uint32_t>(pointing_button));
+  return impl::get_pointing_button_name_value_table().make_name(pointing_button);
 }
 
 inline std::optional<pointing_button> make_pointing_button(hid_usage_page usage_page, hid_usage usage) {
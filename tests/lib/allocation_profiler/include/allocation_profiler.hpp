@@ -0,0 +1,89 @@
+#pragma once
+
+// `krbn::unit_testing::allocation_profiler` cannot be used safely in a multi-threaded environment.
+// (It must be created and destroyed in the same thread.)
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace krbn {
+namespace unit_testing {
+// `allocation_profiler` counts heap allocations (`operator new`) in the current thread
+// while the profiler is alive.
+//
+// - Linking the allocation_profiler library replaces the global `operator new` and `operator delete`.
+// - Allocations in other threads (e.g., the shared dispatcher thread) are not counted.
+// - Profilers can be nested. An allocation is counted by all alive profilers in the thread.
+// - Allocations are attributed to the first caller which is not in the standard library
+//   if `record_call_sites` is true.
+//
+// Example:
+//
+//   {
+//     krbn::unit_testing::allocation_profiler profiler;
+//     ...
+//     REQUIRE(profiler.get_count() <= 10);
+//   }
+
+class allocation_profiler final {
+public:
+  struct call_site final {
+    std::string symbol;
+    uint64_t count;
+    uint64_t bytes;
+  };
+
+  allocation_profiler(const allocation_profiler&) = delete;
+
+  allocation_profiler(bool record_call_sites = true);
+
+  ~allocation_profiler(void);
+
+  // Stop counting. (The destructor calls `stop` automatically.)
+  void stop(void);
+
+  uint64_t get_count(void) const {
+    return count_;
+  }
+
+  uint64_t get_bytes(void) const {
+    return bytes_;
+  }
+
+  // Return call sites sorted by the allocation count.
+  std::vector<call_site> make_call_sites(void) const;
+
+  // Return a human readable report for failed budget assertions.
+  std::string make_report(void) const;
+
+  // Return the total allocation count in the current thread.
+  // (This counter works without profilers and can be used to measure allocations of other threads.)
+  static uint64_t get_thread_allocation_count(void);
+
+  // This method is called from `operator new`.
+  static void record_allocation(size_t size);
+
+private:
+  // `record_allocation`, `allocate` and `operator new`
+  static constexpr int skipped_frame_count = 3;
+  static constexpr int max_stack_depth = 16;
+
+  struct stack_statistics final {
+    uint64_t count = 0;
+    uint64_t bytes = 0;
+  };
+
+  void record(size_t size,
+              const std::vector<void*>* stack);
+
+  bool record_call_sites_;
+  bool stopped_;
+  allocation_profiler* previous_;
+  uint64_t count_;
+  uint64_t bytes_;
+  std::map<std::vector<void*>, stack_statistics> stacks_;
+};
+} // namespace unit_testing
+} // namespace krbn
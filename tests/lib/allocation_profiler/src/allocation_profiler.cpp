@@ -0,0 +1,286 @@
+#include "allocation_profiler.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <new>
+#include <sstream>
+#include <unordered_map>
+
+namespace {
+thread_local krbn::unit_testing::allocation_profiler* current_profiler = nullptr;
+thread_local uint64_t thread_allocation_count = 0;
+
+// Allocations in the profiler itself (e.g., `stacks_` insertion) are not counted.
+thread_local bool in_profiler = false;
+
+class in_profiler_guard final {
+public:
+  in_profiler_guard(void) : previous_(in_profiler) {
+    in_profiler = true;
+  }
+
+  ~in_profiler_guard(void) {
+    in_profiler = previous_;
+  }
+
+private:
+  bool previous_;
+};
+
+bool standard_library_symbol(const char* mangled_name) {
+  const char* prefixes[] = {
+      "_Znw",   // operator new
+      "_Zna",   // operator new[]
+      "_ZSt",   // std::
+      "_ZNSt",  // std::
+      "_ZNKSt", // std:: (const)
+      "_ZN9__gnu_cxx",
+      "_ZNK9__gnu_cxx",
+      "_ZN4krbn12unit_testing19allocation_profiler",
+  };
+
+  for (const auto& p : prefixes) {
+    if (strncmp(mangled_name, p, strlen(p)) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::string demangle(const char* mangled_name) {
+  int status = 0;
+  if (auto name = abi::__cxa_demangle(mangled_name, nullptr, nullptr, &status)) {
+    std::string result(name);
+    free(name);
+    return result;
+  }
+  return mangled_name;
+}
+
+std::string make_address_string(void* address) {
+  std::ostringstream ss;
+  Dl_info info;
+  if (dladdr(address, &info) != 0 && info.dli_fname != nullptr) {
+    // This format can be resolved by `atos -o <image> -l <load address> <address>`.
+    ss << info.dli_fname << " " << info.dli_fbase << " " << address;
+  } else {
+    ss << address;
+  }
+  return ss.str();
+}
+
+// `allocate` is not inlined to skip the fixed frames (`record_allocation`, `allocate` and `operator new`)
+// in the call site attribution.
+__attribute__((noinline)) void* allocate(size_t size) {
+  krbn::unit_testing::allocation_profiler::record_allocation(size);
+
+  if (size == 0) {
+    size = 1;
+  }
+  return malloc(size);
+}
+} // namespace
+
+namespace krbn {
+namespace unit_testing {
+allocation_profiler::allocation_profiler(bool record_call_sites) : record_call_sites_(record_call_sites),
+                                                                   stopped_(false),
+                                                                   previous_(current_profiler),
+                                                                   count_(0),
+                                                                   bytes_(0) {
+  current_profiler = this;
+}
+
+allocation_profiler::~allocation_profiler(void) {
+  stop();
+
+  // Unlink this profiler from the chain.
+
+  if (current_profiler == this) {
+    current_profiler = previous_;
+  } else {
+    for (auto p = current_profiler; p != nullptr; p = p->previous_) {
+      if (p->previous_ == this) {
+        p->previous_ = previous_;
+        break;
+      }
+    }
+  }
+}
+
+void allocation_profiler::stop(void) {
+  stopped_ = true;
+}
+
+std::vector<allocation_profiler::call_site> allocation_profiler::make_call_sites(void) const {
+  in_profiler_guard guard;
+
+  std::unordered_map<void*, std::string> symbols;
+  std::map<std::string, call_site> call_sites;
+
+  for (const auto& [stack, statistics] : stacks_) {
+    std::string symbol = "(unknown)";
+
+    for (const auto& address : stack) {
+      auto it = symbols.find(address);
+      if (it == std::end(symbols)) {
+        std::string s;
+        Dl_info info;
+        if (dladdr(address, &info) != 0 && info.dli_sname != nullptr) {
+          const char* name = info.dli_sname;
+          // Remove the extra underscore of the macOS symbol table.
+          if (strncmp(name, "__Z", 3) == 0) {
+            ++name;
+          }
+          if (!standard_library_symbol(name)) {
+            s = demangle(name);
+          }
+        } else {
+          s = make_address_string(address);
+        }
+        it = symbols.emplace(address, s).first;
+      }
+
+      if (!it->second.empty()) {
+        symbol = it->second;
+        break;
+      }
+    }
+
+    auto& c = call_sites[symbol];
+    c.symbol = symbol;
+    c.count += statistics.count;
+    c.bytes += statistics.bytes;
+  }
+
+  std::vector<call_site> result;
+  for (const auto& [symbol, c] : call_sites) {
+    result.push_back(c);
+  }
+
+  std::sort(std::begin(result),
+            std::end(result),
+            [](const auto& a, const auto& b) {
+              if (a.count != b.count) {
+                return a.count > b.count;
+              }
+              return a.symbol < b.symbol;
+            });
+
+  return result;
+}
+
+std::string allocation_profiler::make_report(void) const {
+  in_profiler_guard guard;
+
+  std::ostringstream ss;
+  ss << count_ << " allocations (" << bytes_ << " bytes)" << std::endl;
+  for (const auto& c : make_call_sites()) {
+    ss << "  " << c.count << " allocations (" << c.bytes << " bytes): " << c.symbol << std::endl;
+  }
+  return ss.str();
+}
+
+uint64_t allocation_profiler::get_thread_allocation_count(void) {
+  return thread_allocation_count;
+}
+
+__attribute__((noinline)) void allocation_profiler::record_allocation(size_t size) {
+  if (in_profiler) {
+    return;
+  }
+
+  ++thread_allocation_count;
+
+  if (current_profiler == nullptr) {
+    return;
+  }
+
+  in_profiler_guard guard;
+
+  std::vector<void*> stack;
+  for (auto p = current_profiler; p != nullptr; p = p->previous_) {
+    if (!p->stopped_ && p->record_call_sites_) {
+      void* buffer[skipped_frame_count + max_stack_depth];
+      auto depth = backtrace(buffer, skipped_frame_count + max_stack_depth);
+      if (depth > skipped_frame_count) {
+        stack.assign(buffer + skipped_frame_count, buffer + depth);
+      }
+      break;
+    }
+  }
+
+  for (auto p = current_profiler; p != nullptr; p = p->previous_) {
+    p->record(size, &stack);
+  }
+}
+
+void allocation_profiler::record(size_t size,
+                                 const std::vector<void*>* stack) {
+  if (stopped_) {
+    return;
+  }
+
+  ++count_;
+  bytes_ += size;
+
+  if (record_call_sites_ && stack) {
+    auto& s = stacks_[*stack];
+    ++(s.count);
+    s.bytes += size;
+  }
+}
+} // namespace unit_testing
+} // namespace krbn
+
+// Replace the global operator new and operator delete.
+// (The aligned variants are not replaced since they are not used in the hot path.)
+
+void* operator new(size_t size) {
+  if (auto p = allocate(size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+  if (auto p = allocate(size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  return allocate(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+  return allocate(size);
+}
+
+void operator delete(void* p) noexcept {
+  free(p);
+}
+
+void operator delete[](void* p) noexcept {
+  free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+  free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+  free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+  free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+  free(p);
+}
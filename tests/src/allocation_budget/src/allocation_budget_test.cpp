@@ -0,0 +1,209 @@
+#include <catch2/catch.hpp>
+
+#include "../../share/manipulator_helper.hpp"
+#include "allocation_profiler.hpp"
+
+// Allocation budgets of a keystroke (key_down and key_up) through each manipulator type.
+//
+// The budgets have some headroom for differences between standard library implementations.
+// If a budget assertion fails, check the call sites in the report and update the budget
+// only if the new allocations are intended.
+
+namespace {
+const size_t measure_count = 100;
+
+krbn::absolute_time_point make_time_point(uint64_t milliseconds) {
+  return krbn::absolute_time_point(0) +
+         pqrs::osx::chrono::make_absolute_time_duration(std::chrono::milliseconds(milliseconds));
+}
+
+class pipeline final {
+public:
+  pipeline(const std::vector<nlohmann::json>& manipulators,
+           bool post_event_to_virtual_devices) : now_ms_(1000) {
+    krbn::core_configuration::details::complex_modifications_parameters parameters;
+
+    auto manager = std::make_shared<krbn::manipulator::manipulator_manager>();
+    for (const auto& json : manipulators) {
+      manager->push_back_manipulator(json, parameters);
+    }
+    manipulator_managers_.push_back(manager);
+
+    event_queues_.push_back(std::make_shared<krbn::event_queue::queue>());
+    event_queues_.push_back(std::make_shared<krbn::event_queue::queue>());
+    connector_.emplace_back_connection(manager,
+                                       event_queues_[0],
+                                       event_queues_[1]);
+
+    if (post_event_to_virtual_devices) {
+      post_event_to_virtual_devices_manipulator_ =
+          std::make_shared<krbn::manipulator::manipulators::post_event_to_virtual_devices::post_event_to_virtual_devices>(
+              console_user_server_client_);
+
+      auto m = std::make_shared<krbn::manipulator::manipulator_manager>();
+      m->push_back_manipulator(post_event_to_virtual_devices_manipulator_);
+      manipulator_managers_.push_back(m);
+
+      event_queues_.push_back(std::make_shared<krbn::event_queue::queue>());
+      connector_.emplace_back_connection(m,
+                                         event_queues_.back());
+    }
+  }
+
+  ~pipeline(void) {
+    connector_.invalidate_manipulators();
+    post_event_to_virtual_devices_manipulator_ = nullptr;
+    manipulator_managers_.clear();
+  }
+
+  void keystroke(krbn::key_code key_code) {
+    input_event(krbn::event_queue::event(key_code), krbn::event_type::key_down);
+    input_event(krbn::event_queue::event(key_code), krbn::event_type::key_up);
+  }
+
+  void input_event(const krbn::event_queue::event& event,
+                   krbn::event_type event_type) {
+    now_ms_ += 10;
+
+    auto t = make_time_point(now_ms_);
+    event_queues_.front()->emplace_back_entry(krbn::device_id(1),
+                                              krbn::event_queue::event_time_stamp(t),
+                                              event,
+                                              event_type,
+                                              event);
+    connector_.manipulate(t);
+  }
+
+  // Clear the output to measure each keystroke in the same condition.
+  void clear_output(void) {
+    event_queues_.back()->clear_events();
+  }
+
+  size_t get_output_event_count(void) const {
+    if (post_event_to_virtual_devices_manipulator_) {
+      return post_event_to_virtual_devices_manipulator_->get_queue().get_events().size();
+    }
+    return event_queues_.back()->get_entries().size();
+  }
+
+private:
+  uint64_t now_ms_;
+  std::shared_ptr<krbn::console_user_server_client> console_user_server_client_;
+  krbn::manipulator::manipulator_managers_connector connector_;
+  std::vector<std::shared_ptr<krbn::manipulator::manipulator_manager>> manipulator_managers_;
+  std::vector<std::shared_ptr<krbn::event_queue::queue>> event_queues_;
+  std::shared_ptr<krbn::manipulator::manipulators::post_event_to_virtual_devices::post_event_to_virtual_devices> post_event_to_virtual_devices_manipulator_;
+};
+
+// Check the average allocation count of `keystroke` is within `budget`.
+void check_budget(pipeline& pipeline,
+                  const std::function<void(void)>& keystroke,
+                  uint64_t budget) {
+  // Warm up
+
+  keystroke();
+  REQUIRE(pipeline.get_output_event_count() > 0);
+  pipeline.clear_output();
+
+  // Measure
+
+  krbn::unit_testing::allocation_profiler profiler;
+
+  for (size_t i = 0; i < measure_count; ++i) {
+    keystroke();
+    pipeline.clear_output();
+  }
+
+  profiler.stop();
+
+  INFO(profiler.make_report());
+  REQUIRE(profiler.get_count() <= budget * measure_count);
+}
+} // namespace
+
+TEST_CASE("basic") {
+  pipeline p({
+                 nlohmann::json::object({
+                     {"type", "basic"},
+                     {"from", {{"key_code", "a"}}},
+                     {"to", {{{"key_code", "b"}}}},
+                 }),
+             },
+             false);
+
+  check_budget(
+      p,
+      [&p] {
+        p.keystroke(krbn::key_code::a);
+      },
+      30);
+}
+
+TEST_CASE("basic (to_if_alone)") {
+  pipeline p({
+                 nlohmann::json::object({
+                     {"type", "basic"},
+                     {"from", {{"key_code", "caps_lock"}, {"modifiers", {{"optional", {"any"}}}}}},
+                     {"to", {{{"key_code", "left_control"}}}},
+                     {"to_if_alone", {{{"key_code", "escape"}}}},
+                 }),
+             },
+             false);
+
+  check_budget(
+      p,
+      [&p] {
+        p.keystroke(krbn::key_code::caps_lock);
+      },
+      15);
+}
+
+TEST_CASE("basic (simultaneous)") {
+  pipeline p({
+                 nlohmann::json::object({
+                     {"type", "basic"},
+                     {"from", {{"simultaneous", {{{"key_code", "a"}}, {{"key_code", "b"}}}}}},
+                     {"to", {{{"key_code", "c"}}}},
+                 }),
+             },
+             false);
+
+  check_budget(
+      p,
+      [&p] {
+        p.input_event(krbn::event_queue::event(krbn::key_code::a), krbn::event_type::key_down);
+        p.input_event(krbn::event_queue::event(krbn::key_code::b), krbn::event_type::key_down);
+        p.input_event(krbn::event_queue::event(krbn::key_code::a), krbn::event_type::key_up);
+        p.input_event(krbn::event_queue::event(krbn::key_code::b), krbn::event_type::key_up);
+      },
+      60);
+}
+
+TEST_CASE("mouse_motion_to_scroll") {
+  pipeline p({
+                 nlohmann::json::object({
+                     {"type", "mouse_motion_to_scroll"},
+                     {"from", {{"modifiers", {{"mandatory", {"any"}}}}}},
+                 }),
+             },
+             false);
+
+  check_budget(
+      p,
+      [&p] {
+        p.keystroke(krbn::key_code::a);
+      },
+      4);
+}
+
+TEST_CASE("post_event_to_virtual_devices") {
+  pipeline p({},
+             true);
+
+  check_budget(
+      p,
+      [&p] {
+        p.keystroke(krbn::key_code::a);
+      },
+      1);
+}
@@ -0,0 +1,82 @@
+#include <catch2/catch.hpp>
+
+#include "allocation_profiler.hpp"
+#include <memory>
+#include <thread>
+
+namespace {
+// Prevent inlining to test the call site attribution.
+__attribute__((noinline)) std::shared_ptr<int> make_int(int value) {
+  return std::make_shared<int>(value);
+}
+} // namespace
+
+TEST_CASE("allocation_profiler") {
+  {
+    krbn::unit_testing::allocation_profiler profiler;
+
+    auto p1 = make_int(1);
+    auto p2 = make_int(2);
+    auto v = std::make_unique<std::vector<int>>(100);
+
+    profiler.stop();
+
+    auto p3 = make_int(3);
+
+    REQUIRE(profiler.get_count() == 4);
+    REQUIRE(profiler.get_bytes() >= sizeof(int) * 102);
+
+    uint64_t count = 0;
+    for (const auto& c : profiler.make_call_sites()) {
+      count += c.count;
+    }
+    REQUIRE(count == 4);
+
+    REQUIRE(profiler.make_report().find("4 allocations") == 0);
+  }
+
+  // Nested profilers
+
+  {
+    krbn::unit_testing::allocation_profiler outer(false);
+
+    auto p1 = make_int(1);
+
+    {
+      krbn::unit_testing::allocation_profiler inner;
+
+      auto p2 = make_int(2);
+
+      REQUIRE(inner.get_count() == 1);
+      REQUIRE(inner.make_call_sites().size() == 1);
+    }
+
+    auto p3 = make_int(3);
+
+    REQUIRE(outer.get_count() == 3);
+    REQUIRE(outer.make_call_sites().empty());
+  }
+
+  // Other threads
+
+  {
+    krbn::unit_testing::allocation_profiler profiler;
+
+    uint64_t thread_allocation_count = 0;
+    std::thread thread([&thread_allocation_count] {
+      auto count = krbn::unit_testing::allocation_profiler::get_thread_allocation_count();
+      auto p = make_int(1);
+      thread_allocation_count = krbn::unit_testing::allocation_profiler::get_thread_allocation_count() - count;
+    });
+    thread.join();
+
+    REQUIRE(thread_allocation_count == 1);
+
+    // std::thread allocates its state in the current thread.
+    auto count = profiler.get_count();
+
+    auto p = make_int(1);
+
+    REQUIRE(profiler.get_count() == count + 1);
+  }
+}
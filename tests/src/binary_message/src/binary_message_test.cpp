@@ -0,0 +1,117 @@
+#include <catch2/catch.hpp>
+
+#include "binary_message.hpp"
+
+TEST_CASE("key_down_up_valued_events_arrived") {
+  std::vector<krbn::binary_message::key_down_up_valued_event_entry> entries{
+      krbn::binary_message::make_key_down_up_valued_event_entry(krbn::device_id(1),
+                                                                krbn::key_down_up_valued_event(krbn::key_code::a),
+                                                                krbn::event_type::key_down,
+                                                                krbn::absolute_time_point(1000)),
+      krbn::binary_message::make_key_down_up_valued_event_entry(krbn::device_id(2),
+                                                                krbn::key_down_up_valued_event(krbn::consumer_key_code::mute),
+                                                                krbn::event_type::key_up,
+                                                                krbn::absolute_time_point(2000)),
+      krbn::binary_message::make_key_down_up_valued_event_entry(krbn::device_id(0xffffffffffffffff),
+                                                                krbn::key_down_up_valued_event(krbn::pointing_button::button3),
+                                                                krbn::event_type::single,
+                                                                krbn::absolute_time_point(0xfffffffffffffffe)),
+  };
+
+  auto buffer = krbn::binary_message::make_key_down_up_valued_events_arrived_message(entries.data(),
+                                                                                     entries.size());
+  REQUIRE(buffer.size() == 8 + 24 * 3);
+  REQUIRE(krbn::binary_message::is_binary_message(buffer));
+
+  auto header = krbn::binary_message::read_header(buffer);
+  REQUIRE(header.operation == krbn::operation_type::key_down_up_valued_event_arrived);
+  REQUIRE(header.count == 3);
+
+  std::vector<std::tuple<krbn::device_id, krbn::key_down_up_valued_event, krbn::event_type, krbn::absolute_time_point>> actual;
+  krbn::binary_message::for_each_entry<krbn::binary_message::key_down_up_valued_event_entry>(buffer, [&](auto&& entry) {
+    actual.emplace_back(krbn::device_id(entry.device_id),
+                        *krbn::binary_message::make_key_down_up_valued_event(entry),
+                        *krbn::binary_message::make_event_type(entry),
+                        krbn::absolute_time_point(entry.time_stamp));
+  });
+
+  REQUIRE(actual.size() == 3);
+  REQUIRE(actual[0] == std::make_tuple(krbn::device_id(1),
+                                       krbn::key_down_up_valued_event(krbn::key_code::a),
+                                       krbn::event_type::key_down,
+                                       krbn::absolute_time_point(1000)));
+  REQUIRE(actual[1] == std::make_tuple(krbn::device_id(2),
+                                       krbn::key_down_up_valued_event(krbn::consumer_key_code::mute),
+                                       krbn::event_type::key_up,
+                                       krbn::absolute_time_point(2000)));
+  REQUIRE(actual[2] == std::make_tuple(krbn::device_id(0xffffffffffffffff),
+                                       krbn::key_down_up_valued_event(krbn::pointing_button::button3),
+                                       krbn::event_type::single,
+                                       krbn::absolute_time_point(0xfffffffffffffffe)));
+
+  // Invalid event_type
+
+  {
+    auto entry = entries[0];
+    entry.event_type = 3;
+    REQUIRE(krbn::binary_message::make_event_type(entry) == std::nullopt);
+    entry.event_type = 0xff;
+    REQUIRE(krbn::binary_message::make_event_type(entry) == std::nullopt);
+  }
+
+  // MessagePack messages are not binary messages.
+
+  {
+    nlohmann::json json{
+        {"operation_type", krbn::operation_type::key_down_up_valued_event_arrived},
+    };
+    REQUIRE(!krbn::binary_message::is_binary_message(nlohmann::json::to_msgpack(json)));
+  }
+}
+
+TEST_CASE("lock_state_changed") {
+  {
+    auto buffer = krbn::binary_message::make_caps_lock_state_changed_message(true);
+    REQUIRE(krbn::binary_message::read_header(buffer).operation == krbn::operation_type::caps_lock_state_changed);
+
+    std::vector<bool> states;
+    krbn::binary_message::for_each_entry<krbn::binary_message::lock_state_entry>(buffer, [&](auto&& entry) {
+      states.push_back(entry.state);
+    });
+    REQUIRE(states == std::vector<bool>{true});
+  }
+  {
+    auto buffer = krbn::binary_message::make_num_lock_state_changed_message(false);
+    REQUIRE(krbn::binary_message::read_header(buffer).operation == krbn::operation_type::num_lock_state_changed);
+
+    std::vector<bool> states;
+    krbn::binary_message::for_each_entry<krbn::binary_message::lock_state_entry>(buffer, [&](auto&& entry) {
+      states.push_back(entry.state);
+    });
+    REQUIRE(states == std::vector<bool>{false});
+  }
+}
+
+TEST_CASE("broken messages") {
+  auto buffer = krbn::binary_message::make_caps_lock_state_changed_message(true);
+  auto f = [](auto&& entry) {};
+
+  {
+    auto b = buffer;
+    b.resize(4);
+    REQUIRE_THROWS_AS(krbn::binary_message::read_header(b), std::runtime_error);
+  }
+  {
+    auto b = buffer;
+    b[1] = 0xff;
+    REQUIRE_THROWS_AS(krbn::binary_message::read_header(b), std::runtime_error);
+  }
+  {
+    auto b = buffer;
+    b.push_back(0);
+    REQUIRE_THROWS_AS(krbn::binary_message::for_each_entry<krbn::binary_message::lock_state_entry>(b, f), std::runtime_error);
+  }
+  {
+    REQUIRE_THROWS_AS(krbn::binary_message::for_each_entry<krbn::binary_message::key_down_up_valued_event_entry>(buffer, f), std::runtime_error);
+  }
+}
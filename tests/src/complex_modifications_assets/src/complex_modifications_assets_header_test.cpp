@@ -0,0 +1,153 @@
+#include <catch2/catch.hpp>
+
+#include "complex_modifications_assets_file.hpp"
+#include "complex_modifications_assets_header.hpp"
+#include <fstream>
+#include <iostream>
+
+namespace {
+std::optional<krbn::complex_modifications_assets_header> parse(const nlohmann::json& json) {
+  auto s = json.dump();
+  return krbn::complex_modifications_assets_header::parse(std::vector<uint8_t>(std::begin(s), std::end(s)));
+}
+} // namespace
+
+TEST_CASE("complex_modifications_assets_header") {
+  {
+    auto header = parse(nlohmann::json::object({
+        {"title", "example"},
+        {"maintainers", nlohmann::json::array({"tekezo"})},
+        {"rules", nlohmann::json::array({
+                      nlohmann::json::object({
+                          {"description", "rule 1"},
+                          {"manipulators", nlohmann::json::array({
+                                               nlohmann::json::object({
+                                                   {"description", "manipulator 1"},
+                                                   {"type", "basic"},
+                                                   {"from", {{"key_code", "a"}}},
+                                                   {"conditions", nlohmann::json::array()},
+                                                   {"parameters", nlohmann::json::object()},
+                                               }),
+                                           })},
+                      }),
+                      // Use manipulators's description
+                      nlohmann::json::object({
+                          {"available_since", "12.0.0"},
+                          {"manipulators", nlohmann::json::array({
+                                               nlohmann::json::object({
+                                                   {"type", "basic"},
+                                                   {"from", {{"key_code", "a"}}},
+                                               }),
+                                               nlohmann::json::object({
+                                                   {"description", "manipulator 2"},
+                                                   {"type", "basic"},
+                                                   {"from", {{"description", "nested"}}},
+                                               }),
+                                               nlohmann::json::object({
+                                                   {"description", "manipulator 3"},
+                                               }),
+                                           })},
+                      }),
+                      nlohmann::json::object(),
+                  })},
+        {"unknown_key", {{"title", "unknown"}}},
+    }));
+
+    REQUIRE(header);
+    REQUIRE(header->get_title() == "example");
+    REQUIRE(header->get_rule_descriptions() == std::vector<std::string>({
+                                                   "rule 1",
+                                                   "manipulator 2",
+                                                   "",
+                                               }));
+  }
+
+  // Invalid structures
+
+  for (const auto& s : {
+           R"([])",
+           R"({"title": null})",
+           R"({"maintainers": null})",
+           R"({"rules": null})",
+           R"({"rules": [null]})",
+           R"({"rules": [{"description": null}]})",
+           R"({"rules": [{"available_since": null}]})",
+           R"({"rules": [{"manipulators": null}]})",
+           R"({"rules": [{"manipulators": [null]}]})",
+           R"({"rules": [{"manipulators": [{"description": null}]}]})",
+           R"({"rules": [{"manipulators": [{"conditions": null}]}]})",
+           R"({"rules": [{"manipulators": [{"parameters": null}]}]})",
+       }) {
+    REQUIRE(!parse(nlohmann::json::parse(s)));
+  }
+
+  // Broken json
+
+  {
+    std::string s = "{\"title\": \"broken\"";
+    REQUIRE(!krbn::complex_modifications_assets_header::parse(std::vector<uint8_t>(std::begin(s), std::end(s))));
+  }
+}
+
+TEST_CASE("complex_modifications_assets_file.lazy_rules") {
+  for (const auto& file_path : {
+           "json/lint/assets/valid.json",
+           "json/lint/assets/unknown_key.json",
+           "json/lint/assets/conditions_error.json",
+           "json/lint/assets/manipulators_error_1.json",
+       }) {
+    krbn::complex_modifications_assets_file file(file_path);
+
+    // Rule descriptions from the header are same as descriptions of constructed rules.
+
+    std::vector<std::string> descriptions;
+    for (const auto& r : file.get_rules()) {
+      descriptions.push_back(r.get_description());
+    }
+    REQUIRE(file.get_rule_descriptions() == descriptions);
+
+    // Copies share constructed rules.
+
+    auto copy = file;
+    REQUIRE(&(copy.get_rules()) == &(file.get_rules()));
+  }
+}
+
+TEST_CASE("complex_modifications_assets_file.changed_after_loaded") {
+  system("rm -rf tmp/changed");
+  system("mkdir -p tmp/changed");
+
+  auto write_file = [](const std::string& description) {
+    std::ofstream output("tmp/changed/rules.json");
+    output << nlohmann::json::object({
+        {"title", "changed"},
+        {"rules", nlohmann::json::array({
+                      nlohmann::json::object({
+                          {"description", description},
+                          {"manipulators", nlohmann::json::array()},
+                      }),
+                  })},
+    });
+  };
+
+  // The same content is accepted.
+
+  {
+    write_file("rule1");
+    krbn::complex_modifications_assets_file file("tmp/changed/rules.json");
+
+    write_file("rule1");
+    REQUIRE(file.get_rules().size() == 1);
+  }
+
+  // Rules of the changed content are not constructed.
+
+  {
+    write_file("rule1");
+    krbn::complex_modifications_assets_file file("tmp/changed/rules.json");
+
+    write_file("rule2");
+    REQUIRE(file.get_rule_descriptions() == std::vector<std::string>({"rule1"}));
+    REQUIRE(file.get_rules().empty());
+  }
+}
@@ -0,0 +1,117 @@
+#include <catch2/catch.hpp>
+
+#include "complex_modifications_assets_manager.hpp"
+#include <fstream>
+#include <iostream>
+
+namespace {
+const std::string directory = "tmp/cache";
+
+void write_file(const std::string& file_name,
+                const std::string& title,
+                size_t rule_count) {
+  auto rules = nlohmann::json::array();
+  for (size_t i = 0; i < rule_count; ++i) {
+    rules.push_back(nlohmann::json::object({
+        {"description", title + std::to_string(i + 1)},
+        {"manipulators", nlohmann::json::array()},
+    }));
+  }
+
+  // Replace the file by `rename` as editors do.
+  auto file_path = directory + "/" + file_name;
+  auto tmp_file_path = file_path + ".tmp";
+  {
+    std::ofstream output(tmp_file_path);
+    output << nlohmann::json::object({
+        {"title", title},
+        {"rules", rules},
+    });
+  }
+  rename(tmp_file_path.c_str(), file_path.c_str());
+}
+
+const krbn::complex_modifications_assets_file* find_file(const krbn::complex_modifications_assets_manager& manager,
+                                                          const std::string& title) {
+  for (const auto& f : manager.get_files()) {
+    if (f.get_title() == title) {
+      return &f;
+    }
+  }
+  return nullptr;
+}
+} // namespace
+
+TEST_CASE("reload.cache") {
+  system((std::string("rm -rf ") + directory).c_str());
+  system((std::string("mkdir -p ") + directory).c_str());
+
+  write_file("1.json", "AAA", 1);
+  write_file("2.json", "BBB", 2);
+
+  krbn::complex_modifications_assets_manager manager;
+  manager.reload(directory, false);
+
+  REQUIRE(manager.get_files().size() == 2);
+  auto aaa_rules = &(find_file(manager, "AAA")->get_rules());
+  auto bbb_rules = &(find_file(manager, "BBB")->get_rules());
+  REQUIRE(aaa_rules->size() == 1);
+  REQUIRE(bbb_rules->size() == 2);
+
+  // Update 2.json, remove 1.json and add 3.json
+
+  write_file("2.json", "BBB", 3);
+  unlink((directory + "/1.json").c_str());
+  write_file("3.json", "CCC", 1);
+
+  manager.reload(directory, false);
+
+  REQUIRE(manager.get_files().size() == 2);
+  REQUIRE(!find_file(manager, "AAA"));
+  REQUIRE(find_file(manager, "BBB")->get_rule_descriptions().size() == 3);
+  REQUIRE(find_file(manager, "BBB")->get_rules().size() == 3);
+  REQUIRE(&(find_file(manager, "BBB")->get_rules()) != bbb_rules);
+  REQUIRE(find_file(manager, "CCC")->get_rules().size() == 1);
+
+  // Unchanged files are reused
+
+  auto ccc_rules = &(find_file(manager, "CCC")->get_rules());
+  bbb_rules = &(find_file(manager, "BBB")->get_rules());
+
+  manager.reload(directory, false);
+
+  REQUIRE(manager.get_files().size() == 2);
+  REQUIRE(&(find_file(manager, "BBB")->get_rules()) == bbb_rules);
+  REQUIRE(&(find_file(manager, "CCC")->get_rules()) == ccc_rules);
+}
+
+TEST_CASE("reload.parallel") {
+  system((std::string("rm -rf ") + directory).c_str());
+  system((std::string("mkdir -p ") + directory).c_str());
+
+  const size_t file_count = 100;
+
+  for (size_t i = 0; i < file_count; ++i) {
+    char title[32];
+    snprintf(title, sizeof(title), "%03zu", i);
+    write_file(std::string(title) + ".json", title, i % 3);
+  }
+
+  // Broken file
+  {
+    std::ofstream output(directory + "/broken.json");
+    output << "{";
+  }
+
+  krbn::complex_modifications_assets_manager manager;
+  manager.reload(directory, false);
+
+  auto& files = manager.get_files();
+  REQUIRE(files.size() == file_count);
+  for (size_t i = 0; i < file_count; ++i) {
+    char title[32];
+    snprintf(title, sizeof(title), "%03zu", i);
+    REQUIRE(files[i].get_title() == title);
+    REQUIRE(files[i].get_rule_descriptions().size() == i % 3);
+  }
+}
@@ -0,0 +1,274 @@
+#include <catch2/catch.hpp>
+
+#include "grabber/device_grabber_details/complex_modifications_manipulator_manager.hpp"
+#include <pqrs/thread_wait.hpp>
+
+namespace {
+nlohmann::json make_manipulator_json(const std::string& from_key_code,
+                                     const std::string& to_key_code) {
+  return nlohmann::json::object({
+      {"type", "basic"},
+      {"from", nlohmann::json::object({{"key_code", from_key_code}})},
+      {"to", nlohmann::json::array({nlohmann::json::object({{"key_code", to_key_code}})})},
+  });
+}
+
+nlohmann::json make_profile_json(const std::vector<nlohmann::json>& manipulators) {
+  auto rules = nlohmann::json::array();
+  for (const auto& m : manipulators) {
+    rules.push_back(nlohmann::json::object({
+        {"description", "rule"},
+        {"manipulators", nlohmann::json::array({m})},
+    }));
+  }
+
+  return nlohmann::json::object({
+      {"name", "profile"},
+      {"complex_modifications", nlohmann::json::object({{"rules", rules}})},
+  });
+}
+} // namespace
+
+TEST_CASE("update") {
+  krbn::grabber::device_grabber_details::complex_modifications_manipulator_manager manager;
+
+  {
+    krbn::core_configuration::details::profile profile(make_profile_json({
+        make_manipulator_json("a", "1"),
+        make_manipulator_json("b", "2"),
+        make_manipulator_json("c", "3"),
+    }));
+    manager.update(profile);
+  }
+
+  auto entries1 = *(manager.get_entries());
+  REQUIRE(entries1.size() == 3);
+  REQUIRE(manager.get_manipulator_manager()->get_manipulators_size() == 3);
+
+  // ----------------------------------------
+  // Change the second rule and insert a rule at the front.
+
+  {
+    krbn::core_configuration::details::profile profile(make_profile_json({
+        make_manipulator_json("z", "0"),
+        make_manipulator_json("a", "1"),
+        make_manipulator_json("b", "20"),
+        make_manipulator_json("c", "3"),
+    }));
+    manager.update(profile);
+  }
+
+  auto entries2 = *(manager.get_entries());
+  REQUIRE(entries2.size() == 4);
+  REQUIRE(manager.get_manipulator_manager()->get_manipulators_size() == 4);
+
+  REQUIRE(entries2[1].second == entries1[0].second);
+  REQUIRE(entries2[2].second != entries1[1].second);
+  REQUIRE(entries2[3].second == entries1[2].second);
+
+  REQUIRE(entries1[0].second->get_valid());
+  REQUIRE(!entries1[1].second->get_valid());
+  REQUIRE(entries1[2].second->get_valid());
+
+  // ----------------------------------------
+  // Parameters changes rebuild manipulators.
+
+  {
+    auto json = make_profile_json({
+        make_manipulator_json("z", "0"),
+        make_manipulator_json("a", "1"),
+        make_manipulator_json("b", "20"),
+        make_manipulator_json("c", "3"),
+    });
+    json["complex_modifications"]["parameters"]["basic.to_if_alone_timeout_milliseconds"] = 100;
+
+    krbn::core_configuration::details::profile profile(json);
+    manager.update(profile);
+  }
+
+  auto entries3 = *(manager.get_entries());
+  REQUIRE(entries3.size() == 4);
+  for (size_t i = 0; i < entries3.size(); ++i) {
+    REQUIRE(entries3[i].second != entries2[i].second);
+  }
+
+  // ----------------------------------------
+  // Broken manipulators are skipped.
+
+  {
+    krbn::core_configuration::details::profile profile(make_profile_json({
+        make_manipulator_json("a", "1"),
+        nlohmann::json::object({{"type", "unknown"}}),
+    }));
+    manager.update(profile);
+  }
+
+  REQUIRE(manager.get_entries()->size() == 1);
+  REQUIRE(manager.get_manipulator_manager()->get_manipulators_size() == 1);
+}
+
+TEST_CASE("update.order") {
+  krbn::grabber::device_grabber_details::complex_modifications_manipulator_manager manager;
+
+  // Manipulators are built in parallel, but they must keep the rule order.
+
+  std::vector<nlohmann::json> manipulators;
+  for (int i = 0; i < 1000; ++i) {
+    auto json = make_manipulator_json("a", "b");
+    json["conditions"] = nlohmann::json::array({
+        nlohmann::json::object({
+            {"type", "variable_if"},
+            {"name", fmt::format("v{0}", i)},
+            {"value", 1},
+        }),
+    });
+    manipulators.push_back(json);
+  }
+  manipulators[500] = nlohmann::json::object({{"type", "unknown"}});
+
+  krbn::core_configuration::details::profile profile(make_profile_json(manipulators));
+  manager.update(profile);
+
+  auto entries = manager.get_entries();
+  REQUIRE(entries->size() == 999);
+
+  for (size_t i = 0; i < entries->size(); ++i) {
+    auto index = i < 500 ? i : i + 1;
+    REQUIRE((*entries)[i].first.find(fmt::format("\"name\":\"v{0}\"", index)) != std::string::npos);
+  }
+}
+
+TEST_CASE("async_update") {
+  auto manager = std::make_unique<krbn::grabber::device_grabber_details::complex_modifications_manipulator_manager>();
+
+  std::atomic<bool> updated(false);
+  auto wait = pqrs::make_thread_wait();
+  manager->manipulators_updated.connect([&updated, wait] {
+    updated = true;
+    wait->notify();
+  });
+
+  std::vector<nlohmann::json> manipulators;
+  for (int i = 0; i < 1000; ++i) {
+    auto json = make_manipulator_json("a", "b");
+    json["conditions"] = nlohmann::json::array({
+        nlohmann::json::object({
+            {"type", "frontmost_application_if"},
+            {"bundle_identifiers", nlohmann::json::array({fmt::format("^com\\.example\\.app{0}$", i)})},
+        }),
+    });
+    manipulators.push_back(json);
+  }
+
+  auto profile = std::make_shared<krbn::core_configuration::details::profile>(make_profile_json(manipulators));
+
+  // Hold the builder thread, and then confirm the shared dispatcher processes tasks while the build is pending.
+
+  auto builder_blocked = pqrs::make_thread_wait();
+  auto builder_latch = pqrs::make_thread_wait();
+  std::thread::id builder_thread_id;
+
+  manager->enqueue_to_builder_dispatcher([builder_blocked, builder_latch, &builder_thread_id] {
+    builder_thread_id = std::this_thread::get_id();
+    builder_blocked->notify();
+    builder_latch->wait_notice();
+  });
+  builder_blocked->wait_notice();
+
+  manager->async_update(profile);
+
+  auto dispatcher_client = std::make_unique<pqrs::dispatcher::extra::dispatcher_client>();
+  auto probe_wait = pqrs::make_thread_wait();
+  std::thread::id shared_dispatcher_thread_id;
+  dispatcher_client->enqueue_to_dispatcher([probe_wait, &shared_dispatcher_thread_id] {
+    shared_dispatcher_thread_id = std::this_thread::get_id();
+    probe_wait->notify();
+  });
+  probe_wait->wait_notice();
+
+  REQUIRE(shared_dispatcher_thread_id != builder_thread_id);
+  REQUIRE(!updated);
+  REQUIRE(manager->get_manipulator_manager()->get_manipulators_size() == 0);
+
+  // Release the builder thread.
+
+  builder_latch->notify();
+  wait->wait_notice();
+
+  REQUIRE(manager->get_manipulator_manager()->get_manipulators_size() == 1000);
+
+  dispatcher_client->detach_from_dispatcher();
+  manager = nullptr;
+}
+
+TEST_CASE("make_rule_statistics_json") {
+  krbn::grabber::device_grabber_details::complex_modifications_manipulator_manager manager;
+
+  auto json = make_profile_json({
+      make_manipulator_json("a", "1"),
+      make_manipulator_json("b", "2"),
+      nlohmann::json::object({{"type", "unknown"}}),
+  });
+  json["complex_modifications"]["rules"][1]["description"] = "rule b";
+  krbn::core_configuration::details::profile profile(json);
+  manager.update(profile);
+
+  auto input_event_queue = std::make_shared<krbn::event_queue::queue>();
+  auto output_event_queue = std::make_shared<krbn::event_queue::queue>();
+
+  auto manipulate = [&](krbn::key_code key_code) {
+    for (auto event_type : {krbn::event_type::key_down, krbn::event_type::key_up}) {
+      input_event_queue->emplace_back_entry(krbn::device_id(1),
+                                            krbn::event_queue::event_time_stamp(krbn::absolute_time_point(0)),
+                                            krbn::event_queue::event(key_code),
+                                            event_type,
+                                            krbn::event_queue::event(key_code));
+      manager.get_manipulator_manager()->manipulate(input_event_queue,
+                                                    output_event_queue,
+                                                    krbn::absolute_time_point(0));
+    }
+  };
+
+  // Counters are not updated while counters are disabled.
+
+  manipulate(krbn::key_code::a);
+
+  {
+    auto j = manager.make_rule_statistics_json(profile);
+    REQUIRE(j["counters_enabled"] == false);
+    REQUIRE(j["rules"].size() == 3);
+    REQUIRE(j["rules"][0]["evaluated"] == 0);
+  }
+
+  manager.get_manipulator_manager()->set_counters_enabled(true);
+
+  manipulate(krbn::key_code::a);
+  manipulate(krbn::key_code::a);
+  manipulate(krbn::key_code::c);
+
+  {
+    auto j = manager.make_rule_statistics_json(profile);
+    REQUIRE(j["counters_enabled"] == true);
+
+    REQUIRE(j["rules"][0]["index"] == 0);
+    REQUIRE(j["rules"][0]["description"] == "rule");
+    REQUIRE(j["rules"][0]["manipulator_count"] == 1);
+    REQUIRE(j["rules"][0]["evaluated"] == 6);
+    REQUIRE(j["rules"][0]["matched"] == 4);
+    REQUIRE(j["rules"][0]["needs_wait_until_time_stamp"] == 0);
+
+    REQUIRE(j["rules"][1]["description"] == "rule b");
+    REQUIRE(j["rules"][1]["manipulator_count"] == 1);
+    // Manipulators are evaluated even if events are manipulated by the previous rules.
+    REQUIRE(j["rules"][1]["evaluated"] == 6);
+    REQUIRE(j["rules"][1]["matched"] == 0);
+
+    // Broken manipulators are not counted.
+    REQUIRE(j["rules"][2]["manipulator_count"] == 0);
+    REQUIRE(j["rules"][2]["evaluated"] == 0);
+  }
+
+  manager.clear_counters();
+
+  REQUIRE(manager.make_rule_statistics_json(profile)["rules"][0]["evaluated"] == 0);
+}
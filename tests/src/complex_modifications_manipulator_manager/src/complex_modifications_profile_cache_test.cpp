@@ -0,0 +1,143 @@
+#include <catch2/catch.hpp>
+
+#include "grabber/device_grabber_details/complex_modifications_manipulator_manager.hpp"
+#include <pqrs/thread_wait.hpp>
+
+namespace {
+nlohmann::json make_profile_json(const std::string& name,
+                                 const std::vector<std::string>& from_key_codes) {
+  auto rules = nlohmann::json::array();
+  for (const auto& k : from_key_codes) {
+    rules.push_back(nlohmann::json::object({
+        {"description", "rule"},
+        {"manipulators", nlohmann::json::array({
+                             nlohmann::json::object({
+                                 {"type", "basic"},
+                                 {"from", nlohmann::json::object({{"key_code", k}})},
+                                 {"to", nlohmann::json::array({nlohmann::json::object({{"key_code", "a"}})})},
+                             }),
+                         })},
+    }));
+  }
+
+  return nlohmann::json::object({
+      {"name", name},
+      {"complex_modifications", nlohmann::json::object({{"rules", rules}})},
+  });
+}
+} // namespace
+
+TEST_CASE("complex_modifications_profile_cache") {
+  using krbn::grabber::device_grabber_details::complex_modifications_profile_cache;
+
+  complex_modifications_profile_cache cache(2);
+
+  auto entries1 = std::make_shared<complex_modifications_profile_cache::entries_t>();
+  entries1->emplace_back("key1", nullptr);
+  auto entries2 = std::make_shared<complex_modifications_profile_cache::entries_t>();
+  auto entries3 = std::make_shared<complex_modifications_profile_cache::entries_t>();
+
+  complex_modifications_profile_cache::key key1{1, 1};
+  complex_modifications_profile_cache::key key2{2, 2};
+  complex_modifications_profile_cache::key key3{3, 3};
+
+  cache.insert(key1, entries1);
+  cache.insert(key2, entries2);
+  REQUIRE(cache.size() == 2);
+  REQUIRE(cache.full());
+  REQUIRE(cache.get_memory_size() == complex_modifications_profile_cache::estimate_memory_size(*entries1) +
+                                         complex_modifications_profile_cache::estimate_memory_size(*entries2));
+
+  // Touch 1 in order to evict 2.
+  REQUIRE(cache.find(key1) == entries1);
+
+  cache.insert(key3, entries3);
+  REQUIRE(cache.size() == 2);
+  REQUIRE(cache.find(key1) == entries1);
+  REQUIRE(cache.find(key2) == nullptr);
+  REQUIRE(cache.find(key3) == entries3);
+  REQUIRE(cache.get_memory_size() == complex_modifications_profile_cache::estimate_memory_size(*entries1) +
+                                         complex_modifications_profile_cache::estimate_memory_size(*entries3));
+
+  // Keys which have the same hash and a different secondary hash are different.
+  REQUIRE(cache.find(complex_modifications_profile_cache::key{1, 2}) == nullptr);
+
+  cache.clear();
+  REQUIRE(cache.size() == 0);
+  REQUIRE(cache.get_memory_size() == 0);
+
+  // estimate_memory_size includes manipulators.
+
+  {
+    krbn::core_configuration::details::complex_modifications_parameters parameters;
+    auto manipulator = krbn::manipulator::manipulator_factory::make_manipulator(
+        nlohmann::json::object({
+            {"type", "basic"},
+            {"from", nlohmann::json::object({{"key_code", "a"}})},
+            {"to", nlohmann::json::array({nlohmann::json::object({{"key_code", "b"}})})},
+        }),
+        parameters);
+    REQUIRE(manipulator->get_memory_size() > sizeof(krbn::manipulator::manipulators::basic::basic));
+
+    complex_modifications_profile_cache::entries_t entries;
+    entries.emplace_back("key", manipulator);
+    complex_modifications_profile_cache::entries_t entries_without_manipulator;
+    entries_without_manipulator.emplace_back("key", nullptr);
+
+    REQUIRE(complex_modifications_profile_cache::estimate_memory_size(entries) ==
+            complex_modifications_profile_cache::estimate_memory_size(entries_without_manipulator) + manipulator->get_memory_size());
+  }
+
+  // make_key
+
+  krbn::core_configuration::details::profile profile1(make_profile_json("profile1", {"a", "b"}));
+  krbn::core_configuration::details::profile profile2(make_profile_json("profile2", {"a", "b"}));
+  krbn::core_configuration::details::profile profile3(make_profile_json("profile3", {"a", "c"}));
+  REQUIRE(complex_modifications_profile_cache::make_key(profile1) == complex_modifications_profile_cache::make_key(profile2));
+  REQUIRE(complex_modifications_profile_cache::make_key(profile1) != complex_modifications_profile_cache::make_key(profile3));
+}
+
+TEST_CASE("async_precompile") {
+  auto manager = std::make_unique<krbn::grabber::device_grabber_details::complex_modifications_manipulator_manager>(2);
+
+  auto profile1 = std::make_shared<krbn::core_configuration::details::profile>(make_profile_json("profile1", {"a", "b"}));
+  auto profile2 = std::make_shared<krbn::core_configuration::details::profile>(make_profile_json("profile2", {"c", "d", "e"}));
+  auto profile3 = std::make_shared<krbn::core_configuration::details::profile>(make_profile_json("profile3", {"f"}));
+
+  manager->update(*profile1);
+  auto entries1 = manager->get_entries();
+
+  manager->async_precompile({profile2, profile3});
+
+  // Wait until precompile is finished.
+  {
+    auto wait = pqrs::make_thread_wait();
+    manager->manipulators_updated.connect([wait] {
+      wait->notify();
+    });
+    manager->async_update(profile1);
+    wait->wait_notice();
+  }
+
+  // profile3 is not precompiled because the cache is full.
+  REQUIRE(manager->get_profile_cache().size() == 2);
+  REQUIRE(manager->get_profile_cache().contains(krbn::grabber::device_grabber_details::complex_modifications_profile_cache::make_key(*profile2)));
+  REQUIRE(!manager->get_profile_cache().contains(krbn::grabber::device_grabber_details::complex_modifications_profile_cache::make_key(*profile3)));
+
+  // Switch to the precompiled profile.
+
+  manager->update(*profile2);
+  REQUIRE(manager->get_entries()->size() == 3);
+  REQUIRE(manager->get_manipulator_manager()->get_manipulators_size() == 3);
+
+  // Switch back to profile1. The cached manipulators are reused and become valid again.
+
+  manager->update(*profile1);
+  REQUIRE(manager->get_entries() == entries1);
+  for (const auto& e : *entries1) {
+    REQUIRE(e.second->get_valid());
+  }
+  REQUIRE(manager->get_manipulator_manager()->get_manipulators_size() == 2);
+
+  manager = nullptr;
+}
@@ -0,0 +1,59 @@
+#include <catch2/catch.hpp>
+
+#include "../../share/json_helper.hpp"
+#include "configuration_linter.hpp"
+
+namespace {
+// Remove time measurements in order to compare results with the expected json.
+nlohmann::json remove_durations(nlohmann::json json) {
+  for (auto& f : json["files"]) {
+    f.erase("milliseconds");
+  }
+  json["summary"].erase("milliseconds");
+  json["summary"].erase("worker_count");
+  return json;
+}
+} // namespace
+
+TEST_CASE("lint") {
+  std::vector<krbn::configuration_linter::input> inputs({
+      {"json/valid.json", krbn::configuration_linter::file_type::complex_modifications},
+      {"json/errors.json", krbn::configuration_linter::file_type::complex_modifications},
+      {"json/broken.json", krbn::configuration_linter::file_type::complex_modifications},
+      {"json/not_found.json", krbn::configuration_linter::file_type::complex_modifications},
+      {"json/karabiner.json", krbn::configuration_linter::file_type::core_configuration},
+  });
+
+  auto result = krbn::configuration_linter::lint(inputs);
+
+  REQUIRE(result.files.size() == inputs.size());
+  REQUIRE(result.worker_count >= 1);
+  REQUIRE(result.get_error_count() == 9);
+
+  auto expected = krbn::unit_testing::json_helper::load_jsonc("json/expected.jsonc");
+  REQUIRE(remove_durations(result.to_json()) == expected);
+}
+
+TEST_CASE("lint.parallel") {
+  // The result must not depend on the number of workers.
+
+  std::vector<krbn::configuration_linter::input> inputs;
+  for (int i = 0; i < 100; ++i) {
+    inputs.push_back({(i % 2 == 0) ? "json/valid.json" : "json/errors.json",
+                      krbn::configuration_linter::file_type::complex_modifications});
+  }
+
+  auto result = krbn::configuration_linter::lint(inputs);
+
+  REQUIRE(result.files.size() == inputs.size());
+  REQUIRE(result.get_error_count() == 4 * 50);
+
+  auto single = krbn::configuration_linter::lint({inputs[1]}).to_json()["files"][0];
+  single.erase("milliseconds");
+  auto json = result.to_json();
+  for (size_t i = 1; i < inputs.size(); i += 2) {
+    auto f = json["files"][i];
+    f.erase("milliseconds");
+    REQUIRE(f == single);
+  }
+}
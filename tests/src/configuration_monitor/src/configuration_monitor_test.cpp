@@ -66,6 +66,17 @@ TEST_CASE("configuration_monitor") {
     REQUIRE(monitor.get_count() == 2);
     REQUIRE(monitor.get_selected_profile_name() == "user1");
 
+    // ============================================================
+    // Update user.json without semantic changes (ignored)
+    // ============================================================
+
+    system("echo '{ \"profiles\": [ { \"selected\": true, \"name\": \"user1\" } ] }' > target/user.json");
+
+    monitor.wait();
+
+    REQUIRE(monitor.get_count() == 2);
+    REQUIRE(monitor.get_selected_profile_name() == "user1");
+
     // ============================================================
     // Update system.json (ignored since user.json exists.)
     // ============================================================
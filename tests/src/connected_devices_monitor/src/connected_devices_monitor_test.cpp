@@ -1,12 +1,17 @@
 #include <catch2/catch.hpp>
 
 #include "monitor/connected_devices_monitor.hpp"
+#include "shared_state/segment.hpp"
 
 namespace {
+const std::string shared_state_name = fmt::format("/krbn_test_cdm_{0}", getpid());
+
 class test_connected_devices_monitor final {
 public:
   test_connected_devices_monitor(void) : count_(0) {
-    connected_devices_monitor_ = std::make_unique<krbn::connected_devices_monitor>("target/devices.json");
+    connected_devices_monitor_ = std::make_unique<krbn::connected_devices_monitor>(shared_state_name,
+                                                                                   "target/devices.json",
+                                                                                   geteuid());
 
     connected_devices_monitor_->connected_devices_updated.connect([this](auto&& weak_connected_devices) {
       ++count_;
@@ -15,7 +20,7 @@ public:
       }
     });
 
-    connected_devices_monitor_->async_start();
+    connected_devices_monitor_->async_start(std::chrono::milliseconds(50));
 
     wait();
   }
@@ -34,27 +39,37 @@ public:
 
 private:
   std::unique_ptr<krbn::connected_devices_monitor> connected_devices_monitor_;
-  size_t count_;
+  std::atomic<size_t> count_;
   std::shared_ptr<const krbn::connected_devices::connected_devices> last_connected_devices_;
 };
 } // namespace
 
 TEST_CASE("connected_devices_monitor") {
+  using region = krbn::shared_state::segment::region;
+
+  system("rm -rf target");
+  system("mkdir -p target");
+
   {
-    system("rm -rf target");
-    system("mkdir -p target");
-    system("echo '[]' > target/devices.json");
+    // The segment does not exist.
 
     test_connected_devices_monitor monitor;
 
+    REQUIRE(monitor.get_count() == 0);
+
+    auto writer = krbn::shared_state::segment::create(shared_state_name);
+    writer->publish(region::devices, nlohmann::json::array());
+
+    monitor.wait();
+
     REQUIRE(monitor.get_count() == 1);
     REQUIRE(monitor.get_last_connected_devices()->get_devices().size() == 0);
 
     // ============================================================
-    // Update devices.json
+    // Update devices
     // ============================================================
 
-    system("echo '[{\"descriptions\":{\"manufacturer\":\"test1\"}}]' > target/devices.json");
+    writer->publish(region::devices, nlohmann::json::parse(R"([{"descriptions":{"manufacturer":"test1"}}])"));
 
     monitor.wait();
 
@@ -63,92 +78,52 @@ TEST_CASE("connected_devices_monitor") {
     REQUIRE(monitor.get_last_connected_devices()->get_devices()[0].get_descriptions().get_manufacturer() == "test1");
 
     // ============================================================
-    // Remove devices.json (ignored file removal)
+    // Unchanged (ignored)
     // ============================================================
 
-    system("rm target/devices.json");
+    writer->publish(region::devices, nlohmann::json::parse(R"([{"descriptions":{"manufacturer":"test1"}}])"));
 
     monitor.wait();
 
     REQUIRE(monitor.get_count() == 2);
-    REQUIRE(monitor.get_last_connected_devices()->get_devices().size() == 1);
-    REQUIRE(monitor.get_last_connected_devices()->get_devices()[0].get_descriptions().get_manufacturer() == "test1");
 
     // ============================================================
-    // Update devices.json
+    // Unavailable in the segment (devices.json is read)
     // ============================================================
 
     system("echo '[{\"descriptions\":{\"manufacturer\":\"test2\"}}]' > target/devices.json");
+    writer->publish_unavailable(region::devices);
 
     monitor.wait();
 
     REQUIRE(monitor.get_count() == 3);
     REQUIRE(monitor.get_last_connected_devices()->get_devices().size() == 1);
     REQUIRE(monitor.get_last_connected_devices()->get_devices()[0].get_descriptions().get_manufacturer() == "test2");
-  }
-
-  // ============================================================
-  // There are not user.json and system.json at start
-  // ============================================================
-
-  {
-    system("rm -rf target");
-    system("mkdir -p target");
-
-    test_connected_devices_monitor monitor;
-
-    REQUIRE(monitor.get_count() == 1);
-    REQUIRE(monitor.get_last_connected_devices()->get_devices().size() == 0);
 
     // ============================================================
-    // Update devices.json
+    // Broken devices.json (ignored)
     // ============================================================
 
-    system("echo '[{\"descriptions\":{\"manufacturer\":\"test2\"}}]' > target/devices.json");
-
-    monitor.wait();
-
-    REQUIRE(monitor.get_count() == 2);
-    REQUIRE(monitor.get_last_connected_devices()->get_devices().size() == 1);
-    REQUIRE(monitor.get_last_connected_devices()->get_devices()[0].get_descriptions().get_manufacturer() == "test2");
-  }
-
-  // ============================================================
-  // Broken json
-  // ============================================================
-
-  {
-    system("rm -rf target");
-    system("mkdir -p target");
     system("echo '[' > target/devices.json");
-
-    test_connected_devices_monitor monitor;
-
-    REQUIRE(monitor.get_count() == 1);
-    REQUIRE(monitor.get_last_connected_devices()->get_devices().size() == 0);
-
-    // ============================================================
-    // Update devices.json
-    // ============================================================
-
-    system("echo '[{\"descriptions\":{\"manufacturer\":\"test1\"}}]' > target/devices.json");
+    writer->publish_unavailable(region::devices);
 
     monitor.wait();
 
-    REQUIRE(monitor.get_count() == 2);
-    REQUIRE(monitor.get_last_connected_devices()->get_devices().size() == 1);
-    REQUIRE(monitor.get_last_connected_devices()->get_devices()[0].get_descriptions().get_manufacturer() == "test1");
+    REQUIRE(monitor.get_count() == 3);
+    REQUIRE(monitor.get_last_connected_devices()->get_devices()[0].get_descriptions().get_manufacturer() == "test2");
 
     // ============================================================
-    // Break user.json (ignored)
+    // Restart the writer
     // ============================================================
 
-    system("echo '[' > target/devices.json");
+    writer = nullptr;
+    writer = krbn::shared_state::segment::create(shared_state_name);
+    writer->publish(region::devices, nlohmann::json::parse(R"([{"descriptions":{"manufacturer":"test3"}}])"));
 
     monitor.wait();
 
-    REQUIRE(monitor.get_count() == 2);
+    REQUIRE(monitor.get_count() == 4);
     REQUIRE(monitor.get_last_connected_devices()->get_devices().size() == 1);
-    REQUIRE(monitor.get_last_connected_devices()->get_devices()[0].get_descriptions().get_manufacturer() == "test1");
+    REQUIRE(monitor.get_last_connected_devices()->get_devices()[0].get_descriptions().get_manufacturer() == "test3");
   }
 }
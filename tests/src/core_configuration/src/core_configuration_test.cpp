@@ -122,6 +122,41 @@ TEST_CASE("not found") {
   }
 }
 
+TEST_CASE("file_body") {
+  krbn::core_configuration::core_configuration expected("json/example.json");
+
+  std::ifstream input("json/example.json", std::ios::binary);
+  auto file_body = std::make_shared<std::vector<uint8_t>>(std::istreambuf_iterator<char>(input),
+                                                          std::istreambuf_iterator<char>());
+
+  {
+    krbn::core_configuration::core_configuration configuration("json/example.json",
+                                                               file_body);
+    REQUIRE(configuration.is_loaded() == true);
+    REQUIRE(configuration.to_json() == expected.to_json());
+  }
+
+  // `file_body` is used instead of the file content.
+
+  {
+    auto body = nlohmann::json::object({
+                                           {"profiles", nlohmann::json::array({
+                                                            nlohmann::json::object({
+                                                                {"name", "file_body"},
+                                                                {"selected", true},
+                                                            }),
+                                                        })},
+                                       })
+                    .dump();
+
+    krbn::core_configuration::core_configuration configuration("json/example.json",
+                                                               std::make_shared<std::vector<uint8_t>>(std::begin(body), std::end(body)));
+    REQUIRE(configuration.is_loaded() == true);
+    REQUIRE(configuration.get_profiles().size() == 1);
+    REQUIRE(configuration.get_selected_profile().get_name() == "file_body");
+  }
+}
+
 TEST_CASE("broken.json") {
   {
     krbn::core_configuration::core_configuration configuration("json/broken.json");
@@ -1064,6 +1099,43 @@ TEST_CASE("complex_modifications") {
   }
 }
 
+TEST_CASE("complex_modifications_rule.shared_json") {
+  auto json = nlohmann::json::object({
+      {"description", "rule"},
+      {"manipulators", nlohmann::json::array({
+                           nlohmann::json::object({
+                               {"type", "basic"},
+                               {"from", {{"key_code", "a"}}},
+                               {"conditions", nlohmann::json::array({
+                                                  nlohmann::json::object({
+                                                      {"type", "variable_if"},
+                                                      {"name", "v"},
+                                                      {"value", 1},
+                                                  }),
+                                              })},
+                           }),
+                       })},
+  });
+
+  krbn::core_configuration::details::complex_modifications_parameters parameters;
+  krbn::core_configuration::details::complex_modifications_rule rule1(json, parameters);
+
+  REQUIRE(rule1.get_json() == json);
+  REQUIRE(rule1.get_manipulators()[0].get_json() == json["manipulators"][0]);
+  REQUIRE(rule1.get_manipulators()[0].get_conditions()[0].get_json() == json["manipulators"][0]["conditions"][0]);
+
+  // Manipulators and conditions refer slices of the rule json.
+
+  REQUIRE(&(rule1.get_manipulators()[0].get_json()) == &(rule1.get_json()["manipulators"][0]));
+  REQUIRE(&(rule1.get_manipulators()[0].get_conditions()[0].get_json()) == &(rule1.get_json()["manipulators"][0]["conditions"][0]));
+
+  // Copies of the rule share the json.
+
+  auto rule2 = rule1;
+  REQUIRE(&(rule2.get_json()) == &(rule1.get_json()));
+  REQUIRE(&(rule2.get_manipulators()[0].get_json()) == &(rule1.get_manipulators()[0].get_json()));
+}
+
 TEST_CASE("complex_modifications.push_back_rule") {
   {
     nlohmann::json json({
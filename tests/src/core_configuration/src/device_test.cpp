@@ -86,6 +86,8 @@ TEST_CASE("device") {
     REQUIRE(device.get_ignore() == false);
     REQUIRE(device.get_manipulate_caps_lock_led() == false);
     REQUIRE(device.get_disable_built_in_keyboard_if_exists() == false);
+    REQUIRE(device.get_key_chatter_debounce_milliseconds() == std::chrono::milliseconds(0));
+    REQUIRE(device.get_input_event_rate_limit_per_second() == 0);
   }
 
   // load values from json
@@ -100,6 +102,8 @@ TEST_CASE("device") {
         {"disable_built_in_keyboard_if_exists", true},
         {"ignore", true},
         {"manipulate_caps_lock_led", true},
+        {"key_chatter_debounce_milliseconds", 30},
+        {"input_event_rate_limit_per_second", 2000},
     });
     krbn::core_configuration::details::device device(json);
     REQUIRE(device.get_identifiers().get_vendor_id() == krbn::vendor_id(1234));
@@ -109,6 +113,8 @@ TEST_CASE("device") {
     REQUIRE(device.get_ignore() == true);
     REQUIRE(device.get_manipulate_caps_lock_led() == true);
     REQUIRE(device.get_disable_built_in_keyboard_if_exists() == true);
+    REQUIRE(device.get_key_chatter_debounce_milliseconds() == std::chrono::milliseconds(30));
+    REQUIRE(device.get_input_event_rate_limit_per_second() == 2000);
   }
 
   // Special default value for specific devices
@@ -224,6 +230,8 @@ TEST_CASE("device.to_json") {
                         }},
         {"ignore", false},
         {"fn_function_keys", nlohmann::json::array()},
+        {"input_event_rate_limit_per_second", 0},
+        {"key_chatter_debounce_milliseconds", 0},
         {"manipulate_caps_lock_led", false},
         {"simple_modifications", nlohmann::json::array()},
     });
@@ -276,6 +284,8 @@ TEST_CASE("device.to_json") {
                             },
                         }},
         {"ignore", true},
+        {"input_event_rate_limit_per_second", 0},
+        {"key_chatter_debounce_milliseconds", 0},
         {"manipulate_caps_lock_led", true},
         {"simple_modifications", nlohmann::json::array()},
     });
@@ -0,0 +1,266 @@
+#include <catch2/catch.hpp>
+
+#include "device_ingress_filter.hpp"
+
+namespace {
+krbn::event_queue::entry make_entry(uint64_t milliseconds,
+                                    const krbn::event_queue::event& event,
+                                    krbn::event_type event_type) {
+  auto t = krbn::absolute_time_point(0) +
+           pqrs::osx::chrono::make_absolute_time_duration(std::chrono::milliseconds(milliseconds));
+  return krbn::event_queue::entry(krbn::device_id(1),
+                                  krbn::event_queue::event_time_stamp(t),
+                                  event,
+                                  event_type,
+                                  event);
+}
+
+krbn::event_queue::entry make_key_entry(uint64_t milliseconds,
+                                        krbn::key_code key_code,
+                                        krbn::event_type event_type) {
+  return make_entry(milliseconds,
+                    krbn::event_queue::event(key_code),
+                    event_type);
+}
+
+krbn::event_queue::entry make_pointing_motion_entry(uint64_t milliseconds,
+                                                    int x,
+                                                    int y) {
+  return make_entry(milliseconds,
+                    krbn::event_queue::event(krbn::pointing_motion(x, y, 0, 0)),
+                    krbn::event_type::single);
+}
+
+class filter_result final {
+public:
+  filter_result(krbn::device_ingress_filter& filter) : filter_(filter) {
+  }
+
+  void push_back(const krbn::event_queue::entry& entry) {
+    filter_.filter(entry, [this](auto&& e) {
+      entries_.push_back(e);
+    });
+  }
+
+  void flush(uint64_t milliseconds) {
+    auto t = krbn::absolute_time_point(0) +
+             pqrs::osx::chrono::make_absolute_time_duration(std::chrono::milliseconds(milliseconds));
+    filter_.flush(krbn::device_id(1), t, [this](auto&& e) {
+      entries_.push_back(e);
+    });
+  }
+
+  const std::vector<krbn::event_queue::entry>& get_entries(void) const {
+    return entries_;
+  }
+
+  void clear(void) {
+    entries_.clear();
+  }
+
+private:
+  krbn::device_ingress_filter& filter_;
+  std::vector<krbn::event_queue::entry> entries_;
+};
+} // namespace
+
+TEST_CASE("device_ingress_filter disabled") {
+  krbn::device_ingress_filter filter;
+  filter_result result(filter);
+
+  REQUIRE(!filter.enabled());
+
+  for (uint64_t i = 0; i < 1000; ++i) {
+    result.push_back(make_key_entry(i, krbn::key_code::a, krbn::event_type::key_down));
+    result.push_back(make_key_entry(i, krbn::key_code::a, krbn::event_type::key_up));
+  }
+
+  REQUIRE(result.get_entries().size() == 2000);
+  REQUIRE(filter.get_counters().empty());
+}
+
+TEST_CASE("device_ingress_filter key chatter") {
+  krbn::device_ingress_filter filter;
+  filter.set_key_chatter_debounce_duration(std::chrono::milliseconds(20));
+  filter_result result(filter);
+
+  REQUIRE(filter.enabled());
+
+  result.push_back(make_key_entry(100, krbn::key_code::a, krbn::event_type::key_down));
+  result.push_back(make_key_entry(150, krbn::key_code::a, krbn::event_type::key_up));
+  // chatter
+  result.push_back(make_key_entry(155, krbn::key_code::a, krbn::event_type::key_down));
+  result.push_back(make_key_entry(160, krbn::key_code::a, krbn::event_type::key_up));
+  // Other keys are not affected.
+  result.push_back(make_key_entry(165, krbn::key_code::b, krbn::event_type::key_down));
+  result.push_back(make_key_entry(170, krbn::key_code::b, krbn::event_type::key_up));
+  // The debounce window is extended by the dropped key_up.
+  result.push_back(make_key_entry(175, krbn::key_code::a, krbn::event_type::key_down));
+  result.push_back(make_key_entry(180, krbn::key_code::a, krbn::event_type::key_up));
+  // Next key press.
+  result.push_back(make_key_entry(300, krbn::key_code::a, krbn::event_type::key_down));
+  result.push_back(make_key_entry(350, krbn::key_code::a, krbn::event_type::key_up));
+
+  REQUIRE(result.get_entries().size() == 6);
+  REQUIRE(result.get_entries()[0].get_event_type() == krbn::event_type::key_down);
+  REQUIRE(result.get_entries()[1].get_event_type() == krbn::event_type::key_up);
+  REQUIRE(result.get_entries()[2].get_event() == krbn::event_queue::event(krbn::key_code::b));
+  REQUIRE(result.get_entries()[3].get_event() == krbn::event_queue::event(krbn::key_code::b));
+  REQUIRE(result.get_entries()[4].get_event_time_stamp().get_time_stamp() == make_key_entry(300, krbn::key_code::a, krbn::event_type::key_down).get_event_time_stamp().get_time_stamp());
+  REQUIRE(result.get_entries()[5].get_event_type() == krbn::event_type::key_up);
+
+  REQUIRE(filter.get_counters().debounced == 4);
+  REQUIRE(filter.get_counters().dropped == 0);
+  REQUIRE(filter.get_counters().merged == 0);
+
+  filter.clear();
+  REQUIRE(filter.get_counters().empty());
+}
+
+TEST_CASE("device_ingress_filter rate limit") {
+  // 100 events per second (The bucket size is 10.)
+
+  krbn::device_ingress_filter filter;
+  filter.set_rate_limit_per_second(100);
+  filter_result result(filter);
+
+  // key storm (1000 key_down per second)
+
+  for (uint64_t i = 0; i < 100; ++i) {
+    result.push_back(make_key_entry(1000 + i, krbn::key_code::a, krbn::event_type::key_down));
+    result.push_back(make_key_entry(1000 + i, krbn::key_code::a, krbn::event_type::key_up));
+  }
+
+  // 10 (bucket) + 9 (refilled in 99 ms) key presses are passed.
+  REQUIRE(result.get_entries().size() == 19 * 2);
+  REQUIRE(filter.get_counters().dropped == 81 * 2);
+
+  // key_up of passed key_down is never dropped.
+
+  filter.clear();
+  result.clear();
+
+  for (uint64_t i = 0; i < 10; ++i) {
+    result.push_back(make_key_entry(2000, krbn::key_code::a, krbn::event_type::key_down));
+  }
+  result.push_back(make_key_entry(2000, krbn::key_code::b, krbn::event_type::key_down));
+  result.push_back(make_key_entry(2000, krbn::key_code::a, krbn::event_type::key_up));
+  result.push_back(make_key_entry(2000, krbn::key_code::b, krbn::event_type::key_up));
+
+  REQUIRE(result.get_entries().size() == 11);
+  REQUIRE(result.get_entries().back().get_event() == krbn::event_queue::event(krbn::key_code::a));
+  REQUIRE(result.get_entries().back().get_event_type() == krbn::event_type::key_up);
+  REQUIRE(filter.get_counters().dropped == 2);
+}
+
+TEST_CASE("device_ingress_filter pointing_motion") {
+  // 100 events per second (The bucket size is 10.)
+
+  krbn::device_ingress_filter filter;
+  filter.set_rate_limit_per_second(100);
+  filter_result result(filter);
+
+  // 8 kHz mouse for 100 ms
+
+  for (uint64_t i = 0; i < 800; ++i) {
+    result.push_back(make_pointing_motion_entry(1000 + i / 8, 1, -1));
+  }
+
+  REQUIRE(filter.get_counters().merged + result.get_entries().size() == 800);
+  REQUIRE(result.get_entries().size() < 25);
+
+  // The total motion is not lost except the pending motion.
+
+  result.push_back(make_pointing_motion_entry(2000, 0, 0));
+
+  int x = 0;
+  int y = 0;
+  for (const auto& e : result.get_entries()) {
+    auto m = e.get_event().get_pointing_motion();
+    REQUIRE(m);
+    x += m->get_x();
+    y += m->get_y();
+  }
+  REQUIRE(x == 800);
+  REQUIRE(y == -800);
+}
+
+TEST_CASE("device_ingress_filter pending pointing_motion") {
+  // 100 events per second (The bucket size is 10.)
+
+  krbn::device_ingress_filter filter;
+  filter.set_rate_limit_per_second(100);
+  filter_result result(filter);
+
+  REQUIRE(filter.get_token_refill_interval() == std::chrono::milliseconds(10));
+
+  // The burst ends while the bucket is empty.
+
+  for (uint64_t i = 0; i < 20; ++i) {
+    result.push_back(make_pointing_motion_entry(1000, 1, 2));
+  }
+
+  REQUIRE(result.get_entries().size() == 10);
+  REQUIRE(filter.has_pending_pointing_motion());
+
+  // flush does nothing until a token is refilled.
+
+  result.flush(1005);
+  REQUIRE(result.get_entries().size() == 10);
+  REQUIRE(filter.has_pending_pointing_motion());
+
+  result.flush(1010);
+  REQUIRE(result.get_entries().size() == 11);
+  REQUIRE(!filter.has_pending_pointing_motion());
+  REQUIRE(result.get_entries().back().get_event() == krbn::event_queue::event(krbn::pointing_motion(10, 20, 0, 0)));
+  REQUIRE(result.get_entries().back().get_event_time_stamp().get_time_stamp() == make_pointing_motion_entry(1010, 0, 0).get_event_time_stamp().get_time_stamp());
+
+  // The pending pointing_motion is passed before the next event of another type.
+
+  filter.clear();
+  result.clear();
+
+  for (uint64_t i = 0; i < 15; ++i) {
+    result.push_back(make_pointing_motion_entry(2000, 1, 0));
+  }
+  result.push_back(make_entry(2100,
+                              krbn::event_queue::event(krbn::pointing_button::button1),
+                              krbn::event_type::key_down));
+
+  REQUIRE(result.get_entries().size() == 12);
+  REQUIRE(result.get_entries()[10].get_event() == krbn::event_queue::event(krbn::pointing_motion(5, 0, 0, 0)));
+  REQUIRE(result.get_entries()[11].get_event() == krbn::event_queue::event(krbn::pointing_button::button1));
+  REQUIRE(!filter.has_pending_pointing_motion());
+}
+
+TEST_CASE("device_ingress_filter pending pointing_motion and key_up") {
+  // 100 events per second (The bucket size is 10.)
+
+  krbn::device_ingress_filter filter;
+  filter.set_rate_limit_per_second(100);
+  filter_result result(filter);
+
+  // Drag: The motion burst and the button release occur at the same time stamp while the bucket is empty.
+
+  result.push_back(make_entry(1000,
+                              krbn::event_queue::event(krbn::pointing_button::button1),
+                              krbn::event_type::key_down));
+  for (uint64_t i = 0; i < 20; ++i) {
+    result.push_back(make_pointing_motion_entry(1000, 1, 0));
+  }
+  result.push_back(make_entry(1000,
+                              krbn::event_queue::event(krbn::pointing_button::button1),
+                              krbn::event_type::key_up));
+
+  // button1 key_down + 9 pointing_motion + merged pointing_motion + button1 key_up
+  REQUIRE(result.get_entries().size() == 12);
+  REQUIRE(result.get_entries()[10].get_event() == krbn::event_queue::event(krbn::pointing_motion(11, 0, 0, 0)));
+  REQUIRE(result.get_entries()[11].get_event() == krbn::event_queue::event(krbn::pointing_button::button1));
+  REQUIRE(result.get_entries()[11].get_event_type() == krbn::event_type::key_up);
+  REQUIRE(!filter.has_pending_pointing_motion());
+
+  // Nothing is delivered after the release.
+
+  result.flush(2000);
+  REQUIRE(result.get_entries().size() == 12);
+}
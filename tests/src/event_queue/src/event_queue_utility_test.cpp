@@ -251,3 +251,60 @@ TEST_CASE("utility::insert_device_keys_and_pointing_buttons_are_released_event")
     REQUIRE(pressed_keys_manager->empty());
   }
 }
+
+TEST_CASE("utility::for_each_entry") {
+  std::vector<krbn::hid_value> hid_values;
+
+  hid_values.emplace_back(krbn::hid_value(krbn::absolute_time_point(1000),
+                                          1,
+                                          *krbn::make_hid_usage_page(krbn::key_code::spacebar),
+                                          *krbn::make_hid_usage(krbn::key_code::spacebar)));
+  hid_values.emplace_back(krbn::hid_value(krbn::absolute_time_point(2000),
+                                          10,
+                                          krbn::hid_usage_page::generic_desktop,
+                                          krbn::hid_usage::gd_x));
+  hid_values.emplace_back(krbn::hid_value(krbn::absolute_time_point(2000),
+                                          20,
+                                          krbn::hid_usage_page::generic_desktop,
+                                          krbn::hid_usage::gd_y));
+  hid_values.emplace_back(krbn::hid_value(krbn::absolute_time_point(3000),
+                                          1,
+                                          krbn::hid_usage_page::button,
+                                          krbn::hid_usage(2)));
+  hid_values.emplace_back(krbn::hid_value(krbn::absolute_time_point(4000),
+                                          0,
+                                          *krbn::make_hid_usage_page(krbn::key_code::spacebar),
+                                          *krbn::make_hid_usage(krbn::key_code::spacebar)));
+  hid_values.emplace_back(krbn::hid_value(krbn::absolute_time_point(5000),
+                                          0,
+                                          krbn::hid_usage_page::button,
+                                          krbn::hid_usage(2)));
+  hid_values.emplace_back(krbn::hid_value(krbn::absolute_time_point(6000),
+                                          -10,
+                                          krbn::hid_usage_page::generic_desktop,
+                                          krbn::hid_usage::gd_x));
+
+  // The result is same as `make_queue` and `insert_device_keys_and_pointing_buttons_are_released_event`.
+
+  auto pressed_keys_manager1 = std::make_shared<krbn::pressed_keys_manager>();
+  auto expected = krbn::event_queue::utility::make_queue(krbn::device_id(1),
+                                                         hid_values);
+  expected = krbn::event_queue::utility::insert_device_keys_and_pointing_buttons_are_released_event(expected,
+                                                                                                    krbn::device_id(1),
+                                                                                                    pressed_keys_manager1);
+
+  krbn::pressed_keys_manager pressed_keys_manager2;
+  krbn::event_queue::queue actual;
+  krbn::event_queue::utility::for_each_entry(krbn::device_id(1),
+                                             hid_values,
+                                             pressed_keys_manager2,
+                                             [&](auto&& entry) {
+                                               actual.push_back_entry(entry);
+                                             });
+
+  REQUIRE(actual.get_entries().size() == 7);
+  REQUIRE(actual.get_entries()[4].get_event().get_type() == krbn::event_queue::event::type::device_keys_and_pointing_buttons_are_released);
+  REQUIRE(actual.get_entries()[4].get_event_time_stamp().get_time_stamp() == krbn::absolute_time_point(5000));
+  REQUIRE(nlohmann::json(actual.get_entries()) == nlohmann::json(expected->get_entries()));
+  REQUIRE(pressed_keys_manager2.empty());
+}
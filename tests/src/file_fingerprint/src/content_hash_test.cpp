@@ -0,0 +1,14 @@
+#include <catch2/catch.hpp>
+
+#include "content_hash.hpp"
+
+TEST_CASE("content_hash") {
+  // XXH64 test vectors
+  REQUIRE(krbn::content_hash::make("") == 0xef46db3751d8e999ULL);
+  REQUIRE(krbn::content_hash::make("abc") == 0x44bc2cf5ad770999ULL);
+  REQUIRE(krbn::content_hash::make("Nobody inspects the spammish repetition") == 0xfbcea83c8a378bf1ULL);
+  REQUIRE(krbn::content_hash::to_string(krbn::content_hash::make("")) == "ef46db3751d8e999");
+  REQUIRE(krbn::content_hash::make("karabiner") != krbn::content_hash::make("karabiner "));
+  REQUIRE(krbn::content_hash::make_secondary("karabiner") != krbn::content_hash::make_secondary("karabiner "));
+  REQUIRE(krbn::content_hash::make_secondary("karabiner") != krbn::content_hash::make("karabiner"));
+}
@@ -0,0 +1,68 @@
+#include <catch2/catch.hpp>
+
+#include "file_fingerprint.hpp"
+#include <fstream>
+#include <unistd.h>
+
+namespace {
+std::shared_ptr<std::vector<uint8_t>> write_file(const std::string& file_path,
+                                                 const std::string& body) {
+  // Replace the file by `rename` as async_file_writer does.
+  auto tmp_file_path = file_path + ".tmp";
+  {
+    std::ofstream output(tmp_file_path);
+    output << body;
+  }
+  rename(tmp_file_path.c_str(), file_path.c_str());
+
+  return std::make_shared<std::vector<uint8_t>>(std::begin(body), std::end(body));
+}
+} // namespace
+
+TEST_CASE("file_fingerprint") {
+  system("mkdir -p tmp");
+
+  std::string file_path = "tmp/file_fingerprint.json";
+  unlink(file_path.c_str());
+
+  // Not exists
+
+  auto fingerprint0 = krbn::file_fingerprint::make(file_path, nullptr);
+  REQUIRE(!fingerprint0.exists());
+  REQUIRE(fingerprint0 == krbn::file_fingerprint());
+  REQUIRE(fingerprint0.same_file_status(file_path));
+
+  // Exists
+
+  auto body1 = write_file(file_path, "{\"alerts\":[]}");
+  auto fingerprint1 = krbn::file_fingerprint::make(file_path, body1);
+  REQUIRE(fingerprint1.exists());
+  REQUIRE(fingerprint1.get_hash() == krbn::content_hash::make(body1->data(), body1->size()));
+  REQUIRE(fingerprint1.get_file_status()->size == body1->size());
+  REQUIRE(fingerprint1 != fingerprint0);
+  REQUIRE(!fingerprint0.same_file_status(file_path));
+  REQUIRE(fingerprint1.same_file_status(file_path));
+
+  // Same content
+
+  auto body2 = write_file(file_path, "{\"alerts\":[]}");
+  auto fingerprint2 = krbn::file_fingerprint::make(file_path, body2);
+  REQUIRE(fingerprint2 == fingerprint1);
+  // The file is replaced.
+  REQUIRE(!fingerprint1.same_file_status(file_path));
+  REQUIRE(fingerprint2.same_file_status(file_path));
+
+  // Changed content
+
+  auto body3 = write_file(file_path, "{\"alerts\":[\"example\"]}");
+  auto fingerprint3 = krbn::file_fingerprint::make(file_path, body3);
+  REQUIRE(fingerprint3 != fingerprint2);
+  REQUIRE(!fingerprint2.same_file_status(file_path));
+  REQUIRE(fingerprint3.same_file_status(file_path));
+
+  // Removed
+
+  unlink(file_path.c_str());
+  REQUIRE(!fingerprint3.same_file_status(file_path));
+  REQUIRE(fingerprint0.same_file_status(file_path));
+}
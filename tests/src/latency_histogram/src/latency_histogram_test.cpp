@@ -0,0 +1,75 @@
+#include <catch2/catch.hpp>
+
+#include "latency_histogram.hpp"
+
+TEST_CASE("latency_histogram") {
+  krbn::latency_histogram histogram;
+
+  REQUIRE(histogram.get_count() == 0);
+  REQUIRE(histogram.value_at_percentile(50.0) == std::chrono::microseconds(0));
+
+  // Small values are recorded exactly.
+
+  for (int i = 1; i <= 20; ++i) {
+    histogram.record(std::chrono::microseconds(i));
+  }
+
+  REQUIRE(histogram.get_count() == 20);
+  REQUIRE(histogram.get_min() == std::chrono::microseconds(1));
+  REQUIRE(histogram.get_max() == std::chrono::microseconds(20));
+  REQUIRE(histogram.get_mean() == std::chrono::microseconds(10));
+  REQUIRE(histogram.value_at_percentile(50.0) == std::chrono::microseconds(10));
+  REQUIRE(histogram.value_at_percentile(90.0) == std::chrono::microseconds(18));
+  REQUIRE(histogram.value_at_percentile(100.0) == std::chrono::microseconds(20));
+
+  // Negative values and too large values
+
+  histogram.clear();
+  histogram.record(std::chrono::microseconds(-100));
+  histogram.record(std::chrono::hours(1));
+
+  REQUIRE(histogram.get_min() == std::chrono::microseconds(0));
+  REQUIRE(histogram.get_max() == std::chrono::microseconds(krbn::latency_histogram::max_value));
+  REQUIRE(histogram.value_at_percentile(100.0) == std::chrono::microseconds(krbn::latency_histogram::max_value));
+}
+
+TEST_CASE("latency_histogram relative error") {
+  krbn::latency_histogram histogram;
+
+  for (int64_t v = 1; v < 10 * 1000 * 1000; v = v * 3 / 2 + 1) {
+    histogram.clear();
+    histogram.record(std::chrono::microseconds(v));
+    histogram.record(std::chrono::microseconds(v * 2));
+
+    // p50 is the highest equivalent value of `v`.
+    auto p50 = histogram.value_at_percentile(50.0).count();
+    REQUIRE(v <= p50);
+    REQUIRE(p50 <= v + v / 16);
+  }
+}
+
+TEST_CASE("latency_histogram merge") {
+  krbn::latency_histogram histogram1;
+  krbn::latency_histogram histogram2;
+
+  for (int i = 0; i < 99; ++i) {
+    histogram1.record(std::chrono::microseconds(1000));
+  }
+  histogram2.record(std::chrono::microseconds(500));
+  histogram2.record(std::chrono::microseconds(100000));
+
+  histogram1.merge(histogram2);
+
+  REQUIRE(histogram1.get_count() == 101);
+  REQUIRE(histogram1.get_min() == std::chrono::microseconds(500));
+  REQUIRE(histogram1.get_max() == std::chrono::microseconds(100000));
+  REQUIRE(histogram1.value_at_percentile(50.0) >= std::chrono::microseconds(1000));
+  REQUIRE(histogram1.value_at_percentile(50.0) < std::chrono::microseconds(1063));
+  REQUIRE(histogram1.value_at_percentile(100.0) == std::chrono::microseconds(100000));
+
+  auto json = histogram1.to_json();
+  REQUIRE(json["count"] == 101);
+  REQUIRE(json["min_us"] == 500);
+  REQUIRE(json["max_us"] == 100000);
+  REQUIRE(json["p50_us"] == histogram1.value_at_percentile(50.0).count());
+}
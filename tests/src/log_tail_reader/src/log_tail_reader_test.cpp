@@ -0,0 +1,117 @@
+#include <catch2/catch.hpp>
+
+#include "log_tail_reader.hpp"
+#include <fstream>
+
+namespace {
+std::string make_line(int millisecond, const std::string& message) {
+  return fmt::format("[2019-01-01 00:00:00.{0:03d}] [info] [test] {1}", millisecond, message);
+}
+
+void append(const std::string& file_path, const std::string& string) {
+  std::ofstream output(file_path, std::ios::app);
+  output << string;
+}
+
+std::vector<std::string> read_new_lines(krbn::log_tail_reader& reader) {
+  auto lines = reader.read_new_lines();
+  return std::vector<std::string>(std::begin(*lines), std::end(*lines));
+}
+} // namespace
+
+TEST_CASE("log_tail_reader") {
+  system("rm -rf tmp");
+  system("mkdir -p tmp");
+
+  krbn::log_tail_reader reader({"tmp/a.log", "tmp/b.log"}, 5);
+
+  // No files
+
+  REQUIRE(read_new_lines(reader).empty());
+
+  // Initial lines
+
+  append("tmp/a.log", make_line(1, "a1") + "\n" + make_line(3, "a3") + "\n");
+  append("tmp/b.log", make_line(2, "b2") + "\n");
+
+  REQUIRE(read_new_lines(reader) == std::vector<std::string>{
+                                        make_line(1, "a1"),
+                                        make_line(2, "b2"),
+                                        make_line(3, "a3"),
+                                    });
+  REQUIRE(read_new_lines(reader).empty());
+
+  // Appended lines are merged by timestamps.
+
+  append("tmp/a.log", make_line(5, "a5") + "\n");
+  append("tmp/b.log", make_line(4, "b4") + "\n");
+
+  REQUIRE(read_new_lines(reader) == std::vector<std::string>{
+                                        make_line(4, "b4"),
+                                        make_line(5, "a5"),
+                                    });
+
+  // A partial line is read after the line terminator is written.
+
+  append("tmp/a.log", "[2019-01-01 00:00:00.006] [info]");
+
+  REQUIRE(read_new_lines(reader).empty());
+
+  append("tmp/a.log", " [test] a6\n");
+
+  REQUIRE(read_new_lines(reader) == std::vector<std::string>{
+                                        make_line(6, "a6"),
+                                    });
+
+  // Broken lines are ignored.
+
+  append("tmp/a.log", "broken\n" + make_line(7, "a7") + "\n");
+
+  REQUIRE(read_new_lines(reader) == std::vector<std::string>{
+                                        make_line(7, "a7"),
+                                    });
+
+  // Rotation
+  // (Lines which are written into the old file before rotation are read from the rotated file.)
+
+  append("tmp/a.log", make_line(8, "a8") + "\n");
+  system("mv tmp/a.log tmp/a.1.log");
+  append("tmp/a.log", make_line(9, "a9") + "\n");
+
+  REQUIRE(read_new_lines(reader) == std::vector<std::string>{
+                                        make_line(8, "a8"),
+                                        make_line(9, "a9"),
+                                    });
+
+  // Rotation (the rotated file is replaced)
+
+  system("mv tmp/a.log tmp/a.1.log");
+  append("tmp/a.log", make_line(10, "a10") + "\n");
+
+  REQUIRE(read_new_lines(reader) == std::vector<std::string>{
+                                        make_line(10, "a10"),
+                                    });
+
+  // Truncation
+
+  system(": > tmp/b.log");
+  append("tmp/b.log", make_line(11, "b11") + "\n");
+
+  REQUIRE(read_new_lines(reader) == std::vector<std::string>{
+                                        make_line(11, "b11"),
+                                    });
+
+  // max_line_count
+
+  for (int i = 0; i < 10; ++i) {
+    append("tmp/b.log", make_line(100 + i, "b") + "\n");
+  }
+
+  REQUIRE(read_new_lines(reader) == std::vector<std::string>{
+                                        make_line(105, "b"),
+                                        make_line(106, "b"),
+                                        make_line(107, "b"),
+                                        make_line(108, "b"),
+                                        make_line(109, "b"),
+                                    });
+}
@@ -0,0 +1,177 @@
+#include <catch2/catch.hpp>
+
+#include "../../share/manipulator_helper.hpp"
+
+TEST_CASE("event_trace") {
+  auto event_trace = std::make_shared<krbn::manipulator::event_trace>();
+
+  std::vector<std::shared_ptr<krbn::event_queue::queue>> event_queues;
+  event_queues.push_back(std::make_shared<krbn::event_queue::queue>());
+  event_queues.push_back(std::make_shared<krbn::event_queue::queue>());
+  event_queues.push_back(std::make_shared<krbn::event_queue::queue>());
+
+  std::vector<std::shared_ptr<krbn::manipulator::manipulator_manager>> manipulator_managers;
+  manipulator_managers.push_back(std::make_shared<krbn::manipulator::manipulator_manager>());
+  manipulator_managers.push_back(std::make_shared<krbn::manipulator::manipulator_manager>());
+
+  krbn::core_configuration::details::complex_modifications_parameters parameters;
+  manipulator_managers[1]->push_back_manipulator(nlohmann::json::object({
+                                                     {"type", "basic"},
+                                                     {"from", {{"key_code", "c"}}},
+                                                     {"to", {{{"key_code", "d"}}}},
+                                                 }),
+                                                 parameters);
+  manipulator_managers[1]->push_back_manipulator(nlohmann::json::object({
+                                                     {"type", "basic"},
+                                                     {"from", {{"key_code", "a"}}},
+                                                     {"to", {{{"key_code", "b"}}}},
+                                                 }),
+                                                 parameters);
+
+  krbn::manipulator::manipulator_managers_connector connector;
+  connector.emplace_back_connection(manipulator_managers[0],
+                                    event_queues[0],
+                                    event_queues[1]);
+  connector.emplace_back_connection(manipulator_managers[1],
+                                    event_queues[2]);
+  connector.set_event_trace(event_trace);
+
+  event_queues[0]->emplace_back_entry(krbn::device_id(1),
+                                      krbn::event_queue::event_time_stamp(krbn::absolute_time_point(1000)),
+                                      krbn::event_queue::event(krbn::key_code::a),
+                                      krbn::event_type::key_down,
+                                      krbn::event_queue::event(krbn::key_code::a));
+
+  connector.manipulate(krbn::absolute_time_point(2000));
+
+  // Records
+
+  auto records = event_trace->make_snapshot();
+  REQUIRE(records.size() == 2);
+
+  REQUIRE(records[0].sequence == 0);
+  REQUIRE(records[0].stage == 0);
+  REQUIRE(records[0].device_id == 1);
+  REQUIRE(records[0].time_stamp == 1000);
+  REQUIRE(records[0].recorded_at == 2000);
+  REQUIRE(records[0].value == static_cast<uint32_t>(krbn::key_code::a));
+  REQUIRE(records[0].flags == krbn::manipulator::event_trace::flag_valid);
+  REQUIRE(records[0].manipulator_index == krbn::manipulator::event_trace::no_manipulator);
+
+  // `a` is manipulated by the second manipulator.
+  REQUIRE(records[1].stage == 1);
+  REQUIRE(records[1].value == static_cast<uint32_t>(krbn::key_code::a));
+  REQUIRE(records[1].flags == 0);
+  REQUIRE(records[1].manipulator_index == 1);
+
+  // The output of the last stage is not recorded.
+  REQUIRE(event_queues[2]->get_entries().size() == 1);
+  REQUIRE(event_queues[2]->get_entries().front().get_event() == krbn::event_queue::event(krbn::key_code::b));
+
+  // Binary
+
+  auto buffer = krbn::manipulator::event_trace::make_binary(records);
+  REQUIRE(buffer.size() == sizeof(krbn::manipulator::event_trace::file_header) +
+                               sizeof(krbn::manipulator::event_trace::record) * 2);
+
+  auto decoded_records = krbn::manipulator::event_trace::read_binary(buffer);
+  REQUIRE(decoded_records.size() == 2);
+  REQUIRE(memcmp(decoded_records.data(), records.data(), sizeof(krbn::manipulator::event_trace::record) * 2) == 0);
+
+  buffer.pop_back();
+  REQUIRE_THROWS(krbn::manipulator::event_trace::read_binary(buffer));
+
+  // Json
+
+  REQUIRE(krbn::manipulator::event_trace::to_json(records[1]) == nlohmann::json::object({
+                                                                     {"sequence", 1},
+                                                                     {"stage", 1},
+                                                                     {"device_id", 1},
+                                                                     {"time_stamp", 1000},
+                                                                     {"recorded_at", 2000},
+                                                                     {"event", {{"type", "key_code"}, {"key_code", "a"}}},
+                                                                     {"event_type", "key_down"},
+                                                                     {"valid", false},
+                                                                     {"lazy", false},
+                                                                     {"manipulator_index", 1},
+                                                                 }));
+
+  // Ring buffer
+
+  auto entry = event_queues[2]->get_entries().front();
+  for (size_t i = 0; i < krbn::manipulator::event_trace::capacity; ++i) {
+    event_trace->push_back_entry(2,
+                                 entry,
+                                 krbn::absolute_time_point(3000),
+                                 krbn::manipulator::event_trace::no_manipulator);
+  }
+
+  records = event_trace->make_snapshot();
+  REQUIRE(records.size() == krbn::manipulator::event_trace::capacity);
+  REQUIRE(records.front().sequence == 2);
+  REQUIRE(records.back().sequence == krbn::manipulator::event_trace::capacity + 1);
+
+  // make_snapshot(begin_sequence)
+
+  records = event_trace->make_snapshot(krbn::manipulator::event_trace::capacity);
+  REQUIRE(records.size() == 2);
+  REQUIRE(records.front().sequence == krbn::manipulator::event_trace::capacity);
+
+  records = event_trace->make_snapshot(1);
+  REQUIRE(records.size() == krbn::manipulator::event_trace::capacity);
+  REQUIRE(records.front().sequence == 2);
+
+  records = event_trace->make_snapshot(krbn::manipulator::event_trace::capacity + 2);
+  REQUIRE(records.empty());
+
+  manipulator_managers.clear();
+}
+
+TEST_CASE("event_trace.manipulator_index") {
+  krbn::manipulator::event_trace event_trace;
+  auto input_event_queue = std::make_shared<krbn::event_queue::queue>();
+  auto output_event_queue = std::make_shared<krbn::event_queue::queue>();
+  krbn::manipulator::manipulator_manager manipulator_manager;
+
+  krbn::core_configuration::details::complex_modifications_parameters parameters;
+  auto make_manipulator = [&](const std::string& from, const std::string& to) {
+    return krbn::manipulator::manipulator_factory::make_manipulator(nlohmann::json::object({
+                                                                        {"type", "basic"},
+                                                                        {"from", {{"key_code", from}}},
+                                                                        {"to", {{{"key_code", to}}}},
+                                                                    }),
+                                                                    parameters);
+  };
+  auto manipulate = [&](krbn::key_code key_code, krbn::event_type event_type) {
+    input_event_queue->emplace_back_entry(krbn::device_id(1),
+                                          krbn::event_queue::event_time_stamp(krbn::absolute_time_point(1000)),
+                                          krbn::event_queue::event(key_code),
+                                          event_type,
+                                          krbn::event_queue::event(key_code));
+    manipulator_manager.manipulate(input_event_queue,
+                                   output_event_queue,
+                                   krbn::absolute_time_point(2000),
+                                   &event_trace);
+    return event_trace.make_snapshot().back().manipulator_index;
+  };
+
+  auto a_to_b = make_manipulator("a", "b");
+  manipulator_manager.replace_manipulators({a_to_b});
+
+  REQUIRE(manipulate(krbn::key_code::a, krbn::event_type::key_down) == 0);
+
+  // `a_to_b` is kept at the front until `a` is released.
+
+  manipulator_manager.replace_manipulators({make_manipulator("c", "d"),
+                                            make_manipulator("a", "e")});
+  REQUIRE(manipulator_manager.get_manipulators_size() == 3);
+
+  REQUIRE(manipulate(krbn::key_code::c, krbn::event_type::key_down) == 0);
+  REQUIRE(manipulate(krbn::key_code::a, krbn::event_type::key_up) == krbn::manipulator::event_trace::invalidated_manipulator);
+  REQUIRE(manipulator_manager.get_manipulators_size() == 2);
+
+  REQUIRE(manipulate(krbn::key_code::a, krbn::event_type::key_down) == 1);
+  REQUIRE(manipulate(krbn::key_code::x, krbn::event_type::key_down) == krbn::manipulator::event_trace::no_manipulator);
+
+  REQUIRE(krbn::manipulator::event_trace::to_json(event_trace.make_snapshot()[2])["manipulator_invalidated"] == true);
+}
@@ -0,0 +1,96 @@
+#include <catch2/catch.hpp>
+
+#include "../../share/manipulator_helper.hpp"
+
+namespace {
+krbn::absolute_time_point make_time_point(std::chrono::milliseconds milliseconds) {
+  return krbn::absolute_time_point(0) + pqrs::osx::chrono::make_absolute_time_duration(milliseconds);
+}
+} // namespace
+
+TEST_CASE("latency_statistics") {
+  auto clock_now = make_time_point(std::chrono::milliseconds(0));
+  auto latency_statistics = std::make_shared<krbn::manipulator::latency_statistics>(
+      std::vector<std::string>{"stage0", "stage1"},
+      [&clock_now] {
+        return clock_now;
+      });
+
+  std::vector<std::shared_ptr<krbn::event_queue::queue>> event_queues;
+  event_queues.push_back(std::make_shared<krbn::event_queue::queue>());
+  event_queues.push_back(std::make_shared<krbn::event_queue::queue>());
+  event_queues.push_back(std::make_shared<krbn::event_queue::queue>());
+
+  std::vector<std::shared_ptr<krbn::manipulator::manipulator_manager>> manipulator_managers;
+  manipulator_managers.push_back(std::make_shared<krbn::manipulator::manipulator_manager>());
+  manipulator_managers.push_back(std::make_shared<krbn::manipulator::manipulator_manager>());
+
+  krbn::core_configuration::details::complex_modifications_parameters parameters;
+  manipulator_managers[1]->push_back_manipulator(nlohmann::json::object({
+                                                     {"type", "basic"},
+                                                     {"from", {{"simultaneous", {{{"key_code", "a"}}, {{"key_code", "b"}}}}}},
+                                                     {"to", {{{"key_code", "c"}}}},
+                                                 }),
+                                                 parameters);
+
+  krbn::manipulator::manipulator_managers_connector connector;
+  connector.emplace_back_connection(manipulator_managers[0],
+                                    event_queues[0],
+                                    event_queues[1]);
+  connector.emplace_back_connection(manipulator_managers[1],
+                                    event_queues[2]);
+  connector.set_latency_statistics(latency_statistics);
+
+  event_queues[0]->emplace_back_entry(krbn::device_id(1),
+                                      krbn::event_queue::event_time_stamp(make_time_point(std::chrono::milliseconds(1000))),
+                                      krbn::event_queue::event(krbn::key_code::a),
+                                      krbn::event_type::key_down,
+                                      krbn::event_queue::event(krbn::key_code::a));
+
+  // The second stage waits `b` until simultaneous_threshold_milliseconds.
+
+  clock_now = make_time_point(std::chrono::milliseconds(1002));
+  connector.manipulate(clock_now);
+
+  REQUIRE(event_queues[1]->get_entries().size() == 1);
+
+  clock_now = make_time_point(std::chrono::milliseconds(1100));
+  connector.manipulate(clock_now);
+
+  REQUIRE(event_queues[1]->get_entries().empty());
+  REQUIRE(event_queues[2]->get_entries().back().get_event() == krbn::event_queue::event(krbn::key_code::a));
+
+  // posted
+
+  latency_statistics->record_posted(make_time_point(std::chrono::milliseconds(1100)),
+                                    make_time_point(std::chrono::milliseconds(1103)));
+
+  // Check json
+
+  auto json = latency_statistics->to_json();
+
+  REQUIRE(json["stages"].size() == 2);
+
+  REQUIRE(json["stages"][0]["name"] == "stage0");
+  REQUIRE(json["stages"][0]["count"] == 1);
+  REQUIRE(json["stages"][0]["needs_wait_until_time_stamp_count"] == 0);
+  REQUIRE(json["stages"][0]["p50_us"] >= 2000);
+  REQUIRE(json["stages"][0]["p50_us"] < 2000 + 2000 / 16);
+
+  REQUIRE(json["stages"][1]["name"] == "stage1");
+  REQUIRE(json["stages"][1]["count"] == 1);
+  REQUIRE(json["stages"][1]["needs_wait_until_time_stamp_count"] == 1);
+  REQUIRE(json["stages"][1]["p50_us"] >= 100000);
+  REQUIRE(json["stages"][1]["p50_us"] < 100000 + 100000 / 16);
+
+  REQUIRE(json["posted"]["count"] == 1);
+  REQUIRE(json["posted"]["p50_us"] >= 3000);
+  REQUIRE(json["posted"]["p50_us"] < 3000 + 3000 / 16);
+
+  REQUIRE(latency_statistics->get_total_count() == 4);
+
+  latency_statistics->clear();
+  REQUIRE(latency_statistics->get_total_count() == 0);
+
+  manipulator_managers.clear();
+}
@@ -9,6 +9,16 @@ TEST_CASE("manipulator.manipulator_manager") {
   helper = nullptr;
 }
 
+TEST_CASE("manipulator.manipulator_manager.order_optimization") {
+  // The order optimization must not change results.
+
+  auto helper = std::make_unique<krbn::unit_testing::manipulator_helper>();
+  helper->set_order_optimization(true);
+  helper->run_tests(nlohmann::json::parse(std::ifstream("json/manipulator_manager/tests.json")));
+
+  helper = nullptr;
+}
+
 TEST_CASE("min_input_event_time_stamp") {
   std::vector<std::shared_ptr<krbn::event_queue::queue>> event_queues;
   event_queues.push_back(std::make_shared<krbn::event_queue::queue>());
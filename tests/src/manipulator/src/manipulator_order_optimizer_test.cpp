@@ -0,0 +1,124 @@
+#include <catch2/catch.hpp>
+
+#include "../../share/manipulator_helper.hpp"
+
+namespace {
+std::shared_ptr<krbn::manipulator::manipulators::base> make_manipulator(const nlohmann::json& json) {
+  krbn::core_configuration::details::complex_modifications_parameters parameters;
+  auto m = krbn::manipulator::manipulator_factory::make_manipulator(json, parameters);
+  if (auto conditions = json.find("conditions"); conditions != std::end(json)) {
+    for (const auto& c : *conditions) {
+      m->push_back_condition(krbn::manipulator::manipulator_factory::make_condition(c));
+    }
+  }
+  return m;
+}
+
+nlohmann::json make_variable_condition(const std::string& type, int value) {
+  return nlohmann::json::object({
+      {"type", type},
+      {"name", "mode"},
+      {"value", value},
+  });
+}
+
+krbn::event_queue::entry make_entry(krbn::key_code key_code,
+                                    krbn::event_type event_type) {
+  return krbn::event_queue::entry(krbn::device_id(1),
+                                  krbn::event_queue::event_time_stamp(krbn::absolute_time_point(0)),
+                                  krbn::event_queue::event(key_code),
+                                  event_type,
+                                  krbn::event_queue::event(key_code),
+                                  false);
+}
+} // namespace
+
+TEST_CASE("manipulator_order_optimizer") {
+  std::vector<std::shared_ptr<krbn::manipulator::manipulators::base>> manipulators{
+      // 0: a (mode == 1)
+      make_manipulator(nlohmann::json::object({
+          {"type", "basic"},
+          {"from", {{"key_code", "a"}}},
+          {"to", {{{"key_code", "1"}}}},
+          {"conditions", {make_variable_condition("variable_if", 1)}},
+      })),
+      // 1: b (not stateful)
+      make_manipulator(nlohmann::json::object({
+          {"type", "basic"},
+          {"from", {{"key_code", "b"}}},
+          {"to", {{{"key_code", "2"}}}},
+      })),
+      // 2: c (to_if_alone)
+      make_manipulator(nlohmann::json::object({
+          {"type", "basic"},
+          {"from", {{"key_code", "c"}}},
+          {"to", {{{"key_code", "left_control"}}}},
+          {"to_if_alone", {{{"key_code", "escape"}}}},
+      })),
+      // 3: a (mode != 1)
+      make_manipulator(nlohmann::json::object({
+          {"type", "basic"},
+          {"from", {{"key_code", "a"}}},
+          {"to", {{{"key_code", "3"}}}},
+          {"conditions", {make_variable_condition("variable_unless", 1)}},
+      })),
+      // 4: d (to_delayed_action)
+      make_manipulator(nlohmann::json::object({
+          {"type", "basic"},
+          {"from", {{"key_code", "d"}}},
+          {"to", {{{"key_code", "d"}}}},
+          {"to_delayed_action", {{"to_if_invoked", {{{"key_code", "4"}}}}}},
+      })),
+      // 5: a
+      make_manipulator(nlohmann::json::object({
+          {"type", "basic"},
+          {"from", {{"key_code", "a"}}},
+          {"to", {{{"key_code", "5"}}}},
+      })),
+      // 6: a (mandatory command)
+      make_manipulator(nlohmann::json::object({
+          {"type", "basic"},
+          {"from", {{"key_code", "a"}, {"modifiers", {{"mandatory", {"command"}}}}}},
+          {"to", {{{"key_code", "6"}}}},
+      })),
+  };
+
+  krbn::manipulator::manipulator_order_optimizer optimizer(4);
+
+  // Events other than key_down are evaluated in the rule order.
+
+  REQUIRE(optimizer.find_order(make_entry(krbn::key_code::a, krbn::event_type::key_up), manipulators) == nullptr);
+
+  // Manipulators which never react to `a` are skipped.
+
+  auto key_down_a = make_entry(krbn::key_code::a, krbn::event_type::key_down);
+  REQUIRE(*(optimizer.find_order(key_down_a, manipulators)) == std::vector<size_t>({0, 2, 3, 4, 5, 6}));
+
+  // Frequently matched manipulators are moved forward.
+  // (manipulator 3 and manipulator 0 have contradicting conditions.)
+
+  for (int i = 0; i < 4; ++i) {
+    optimizer.record(key_down_a.get_event(), 2);
+  }
+  REQUIRE(*(optimizer.find_order(key_down_a, manipulators)) == std::vector<size_t>({3, 0, 2, 4, 5, 6}));
+
+  // Manipulators are not moved over to_delayed_action.
+
+  for (int i = 0; i < 4; ++i) {
+    optimizer.record(key_down_a.get_event(), 4);
+  }
+  REQUIRE(*(optimizer.find_order(key_down_a, manipulators)) == std::vector<size_t>({3, 0, 2, 4, 5, 6}));
+
+  // Manipulators with disjoint mandatory modifiers are moved.
+  // (manipulator 6 requires command, manipulator 5 does not allow command.)
+
+  for (int i = 0; i < 4; ++i) {
+    optimizer.record(key_down_a.get_event(), 5);
+  }
+  REQUIRE(*(optimizer.find_order(key_down_a, manipulators)) == std::vector<size_t>({3, 0, 2, 4, 6, 5}));
+
+  // Orders are reset by `clear`.
+
+  optimizer.clear();
+  REQUIRE(*(optimizer.find_order(key_down_a, manipulators)) == std::vector<size_t>({0, 2, 3, 4, 5, 6}));
+}
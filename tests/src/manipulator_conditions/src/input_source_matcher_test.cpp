@@ -0,0 +1,78 @@
+#include <catch2/catch.hpp>
+
+#include "manipulator/input_source_matcher.hpp"
+
+namespace {
+void set_input_source(krbn::manipulator::manipulator_environment& manipulator_environment,
+                      const std::string& language,
+                      const std::string& input_source_id) {
+  pqrs::osx::input_source::properties properties;
+  properties.set_first_language(language);
+  properties.set_input_source_id(input_source_id);
+  manipulator_environment.set_input_source_properties(properties);
+}
+} // namespace
+
+TEST_CASE("input_source_matcher") {
+  krbn::manipulator::input_source_matcher matcher;
+  krbn::manipulator::manipulator_environment manipulator_environment;
+
+  auto en = matcher.make_specifier({{"language", "^en$"}});
+  auto en_us = matcher.make_specifier({
+      {"language", "^en$"},
+      {"input_source_id", "^com\\.apple\\.keylayout\\.US$"},
+  });
+  auto ja = matcher.make_specifier({{"language", "^ja$"}});
+  auto any = matcher.make_specifier(nlohmann::json::object());
+
+  // Same patterns are shared.
+
+  REQUIRE(en.language == en_us.language);
+  REQUIRE(matcher.get_pattern_count() == 3);
+
+  set_input_source(manipulator_environment, "en", "com.apple.keylayout.US");
+
+  REQUIRE(matcher.test({en}, manipulator_environment) == true);
+  REQUIRE(matcher.test({en_us}, manipulator_environment) == true);
+  REQUIRE(matcher.test({ja}, manipulator_environment) == false);
+  REQUIRE(matcher.test({ja, en}, manipulator_environment) == true);
+  REQUIRE(matcher.test({any}, manipulator_environment) == true);
+  REQUIRE(matcher.test({}, manipulator_environment) == false);
+
+  set_input_source(manipulator_environment, "en", "com.apple.keylayout.Dvorak");
+
+  REQUIRE(matcher.test({en}, manipulator_environment) == true);
+  REQUIRE(matcher.test({en_us}, manipulator_environment) == false);
+
+  set_input_source(manipulator_environment, "ja", "com.apple.inputmethod.Kotoeri.Japanese");
+
+  REQUIRE(matcher.test({en}, manipulator_environment) == false);
+  REQUIRE(matcher.test({ja}, manipulator_environment) == true);
+
+  // Missing properties do not match.
+
+  manipulator_environment.set_input_source_properties(pqrs::osx::input_source::properties());
+
+  REQUIRE(matcher.test({ja}, manipulator_environment) == false);
+  REQUIRE(matcher.test({any}, manipulator_environment) == true);
+
+  // Released patterns are reused for new patterns.
+
+  ja = krbn::manipulator::input_source_matcher::specifier();
+  REQUIRE(matcher.get_pattern_count() == 2);
+
+  auto fr = matcher.make_specifier({{"language", "^fr$"}});
+  REQUIRE(matcher.get_pattern_count() == 3);
+
+  // New patterns are tested even if the input source is not changed.
+
+  set_input_source(manipulator_environment, "fr", "com.apple.keylayout.French");
+
+  REQUIRE(matcher.test({en}, manipulator_environment) == false);
+
+  auto fr2 = matcher.make_specifier({{"input_source_id", "French"}});
+
+  REQUIRE(matcher.test({fr}, manipulator_environment) == true);
+  REQUIRE(matcher.test({fr2}, manipulator_environment) == true);
+  REQUIRE(matcher.test({en}, manipulator_environment) == false);
+}
@@ -161,6 +161,71 @@ TEST_CASE("manipulator_environment.save_to_file") {
                                                          "tmp/manipulator_environment.json"));
 }
 
+TEST_CASE("manipulator_environment.generation") {
+  krbn::manipulator::manipulator_environment manipulator_environment;
+
+  // Generations are changed only when values are changed.
+
+  {
+    auto generation = manipulator_environment.get_frontmost_application_generation();
+
+    pqrs::osx::frontmost_application_monitor::application application;
+    application.set_bundle_identifier("com.apple.Terminal");
+    manipulator_environment.set_frontmost_application(application);
+    REQUIRE(manipulator_environment.get_frontmost_application_generation() != generation);
+
+    generation = manipulator_environment.get_frontmost_application_generation();
+    manipulator_environment.set_frontmost_application(application);
+    REQUIRE(manipulator_environment.get_frontmost_application_generation() == generation);
+  }
+
+  {
+    auto generation = manipulator_environment.get_input_source_properties_generation();
+
+    pqrs::osx::input_source::properties properties;
+    properties.set_input_source_id("com.apple.keylayout.US");
+    manipulator_environment.set_input_source_properties(properties);
+    REQUIRE(manipulator_environment.get_input_source_properties_generation() != generation);
+
+    generation = manipulator_environment.get_input_source_properties_generation();
+    manipulator_environment.set_input_source_properties(properties);
+    REQUIRE(manipulator_environment.get_input_source_properties_generation() == generation);
+  }
+
+  {
+    auto generation = manipulator_environment.get_virtual_hid_keyboard_keyboard_type_generation();
+
+    pqrs::osx::system_preferences::properties system_preferences_properties;
+    system_preferences_properties.set_keyboard_types(
+        std::map<pqrs::osx::system_preferences::keyboard_type_key,
+                 pqrs::osx::iokit_keyboard_type>({
+            {
+                pqrs::osx::system_preferences::keyboard_type_key(krbn::vendor_id_karabiner_virtual_hid_device,
+                                                                 krbn::product_id_karabiner_virtual_hid_keyboard,
+                                                                 krbn::hid_country_code(0)),
+                pqrs::osx::iokit_keyboard_type(41), // iso
+            },
+        }));
+    manipulator_environment.set_system_preferences_properties(system_preferences_properties);
+    REQUIRE(manipulator_environment.get_virtual_hid_keyboard_keyboard_type_generation() != generation);
+
+    // The keyboard type is not changed.
+
+    generation = manipulator_environment.get_virtual_hid_keyboard_keyboard_type_generation();
+    manipulator_environment.set_virtual_hid_keyboard_country_code(krbn::hid_country_code(0));
+    REQUIRE(manipulator_environment.get_virtual_hid_keyboard_keyboard_type_generation() == generation);
+  }
+
+  // Generations are unique among instances.
+
+  {
+    krbn::manipulator::manipulator_environment other;
+    REQUIRE(other.get_frontmost_application_generation() != manipulator_environment.get_frontmost_application_generation());
+    REQUIRE(other.get_input_source_properties_generation() != manipulator_environment.get_input_source_properties_generation());
+    REQUIRE(other.get_virtual_hid_keyboard_keyboard_type_generation() != manipulator_environment.get_virtual_hid_keyboard_keyboard_type_generation());
+  }
+}
+
 TEST_CASE("conditions.frontmost_application") {
   actual_examples_helper helper("frontmost_application.json");
   krbn::manipulator::manipulator_environment manipulator_environment;
@@ -506,6 +571,16 @@ TEST_CASE("conditions.keyboard_type") {
     manipulator_environment.set_virtual_hid_keyboard_country_code(krbn::hid_country_code(1));
     REQUIRE(helper.get_condition_manager().is_fulfilled(entry,
                                                         manipulator_environment) == true);
+    // use cache
+    REQUIRE(helper.get_condition_manager().is_fulfilled(entry,
+                                                        manipulator_environment) == true);
+
+    // Cached results are not used for another environment.
+    {
+      krbn::manipulator::manipulator_environment other;
+      REQUIRE(helper.get_condition_manager().is_fulfilled(entry,
+                                                          other) == false);
+    }
 
     // ansi
     manipulator_environment.set_virtual_hid_keyboard_country_code(krbn::hid_country_code(0));
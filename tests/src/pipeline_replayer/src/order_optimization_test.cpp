@@ -0,0 +1,100 @@
+#include <catch2/catch.hpp>
+
+#include "grabber/pipeline_replayer.hpp"
+#include <random>
+
+namespace {
+// Make a random key stream which contains simultaneous key presses, holds and modifier combinations.
+std::vector<krbn::event_queue::entry> make_random_input_events(uint32_t seed,
+                                                               size_t count) {
+  std::mt19937 engine(seed);
+
+  // `a` and `j` are pressed frequently in order to reorder manipulators.
+  std::vector<krbn::key_code> key_codes{
+      krbn::key_code::a,
+      krbn::key_code::a,
+      krbn::key_code::a,
+      krbn::key_code::j,
+      krbn::key_code::j,
+      krbn::key_code::k,
+      krbn::key_code::s,
+      krbn::key_code::d,
+      krbn::key_code::f,
+      krbn::key_code::spacebar,
+      krbn::key_code::left_shift,
+      krbn::key_code::left_command,
+  };
+
+  std::vector<krbn::event_queue::entry> result;
+  std::vector<krbn::key_code> pressed_keys;
+  auto time_stamp = krbn::absolute_time_point(0) + pqrs::osx::chrono::make_absolute_time_duration(std::chrono::milliseconds(1000));
+
+  auto push_back = [&](krbn::key_code key_code, krbn::event_type event_type) {
+    result.emplace_back(krbn::device_id(1),
+                        krbn::event_queue::event_time_stamp(time_stamp),
+                        krbn::event_queue::event(key_code),
+                        event_type,
+                        krbn::event_queue::event(key_code));
+
+    // Short intervals for simultaneous, long intervals for to_if_held_down, to_if_alone and to_delayed_action.
+    std::uniform_int_distribution<int> interval_type(0, 2);
+    std::uniform_int_distribution<int> short_interval(0, 40);
+    std::uniform_int_distribution<int> long_interval(50, 800);
+    auto interval = interval_type(engine) == 0 ? short_interval(engine) : long_interval(engine);
+    time_stamp += pqrs::osx::chrono::make_absolute_time_duration(std::chrono::milliseconds(interval));
+  };
+
+  std::uniform_int_distribution<size_t> key_index(0, key_codes.size() - 1);
+  std::uniform_int_distribution<int> release(0, 2);
+
+  while (result.size() < count) {
+    if (!pressed_keys.empty() && (pressed_keys.size() >= 3 || release(engine) == 0)) {
+      std::uniform_int_distribution<size_t> pressed_index(0, pressed_keys.size() - 1);
+      auto it = std::begin(pressed_keys) + pressed_index(engine);
+      push_back(*it, krbn::event_type::key_up);
+      pressed_keys.erase(it);
+      continue;
+    }
+
+    auto key_code = key_codes[key_index(engine)];
+    if (std::find(std::begin(pressed_keys), std::end(pressed_keys), key_code) != std::end(pressed_keys)) {
+      continue;
+    }
+
+    push_back(key_code, krbn::event_type::key_down);
+    pressed_keys.push_back(key_code);
+  }
+
+  for (const auto& key_code : pressed_keys) {
+    push_back(key_code, krbn::event_type::key_up);
+  }
+
+  return result;
+}
+} // namespace
+
+TEST_CASE("pipeline_replayer.order_optimization") {
+  // Replay random event streams with and without `manipulator_order_optimizer` and compare the output.
+
+  auto profile = krbn::grabber::pipeline_replayer::load_profile("json/order_optimization.json");
+
+  for (uint32_t seed = 0; seed < 8; ++seed) {
+    auto input_events = make_random_input_events(seed, 1000);
+
+    std::vector<std::shared_ptr<krbn::grabber::pipeline_replayer::result>> results;
+    for (auto order_optimization : {false, true}) {
+      krbn::grabber::pipeline_replayer::options options;
+      options.order_optimization = order_optimization;
+
+      auto replayer = std::make_unique<krbn::grabber::pipeline_replayer>(*profile, options);
+      results.push_back(replayer->replay(input_events));
+      replayer = nullptr;
+    }
+
+    INFO("seed: " << seed);
+
+    REQUIRE(results[0]->reports.size() > 0);
+    REQUIRE(results[0]->reports == results[1]->reports);
+    REQUIRE(results[0]->rule_hit_counts == results[1]->rule_hit_counts);
+  }
+}
@@ -0,0 +1,113 @@
+#include <catch2/catch.hpp>
+
+#include "grabber/pipeline_replayer.hpp"
+
+TEST_CASE("pipeline_replayer") {
+  auto profile = krbn::grabber::pipeline_replayer::load_profile("json/karabiner.json");
+  auto input_events = krbn::grabber::pipeline_replayer::load_input_events("json/input_events.json");
+
+  uint64_t allocation_count = 0;
+  krbn::grabber::pipeline_replayer::options options;
+  options.allocation_counter = [&allocation_count] {
+    return ++allocation_count;
+  };
+
+  // Replay several times in order to confirm the result is deterministic.
+
+  std::vector<std::shared_ptr<krbn::grabber::pipeline_replayer::result>> results;
+  for (int i = 0; i < 3; ++i) {
+    auto replayer = std::make_unique<krbn::grabber::pipeline_replayer>(*profile, options);
+    results.push_back(replayer->replay(input_events));
+    replayer = nullptr;
+  }
+
+  for (const auto& r : results) {
+    REQUIRE(r->reports == results.front()->reports);
+
+    REQUIRE(r->cpu_times.size() == input_events.size());
+    REQUIRE(r->allocation_counts.size() == input_events.size());
+    // `allocation_counter` is called twice per event.
+    REQUIRE(r->allocation_counts.front() == 1);
+  }
+
+  auto& reports = results.front()->reports;
+
+  // caps_lock -> left_control (simple_modifications)
+
+  REQUIRE(reports.size() > 1);
+  REQUIRE(reports[0]["keyboard_input"]["modifiers"] == nlohmann::json::array({"left_control"}));
+
+  // Reports are ordered by time stamp.
+
+  for (size_t i = 1; i < reports.size(); ++i) {
+    REQUIRE(reports[i - 1]["time_stamp"].get<uint64_t>() <= reports[i]["time_stamp"].get<uint64_t>());
+  }
+
+  auto statistics = results.front()->make_statistics_json();
+  REQUIRE(statistics["event_count"] == input_events.size());
+  REQUIRE(statistics["report_count"] == reports.size());
+  REQUIRE(statistics["allocations"]["total"] == input_events.size());
+}
+
+TEST_CASE("pipeline_replayer.load_input_events") {
+  // Make an event trace file from the input events.
+
+  auto input_events = krbn::grabber::pipeline_replayer::load_input_events("json/input_events.json");
+
+  krbn::manipulator::event_trace event_trace;
+  for (const auto& e : input_events) {
+    auto time_stamp = e.get_event_time_stamp().get_time_stamp();
+    event_trace.push_back_entry(0, e, time_stamp, krbn::manipulator::event_trace::no_manipulator);
+    event_trace.push_back_entry(1, e, time_stamp, krbn::manipulator::event_trace::no_manipulator);
+  }
+
+  {
+    system("rm -rf tmp");
+    system("mkdir -p tmp");
+
+    auto buffer = krbn::manipulator::event_trace::make_binary(event_trace.make_snapshot());
+    std::ofstream ofs("tmp/event_trace.bin", std::ios::binary);
+    REQUIRE(ofs);
+    ofs.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+  }
+
+  // Only the first stage is loaded.
+
+  auto loaded_events = krbn::grabber::pipeline_replayer::load_input_events("tmp/event_trace.bin");
+  REQUIRE(loaded_events.size() == input_events.size());
+  for (size_t i = 0; i < input_events.size(); ++i) {
+    REQUIRE(loaded_events[i].get_event() == input_events[i].get_event());
+    REQUIRE(loaded_events[i].get_event_type() == input_events[i].get_event_type());
+    REQUIRE(loaded_events[i].get_event_time_stamp().get_time_stamp() - loaded_events[0].get_event_time_stamp().get_time_stamp() ==
+            input_events[i].get_event_time_stamp().get_time_stamp() - input_events[0].get_event_time_stamp().get_time_stamp());
+  }
+}
+
+TEST_CASE("pipeline_replayer.script") {
+  auto profile = krbn::grabber::pipeline_replayer::load_profile("json/karabiner.json");
+  auto input_events = krbn::grabber::pipeline_replayer::load_input_events("json/script.json");
+
+  REQUIRE(input_events.size() == 6);
+  REQUIRE(input_events[0].get_event() == krbn::event_queue::event(krbn::key_code::caps_lock));
+  REQUIRE(input_events[0].get_event_type() == krbn::event_type::key_down);
+  REQUIRE(input_events[0].get_event_time_stamp().get_time_stamp() ==
+          krbn::absolute_time_point(0) + pqrs::osx::chrono::make_absolute_time_duration(std::chrono::milliseconds(1000)));
+  REQUIRE(input_events[5].get_event_time_stamp().get_time_stamp() ==
+          krbn::absolute_time_point(0) + pqrs::osx::chrono::make_absolute_time_duration(std::chrono::milliseconds(1080)));
+
+  auto replayer = std::make_unique<krbn::grabber::pipeline_replayer>(*profile);
+  auto result = replayer->replay(input_events);
+  replayer = nullptr;
+
+  // control-h is manipulated by the first rule (key_down and key_up).
+
+  REQUIRE(result->rule_descriptions.size() == profile->get_complex_modifications().get_rules().size());
+  REQUIRE(result->rule_descriptions[0] == "control-h to delete_or_backspace");
+  REQUIRE(result->rule_hit_counts[0] == 2);
+  for (size_t i = 1; i < result->rule_hit_counts.size(); ++i) {
+    REQUIRE(result->rule_hit_counts[i] == 0);
+  }
+
+  auto rules_json = result->make_rules_json();
+  REQUIRE(rules_json[0]["hit_count"] == 2);
+}
@@ -29,6 +29,11 @@ public:
     });
   }
 
+  // Manipulators are reordered after every key_down event if `order_optimization` is true.
+  void set_order_optimization(bool value) {
+    order_optimization_ = value;
+  }
+
   void run_tests(const nlohmann::json& json,
                  bool overwrite_expected_results = false) {
     logger::get_logger()->info("krbn::unit_testing::manipulator_helper::run_tests");
@@ -48,6 +53,9 @@ public:
 
       for (const auto& rule : test["rules"]) {
         manipulator_managers->push_back(std::make_shared<manipulator::manipulator_manager>());
+        if (order_optimization_) {
+          manipulator_managers->back()->set_order_optimization_enabled(true, 1);
+        }
 
         {
           std::ifstream ifs(rule.get<std::string>());
@@ -232,6 +240,7 @@ private:
   std::weak_ptr<pqrs::dispatcher::time_source> original_weak_time_source_;
   std::shared_ptr<pqrs::dispatcher::pseudo_time_source> pseudo_time_source_;
   absolute_time_point now_;
+  bool order_optimization_ = false;
 };
 } // namespace unit_testing
 } // namespace krbn
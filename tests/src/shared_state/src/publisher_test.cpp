@@ -0,0 +1,80 @@
+#include <catch2/catch.hpp>
+
+#include "shared_state/publisher.hpp"
+#include <pqrs/filesystem.hpp>
+
+namespace {
+const std::string json_file_path("tmp/publisher.json");
+
+void publish(const nlohmann::json& json) {
+  krbn::shared_state::publisher::async_publish(krbn::shared_state::segment::region::grabber_alerts,
+                                               json,
+                                               json_file_path);
+  krbn::async_file_writer::wait();
+}
+} // namespace
+
+TEST_CASE("publisher") {
+  using region = krbn::shared_state::segment::region;
+
+  auto name = fmt::format("/krbn_test_publisher_{0}", getpid());
+
+  auto json1 = nlohmann::json::object({{"alerts", nlohmann::json::array()}});
+  auto json2 = nlohmann::json::object({{"alerts", nlohmann::json::array({"system_policy_prevents_loading_kext"})}});
+
+  // Not initialized (json files are always written)
+
+  unlink(json_file_path.c_str());
+  publish(json1);
+  REQUIRE(pqrs::filesystem::exists(json_file_path));
+
+  unlink(json_file_path.c_str());
+  publish(json1);
+  REQUIRE(pqrs::filesystem::exists(json_file_path));
+
+  // Initialized
+
+  krbn::shared_state::publisher::initialize(name);
+
+  auto reader = krbn::shared_state::segment::open(name, geteuid());
+  REQUIRE(reader);
+
+  // The json file is not written while the document is published in the segment.
+
+  unlink(json_file_path.c_str());
+  publish(json1);
+  REQUIRE(!pqrs::filesystem::exists(json_file_path));
+  REQUIRE(reader->get_generation(region::grabber_alerts) == 1);
+  REQUIRE(reader->read(region::grabber_alerts) == json1);
+
+  publish(json1);
+  REQUIRE(reader->get_generation(region::grabber_alerts) == 1);
+
+  publish(json2);
+  REQUIRE(!pqrs::filesystem::exists(json_file_path));
+  REQUIRE(reader->get_generation(region::grabber_alerts) == 2);
+  REQUIRE(reader->read(region::grabber_alerts) == json2);
+
+  // Too large documents are written into the json file.
+
+  auto json3 = nlohmann::json::object({{"alerts", nlohmann::json::array({std::string(krbn::shared_state::segment::region_capacity, 'x')})}});
+
+  publish(json3);
+  REQUIRE(reader->get_generation(region::grabber_alerts) == 4);
+  REQUIRE(reader->read(region::grabber_alerts) == std::nullopt);
+
+  {
+    std::ifstream input(json_file_path);
+    REQUIRE(nlohmann::json::parse(input) == json3);
+  }
+
+  publish(json2);
+  REQUIRE(reader->get_generation(region::grabber_alerts) == 5);
+  REQUIRE(reader->read(region::grabber_alerts) == json2);
+
+  // Terminate
+
+  krbn::shared_state::publisher::terminate();
+
+  REQUIRE(reader->closed());
+}
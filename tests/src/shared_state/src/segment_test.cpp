@@ -0,0 +1,217 @@
+#include <catch2/catch.hpp>
+
+#include "shared_state/segment.hpp"
+#include <thread>
+
+namespace {
+std::string make_segment_name(void) {
+  return fmt::format("/krbn_test_{0}", getpid());
+}
+} // namespace
+
+TEST_CASE("segment") {
+  using region = krbn::shared_state::segment::region;
+  using publish_result = krbn::shared_state::segment::publish_result;
+
+  auto name = make_segment_name();
+
+  REQUIRE(krbn::shared_state::segment::open(name, geteuid()) == nullptr);
+
+  auto writer = krbn::shared_state::segment::create(name);
+  REQUIRE(writer);
+
+  auto reader = krbn::shared_state::segment::open(name, geteuid());
+  REQUIRE(reader);
+  REQUIRE(!reader->closed());
+
+  // Not published
+
+  REQUIRE(reader->get_generation(region::devices) == 0);
+  REQUIRE(reader->read(region::devices) == std::nullopt);
+  REQUIRE(reader->to_json() == nlohmann::json::object());
+
+  // Publish
+
+  auto json = nlohmann::json::object({
+      {"alerts", nlohmann::json::array({"system_policy_prevents_loading_kext"})},
+  });
+
+  REQUIRE(writer->publish(region::grabber_alerts, json) == publish_result::published);
+  REQUIRE(reader->get_generation(region::grabber_alerts) == 1);
+  REQUIRE(reader->get_generation(region::devices) == 0);
+  REQUIRE(reader->read(region::grabber_alerts) == json);
+
+  // Unchanged
+
+  REQUIRE(writer->publish(region::grabber_alerts, json) == publish_result::unchanged);
+  REQUIRE(reader->get_generation(region::grabber_alerts) == 1);
+
+  // Changed
+
+  json["alerts"] = nlohmann::json::array();
+  REQUIRE(writer->publish(region::grabber_alerts, json) == publish_result::published);
+  REQUIRE(reader->get_generation(region::grabber_alerts) == 2);
+  REQUIRE(reader->read(region::grabber_alerts) == json);
+
+  REQUIRE(reader->to_json() == nlohmann::json::object({
+                                   {"grabber_alerts", nlohmann::json::object({
+                                                          {"generation", 2},
+                                                          {"value", json},
+                                                      })},
+                               }));
+
+  // wait_for_generation
+
+  REQUIRE(reader->wait_for_generation(region::devices, 0, std::chrono::milliseconds(10)) == std::nullopt);
+
+  {
+    std::thread thread([&writer] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      writer->publish(region::devices, nlohmann::json::array());
+    });
+
+    REQUIRE(reader->wait_for_generation(region::devices, 0, std::chrono::milliseconds(5000)) == 1);
+
+    thread.join();
+  }
+
+  // Too large (The previous payload is cleared.)
+
+  {
+    std::string large(krbn::shared_state::segment::region_capacity, 'x');
+    REQUIRE(writer->publish(region::devices, nlohmann::json(large)) == publish_result::too_large);
+    REQUIRE(reader->get_generation(region::devices) == 2);
+    REQUIRE(reader->read(region::devices) == std::nullopt);
+
+    std::vector<uint8_t> bytes;
+    REQUIRE(reader->read_bytes(region::devices, bytes) == 2);
+    REQUIRE(bytes.empty());
+
+    REQUIRE(reader->to_json()["devices"] == nlohmann::json::object({
+                                                {"generation", 2},
+                                            }));
+
+    // publish_unavailable
+
+    writer->publish_unavailable(region::devices);
+    REQUIRE(reader->get_generation(region::devices) == 3);
+    REQUIRE(reader->read(region::devices) == std::nullopt);
+
+    // The region becomes available again.
+
+    REQUIRE(writer->publish(region::devices, nlohmann::json::array()) == publish_result::published);
+    REQUIRE(reader->get_generation(region::devices) == 4);
+    REQUIRE(reader->read(region::devices) == nlohmann::json::array());
+  }
+
+  // Close
+
+  writer = nullptr;
+
+  REQUIRE(reader->closed());
+  REQUIRE(krbn::shared_state::segment::open(name, geteuid()) == nullptr);
+}
+
+TEST_CASE("segment recreate") {
+  using region = krbn::shared_state::segment::region;
+
+  auto name = make_segment_name();
+
+  auto writer1 = krbn::shared_state::segment::create(name);
+  writer1->publish(region::devices, nlohmann::json::array({1}));
+
+  auto reader1 = krbn::shared_state::segment::open(name, geteuid());
+  REQUIRE(reader1->read(region::devices) == nlohmann::json::array({1}));
+
+  // Replace the segment (e.g., karabiner_grabber is restarted.)
+
+  auto writer2 = krbn::shared_state::segment::create(name);
+  writer2->publish(region::devices, nlohmann::json::array({2}));
+
+  auto reader2 = krbn::shared_state::segment::open(name, geteuid());
+  REQUIRE(reader2->read(region::devices) == nlohmann::json::array({2}));
+
+  // reader1 still refers the old segment.
+  REQUIRE(reader1->read(region::devices) == nlohmann::json::array({1}));
+
+  writer1 = nullptr;
+  REQUIRE(reader1->closed());
+  REQUIRE(!reader2->closed());
+
+  // writer1 must not unlink the segment of writer2.
+  REQUIRE(krbn::shared_state::segment::open(name, geteuid()));
+
+  writer2 = nullptr;
+  REQUIRE(reader2->closed());
+  REQUIRE(krbn::shared_state::segment::open(name, geteuid()) == nullptr);
+}
+
+TEST_CASE("segment owner") {
+  auto name = make_segment_name();
+
+  auto writer = krbn::shared_state::segment::create(name);
+  REQUIRE(writer);
+
+  // Segments which are owned by other users are ignored.
+
+  REQUIRE(krbn::shared_state::segment::open(name, geteuid()));
+  REQUIRE(krbn::shared_state::segment::open(name, geteuid() + 1) == nullptr);
+}
+
+TEST_CASE("segment create existing") {
+  using region = krbn::shared_state::segment::region;
+
+  auto name = make_segment_name();
+
+  // A segment which is not created by `segment::create` is replaced.
+
+  int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+  REQUIRE(fd >= 0);
+  close(fd);
+
+  auto writer = krbn::shared_state::segment::create(name);
+  REQUIRE(writer);
+  writer->publish(region::devices, nlohmann::json::array({1}));
+
+  auto reader = krbn::shared_state::segment::open(name, geteuid());
+  REQUIRE(reader);
+  REQUIRE(reader->read(region::devices) == nlohmann::json::array({1}));
+}
+
+TEST_CASE("segment concurrent read") {
+  using region = krbn::shared_state::segment::region;
+
+  auto name = make_segment_name();
+
+  auto writer = krbn::shared_state::segment::create(name);
+  auto reader = krbn::shared_state::segment::open(name, geteuid());
+
+  const int count = 2000;
+
+  std::thread thread([&writer] {
+    for (int i = 1; i <= count; ++i) {
+      // Each document has a consistent content: all elements are `i`.
+      writer->publish(region::manipulator_environment,
+                      nlohmann::json::object({
+                          {"variables", nlohmann::json::array({i, i, i, i})},
+                          {"padding", std::string(i % 1000, 'x')},
+                      }));
+    }
+  });
+
+  uint64_t last_generation = 0;
+  while (last_generation < count) {
+    std::vector<uint8_t> bytes;
+    if (auto generation = reader->read_bytes(region::manipulator_environment, bytes)) {
+      REQUIRE(*generation >= last_generation);
+      last_generation = *generation;
+
+      auto json = nlohmann::json::from_msgpack(bytes);
+      auto i = json["variables"][0].get<int>();
+      REQUIRE(json["variables"] == nlohmann::json::array({i, i, i, i}));
+      REQUIRE(json["padding"].get<std::string>().size() == static_cast<size_t>(i % 1000));
+    }
+  }
+
+  thread.join();
+}
@@ -0,0 +1,78 @@
+#include <catch2/catch.hpp>
+
+#include "types.hpp"
+
+namespace {
+enum class example : uint32_t {
+  zero,
+  one,
+  two,
+  large = 0x10000,
+};
+} // namespace
+
+TEST_CASE("name_value_table") {
+  {
+    krbn::name_value_table<example> table({
+        {"zero", example::zero},
+        {"one", example::one},
+        {"uno", example::one},
+        {"two", example::two},
+        {"large", example::large},
+    });
+
+    REQUIRE(table.find_value("zero") == example::zero);
+    REQUIRE(table.find_value("one") == example::one);
+    REQUIRE(table.find_value("uno") == example::one);
+    REQUIRE(table.find_value("two") == example::two);
+    REQUIRE(table.find_value("large") == example::large);
+    REQUIRE(table.find_value("three") == std::nullopt);
+    REQUIRE(table.find_value("") == std::nullopt);
+
+    // The first name is used.
+    REQUIRE(table.make_name(example::one) == "one");
+    REQUIRE(table.make_name(example::large) == "large");
+    REQUIRE(table.make_name(example(3)) == "(number:3)");
+    REQUIRE(table.make_name(example(0x10001)) == "(number:65537)");
+    REQUIRE(table.find_name(example(3)) == nullptr);
+  }
+
+  // Empty table
+
+  {
+    krbn::name_value_table<example> table({});
+
+    REQUIRE(table.find_value("zero") == std::nullopt);
+    REQUIRE(table.make_name(example::zero) == "(number:0)");
+  }
+
+  // Duplicated names
+
+  {
+    REQUIRE_THROWS_AS(krbn::name_value_table<example>({
+                          {"zero", example::zero},
+                          {"zero", example::one},
+                      }),
+                      std::logic_error);
+  }
+}
+
+TEST_CASE("name_value_table (all names)") {
+  for (const auto& pair : krbn::impl::get_key_code_name_value_pairs()) {
+    REQUIRE(krbn::make_key_code(pair.first) == pair.second);
+  }
+  for (const auto& pair : krbn::impl::get_consumer_key_code_name_value_pairs()) {
+    REQUIRE(krbn::make_consumer_key_code(pair.first) == pair.second);
+  }
+  for (const auto& pair : krbn::impl::get_pointing_button_name_value_pairs()) {
+    REQUIRE(krbn::make_pointing_button(pair.first) == pair.second);
+  }
+  for (const auto& pair : krbn::impl::get_modifier_flag_name_value_pairs()) {
+    REQUIRE(krbn::make_modifier_flag(pair.first) == pair.second);
+    REQUIRE(krbn::make_modifier_flag_name(pair.second) == pair.first);
+  }
+
+  REQUIRE(krbn::make_modifier_flag("left_shift") == krbn::modifier_flag::left_shift);
+  REQUIRE(krbn::make_modifier_flag("unknown") == std::nullopt);
+  REQUIRE(krbn::make_modifier_flag_name(krbn::modifier_flag::end_) == "(number:12)");
+}